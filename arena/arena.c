@@ -0,0 +1,120 @@
+//  arena.c : partie implantation d'un module pour l'allocation par blocs de
+//    zones d'octets qui sont toutes libérées en même temps.
+
+#include <stdint.h>
+
+#include "arena.h"
+#include "hugemem.h"
+
+//  La taille des blocs, en-tête compris, est initialement ARENA__BLOCK_MIN
+//    octets et double à chaque nouveau bloc jusqu'à ARENA__BLOCK_MAX octets,
+//    de sorte qu'une petite arène n'occupe que peu de mémoire. Les zones qui
+//    ne tiendraient pas dans un bloc disposent d'un bloc à leur mesure. Les
+//    blocs sont alloués par le module hugemem : ceux de taille maximale, celle
+//    d'une page géante, sont rangés sur des pages géantes au seuil par défaut.
+
+#define ARENA__BLOCK_MIN  1024
+#define ARENA__BLOCK_MAX  HUGEMEM_PAGE
+#define ARENA__BLOCK_MUL  2
+
+//  struct block, block : en-tête d'un bloc. Les octets disponibles suivent
+//    immédiatement l'en-tête ; size est leur nombre.
+typedef struct block block;
+
+struct block {
+  block *next;
+  size_t size;
+};
+
+//  struct arena, arena : liste simplement chainée des blocs, le bloc courant
+//    en tête. Le composant free mémorise le nombre d'octets encore disponibles
+//    à la fin du bloc courant, bsize la taille, en-tête compris, du prochain
+//    bloc, memory le nombre total d'octets alloués aux blocs.
+struct arena {
+  block *head;
+  size_t free;
+  size_t bsize;
+  size_t memory;
+};
+
+#define BLOCK_DATA(b) ((char *) ((b) + 1))
+
+arena *arena_empty(void) {
+  arena *ar = malloc(sizeof *ar);
+  if (ar == NULL) {
+    return NULL;
+  }
+  ar->head = NULL;
+  ar->free = 0;
+  ar->bsize = ARENA__BLOCK_MIN;
+  ar->memory = 0;
+  return ar;
+}
+
+void arena_dispose(arena **arptr) {
+  if (*arptr == NULL) {
+    return;
+  }
+  arena_clear(*arptr);
+  free(*arptr);
+  *arptr = NULL;
+}
+
+void *arena_alloc(arena *ar, size_t size) {
+  if (size > ar->free) {
+    size_t bsize = ar->bsize - sizeof(block);
+    if (size > bsize) {
+      if (size > SIZE_MAX - sizeof(block)) {
+        return NULL;
+      }
+      bsize = size;
+    }
+    block *b = hugemem_alloc(sizeof *b + bsize);
+    if (b == NULL) {
+      return NULL;
+    }
+    b->size = bsize;
+    ar->memory += sizeof *b + bsize;
+    if (bsize > ar->bsize - sizeof(block) && ar->head != NULL) {
+      //  Bloc à la mesure : inséré derrière le bloc courant pour ne pas perdre
+      //    les octets encore disponibles de ce dernier.
+      b->next = ar->head->next;
+      ar->head->next = b;
+      return BLOCK_DATA(b);
+    }
+    b->next = ar->head;
+    ar->head = b;
+    ar->free = bsize;
+    if (ar->bsize < ARENA__BLOCK_MAX) {
+      ar->bsize *= ARENA__BLOCK_MUL;
+    }
+  }
+  void *p = BLOCK_DATA(ar->head) + (ar->head->size - ar->free);
+  ar->free -= size;
+  return p;
+}
+
+void arena_clear(arena *ar) {
+  block *b = ar->head;
+  while (b != NULL) {
+    block *t = b;
+    b = b->next;
+    hugemem_free(t);
+  }
+  ar->head = NULL;
+  ar->free = 0;
+  ar->bsize = ARENA__BLOCK_MIN;
+  ar->memory = 0;
+}
+
+size_t arena_memory(arena *ar) {
+  return sizeof *ar + ar->memory;
+}
+
+size_t arena_alloc_memory(arena *ar, size_t size) {
+  if (size <= ar->free) {
+    return 0;
+  }
+  return sizeof(block) + (size > ar->bsize - sizeof(block)
+      ? size : ar->bsize - sizeof(block));
+}
@@ -0,0 +1,46 @@
+//  arena.h : partie interface d'un module pour l'allocation par blocs de zones
+//    d'octets qui sont toutes libérées en même temps.
+
+#ifndef ARENA__H
+#define ARENA__H
+
+#include <stdlib.h>
+
+//  Fonctionnement général :
+//  - les zones sont découpées consécutivement dans des blocs de grande taille.
+//      Aucune garantie d'alignement n'est donnée sur les adresses des zones :
+//      le module est destiné à la mémorisation de suites d'octets telles que
+//      des chaînes de caractères ;
+//  - les zones ne peuvent pas être libérées individuellement.
+
+//  struct arena, arena : type et nom de type d'un contrôleur regroupant les
+//    informations nécessaires pour gérer une arène.
+typedef struct arena arena;
+
+//  arena_empty : tente d'allouer les ressources nécessaires pour gérer une
+//    nouvelle arène initialement vide. Renvoie NULL en cas de dépassement de
+//    capacité. Renvoie sinon un pointeur vers le contrôleur associé à l'arène.
+extern arena *arena_empty(void);
+
+//  arena_dispose : sans effet si *arptr vaut NULL. Libère sinon les ressources
+//    allouées à la gestion de l'arène associée à *arptr, zones comprises, puis
+//    affecte NULL à *arptr.
+extern void arena_dispose(arena **arptr);
+
+//  arena_alloc : tente de réserver une zone de size octets dans l'arène
+//    associée à ar. Renvoie NULL en cas de dépassement de capacité. Renvoie
+//    sinon l'adresse de la zone.
+extern void *arena_alloc(arena *ar, size_t size);
+
+//  arena_clear : libère toutes les zones de l'arène associée à ar.
+extern void arena_clear(arena *ar);
+
+//  arena_memory : renvoie le nombre d'octets actuellement alloués pour la
+//    gestion de l'arène associée à ar, contrôleur compris.
+extern size_t arena_memory(arena *ar);
+
+//  arena_alloc_memory : renvoie le nombre d'octets que tenterait d'allouer en
+//    plus la réservation d'une zone de size octets dans l'arène associée à ar.
+extern size_t arena_alloc_memory(arena *ar, size_t size);
+
+#endif
@@ -0,0 +1,688 @@
+//  art.c : partie implantation d'un module polymorphe pour un arbre de préfixes
+//    adaptatif.
+
+#include <stdint.h>
+#include <string.h>
+
+#include "art.h"
+
+//  Un nœud interne n situé à la profondeur d, c'est-à-dire atteint après
+//    lecture des d premiers octets d'une clé, mémorise les n->prefixlen octets
+//    suivants, communs à toutes les clés de son sous-arbre. Sa valeur term est
+//    celle dont la clé s'achève juste après ce préfixe, s'il y en a une ; ses
+//    fils sont indexés par l'octet qui suit le préfixe. Seuls les
+//    ART__PREFIX_MAX premiers octets du préfixe figurent dans le nœud :
+//    au-delà, ils sont lus dans la clé de la plus petite valeur du
+//    sous-arbre. Lors d'une recherche, les octets non mémorisés sont sautés,
+//    la clé de la valeur trouvée étant comparée en entier à la fin.
+
+#define ART__PREFIX_MAX   13
+
+//  Les fils qui sont des feuilles sont des références de valeurs marquées par
+//    leur bit de poids faible ; les autres fils sont des adresses de nœuds.
+
+#define ART__IS_LEAF(p)   (((uintptr_t) (p) & 1) != 0)
+#define ART__LEAF(v)      ((void *) ((uintptr_t) (v) | 1))
+#define ART__VALUE(p)     ((void *) ((uintptr_t) (p) & ~(uintptr_t) 1))
+
+#define ART__MIN(a, b)    ((a) < (b) ? (a) : (b))
+
+#if defined __GNUC__
+#define ART__PREFETCH(p)  __builtin_prefetch(p)
+#else
+#define ART__PREFETCH(p)  ((void) (p))
+#endif
+
+//  Nombre maximal de recherches menées de front par art_search_batch.
+#define ART__BATCH_MAX    32
+
+//  Capacités des quatre sortes de nœuds. Les octets des nœuds de capacité 4 et
+//    16 sont rangés dans l'ordre croissant ; ceux de capacité 48 sont associés
+//    à leurs fils par le tableau index, qui donne pour chaque octet le rang de
+//    son fils augmenté de un, zéro s'il n'en a pas.
+
+enum {
+  ART__N4,
+  ART__N16,
+  ART__N48,
+  ART__N256,
+};
+
+typedef struct {
+  void *term;
+  size_t prefixlen;
+  uint16_t count;
+  uint8_t kind;
+  unsigned char prefix[ART__PREFIX_MAX];
+} node;
+
+typedef struct {
+  node h;
+  unsigned char keys[4];
+  void *children[4];
+} node4;
+
+typedef struct {
+  node h;
+  unsigned char keys[16];
+  void *children[16];
+} node16;
+
+typedef struct {
+  node h;
+  unsigned char index[256];
+  void *children[48];
+} node48;
+
+typedef struct {
+  node h;
+  void *children[256];
+} node256;
+
+static const size_t node_sizes[] = {
+  sizeof(node4), sizeof(node16), sizeof(node48), sizeof(node256),
+};
+
+static const size_t node_capacities[] = {
+  4, 16, 48, 256,
+};
+
+struct art {
+  const char *(*keyfun)(const void *, size_t *);
+  void *root;
+  size_t count;
+  size_t memory;
+};
+
+//  node_new : tente d'allouer un nœud de sorte kind sans préfixe, sans valeur
+//    et sans fils. Renvoie NULL en cas de dépassement de capacité, l'adresse
+//    du nœud sinon.
+static node *node_new(art *t, int kind);
+
+//  node_free : libère le nœud pointé par n, mais pas ses fils.
+static void node_free(art *t, node *n);
+
+//  node_find : renvoie l'adresse de l'emplacement du fils d'octet c du nœud
+//    pointé par n s'il existe, NULL sinon.
+static void **node_find(node *n, unsigned char c);
+
+//  node_add : tente d'ajouter au nœud pointé par n, qui n'en a pas, le fils
+//    child d'octet c. Si le nœud est plein, il est remplacé par un nœud de
+//    capacité supérieure dont l'adresse est affectée à *ref. Renvoie une
+//    valeur non nulle en cas de dépassement de capacité, zéro sinon.
+static int node_add(art *t, void **ref, node *n, unsigned char c,
+    void *child);
+
+//  node_min : renvoie la référence de la plus petite valeur du sous-arbre de
+//    racine le nœud pointé par n.
+static void *node_min(node *n);
+
+//  node_step : descend d'un niveau, depuis le nœud pointé par n situé à la
+//    profondeur *dptr, la recherche du mot key de longueur len et met à jour
+//    *dptr. Renvoie le fils atteint, la valeur term de n marquée comme une
+//    feuille si le mot s'achève avec le préfixe de n, NULL si la recherche est
+//    négative.
+static inline void *node_step(node *n, const unsigned char *key, size_t len,
+    size_t *dptr);
+
+//  leaf_value : renvoie la valeur de la feuille p si sa clé est égale au mot
+//    key de longueur len, NULL sinon. La feuille p peut valoir NULL.
+static inline void *leaf_value(art *t, void *p, const char *key, size_t len);
+
+//  node_match : renvoie le nombre d'octets du préfixe du nœud pointé par n,
+//    situé à la profondeur d, qui coïncident avec ceux du mot key de longueur
+//    len à partir de l'indice d.
+static size_t node_match(art *t, node *n, const unsigned char *key, size_t len,
+    size_t d);
+
+//  node_apply : parcourt le sous-arbre de racine p à la manière de art_apply.
+static int node_apply(void *p, bool reversed, void *context,
+    int (*fun)(void *context, void *valref));
+
+//  node_dispose : libère les nœuds du sous-arbre de racine p.
+static void node_dispose(art *t, void *p);
+
+//  node_stats : cumule dans *stsptr les statistiques du sous-arbre de racine
+//    p, situé à la hauteur height.
+static void node_stats(void *p, size_t height, struct art_stats *stsptr);
+
+art *art_empty(const char *(*keyfun)(const void *valref, size_t *lenptr)) {
+  art *t = malloc(sizeof *t);
+  if (t == NULL) {
+    return NULL;
+  }
+  t->keyfun = keyfun;
+  t->root = NULL;
+  t->count = 0;
+  t->memory = sizeof *t;
+  return t;
+}
+
+void art_dispose(art **tptr) {
+  if (*tptr == NULL) {
+    return;
+  }
+  node_dispose(*tptr, (*tptr)->root);
+  free(*tptr);
+  *tptr = NULL;
+}
+
+void *art_search(art *t, const char *key, size_t len) {
+  void *p = t->root;
+  size_t d = 0;
+  while (p != NULL && !ART__IS_LEAF(p)) {
+    p = node_step(p, (const unsigned char *) key, len, &d);
+  }
+  return leaf_value(t, p, key, len);
+}
+
+void art_search_batch(art *t, size_t n, const char *const keys[],
+    const size_t lens[], void *valrefs[]) {
+  void *ps[ART__BATCH_MAX];
+  size_t ds[ART__BATCH_MAX];
+  for (size_t first = 0; first < n; first += ART__BATCH_MAX) {
+    size_t m = ART__MIN(n - first, (size_t) ART__BATCH_MAX);
+    const char *const *ks = keys + first;
+    const size_t *ls = lens + first;
+    for (size_t k = 0; k < m; ++k) {
+      ps[k] = t->root;
+      ds[k] = 0;
+    }
+    //  Chaque étape fait descendre d'un niveau toutes les recherches en cours
+    //    et demande le chargement des nœuds ou des valeurs atteints.
+    bool pending = true;
+    while (pending) {
+      pending = false;
+      for (size_t k = 0; k < m; ++k) {
+        if (ps[k] != NULL && !ART__IS_LEAF(ps[k])) {
+          ps[k] = node_step(ps[k], (const unsigned char *) ks[k], ls[k],
+              &ds[k]);
+          ART__PREFETCH(ART__VALUE(ps[k]));
+          pending = true;
+        }
+      }
+    }
+    //  Les valeurs atteintes sont chargées : leurs clés peuvent l'être à leur
+    //    tour avant d'être comparées.
+    for (size_t k = 0; k < m; ++k) {
+      if (ps[k] != NULL) {
+        size_t vlen;
+        ART__PREFETCH(t->keyfun(ART__VALUE(ps[k]), &vlen));
+      }
+    }
+    for (size_t k = 0; k < m; ++k) {
+      valrefs[first + k] = leaf_value(t, ps[k], ks[k], ls[k]);
+    }
+  }
+}
+
+void *art_add(art *t, void *valref) {
+  if (valref == NULL || ART__IS_LEAF(valref)) {
+    return NULL;
+  }
+  size_t len;
+  const unsigned char *key = (const unsigned char *) t->keyfun(valref, &len);
+  void **ref = &t->root;
+  size_t d = 0;
+  while (true) {
+    void *p = *ref;
+    if (p == NULL) {
+      *ref = ART__LEAF(valref);
+      t->count += 1;
+      return valref;
+    }
+    if (ART__IS_LEAF(p)) {
+      //  La feuille est remplacée par un nœud dont le préfixe est la partie
+      //    commune restante des deux clés.
+      void *v = ART__VALUE(p);
+      size_t vlen;
+      const unsigned char *vkey = (const unsigned char *) t->keyfun(v, &vlen);
+      size_t i = d;
+      while (i < len && i < vlen && key[i] == vkey[i]) {
+        ++i;
+      }
+      if (i == len && i == vlen) {
+        *ref = ART__LEAF(valref);
+        return valref;
+      }
+      node *n = node_new(t, ART__N4);
+      if (n == NULL) {
+        return NULL;
+      }
+      n->prefixlen = i - d;
+      memcpy(n->prefix, key + d, ART__MIN(n->prefixlen, ART__PREFIX_MAX));
+      if (i == vlen) {
+        n->term = v;
+      } else {
+        node_add(t, NULL, n, vkey[i], p);
+      }
+      if (i == len) {
+        n->term = valref;
+      } else {
+        node_add(t, NULL, n, key[i], ART__LEAF(valref));
+      }
+      *ref = n;
+      t->count += 1;
+      return valref;
+    }
+    node *n = p;
+    if (n->prefixlen != 0) {
+      size_t m = node_match(t, n, key, len, d);
+      if (m < n->prefixlen) {
+        //  Le préfixe est coupé au premier octet qui diffère : un nouveau
+        //    nœud en reçoit le début et a pour fils n, qui en garde la fin.
+        node *s = node_new(t, ART__N4);
+        if (s == NULL) {
+          return NULL;
+        }
+        s->prefixlen = m;
+        memcpy(s->prefix, key + d, ART__MIN(m, ART__PREFIX_MAX));
+        unsigned char c;
+        if (n->prefixlen <= ART__PREFIX_MAX) {
+          c = n->prefix[m];
+          n->prefixlen -= m + 1;
+          memmove(n->prefix, n->prefix + m + 1, n->prefixlen);
+        } else {
+          size_t mlen;
+          const unsigned char *mkey
+            = (const unsigned char *) t->keyfun(node_min(n), &mlen);
+          c = mkey[d + m];
+          n->prefixlen -= m + 1;
+          memcpy(n->prefix, mkey + d + m + 1,
+              ART__MIN(n->prefixlen, ART__PREFIX_MAX));
+        }
+        node_add(t, NULL, s, c, n);
+        if (d + m == len) {
+          s->term = valref;
+        } else {
+          node_add(t, NULL, s, key[d + m], ART__LEAF(valref));
+        }
+        *ref = s;
+        t->count += 1;
+        return valref;
+      }
+      d += n->prefixlen;
+    }
+    if (d == len) {
+      if (n->term == NULL) {
+        t->count += 1;
+      }
+      n->term = valref;
+      return valref;
+    }
+    void **child = node_find(n, key[d]);
+    if (child == NULL) {
+      if (node_add(t, ref, n, key[d], ART__LEAF(valref)) != 0) {
+        return NULL;
+      }
+      t->count += 1;
+      return valref;
+    }
+    ref = child;
+    ++d;
+  }
+}
+
+size_t art_count(art *t) {
+  return t->count;
+}
+
+int art_apply(art *t, bool reversed, void *context,
+    int (*fun)(void *context, void *valref)) {
+  if (t->root == NULL) {
+    return 0;
+  }
+  return node_apply(t->root, reversed, context, fun);
+}
+
+size_t art_memory(art *t) {
+  return t->memory;
+}
+
+void art_get_stats(art *t, struct art_stats *stsptr) {
+  *stsptr = (struct art_stats) { { 0, 0, 0, 0 }, 0, 0 };
+  if (t->root != NULL) {
+    node_stats(t->root, 0, stsptr);
+  }
+}
+
+node *node_new(art *t, int kind) {
+  node *n;
+  if (kind >= ART__N48) {
+    n = calloc(1, node_sizes[kind]);
+  } else {
+    n = malloc(node_sizes[kind]);
+  }
+  if (n == NULL) {
+    return NULL;
+  }
+  n->term = NULL;
+  n->prefixlen = 0;
+  n->count = 0;
+  n->kind = (uint8_t) kind;
+  t->memory += node_sizes[kind];
+  return n;
+}
+
+void node_free(art *t, node *n) {
+  t->memory -= node_sizes[n->kind];
+  free(n);
+}
+
+void **node_find(node *n, unsigned char c) {
+  switch (n->kind) {
+    case ART__N4: {
+      node4 *m = (node4 *) n;
+      for (size_t k = 0; k < n->count; ++k) {
+        if (m->keys[k] == c) {
+          return &m->children[k];
+        }
+      }
+      return NULL;
+    }
+    case ART__N16: {
+      node16 *m = (node16 *) n;
+      for (size_t k = 0; k < n->count && m->keys[k] <= c; ++k) {
+        if (m->keys[k] == c) {
+          return &m->children[k];
+        }
+      }
+      return NULL;
+    }
+    case ART__N48: {
+      node48 *m = (node48 *) n;
+      return m->index[c] == 0 ? NULL : &m->children[m->index[c] - 1];
+    }
+    default: {
+      node256 *m = (node256 *) n;
+      return m->children[c] == NULL ? NULL : &m->children[c];
+    }
+  }
+}
+
+int node_add(art *t, void **ref, node *n, unsigned char c, void *child) {
+  if (n->count == node_capacities[n->kind]) {
+    //  Le nœud plein est recopié dans un nœud de la sorte suivante. Les nœuds
+    //    de capacité 256 ne sont jamais pleins.
+    node *g = node_new(t, n->kind + 1);
+    if (g == NULL) {
+      return -1;
+    }
+    g->term = n->term;
+    g->prefixlen = n->prefixlen;
+    g->count = n->count;
+    memcpy(g->prefix, n->prefix, sizeof n->prefix);
+    if (n->kind == ART__N4) {
+      node4 *m = (node4 *) n;
+      node16 *h = (node16 *) g;
+      memcpy(h->keys, m->keys, sizeof m->keys);
+      memcpy(h->children, m->children, sizeof m->children);
+    } else if (n->kind == ART__N16) {
+      node16 *m = (node16 *) n;
+      node48 *h = (node48 *) g;
+      for (size_t k = 0; k < n->count; ++k) {
+        h->index[m->keys[k]] = (unsigned char) (k + 1);
+        h->children[k] = m->children[k];
+      }
+    } else {
+      node48 *m = (node48 *) n;
+      node256 *h = (node256 *) g;
+      for (size_t k = 0; k <= UINT8_MAX; ++k) {
+        if (m->index[k] != 0) {
+          h->children[k] = m->children[m->index[k] - 1];
+        }
+      }
+    }
+    node_free(t, n);
+    *ref = g;
+    n = g;
+  }
+  switch (n->kind) {
+    case ART__N4:
+    case ART__N16: {
+      unsigned char *keys = (n->kind == ART__N4 ? ((node4 *) n)->keys
+          : ((node16 *) n)->keys);
+      void **children = (n->kind == ART__N4 ? ((node4 *) n)->children
+          : ((node16 *) n)->children);
+      size_t k = n->count;
+      while (k > 0 && keys[k - 1] > c) {
+        keys[k] = keys[k - 1];
+        children[k] = children[k - 1];
+        --k;
+      }
+      keys[k] = c;
+      children[k] = child;
+      break;
+    }
+    case ART__N48: {
+      node48 *m = (node48 *) n;
+      //  Aucun fils n'étant jamais retiré, les rangs occupés sont les premiers.
+      m->children[n->count] = child;
+      m->index[c] = (unsigned char) (n->count + 1);
+      break;
+    }
+    default:
+      ((node256 *) n)->children[c] = child;
+      break;
+  }
+  n->count += 1;
+  return 0;
+}
+
+void *node_min(node *n) {
+  while (true) {
+    if (n->term != NULL) {
+      return n->term;
+    }
+    void *p;
+    switch (n->kind) {
+      case ART__N4:
+        p = ((node4 *) n)->children[0];
+        break;
+      case ART__N16:
+        p = ((node16 *) n)->children[0];
+        break;
+      case ART__N48: {
+        node48 *m = (node48 *) n;
+        size_t k = 0;
+        while (m->index[k] == 0) {
+          ++k;
+        }
+        p = m->children[m->index[k] - 1];
+        break;
+      }
+      default: {
+        node256 *m = (node256 *) n;
+        size_t k = 0;
+        while (m->children[k] == NULL) {
+          ++k;
+        }
+        p = m->children[k];
+        break;
+      }
+    }
+    if (ART__IS_LEAF(p)) {
+      return ART__VALUE(p);
+    }
+    n = p;
+  }
+}
+
+void *node_step(node *n, const unsigned char *key, size_t len,
+    size_t *dptr) {
+  size_t d = *dptr;
+  if (n->prefixlen != 0) {
+    if (len - d < n->prefixlen
+        || memcmp(n->prefix, key + d, ART__MIN(n->prefixlen, ART__PREFIX_MAX))
+        != 0) {
+      return NULL;
+    }
+    d += n->prefixlen;
+  }
+  if (d == len) {
+    return n->term == NULL ? NULL : ART__LEAF(n->term);
+  }
+  void **child = node_find(n, key[d]);
+  *dptr = d + 1;
+  return child == NULL ? NULL : *child;
+}
+
+void *leaf_value(art *t, void *p, const char *key, size_t len) {
+  if (p == NULL) {
+    return NULL;
+  }
+  void *v = ART__VALUE(p);
+  size_t vlen;
+  const char *vkey = t->keyfun(v, &vlen);
+  return vlen == len && memcmp(vkey, key, len) == 0 ? v : NULL;
+}
+
+size_t node_match(art *t, node *n, const unsigned char *key, size_t len,
+    size_t d) {
+  size_t max = ART__MIN(n->prefixlen, len - d);
+  size_t m = ART__MIN(max, ART__PREFIX_MAX);
+  size_t i = 0;
+  while (i < m && n->prefix[i] == key[d + i]) {
+    ++i;
+  }
+  if (i < m || i == max) {
+    return i;
+  }
+  size_t mlen;
+  const unsigned char *mkey
+    = (const unsigned char *) t->keyfun(node_min(n), &mlen);
+  while (i < max && mkey[d + i] == key[d + i]) {
+    ++i;
+  }
+  return i;
+}
+
+//  NODE_APPLY : appelle node_apply pour le fils p et renvoie la valeur de
+//    l'appel si elle n'est pas nulle.
+#define NODE_APPLY(p)                                                          \
+  do {                                                                         \
+    int r = node_apply(p, reversed, context, fun);                             \
+    if (r != 0) {                                                              \
+      return r;                                                                \
+    }                                                                          \
+  } while (0)
+
+int node_apply(void *p, bool reversed, void *context,
+    int (*fun)(void *context, void *valref)) {
+  if (ART__IS_LEAF(p)) {
+    return fun(context, ART__VALUE(p));
+  }
+  node *n = p;
+  //  La clé de la valeur term est un préfixe de toutes les autres clés du
+  //    sous-arbre : elle les précède.
+  if (!reversed && n->term != NULL) {
+    int r = fun(context, n->term);
+    if (r != 0) {
+      return r;
+    }
+  }
+  switch (n->kind) {
+    case ART__N4:
+    case ART__N16: {
+      void **children = (n->kind == ART__N4 ? ((node4 *) n)->children
+          : ((node16 *) n)->children);
+      for (size_t k = 0; k < n->count; ++k) {
+        NODE_APPLY(children[reversed ? n->count - 1 - k : k]);
+      }
+      break;
+    }
+    case ART__N48: {
+      node48 *m = (node48 *) n;
+      for (size_t k = 0; k <= UINT8_MAX; ++k) {
+        size_t c = reversed ? UINT8_MAX - k : k;
+        if (m->index[c] != 0) {
+          NODE_APPLY(m->children[m->index[c] - 1]);
+        }
+      }
+      break;
+    }
+    default: {
+      node256 *m = (node256 *) n;
+      for (size_t k = 0; k <= UINT8_MAX; ++k) {
+        size_t c = reversed ? UINT8_MAX - k : k;
+        if (m->children[c] != NULL) {
+          NODE_APPLY(m->children[c]);
+        }
+      }
+      break;
+    }
+  }
+  if (reversed && n->term != NULL) {
+    return fun(context, n->term);
+  }
+  return 0;
+}
+
+void node_dispose(art *t, void *p) {
+  if (p == NULL || ART__IS_LEAF(p)) {
+    return;
+  }
+  node *n = p;
+  switch (n->kind) {
+    case ART__N4:
+      for (size_t k = 0; k < n->count; ++k) {
+        node_dispose(t, ((node4 *) n)->children[k]);
+      }
+      break;
+    case ART__N16:
+      for (size_t k = 0; k < n->count; ++k) {
+        node_dispose(t, ((node16 *) n)->children[k]);
+      }
+      break;
+    case ART__N48:
+      for (size_t k = 0; k < n->count; ++k) {
+        node_dispose(t, ((node48 *) n)->children[k]);
+      }
+      break;
+    default:
+      for (size_t k = 0; k <= UINT8_MAX; ++k) {
+        node_dispose(t, ((node256 *) n)->children[k]);
+      }
+      break;
+  }
+  node_free(t, n);
+}
+
+void node_stats(void *p, size_t height, struct art_stats *stsptr) {
+  if (ART__IS_LEAF(p)) {
+    if (height > stsptr->height) {
+      stsptr->height = height;
+    }
+    return;
+  }
+  node *n = p;
+  stsptr->nnodes[n->kind] += 1;
+  stsptr->prefix += n->prefixlen;
+  if (n->term != NULL && height + 1 > stsptr->height) {
+    stsptr->height = height + 1;
+  }
+  switch (n->kind) {
+    case ART__N4:
+      for (size_t k = 0; k < n->count; ++k) {
+        node_stats(((node4 *) n)->children[k], height + 1, stsptr);
+      }
+      break;
+    case ART__N16:
+      for (size_t k = 0; k < n->count; ++k) {
+        node_stats(((node16 *) n)->children[k], height + 1, stsptr);
+      }
+      break;
+    case ART__N48:
+      for (size_t k = 0; k < n->count; ++k) {
+        node_stats(((node48 *) n)->children[k], height + 1, stsptr);
+      }
+      break;
+    default:
+      for (size_t k = 0; k <= UINT8_MAX; ++k) {
+        if (((node256 *) n)->children[k] != NULL) {
+          node_stats(((node256 *) n)->children[k], height + 1, stsptr);
+        }
+      }
+      break;
+  }
+}
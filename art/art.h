@@ -0,0 +1,95 @@
+//  art.h : partie interface d'un module polymorphe pour un arbre de préfixes
+//    adaptatif (adaptive radix tree) dont les clés sont des suites d'octets.
+
+#ifndef ART__H
+#define ART__H
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+//  Fonctionnement général :
+//  - la structure de données ne stocke que des références vers des valeurs,
+//      NULL ne pouvant pas être une référence de valeur. Les références de
+//      valeurs doivent être des multiples de deux, ce qui est le cas des
+//      adresses renvoyées par malloc ;
+//  - la clé d'une valeur n'est pas mémorisée par l'arbre : elle est obtenue
+//      à partir de la référence de la valeur par la fonction keyfun transmise
+//      à art_empty. Une clé est une suite de len octets quelconques, len
+//      pouvant être nul ; elle ne doit pas être modifiée tant que la valeur
+//      figure dans l'arbre ;
+//  - les nœuds internes ont une capacité de 4, 16, 48 ou 256 fils, choisie
+//      selon leur nombre effectif de fils ; les suites d'octets communes à
+//      toutes les clés d'un sous-arbre sont mémorisées une seule fois ;
+//  - l'arbre est parcouru dans l'ordre lexicographique des clés, les octets
+//      étant comparés comme des unsigned char et une clé précédant ses
+//      prolongements.
+
+//  struct art, art : type et nom de type d'un contrôleur regroupant les
+//    informations nécessaires pour gérer un arbre.
+typedef struct art art;
+
+//  art_empty : tente d'allouer les ressources nécessaires pour gérer un nouvel
+//    arbre initialement vide. La fonction keyfun renvoie l'adresse du premier
+//    octet de la clé de la valeur de référence valref et affecte sa longueur à
+//    *lenptr. Renvoie NULL en cas de dépassement de capacité. Renvoie sinon un
+//    pointeur vers le contrôleur associé à l'arbre.
+extern art *art_empty(const char *(*keyfun)(const void *valref,
+    size_t *lenptr));
+
+//  art_dispose : sans effet si *tptr vaut NULL. Libère sinon les ressources
+//    allouées à la gestion de l'arbre associé à *tptr puis affecte NULL à
+//    *tptr. Les valeurs ne sont pas libérées.
+extern void art_dispose(art **tptr);
+
+//  art_search : recherche dans l'arbre associé à t la référence d'une valeur
+//    dont la clé est égale au mot key de longueur len. Renvoie NULL si la
+//    recherche est négative, la référence de la valeur sinon.
+extern void *art_search(art *t, const char *key, size_t len);
+
+//  art_search_batch : affecte à valrefs[k], pour tout k < n, la valeur de
+//    art_search(t, keys[k], lens[k]). Les recherches sont menées de front,
+//    niveau par niveau, en demandant au processeur de charger les nœuds
+//    atteints : les défauts de cache d'une recherche se recouvrent ainsi avec
+//    ceux des autres au lieu de s'enchainer.
+extern void art_search_batch(art *t, size_t n, const char *const keys[],
+    const size_t lens[], void *valrefs[]);
+
+//  art_add : tente d'ajouter à l'arbre associé à t la référence valref. Si une
+//    valeur de clé égale figure déjà dans l'arbre, sa référence est remplacée
+//    par valref. Renvoie NULL si valref vaut NULL, n'est pas un multiple de
+//    deux ou en cas de dépassement de capacité. Renvoie sinon valref.
+extern void *art_add(art *t, void *valref);
+
+//  art_count : renvoie le nombre de valeurs de l'arbre associé à t.
+extern size_t art_count(art *t);
+
+//  art_apply : parcourt l'arbre associé à t dans l'ordre croissant de ses
+//    clés, décroissant si reversed est vrai, en appelant fun(context, valref)
+//    pour chacune de ses références de valeurs. Si, lors du parcours, la valeur
+//    de l'appel n'est pas nulle, l'exécution de la fonction prend fin et la
+//    fonction renvoie cette valeur. Sinon, la fonction renvoie zéro. La clé de
+//    la valeur valref n'est plus consultée après l'appel : fun peut libérer
+//    les objets associés à l'arbre.
+extern int art_apply(art *t, bool reversed, void *context,
+    int (*fun)(void *context, void *valref));
+
+//  art_memory : renvoie le nombre d'octets actuellement alloués pour la
+//    gestion de l'arbre associé à t, contrôleur compris.
+extern size_t art_memory(art *t);
+
+//  struct art_stats : structure regroupant quelques statistiques sur un arbre.
+//    Le composant nnodes[k] est le nombre de nœuds de capacité respective 4,
+//    16, 48 et 256 pour k valant 0, 1, 2 et 3 ; height est le plus grand
+//    nombre de nœuds traversés pour atteindre une valeur ; prefix est le
+//    nombre total d'octets de clés mémorisés en commun par les nœuds.
+struct art_stats {
+  size_t nnodes[4];
+  size_t height;
+  size_t prefix;
+};
+
+//  art_get_stats : effectue un bilan de l'arbre associé à t et affecte le
+//    résultat à *stsptr.
+extern void art_get_stats(art *t, struct art_stats *stsptr);
+
+#endif
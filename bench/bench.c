@@ -0,0 +1,536 @@
+//  bench.c : mesure séparément le coût des différentes phases du traitement
+//    effectué par xwc sur un ensemble de fichiers : découpage en mots,
+//    insertion des mots distincts dans la table de hachage, recherche de leurs
+//    autres occurrences, tri du fourretout et écriture des résultats. Les
+//    mêmes mots sont ensuite comptés dans un arbre de préfixes adaptatif, dont
+//    le parcours donne directement les résultats triés. Les débits sont
+//    donnés en Mo/s et en mots/s ; la mémoire allouée aux deux dictionnaires,
+//    hors mots et structures word_info, en octets.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <ctype.h>
+#include <locale.h>
+#include <time.h>
+#include <getopt.h>
+
+#include "hashtable.h"
+#include "hashtable_ext.h"
+#include "holdall.h"
+#include "holdall_ext.h"
+#include "sbuffer.h"
+#include "art.h"
+
+#define RESTRICT_FILE_INDEX     0
+#define INPUT_FILE_START_INDEX  1
+
+#define ARENA_CAPACITY_MIN  4096
+#define ARENA_CAPACITY_MUL  2
+
+#define MEGA  1e6
+
+#define TOKENIZE_BLOCK_SIZE 65536
+
+//  word_info : copie de la structure homonyme de xwc.
+typedef struct {
+  long int occ;
+  size_t file;
+} word_info;
+
+//  corpus : type et nom de type pour une structure mémorisant la suite des
+//    mots lus. Les mots sont rangés consécutivement dans arena, chacun suivi de
+//    '\0' ; files[k] est l'indice du fichier dont provient le k-ième mot.
+typedef struct {
+  char *arena;
+  size_t arenalen;
+  size_t arenacap;
+  size_t *files;
+  size_t nwords;
+  size_t wordscap;
+  size_t nbytes;
+} corpus;
+
+//  art_entry : type et nom de type pour une structure associant un mot du corpus
+//    de longueur len à ses informations, valeur de l'arbre de préfixes.
+typedef struct {
+  const char *w;
+  size_t len;
+  word_info wi;
+} art_entry;
+
+//  phase : type et nom de type pour une structure décrivant le résultat de la
+//    mesure d'une phase.
+typedef struct {
+  const char *name;
+  double seconds;
+} phase;
+
+//  now : renvoie la valeur courante en secondes d'une horloge monotone.
+static double now(void);
+
+//  corpus_push : tente d'ajouter le mot w de longueur len provenant du fichier
+//    d'indice file au corpus pointé par c. Renvoie une valeur non nulle en cas
+//    de dépassement de capacité, zéro sinon.
+static int corpus_push(corpus *c, const char *w, size_t len, size_t file);
+
+//  tokenize : découpe en mots le fichier de nom fname, d'indice file, selon les
+//    mêmes règles que xwc, et les ajoute au corpus pointé par c. Le fichier est
+//    lu par blocs ; seul un mot à cheval sur deux blocs est recopié dans sb.
+//    Renvoie une valeur non nulle en cas d'erreur, zéro sinon.
+static int tokenize(corpus *c, sbuffer *sb, const char *fname, size_t file,
+    bool punct);
+
+//  is_separator : renvoie true si le caractère ch sépare les mots, false sinon.
+static bool is_separator(unsigned char ch, bool punct);
+
+//  mark_firsts : tente d'allouer un tableau de c->nwords booléens dont le
+//    k-ième vaut true si le k-ième mot du corpus pointé par c en est la
+//    première occurrence, false sinon. Renvoie NULL en cas de dépassement de
+//    capacité. Affecte sinon le nombre de mots distincts à *ndistinctptr.
+static bool *mark_firsts(const corpus *c, size_t *ndistinctptr);
+
+//  count_insert : reproduit la phase de comptage de xwc pour les premières
+//    occurrences, selon firsts, des mots du corpus pointé par c, qui sont
+//    ajoutés à la table de hachage. Renvoie une valeur non nulle en cas de
+//    dépassement de capacité, zéro sinon.
+static int count_insert(const corpus *c, const bool *firsts, hashtable *ht,
+    holdall *has);
+
+//  count_lookup : reproduit la phase de comptage de xwc pour les autres
+//    occurrences des mots du corpus pointé par c, dont la recherche dans la
+//    table de hachage est toujours positive.
+static void count_lookup(const corpus *c, const bool *firsts, hashtable *ht);
+
+//  count_art : reproduit la phase de comptage de xwc sur les mots du corpus
+//    pointé par c, dans l'arbre de préfixes associé à t. Renvoie une valeur
+//    non nulle en cas de dépassement de capacité, zéro sinon. Les nombres de
+//    recherches positives et négatives sont affectés à *hitsptr et *missesptr.
+static int count_art(const corpus *c, art *t, size_t *hitsptr,
+    size_t *missesptr);
+
+static const char *art_entry_key(const art_entry *e, size_t *lenptr);
+static int rfprint_art_entry(FILE *f, art_entry *e);
+static int rfree_art_entry(void *context, art_entry *e);
+
+static size_t str_hashfun(const char *s);
+static int rfprint_word_info(FILE *f, char *w, word_info *wi);
+static int rfree_word_info(char *w, word_info *wi);
+static int rfree(char *w);
+
+//  print_phase : affiche sur la sortie standard le bilan de la phase pointée
+//    par ph pour nbytes octets et nwords mots traités.
+static void print_phase(const phase *ph, size_t nbytes, size_t nwords);
+
+int main(int argc, char **argv) {
+  setlocale(LC_COLLATE, "");
+  bool punct = false;
+  bool sort = true;
+  int c;
+  while ((c = getopt(argc, argv, "pS")) != -1) {
+    switch (c) {
+      case 'p':
+        punct = true;
+        break;
+      case 'S':
+        sort = false;
+        break;
+      default:
+        fprintf(stderr, "Usage: %s [-p] [-S] FILE...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+  }
+  if (optind == argc) {
+    fprintf(stderr, "Usage: %s [-p] [-S] FILE...\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  int r = EXIT_SUCCESS;
+  corpus co = { 0 };
+  hashtable *ht = hashtable_empty((int (*)(const void *, const void *))strcmp,
+      (size_t (*)(const void *))str_hashfun);
+  holdall *has = holdall_empty();
+  art *tree = art_empty((const char *(*)(const void *, size_t *))art_entry_key);
+  sbuffer *sb = sbuffer_empty();
+  bool *firsts = NULL;
+  FILE *devnull = fopen("/dev/null", "w");
+  if (ht == NULL || has == NULL || tree == NULL || sb == NULL) {
+    goto error_capacity;
+  }
+  if (devnull == NULL) {
+    fprintf(stderr, "Error: Cannot open '/dev/null'\n");
+    goto error;
+  }
+  phase phases[7] = {
+    { "tokenize", 0.0 },
+    { "insert", 0.0 },
+    { "lookup", 0.0 },
+    { "sort", 0.0 },
+    { "output", 0.0 },
+    { "art", 0.0 },
+    { "art walk", 0.0 },
+  };
+  double t = now();
+  for (int i = optind; i < argc; ++i) {
+    if (tokenize(&co, sb, argv[i],
+        INPUT_FILE_START_INDEX + (size_t) (i - optind), punct) != 0) {
+      fprintf(stderr, "Error: An error has occurred while reading file '%s'\n",
+          argv[i]);
+      goto error;
+    }
+  }
+  phases[0].seconds = now() - t;
+  size_t misses;
+  firsts = mark_firsts(&co, &misses);
+  if (firsts == NULL) {
+    goto error_capacity;
+  }
+  size_t hits = co.nwords - misses;
+  t = now();
+  if (count_insert(&co, firsts, ht, has) != 0) {
+    goto error_capacity;
+  }
+  phases[1].seconds = now() - t;
+  t = now();
+  count_lookup(&co, firsts, ht);
+  phases[2].seconds = now() - t;
+  t = now();
+  if (sort) {
+    holdall_sort(has, (int (*)(const void *, const void *))strcoll);
+  }
+  phases[3].seconds = now() - t;
+  t = now();
+  holdall_apply_context2(has, ht,
+      (void *(*)(void *, void *))hashtable_search, devnull,
+      (int (*)(void *, void *, void *))rfprint_word_info);
+  fflush(devnull);
+  phases[4].seconds = now() - t;
+  size_t arthits;
+  size_t artmisses;
+  t = now();
+  if (count_art(&co, tree, &arthits, &artmisses) != 0) {
+    goto error_capacity;
+  }
+  phases[5].seconds = now() - t;
+  t = now();
+  art_apply(tree, false, devnull, (int (*)(void *, void *))rfprint_art_entry);
+  fflush(devnull);
+  phases[6].seconds = now() - t;
+  printf("files\t%d\nbytes\t%zu\nwords\t%zu\ndistinct\t%zu\nhits\t%zu\n"
+      "misses\t%zu\n", argc - optind, co.nbytes, co.nwords,
+      holdall_count(has), hits, misses);
+  printf("%-10s\t%10s\t%10s\t%12s\n", "phase", "seconds", "MB/s", "words/s");
+  double total = 0.0;
+  for (size_t k = 0; k < 5; ++k) {
+    print_phase(&phases[k], co.nbytes, co.nwords);
+    total += phases[k].seconds;
+  }
+  print_phase(&(phase) { "total", total }, co.nbytes, co.nwords);
+  total = phases[0].seconds;
+  for (size_t k = 5; k < sizeof phases / sizeof *phases; ++k) {
+    print_phase(&phases[k], co.nbytes, co.nwords);
+    total += phases[k].seconds;
+  }
+  print_phase(&(phase) { "total art", total }, co.nbytes, co.nwords);
+  printf("%-10s\t%10s\t%10s\n", "dictionary", "bytes", "bytes/word");
+  size_t mem = hashtable_memory(ht, NULL, NULL) + holdall_memory(has);
+  printf("%-10s\t%10zu\t%10.1f\n", "hashtable", mem,
+      (double) mem / (double) (misses == 0 ? 1 : misses));
+  mem = art_memory(tree);
+  printf("%-10s\t%10zu\t%10.1f\n", "art", mem,
+      (double) mem / (double) (artmisses == 0 ? 1 : artmisses));
+  goto dispose;
+error_capacity:
+  fprintf(stderr, "Error: Not enough memory\n");
+  goto error;
+error:
+  r = EXIT_FAILURE;
+  goto dispose;
+dispose:
+  if (devnull != NULL) {
+    fclose(devnull);
+  }
+  if (has != NULL) {
+    if (ht != NULL) {
+      holdall_apply_context(has, ht,
+          (void *(*)(void *, void *))hashtable_search,
+          (int (*)(void *, void *))rfree_word_info);
+      hashtable_dispose(&ht);
+    }
+    holdall_apply(has, (int (*)(void *))rfree);
+    holdall_dispose(&has);
+  }
+  hashtable_dispose(&ht);
+  if (tree != NULL) {
+    art_apply(tree, false, NULL, (int (*)(void *, void *))rfree_art_entry);
+    art_dispose(&tree);
+  }
+  sbuffer_dispose(&sb);
+  free(firsts);
+  free(co.arena);
+  free(co.files);
+  return r;
+}
+
+double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+}
+
+int corpus_push(corpus *c, const char *w, size_t len, size_t file) {
+  if (c->arenacap - c->arenalen < len + 1) {
+    size_t cap = (c->arenacap == 0 ? ARENA_CAPACITY_MIN : c->arenacap);
+    while (cap - c->arenalen < len + 1) {
+      if (cap > SIZE_MAX / ARENA_CAPACITY_MUL) {
+        return -1;
+      }
+      cap *= ARENA_CAPACITY_MUL;
+    }
+    char *a = realloc(c->arena, cap);
+    if (a == NULL) {
+      return -1;
+    }
+    c->arena = a;
+    c->arenacap = cap;
+  }
+  if (c->nwords == c->wordscap) {
+    size_t cap = (c->wordscap == 0 ? ARENA_CAPACITY_MIN
+        : c->wordscap * ARENA_CAPACITY_MUL);
+    if (cap > SIZE_MAX / sizeof *c->files) {
+      return -1;
+    }
+    size_t *f = realloc(c->files, cap * sizeof *f);
+    if (f == NULL) {
+      return -1;
+    }
+    c->files = f;
+    c->wordscap = cap;
+  }
+  memcpy(c->arena + c->arenalen, w, len);
+  c->arena[c->arenalen + len] = '\0';
+  c->arenalen += len + 1;
+  c->files[c->nwords] = file;
+  c->nwords += 1;
+  return 0;
+}
+
+int tokenize(corpus *c, sbuffer *sb, const char *fname, size_t file,
+    bool punct) {
+  FILE *f = fopen(fname, "r");
+  if (f == NULL) {
+    return -1;
+  }
+  sbuffer_clear(sb);
+  char buf[TOKENIZE_BLOCK_SIZE];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof buf, f)) != 0) {
+    c->nbytes += n;
+    const char *p = buf;
+    const char *end = buf + n;
+    while (p < end) {
+      const char *s = p;
+      while (p < end && !is_separator((unsigned char) *p, punct)) {
+        ++p;
+      }
+      size_t len = (size_t) (p - s);
+      if (p == end) {
+        //  Le mot peut se poursuivre dans le bloc suivant.
+        if (sbuffer_append_span(sb, s, len) != 0) {
+          goto error;
+        }
+        break;
+      }
+      if (sbuffer_length(sb) != 0) {
+        if (sbuffer_append_span(sb, s, len) != 0) {
+          goto error;
+        }
+        const char *w = sbuffer_get_span(sb, &len);
+        if (corpus_push(c, w, len, file) != 0) {
+          goto error;
+        }
+        sbuffer_clear(sb);
+      } else if (len != 0 && corpus_push(c, s, len, file) != 0) {
+        goto error;
+      }
+      ++p;
+    }
+  }
+  if (sbuffer_length(sb) != 0) {
+    size_t len;
+    const char *w = sbuffer_get_span(sb, &len);
+    if (corpus_push(c, w, len, file) != 0) {
+      goto error;
+    }
+    sbuffer_clear(sb);
+  }
+  bool err = !feof(f);
+  return (fclose(f) != 0 || err) ? -1 : 0;
+error:
+  fclose(f);
+  return -1;
+}
+
+bool is_separator(unsigned char ch, bool punct) {
+  return isspace(ch) || (punct && ispunct(ch));
+}
+
+bool *mark_firsts(const corpus *c, size_t *ndistinctptr) {
+  hashtable *ht = hashtable_empty((int (*)(const void *, const void *))strcmp,
+      (size_t (*)(const void *))str_hashfun);
+  bool *firsts = malloc((c->nwords == 0 ? 1 : c->nwords) * sizeof *firsts);
+  if (ht == NULL || firsts == NULL) {
+    goto error;
+  }
+  *ndistinctptr = 0;
+  const char *w = c->arena;
+  for (size_t k = 0; k < c->nwords; ++k) {
+    firsts[k] = (hashtable_search(ht, w) == NULL);
+    if (firsts[k]) {
+      if (hashtable_add(ht, w, w) == NULL) {
+        goto error;
+      }
+      *ndistinctptr += 1;
+    }
+    w += strlen(w) + 1;
+  }
+  hashtable_dispose(&ht);
+  return firsts;
+error:
+  hashtable_dispose(&ht);
+  free(firsts);
+  return NULL;
+}
+
+int count_insert(const corpus *c, const bool *firsts, hashtable *ht,
+    holdall *has) {
+  const char *w = c->arena;
+  for (size_t k = 0; k < c->nwords; ++k) {
+    size_t len = strlen(w);
+    if (firsts[k]) {
+      char *w2 = malloc(len + 1);
+      if (w2 == NULL) {
+        return -1;
+      }
+      memcpy(w2, w, len + 1);
+      if (holdall_put(has, w2) != 0) {
+        free(w2);
+        return -1;
+      }
+      word_info *wi = malloc(sizeof *wi);
+      if (wi == NULL) {
+        return -1;
+      }
+      if (hashtable_add(ht, w2, wi) == NULL) {
+        free(wi);
+        return -1;
+      }
+      wi->file = c->files[k];
+      wi->occ = 1;
+    }
+    w += len + 1;
+  }
+  return 0;
+}
+
+void count_lookup(const corpus *c, const bool *firsts, hashtable *ht) {
+  const char *w = c->arena;
+  for (size_t k = 0; k < c->nwords; ++k) {
+    size_t len = strlen(w);
+    if (!firsts[k]) {
+      word_info *wi = hashtable_search(ht, w);
+      if (wi->file != c->files[k]) {
+        wi->occ = 0;
+      } else if (wi->occ != 0) {
+        wi->occ += 1;
+      }
+    }
+    w += len + 1;
+  }
+}
+
+int count_art(const corpus *c, art *t, size_t *hitsptr,
+    size_t *missesptr) {
+  *hitsptr = 0;
+  *missesptr = 0;
+  const char *w = c->arena;
+  for (size_t k = 0; k < c->nwords; ++k) {
+    size_t len = strlen(w);
+    size_t nfile = c->files[k];
+    art_entry *e = art_search(t, w, len);
+    if (e == NULL) {
+      *missesptr += 1;
+      e = malloc(sizeof *e);
+      if (e == NULL) {
+        return -1;
+      }
+      e->w = w;
+      e->len = len;
+      e->wi.file = nfile;
+      e->wi.occ = 1;
+      if (art_add(t, e) == NULL) {
+        free(e);
+        return -1;
+      }
+    } else {
+      *hitsptr += 1;
+      if (e->wi.file != nfile) {
+        e->wi.occ = 0;
+      } else if (e->wi.occ != 0) {
+        e->wi.occ += 1;
+      }
+    }
+    w += len + 1;
+  }
+  return 0;
+}
+
+const char *art_entry_key(const art_entry *e, size_t *lenptr) {
+  *lenptr = e->len;
+  return e->w;
+}
+
+int rfprint_art_entry(FILE *f, art_entry *e) {
+  return rfprint_word_info(f, (char *) e->w, &e->wi);
+}
+
+int rfree_art_entry([[maybe_unused]] void *context, art_entry *e) {
+  free(e);
+  return 0;
+}
+
+size_t str_hashfun(const char *s) {
+  size_t h = 0;
+  for (const unsigned char *p = (const unsigned char *) s; *p != '\0'; ++p) {
+    h = 37 * h + *p;
+  }
+  return h;
+}
+
+int rfprint_word_info(FILE *f, char *w, word_info *wi) {
+  if (wi->occ != 0) {
+    fputs(w, f);
+    for (size_t i = 0; i < wi->file; i++) {
+      fputc('\t', f);
+    }
+    fprintf(f, "%ld\n", wi->occ);
+  }
+  return 0;
+}
+
+int rfree_word_info([[maybe_unused]] char *w, word_info *wi) {
+  free(wi);
+  return 0;
+}
+
+int rfree(char *w) {
+  free(w);
+  return 0;
+}
+
+void print_phase(const phase *ph, size_t nbytes, size_t nwords) {
+  double s = ph->seconds > 0.0 ? ph->seconds : 1e-9;
+  printf("%-10s\t%10.4f\t%10.2f\t%12.0f\n", ph->name, ph->seconds,
+      (double) nbytes / MEGA / s, (double) nwords / s);
+}
@@ -0,0 +1,393 @@
+//  cstress.c : test de charge du module chashtable. Plusieurs fils d'exécution
+//    comptent simultanément, selon les règles du comptage exclusif de xwc, les
+//    mots de fichiers synthétiques dans une même table partagée ; le résultat
+//    est ensuite comparé à celui d'un comptage séquentiel effectué avec le
+//    module hashtable. Destiné à être compilé avec -fsanitize=thread.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "chashtable.h"
+#include "hashtable.h"
+#include "holdall.h"
+
+#define NTHREADS_DEF    8
+#define NFILES_DEF      32
+#define NWORDS_DEF      100000
+#define VOCAB_DEF       20000
+#define NSHARDS_DEF     16
+#define SEED_DEF        42
+
+//  Un mot sur PRIVATE_RATIO est tiré dans le vocabulaire propre du fichier, les
+//    autres dans le vocabulaire partagé : le test produit ainsi à la fois des
+//    mots exclusifs et des mots disqualifiés.
+#define PRIVATE_RATIO   4
+#define PRIVATE_VOCAB   256
+
+#define WORD_MAXLEN     24
+
+//  stress_options : type et nom de type pour une structure contenant les
+//    paramètres du test.
+typedef struct {
+  size_t nthreads;
+  size_t nfiles;
+  size_t nwords;
+  size_t vocab;
+  size_t nshards;
+  uint64_t seed;
+} stress_options;
+
+//  rng : type et nom de type pour l'état d'un générateur pseudo-aléatoire de la
+//    famille xorshift*.
+typedef struct {
+  uint64_t state;
+} rng;
+
+//  item : type et nom de type pour le compteur d'un mot. Comme pour xwc, file
+//    vaut l'indice, commençant à 1, du seul fichier dans lequel le mot est
+//    apparu et occ son nombre d'occurrences ; occ vaut zéro si le mot est
+//    apparu dans plusieurs fichiers.
+typedef struct {
+  char s[WORD_MAXLEN];
+  long occ;
+  size_t file;
+} item;
+
+//  stress_context : type et nom de type pour l'état partagé par les fils
+//    d'exécution.
+typedef struct {
+  const stress_options *o;
+  chashtable *cht;
+  atomic_size_t next;
+  atomic_bool failed;
+} stress_context;
+
+//  rng_seed : initialise le générateur pointé par g à partir de seed.
+static void rng_seed(rng *g, uint64_t seed);
+
+//  rng_next : renvoie le prochain entier pseudo-aléatoire de 64 bits du
+//    générateur pointé par g.
+static uint64_t rng_next(rng *g);
+
+//  draw_word : écrit dans s le prochain mot du fichier d'indice nfile tiré à
+//    l'aide de g.
+static void draw_word(const stress_options *o, size_t nfile, rng *g, char *s);
+
+//  item_seen : met à jour it pour une occurrence de son mot dans le fichier
+//    d'indice nfile.
+static void item_seen(item *it, size_t nfile);
+
+//  item_new : tente d'allouer un compteur pour le mot s, initialisé pour une
+//    occurrence dans le fichier d'indice nfile. Renvoie NULL en cas de
+//    dépassement de capacité, l'adresse du compteur sinon.
+static item *item_new(const char *s, size_t nfile);
+
+//  shared_add, shared_update : fonctions de création et de mise à jour des
+//    compteurs passées à chashtable_add_or_update. Le contexte pointe vers
+//    l'indice du fichier courant.
+static void *shared_add(size_t *nfileptr, const void **keyrefptr);
+static void shared_update(size_t *nfileptr, item *it);
+
+//  stress_thread : fonction exécutée par chaque fil d'exécution. Compte les
+//    fichiers attribués au fil jusqu'à épuisement ou échec.
+static void *stress_thread(stress_context *sc);
+
+//  count_reference : compte séquentiellement, dans l'ordre des indices, les
+//    mots de tous les fichiers dans la table ht ; les compteurs sont ajoutés au
+//    fourretout ha. Renvoie une valeur non nulle en cas de dépassement de
+//    capacité, zéro sinon.
+static int count_reference(const stress_options *o, hashtable *ht,
+    holdall *ha);
+
+//  check_item : recherche dans la table ref le compteur du mot de it et le
+//    compare à it. Renvoie zéro s'ils sont égaux, une valeur non nulle sinon.
+static int check_item(hashtable *ref, item *it);
+
+static size_t str_hashfun(const char *s);
+static int rfree(void *p);
+static int rcfree(void *context, void *p);
+static int parse_size(const char *s, size_t *vptr);
+static void print_usage(const char *prog_name);
+
+int main(int argc, char **argv) {
+  stress_options o = {
+    .nthreads = NTHREADS_DEF,
+    .nfiles = NFILES_DEF,
+    .nwords = NWORDS_DEF,
+    .vocab = VOCAB_DEF,
+    .nshards = NSHARDS_DEF,
+    .seed = SEED_DEF
+  };
+  int c;
+  while ((c = getopt(argc, argv, "t:n:w:v:k:s:")) != -1) {
+    size_t v;
+    if (parse_size(optarg, &v) != 0) {
+      fprintf(stderr, "%s: invalid value for -%c: '%s'\n", argv[0], c,
+          optarg);
+      return EXIT_FAILURE;
+    }
+    switch (c) {
+      case 't':
+        o.nthreads = v;
+        break;
+      case 'n':
+        o.nfiles = v;
+        break;
+      case 'w':
+        o.nwords = v;
+        break;
+      case 'v':
+        o.vocab = v;
+        break;
+      case 'k':
+        o.nshards = v;
+        break;
+      case 's':
+        o.seed = v;
+        break;
+      default:
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+  }
+  if (optind != argc) {
+    print_usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+  int r = EXIT_SUCCESS;
+  stress_context sc = {
+    .o = &o,
+    .cht = chashtable_empty((int (*)(const void *, const void *))strcmp,
+        (size_t (*)(const void *))str_hashfun, o.nshards, 0),
+    .next = 0,
+    .failed = false
+  };
+  hashtable *ref = hashtable_empty(
+      (int (*)(const void *, const void *))strcmp,
+      (size_t (*)(const void *))str_hashfun);
+  holdall *refitems = holdall_empty();
+  pthread_t *threads = malloc(o.nthreads * sizeof *threads);
+  size_t nstarted = 0;
+  if (sc.cht == NULL || ref == NULL || refitems == NULL || threads == NULL) {
+    goto error_capacity;
+  }
+  while (nstarted < o.nthreads) {
+    if (pthread_create(&threads[nstarted], NULL,
+        (void *(*)(void *))stress_thread, &sc) != 0) {
+      atomic_store(&sc.failed, true);
+      break;
+    }
+    ++nstarted;
+  }
+  for (size_t k = 0; k < nstarted; ++k) {
+    pthread_join(threads[k], NULL);
+  }
+  if (atomic_load(&sc.failed)) {
+    goto error_capacity;
+  }
+  if (count_reference(&o, ref, refitems) != 0) {
+    goto error_capacity;
+  }
+  size_t n = chashtable_count(sc.cht);
+  size_t nref = holdall_count(refitems);
+  if (n != nref) {
+    fprintf(stderr, "%s: %zu words counted, %zu expected\n", argv[0], n, nref);
+    goto error;
+  }
+  if (chashtable_apply(sc.cht, ref,
+      (int (*)(void *, void *))check_item) != 0) {
+    fprintf(stderr, "%s: counts differ from the sequential reference\n",
+        argv[0]);
+    goto error;
+  }
+  printf("%zu threads, %zu files, %zu words, %zu distinct: OK\n",
+      o.nthreads, o.nfiles, o.nfiles * o.nwords, n);
+  goto dispose;
+error_capacity:
+  fprintf(stderr, "%s: not enough memory\n", argv[0]);
+  goto error;
+error:
+  r = EXIT_FAILURE;
+  goto dispose;
+dispose:
+  if (sc.cht != NULL) {
+    chashtable_apply(sc.cht, NULL, rcfree);
+    chashtable_dispose(&sc.cht);
+  }
+  hashtable_dispose(&ref);
+  if (refitems != NULL) {
+    holdall_apply(refitems, rfree);
+    holdall_dispose(&refitems);
+  }
+  free(threads);
+  return r;
+}
+
+void rng_seed(rng *g, uint64_t seed) {
+  //  splitmix64 sur la graine, pour éviter l'état nul.
+  uint64_t z = seed + 0x9E3779B97F4A7C15ULL;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  z ^= z >> 31;
+  g->state = (z == 0 ? 1 : z);
+}
+
+uint64_t rng_next(rng *g) {
+  uint64_t x = g->state;
+  x ^= x >> 12;
+  x ^= x << 25;
+  x ^= x >> 27;
+  g->state = x;
+  return x * 0x2545F4914F6CDD1DULL;
+}
+
+void draw_word(const stress_options *o, size_t nfile, rng *g, char *s) {
+  uint64_t x = rng_next(g);
+  if (x % PRIVATE_RATIO == 0) {
+    snprintf(s, WORD_MAXLEN, "p%zu.%u", nfile,
+        (unsigned) ((x >> 8) % PRIVATE_VOCAB));
+  } else {
+    //  Le produit de deux tirages favorise les petits rangs, à la manière
+    //    d'une loi de Zipf.
+    uint64_t y = rng_next(g);
+    size_t rank = (size_t) ((x >> 32) % o->vocab * ((y >> 32) % o->vocab)
+        / o->vocab);
+    snprintf(s, WORD_MAXLEN, "w%zu", rank);
+  }
+}
+
+void item_seen(item *it, size_t nfile) {
+  if (it->file != nfile) {
+    it->occ = 0;
+  } else if (it->occ != 0) {
+    it->occ += 1;
+  }
+}
+
+item *item_new(const char *s, size_t nfile) {
+  item *it = malloc(sizeof *it);
+  if (it == NULL) {
+    return NULL;
+  }
+  strcpy(it->s, s);
+  it->occ = 1;
+  it->file = nfile;
+  return it;
+}
+
+void *shared_add(size_t *nfileptr, const void **keyrefptr) {
+  item *it = item_new(*keyrefptr, *nfileptr);
+  if (it != NULL) {
+    *keyrefptr = it->s;
+  }
+  return it;
+}
+
+void shared_update(size_t *nfileptr, item *it) {
+  item_seen(it, *nfileptr);
+}
+
+void *stress_thread(stress_context *sc) {
+  const stress_options *o = sc->o;
+  while (!atomic_load(&sc->failed)) {
+    size_t nfile = atomic_fetch_add(&sc->next, 1) + 1;
+    if (nfile > o->nfiles) {
+      break;
+    }
+    rng g;
+    rng_seed(&g, o->seed + nfile);
+    char s[WORD_MAXLEN];
+    for (size_t k = 0; k < o->nwords; ++k) {
+      draw_word(o, nfile, &g, s);
+      if (chashtable_add_or_update(sc->cht, s, &nfile,
+          (void *(*)(void *, const void **))shared_add,
+          (void (*)(void *, void *))shared_update) != 0) {
+        atomic_store(&sc->failed, true);
+        break;
+      }
+    }
+  }
+  return NULL;
+}
+
+int count_reference(const stress_options *o, hashtable *ht, holdall *ha) {
+  char s[WORD_MAXLEN];
+  for (size_t nfile = 1; nfile <= o->nfiles; ++nfile) {
+    rng g;
+    rng_seed(&g, o->seed + nfile);
+    for (size_t k = 0; k < o->nwords; ++k) {
+      draw_word(o, nfile, &g, s);
+      item *it = hashtable_search(ht, s);
+      if (it != NULL) {
+        item_seen(it, nfile);
+        continue;
+      }
+      it = item_new(s, nfile);
+      if (it == NULL) {
+        return -1;
+      }
+      if (holdall_put(ha, it) != 0) {
+        free(it);
+        return -1;
+      }
+      if (hashtable_add(ht, it->s, it) == NULL) {
+        return -1;
+      }
+    }
+  }
+  return 0;
+}
+
+int check_item(hashtable *ref, item *it) {
+  item *r = hashtable_search(ref, it->s);
+  if (r == NULL || r->occ != it->occ
+      || (r->occ != 0 && r->file != it->file)) {
+    fprintf(stderr, "'%s': file %zu, %ld occurrences; expected file %zu, %ld "
+        "occurrences\n", it->s, it->file, it->occ,
+        r == NULL ? 0 : r->file, r == NULL ? 0 : r->occ);
+    return -1;
+  }
+  return 0;
+}
+
+size_t str_hashfun(const char *s) {
+  size_t h = 0;
+  for (const unsigned char *p = (const unsigned char *) s; *p != '\0'; ++p) {
+    h = 37 * h + *p;
+  }
+  return h;
+}
+
+int rfree(void *p) {
+  free(p);
+  return 0;
+}
+
+int rcfree([[maybe_unused]] void *context, void *p) {
+  return rfree(p);
+}
+
+int parse_size(const char *s, size_t *vptr) {
+  char *end;
+  errno = 0;
+  unsigned long long int v = strtoull(s, &end, 10);
+  if (*end != '\0' || !isdigit((unsigned char) *s) || errno == ERANGE
+      || v == 0 || v > SIZE_MAX) {
+    return -1;
+  }
+  *vptr = (size_t) v;
+  return 0;
+}
+
+void print_usage(const char *prog_name) {
+  fprintf(stderr, "Usage: %s [-t THREADS] [-n FILES] [-w WORDS] [-v VOCAB] "
+      "[-k SHARDS] [-s SEED]\n", prog_name);
+}
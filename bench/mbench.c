@@ -0,0 +1,199 @@
+//  mbench.c : outils communs aux micro-mesures des modules hashtable, holdall
+//    et sbuffer.
+
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <time.h>
+
+#include "mbench.h"
+
+#define NANO 1e9
+
+#define SAMPLES_CAPACITY_MIN  64
+#define SAMPLES_CAPACITY_MUL  2
+
+//  mix32 : bijection de l'ensemble des entiers de 32 bits, finaliseur de
+//    MurmurHash3.
+static uint32_t mix32(uint32_t x);
+
+//  compar_double : fonction de comparaison de qsort pour des double.
+static int compar_double(const void *a, const void *b);
+
+//  percentile : renvoie le centile p de la suite triée sorted de longueur n.
+static double percentile(const double *sorted, size_t n, double p);
+
+double mbench_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+}
+
+uint64_t mbench_random(uint64_t *stateptr) {
+  uint64_t x = *stateptr;
+  x ^= x >> 12;
+  x ^= x << 25;
+  x ^= x >> 27;
+  *stateptr = x;
+  return x * 0x2545F4914F6CDD1DULL;
+}
+
+void mbench_shuffle(void *a, size_t n, size_t size, uint64_t *stateptr) {
+  unsigned char *p = a;
+  for (size_t k = n; k > 1; --k) {
+    size_t j = (size_t) (mbench_random(stateptr) % k);
+    for (size_t i = 0; i < size; ++i) {
+      unsigned char t = p[(k - 1) * size + i];
+      p[(k - 1) * size + i] = p[j * size + i];
+      p[j * size + i] = t;
+    }
+  }
+}
+
+char *mbench_keys(size_t n, size_t first) {
+  if (n > SIZE_MAX / MBENCH_KEY_SIZE || first > UINT32_MAX
+      || n > UINT32_MAX - first + 1) {
+    return NULL;
+  }
+  char *keys = malloc(n * MBENCH_KEY_SIZE);
+  if (keys == NULL) {
+    return NULL;
+  }
+  for (size_t k = 0; k < n; ++k) {
+    //  26 ^ 7 dépasse 2 ^ 32 : sept lettres suffisent.
+    uint32_t x = mix32((uint32_t) (first + k));
+    char *s = keys + k * MBENCH_KEY_SIZE;
+    size_t len = 0;
+    do {
+      s[len] = (char) ('a' + x % 26);
+      ++len;
+      x /= 26;
+    } while (x != 0);
+    s[len] = '\0';
+  }
+  return keys;
+}
+
+int mbench_parse_sizes(const char *s, size_t **sizesptr, size_t *nptr) {
+  size_t n = 1;
+  for (const char *p = s; *p != '\0'; ++p) {
+    n += (*p == ',');
+  }
+  size_t *sizes = malloc(n * sizeof *sizes);
+  if (sizes == NULL) {
+    return -1;
+  }
+  const char *p = s;
+  for (size_t k = 0; k < n; ++k) {
+    char *end;
+    errno = 0;
+    unsigned long long int v = strtoull(p, &end, 10);
+    unsigned long long int mul = 1;
+    if (*end == 'K') {
+      mul = 1000;
+      ++end;
+    } else if (*end == 'M') {
+      mul = 1000000;
+      ++end;
+    }
+    if (!isdigit((unsigned char) *p) || errno == ERANGE || v == 0
+        || v > SIZE_MAX / mul || (*end != ',' && *end != '\0')) {
+      free(sizes);
+      return -1;
+    }
+    sizes[k] = (size_t) (v * mul);
+    p = end + 1;
+  }
+  *sizesptr = sizes;
+  *nptr = n;
+  return 0;
+}
+
+bool mbench_selected(const char *list, const char *name) {
+  if (list == NULL) {
+    return true;
+  }
+  size_t len = strlen(name);
+  const char *p = list;
+  while (true) {
+    size_t n = strcspn(p, ",");
+    if (n == len && strncmp(p, name, len) == 0) {
+      return true;
+    }
+    if (p[n] == '\0') {
+      return false;
+    }
+    p += n + 1;
+  }
+}
+
+int mbench_record(mbench_samples *s, double seconds, size_t nops) {
+  if (s->len == s->cap) {
+    if (s->cap > SIZE_MAX / SAMPLES_CAPACITY_MUL / sizeof *s->a) {
+      return -1;
+    }
+    size_t cap = s->cap == 0 ? SAMPLES_CAPACITY_MIN
+        : s->cap * SAMPLES_CAPACITY_MUL;
+    double *a = realloc(s->a, cap * sizeof *a);
+    if (a == NULL) {
+      return -1;
+    }
+    s->a = a;
+    s->cap = cap;
+  }
+  s->a[s->len] = seconds / (double) nops;
+  s->len += 1;
+  s->ops += nops;
+  s->seconds += seconds;
+  return 0;
+}
+
+void mbench_print_header(void) {
+  printf("backend\top\tsize\tns/op\tp50\tp90\tp99\tmax\n");
+}
+
+void mbench_print(mbench_samples *s, const char *backend, const char *op,
+    size_t size) {
+  if (s->len == 0) {
+    return;
+  }
+  qsort(s->a, s->len, sizeof *s->a, compar_double);
+  printf("%s\t%s\t%zu\t%.2f\t%.2f\t%.2f\t%.2f\t%.2f\n", backend, op, size,
+      s->seconds / (double) s->ops * NANO,
+      percentile(s->a, s->len, 0.50) * NANO,
+      percentile(s->a, s->len, 0.90) * NANO,
+      percentile(s->a, s->len, 0.99) * NANO,
+      s->a[s->len - 1] * NANO);
+  fflush(stdout);
+  s->len = 0;
+  s->ops = 0;
+  s->seconds = 0.0;
+}
+
+void mbench_dispose(mbench_samples *s) {
+  free(s->a);
+  s->a = NULL;
+  s->len = 0;
+  s->cap = 0;
+}
+
+uint32_t mix32(uint32_t x) {
+  x ^= x >> 16;
+  x *= 0x85EBCA6BU;
+  x ^= x >> 13;
+  x *= 0xC2B2AE35U;
+  x ^= x >> 16;
+  return x;
+}
+
+int compar_double(const void *a, const void *b) {
+  double x = *(const double *) a;
+  double y = *(const double *) b;
+  return (x > y) - (x < y);
+}
+
+double percentile(const double *sorted, size_t n, double p) {
+  size_t k = (size_t) (p * (double) (n - 1) + 0.5);
+  return sorted[k];
+}
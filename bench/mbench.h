@@ -0,0 +1,87 @@
+//  mbench.h : outils communs aux micro-mesures des modules hashtable, holdall
+//    et sbuffer : horloge, tirages pseudo-aléatoires reproductibles, clés
+//    synthétiques, lecture des options et bilan des échantillons de durées en
+//    nanosecondes par opération.
+
+#ifndef MBENCH__H
+#define MBENCH__H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+//  MBENCH_BATCH : nombre d'opérations par échantillon pour les opérations trop
+//    brèves pour être chronométrées une à une. La lecture de l'horloge coûte
+//    quelques dizaines de nanosecondes ; amortie sur un lot, elle ne fausse
+//    pas la mesure, au prix d'un lissage des centiles.
+#define MBENCH_BATCH 256
+
+//  MBENCH_KEY_SIZE : nombre d'octets occupés par une clé synthétique, '\0'
+//    compris.
+#define MBENCH_KEY_SIZE 8
+
+//  mbench_samples : type et nom de type pour une structure mémorisant les
+//    durées par opération des len échantillons mesurés, dans le tableau a de
+//    capacité cap, ainsi que le nombre total d'opérations ops et leur durée
+//    totale seconds.
+typedef struct {
+  double *a;
+  size_t len;
+  size_t cap;
+  size_t ops;
+  double seconds;
+} mbench_samples;
+
+//  mbench_now : renvoie la valeur courante en secondes d'une horloge monotone.
+extern double mbench_now(void);
+
+//  mbench_random : renvoie le tirage suivant de la suite xorshift64* d'état
+//    *stateptr, supposé non nul.
+extern uint64_t mbench_random(uint64_t *stateptr);
+
+//  mbench_shuffle : permute au hasard les n composants de taille size du
+//    tableau a, selon la suite d'état *stateptr.
+extern void mbench_shuffle(void *a, size_t n, size_t size,
+    uint64_t *stateptr);
+
+//  mbench_keys : tente d'allouer un tableau de n clés synthétiques, celles de
+//    rangs first à first + n - 1, chacune occupant MBENCH_KEY_SIZE octets.
+//    Les clés sont des mots de une à sept lettres minuscules, distincts pour
+//    des rangs distincts et dont l'ordre est sans rapport avec celui des
+//    rangs. Renvoie NULL en cas de dépassement de capacité, l'adresse du
+//    tableau sinon.
+extern char *mbench_keys(size_t n, size_t first);
+
+//  mbench_parse_sizes : tente d'analyser la liste s de tailles non nulles
+//    séparées par des virgules, chacune éventuellement suivie du suffixe
+//    multiplicatif K ou M. En cas de succès, affecte à *sizesptr l'adresse
+//    d'un tableau alloué contenant les tailles, à *nptr leur nombre et renvoie
+//    zéro. Renvoie une valeur non nulle sinon.
+extern int mbench_parse_sizes(const char *s, size_t **sizesptr, size_t *nptr);
+
+//  mbench_selected : renvoie true si name figure dans la liste list de noms
+//    séparés par des virgules ou si list vaut NULL, false sinon.
+extern bool mbench_selected(const char *list, const char *name);
+
+//  mbench_record : tente d'ajouter aux échantillons pointés par s la mesure
+//    de nops opérations, nops non nul, de durée totale seconds. Renvoie une
+//    valeur non nulle en cas de dépassement de capacité, zéro sinon.
+extern int mbench_record(mbench_samples *s, double seconds, size_t nops);
+
+//  mbench_print_header : affiche sur la sortie standard la ligne d'en-tête
+//    des bilans.
+extern void mbench_print_header(void);
+
+//  mbench_print : affiche sur la sortie standard le bilan des échantillons
+//    pointés par s pour l'opération op du composant backend sur la taille
+//    size : durée moyenne par opération, puis médiane, centiles 90 et 99 et
+//    maximum des durées par opération des échantillons, en nanosecondes. Les
+//    échantillons sont ensuite vidés.
+extern void mbench_print(mbench_samples *s, const char *backend,
+    const char *op, size_t size);
+
+//  mbench_dispose : libère les ressources allouées aux échantillons pointés par
+//    s.
+extern void mbench_dispose(mbench_samples *s);
+
+#endif
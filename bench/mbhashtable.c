@@ -0,0 +1,472 @@
+//  mbhashtable.c : micro-mesure des dictionnaires de mots. Pour chaque taille
+//    n et chaque composant retenu, n clés synthétiques distinctes sont
+//    ajoutées à un dictionnaire vide, puis à un dictionnaire dimensionné
+//    d'emblée pour n clés lorsque le composant le permet ; l'écart entre les
+//    deux mesures est le coût des agrandissements. Les n clés sont ensuite
+//    recherchées dans un ordre aléatoire, puis n clés absentes. Les
+//    composants sont la table générique du module hashtable, sa
+//    spécialisation par le patron hashtable_tpl.h, la table partagée du
+//    module chashtable, réduite à un fragment, et l'arbre de préfixes du
+//    module art. Les durées sont données en nanosecondes par opération.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <getopt.h>
+
+#include "hashtable.h"
+#include "hashtable_ext.h"
+#include "chashtable.h"
+#include "art.h"
+#include "mbench.h"
+
+#define SIZES_DEF   "1K,100K,1M"
+#define REPEATS_DEF 5
+#define SEED_DEF    42
+
+//  key : type et nom de type pour une structure décrivant une clé synthétique
+//    s de longueur len.
+typedef struct {
+  char *s;
+  size_t len;
+} key;
+
+//  key_hash : valeur de pré-hachage de la clé pointée par k, la même que celle
+//    de str_hashfun.
+static inline size_t key_hash(const key *k);
+
+//  key_table : type et nom de type pour une table de hachage associant des
+//    clés, mémorisées par valeur, à elles-mêmes. Instance du patron
+//    hashtable_tpl.h, pour mesurer le gain du développement en ligne du
+//    pré-hachage et de la comparaison.
+#define HASHTABLE_TPL_NAME    key_table
+#define HASHTABLE_TPL_PREFIX  key_table
+#define HASHTABLE_TPL_KEY     key
+#define HASHTABLE_TPL_VALUE   key
+#define HASHTABLE_TPL_HASH(ht, kp) \
+  key_hash(kp)
+#define HASHTABLE_TPL_EQUAL(ht, kp1, kp2) \
+  ((kp1)->len == (kp2)->len && memcmp((kp1)->s, (kp2)->s, (kp1)->len) == 0)
+#define HASHTABLE_TPL_KEY_DATA(kp) \
+  ((kp)->s)
+#include "hashtable_tpl.h"
+
+//  backend : type et nom de type pour une structure décrivant un composant
+//    mesuré, de nom name. La fonction empty tente de créer un dictionnaire
+//    vide, dimensionné pour capacity clés si capacity n'est pas nul et si
+//    presized est vrai ; elle renvoie NULL en cas d'échec. La fonction add
+//    tente d'ajouter au dictionnaire les n clés du tableau keys et renvoie une
+//    valeur non nulle en cas de dépassement de capacité ; search y recherche
+//    les n clés du tableau keys et renvoie le nombre de recherches positives.
+//    Les appels indirects sont ainsi amortis sur un lot.
+typedef struct {
+  const char *name;
+  bool presized;
+  void *(*empty)(size_t capacity);
+  int (*add)(void *d, key *keys, size_t n);
+  size_t (*search)(void *d, key *keys, size_t n);
+  void (*dispose)(void *d);
+} backend;
+
+static size_t str_hashfun(const char *s);
+
+static void *ht_empty(size_t capacity);
+static int ht_add(hashtable *ht, key *keys, size_t n);
+static size_t ht_search(hashtable *ht, key *keys, size_t n);
+static void ht_dispose(hashtable *ht);
+
+static void *tpl_empty(size_t capacity);
+static int tpl_add(key_table *kt, key *keys, size_t n);
+static size_t tpl_search(key_table *kt, key *keys, size_t n);
+static void tpl_dispose(key_table *kt);
+
+static void *cht_empty(size_t capacity);
+static int cht_add(chashtable *cht, key *keys, size_t n);
+static size_t cht_search(chashtable *cht, key *keys, size_t n);
+static void cht_dispose(chashtable *cht);
+static void *cht_add_value(void *context, const void **keyrefptr);
+static void cht_update_value(void *context, void *valref);
+
+static void *art_empty_any(size_t capacity);
+static int art_add_keys(art *t, key *keys, size_t n);
+static size_t art_search_keys(art *t, key *keys, size_t n);
+static void art_dispose_any(art *t);
+static const char *art_key(const key *k, size_t *lenptr);
+
+//  backends : composants mesurés.
+static const backend backends[] = {
+  {
+    "hashtable", true, ht_empty,
+    (int (*)(void *, key *, size_t))ht_add,
+    (size_t (*)(void *, key *, size_t))ht_search,
+    (void (*)(void *))ht_dispose
+  },
+  {
+    "tpl", true, tpl_empty,
+    (int (*)(void *, key *, size_t))tpl_add,
+    (size_t (*)(void *, key *, size_t))tpl_search,
+    (void (*)(void *))tpl_dispose
+  },
+  {
+    "chashtable", true, cht_empty,
+    (int (*)(void *, key *, size_t))cht_add,
+    (size_t (*)(void *, key *, size_t))cht_search,
+    (void (*)(void *))cht_dispose
+  },
+  {
+    "art", false, art_empty_any,
+    (int (*)(void *, key *, size_t))art_add_keys,
+    (size_t (*)(void *, key *, size_t))art_search_keys,
+    (void (*)(void *))art_dispose_any
+  },
+};
+
+#define NBACKENDS (sizeof backends / sizeof *backends)
+
+//  load_keys : tente d'allouer le tableau des descripteurs des n clés du
+//    tableau chars produit par mbench_keys. Renvoie NULL en cas de dépassement
+//    de capacité, l'adresse du tableau sinon.
+static key *load_keys(char *chars, size_t n);
+
+//  measure_add : crée un dictionnaire du composant pointé par b, dimensionné
+//    pour n clés si capacity est vrai, puis y ajoute par lots les n clés du
+//    tableau keys en mesurant chaque lot dans les échantillons pointés par s.
+//    Renvoie NULL en cas de dépassement de capacité, le dictionnaire sinon.
+static void *measure_add(const backend *b, bool capacity, key *keys, size_t n,
+    mbench_samples *s);
+
+//  measure_search : recherche par lots dans le dictionnaire d du composant
+//    pointé par b les n clés du tableau keys en mesurant chaque lot dans les
+//    échantillons pointés par s. Renvoie le nombre de recherches positives,
+//    SIZE_MAX en cas de dépassement de capacité.
+static size_t measure_search(const backend *b, void *d, key *keys, size_t n,
+    mbench_samples *s);
+
+static void print_usage(const char *prog_name);
+
+int main(int argc, char **argv) {
+  const char *list = NULL;
+  const char *sizes_arg = SIZES_DEF;
+  size_t repeats = REPEATS_DEF;
+  uint64_t seed = SEED_DEF;
+  int c;
+  while ((c = getopt(argc, argv, "b:n:r:s:")) != -1) {
+    switch (c) {
+      case 'b':
+        list = optarg;
+        break;
+      case 'n':
+        sizes_arg = optarg;
+        break;
+      case 'r':
+      case 's':
+        char *end;
+        errno = 0;
+        unsigned long long int v = strtoull(optarg, &end, 10);
+        if (*end != '\0' || !isdigit((unsigned char) *optarg)
+            || errno == ERANGE || v == 0 || v > SIZE_MAX) {
+          fprintf(stderr, "%s: invalid value for -%c: '%s'\n", argv[0], c,
+              optarg);
+          return EXIT_FAILURE;
+        }
+        if (c == 'r') {
+          repeats = (size_t) v;
+        } else {
+          seed = v;
+        }
+        break;
+      default:
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+  }
+  if (optind != argc) {
+    print_usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+  size_t *sizes;
+  size_t nsizes;
+  if (mbench_parse_sizes(sizes_arg, &sizes, &nsizes) != 0) {
+    fprintf(stderr, "%s: invalid value for -n: '%s'\n", argv[0], sizes_arg);
+    return EXIT_FAILURE;
+  }
+  int r = EXIT_SUCCESS;
+  char *hitchars = NULL;
+  char *misschars = NULL;
+  key *hits = NULL;
+  key *order = NULL;
+  key *misses = NULL;
+  mbench_samples s = { 0 };
+  mbench_print_header();
+  for (size_t i = 0; i < nsizes; ++i) {
+    size_t n = sizes[i];
+    hitchars = mbench_keys(n, 0);
+    misschars = mbench_keys(n, n);
+    if (hitchars == NULL || misschars == NULL) {
+      goto error_capacity;
+    }
+    hits = load_keys(hitchars, n);
+    order = load_keys(hitchars, n);
+    misses = load_keys(misschars, n);
+    if (hits == NULL || order == NULL || misses == NULL) {
+      goto error_capacity;
+    }
+    for (size_t k = 0; k < NBACKENDS; ++k) {
+      const backend *b = &backends[k];
+      if (!mbench_selected(list, b->name)) {
+        continue;
+      }
+      //  Les mesures d'une même opération sont groupées : une répétition par
+      //    opération, dans l'ordre de la sortie.
+      for (int op = 0; op < 4; ++op) {
+        if (op == 1 && !b->presized) {
+          continue;
+        }
+        uint64_t state = seed;
+        for (size_t j = 0; j < repeats; ++j) {
+          void *d = measure_add(b, op == 1, hits, n, op <= 1 ? &s : NULL);
+          if (d == NULL) {
+            goto error_capacity;
+          }
+          size_t found = 0;
+          size_t expected = 0;
+          if (op == 2) {
+            mbench_shuffle(order, n, sizeof *order, &state);
+            found = measure_search(b, d, order, n, &s);
+            expected = n;
+          } else if (op == 3) {
+            found = measure_search(b, d, misses, n, &s);
+          }
+          b->dispose(d);
+          if (found == SIZE_MAX) {
+            goto error_capacity;
+          }
+          if (found != expected) {
+            fprintf(stderr, "%s: %s: %zu keys found instead of %zu\n",
+                argv[0], b->name, found, expected);
+            goto error;
+          }
+        }
+        static const char *ops[] = {
+          "insert", "insert-presized", "search-hit", "search-miss",
+        };
+        mbench_print(&s, b->name, ops[op], n);
+      }
+    }
+    free(hitchars);
+    free(misschars);
+    free(hits);
+    free(order);
+    free(misses);
+    hitchars = misschars = NULL;
+    hits = order = misses = NULL;
+  }
+  goto dispose;
+error_capacity:
+  fprintf(stderr, "Error: Not enough memory\n");
+  goto error;
+error:
+  r = EXIT_FAILURE;
+  goto dispose;
+dispose:
+  mbench_dispose(&s);
+  free(hitchars);
+  free(misschars);
+  free(hits);
+  free(order);
+  free(misses);
+  free(sizes);
+  return r;
+}
+
+size_t key_hash(const key *k) {
+  size_t h = 0;
+  for (size_t j = 0; j < k->len; ++j) {
+    h = 37 * h + (unsigned char) k->s[j];
+  }
+  return h;
+}
+
+size_t str_hashfun(const char *s) {
+  size_t h = 0;
+  for (const unsigned char *p = (const unsigned char *) s; *p != '\0'; ++p) {
+    h = 37 * h + *p;
+  }
+  return h;
+}
+
+key *load_keys(char *chars, size_t n) {
+  key *keys = malloc(n * sizeof *keys);
+  if (keys == NULL) {
+    return NULL;
+  }
+  for (size_t k = 0; k < n; ++k) {
+    keys[k].s = chars + k * MBENCH_KEY_SIZE;
+    keys[k].len = strlen(keys[k].s);
+  }
+  return keys;
+}
+
+void *measure_add(const backend *b, bool capacity, key *keys, size_t n,
+    mbench_samples *s) {
+  void *d = b->empty(capacity ? n : 0);
+  if (d == NULL) {
+    return NULL;
+  }
+  for (size_t k = 0; k < n; k += MBENCH_BATCH) {
+    size_t m = n - k < MBENCH_BATCH ? n - k : MBENCH_BATCH;
+    double t = mbench_now();
+    int e = b->add(d, keys + k, m);
+    t = mbench_now() - t;
+    if (e != 0 || (s != NULL && mbench_record(s, t, m) != 0)) {
+      b->dispose(d);
+      return NULL;
+    }
+  }
+  return d;
+}
+
+size_t measure_search(const backend *b, void *d, key *keys, size_t n,
+    mbench_samples *s) {
+  size_t found = 0;
+  for (size_t k = 0; k < n; k += MBENCH_BATCH) {
+    size_t m = n - k < MBENCH_BATCH ? n - k : MBENCH_BATCH;
+    double t = mbench_now();
+    found += b->search(d, keys + k, m);
+    t = mbench_now() - t;
+    if (mbench_record(s, t, m) != 0) {
+      return SIZE_MAX;
+    }
+  }
+  return found;
+}
+
+void *ht_empty(size_t capacity) {
+  int (*compar)(const void *, const void *)
+    = (int (*)(const void *, const void *))strcmp;
+  size_t (*hashfun)(const void *) = (size_t (*)(const void *))str_hashfun;
+  return capacity == 0 ? hashtable_empty(compar, hashfun)
+      : hashtable_empty_with_capacity(compar, hashfun, capacity);
+}
+
+int ht_add(hashtable *ht, key *keys, size_t n) {
+  for (size_t k = 0; k < n; ++k) {
+    if (hashtable_add(ht, keys[k].s, &keys[k]) == NULL) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+size_t ht_search(hashtable *ht, key *keys, size_t n) {
+  size_t found = 0;
+  for (size_t k = 0; k < n; ++k) {
+    found += (hashtable_search(ht, keys[k].s) != NULL);
+  }
+  return found;
+}
+
+void ht_dispose(hashtable *ht) {
+  hashtable_dispose(&ht);
+}
+
+void *tpl_empty(size_t capacity) {
+  return capacity == 0 ? key_table_empty()
+      : key_table_empty_with_capacity(capacity);
+}
+
+int tpl_add(key_table *kt, key *keys, size_t n) {
+  for (size_t k = 0; k < n; ++k) {
+    if (key_table_add(kt, &keys[k], &keys[k]) == NULL) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+size_t tpl_search(key_table *kt, key *keys, size_t n) {
+  size_t found = 0;
+  for (size_t k = 0; k < n; ++k) {
+    found += (key_table_search(kt, &keys[k]) != NULL);
+  }
+  return found;
+}
+
+void tpl_dispose(key_table *kt) {
+  key_table_dispose(&kt);
+}
+
+void *cht_empty(size_t capacity) {
+  return chashtable_empty((int (*)(const void *, const void *))strcmp,
+      (size_t (*)(const void *))str_hashfun, 1, capacity);
+}
+
+int cht_add(chashtable *cht, key *keys, size_t n) {
+  for (size_t k = 0; k < n; ++k) {
+    if (chashtable_add_or_update(cht, keys[k].s, &keys[k], cht_add_value,
+        cht_update_value) != 0) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+size_t cht_search(chashtable *cht, key *keys, size_t n) {
+  size_t found = 0;
+  for (size_t k = 0; k < n; ++k) {
+    found += (chashtable_search(cht, keys[k].s) != NULL);
+  }
+  return found;
+}
+
+void cht_dispose(chashtable *cht) {
+  chashtable_dispose(&cht);
+}
+
+void *cht_add_value(void *context, [[maybe_unused]] const void **keyrefptr) {
+  return context;
+}
+
+void cht_update_value([[maybe_unused]] void *context,
+    [[maybe_unused]] void *valref) {
+}
+
+void *art_empty_any([[maybe_unused]] size_t capacity) {
+  return art_empty((const char *(*)(const void *, size_t *))art_key);
+}
+
+int art_add_keys(art *t, key *keys, size_t n) {
+  for (size_t k = 0; k < n; ++k) {
+    if (art_add(t, &keys[k]) == NULL) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+size_t art_search_keys(art *t, key *keys, size_t n) {
+  size_t found = 0;
+  for (size_t k = 0; k < n; ++k) {
+    found += (art_search(t, keys[k].s, keys[k].len) != NULL);
+  }
+  return found;
+}
+
+void art_dispose_any(art *t) {
+  art_dispose(&t);
+}
+
+const char *art_key(const key *k, size_t *lenptr) {
+  *lenptr = k->len;
+  return k->s;
+}
+
+void print_usage(const char *prog_name) {
+  fprintf(stderr, "Usage: %s [-b BACKEND,...] [-n SIZE,...] [-r REPEATS] "
+      "[-s SEED]\n", prog_name);
+  fprintf(stderr, "Backends: hashtable, tpl, chashtable, art\n");
+}
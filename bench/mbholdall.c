@@ -0,0 +1,364 @@
+//  mbholdall.c : micro-mesure du fourretout. Pour chaque taille n et chaque
+//    composant retenu, n références de clés synthétiques sont insérées dans
+//    un fourretout vide, puis triées selon strcmp, les clés étant
+//    initialement dans un ordre aléatoire, croissant, décroissant, ou tirées
+//    parmi DUPS_DISTINCT clés seulement. Les composants sont le module holdall
+//    et, pour comparaison, un tableau de références agrandi par realloc et
+//    trié par qsort. Les durées sont données en nanosecondes par référence ;
+//    un tri complet forme un échantillon.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <getopt.h>
+
+#include "holdall.h"
+#include "mbench.h"
+
+#define SIZES_DEF   "1K,100K,1M"
+#define REPEATS_DEF 5
+#define SEED_DEF    42
+
+#define DUPS_DISTINCT 16
+
+#define ARRAY_CAPACITY_MIN  16
+#define ARRAY_CAPACITY_MUL  2
+
+//  array : type et nom de type pour une structure décrivant un tableau de
+//    références refs de longueur len et de capacité cap.
+typedef struct {
+  void **refs;
+  size_t len;
+  size_t cap;
+} array;
+
+//  backend : type et nom de type pour une structure décrivant un composant
+//    mesuré, de nom name. La fonction empty tente de créer un fourretout vide
+//    et renvoie NULL en cas d'échec. La fonction put tente d'y insérer les n
+//    références du tableau refs et renvoie une valeur non nulle en cas de
+//    dépassement de capacité ; sort le trie selon strcmp ; first renvoie sa
+//    première référence, qui permet de vérifier le tri.
+typedef struct {
+  const char *name;
+  void *(*empty)(void);
+  int (*put)(void *d, char **refs, size_t n);
+  void (*sort)(void *d);
+  void *(*first)(void *d);
+  void (*dispose)(void *d);
+} backend;
+
+static void *ha_empty(void);
+static int ha_put(holdall *ha, char **refs, size_t n);
+static void ha_sort(holdall *ha);
+static void *ha_first(holdall *ha);
+static void *ha_first_ref(void **refptr, void *ref);
+static int ha_stop(void *ref, void *resultfun1);
+static void ha_dispose(holdall *ha);
+
+static void *array_empty(void);
+static int array_put(array *a, char **refs, size_t n);
+static void array_sort(array *a);
+static void *array_first(array *a);
+static void array_dispose(array *a);
+static int array_compar(const void *p1, const void *p2);
+
+//  backends : composants mesurés.
+static const backend backends[] = {
+  {
+    "holdall", ha_empty,
+    (int (*)(void *, char **, size_t))ha_put,
+    (void (*)(void *))ha_sort,
+    (void *(*)(void *))ha_first,
+    (void (*)(void *))ha_dispose
+  },
+  {
+    "array", array_empty,
+    (int (*)(void *, char **, size_t))array_put,
+    (void (*)(void *))array_sort,
+    (void *(*)(void *))array_first,
+    (void (*)(void *))array_dispose
+  },
+};
+
+#define NBACKENDS (sizeof backends / sizeof *backends)
+
+//  Ordres initiaux des références à trier.
+enum {
+  INPUT_RANDOM,
+  INPUT_SORTED,
+  INPUT_REVERSED,
+  INPUT_DUPS,
+  NINPUTS,
+};
+
+//  fill : affecte aux n composants du tableau refs les références des clés du
+//    tableau keys dans l'ordre initial input, selon la suite d'état *stateptr.
+//    Les n références de sorted sont celles des clés dans l'ordre croissant.
+static void fill(char **refs, size_t n, char *keys, char **sorted, int input,
+    uint64_t *stateptr);
+
+static void print_usage(const char *prog_name);
+
+int main(int argc, char **argv) {
+  const char *list = NULL;
+  const char *sizes_arg = SIZES_DEF;
+  size_t repeats = REPEATS_DEF;
+  uint64_t seed = SEED_DEF;
+  int c;
+  while ((c = getopt(argc, argv, "b:n:r:s:")) != -1) {
+    switch (c) {
+      case 'b':
+        list = optarg;
+        break;
+      case 'n':
+        sizes_arg = optarg;
+        break;
+      case 'r':
+      case 's':
+        char *end;
+        errno = 0;
+        unsigned long long int v = strtoull(optarg, &end, 10);
+        if (*end != '\0' || !isdigit((unsigned char) *optarg)
+            || errno == ERANGE || v == 0 || v > SIZE_MAX) {
+          fprintf(stderr, "%s: invalid value for -%c: '%s'\n", argv[0], c,
+              optarg);
+          return EXIT_FAILURE;
+        }
+        if (c == 'r') {
+          repeats = (size_t) v;
+        } else {
+          seed = v;
+        }
+        break;
+      default:
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+  }
+  if (optind != argc) {
+    print_usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+  size_t *sizes;
+  size_t nsizes;
+  if (mbench_parse_sizes(sizes_arg, &sizes, &nsizes) != 0) {
+    fprintf(stderr, "%s: invalid value for -n: '%s'\n", argv[0], sizes_arg);
+    return EXIT_FAILURE;
+  }
+  int r = EXIT_SUCCESS;
+  char *keys = NULL;
+  char **sorted = NULL;
+  char **refs = NULL;
+  void *d = NULL;
+  const backend *b = NULL;
+  mbench_samples s = { 0 };
+  mbench_print_header();
+  for (size_t i = 0; i < nsizes; ++i) {
+    size_t n = sizes[i];
+    keys = mbench_keys(n, 0);
+    sorted = malloc(n * sizeof *sorted);
+    refs = malloc(n * sizeof *refs);
+    if (keys == NULL || sorted == NULL || refs == NULL) {
+      goto error_capacity;
+    }
+    for (size_t k = 0; k < n; ++k) {
+      sorted[k] = keys + k * MBENCH_KEY_SIZE;
+    }
+    qsort(sorted, n, sizeof *sorted, array_compar);
+    for (size_t k = 0; k < NBACKENDS; ++k) {
+      b = &backends[k];
+      if (!mbench_selected(list, b->name)) {
+        continue;
+      }
+      uint64_t state = seed;
+      fill(refs, n, keys, sorted, INPUT_RANDOM, &state);
+      for (size_t j = 0; j < repeats; ++j) {
+        d = b->empty();
+        if (d == NULL) {
+          goto error_capacity;
+        }
+        for (size_t h = 0; h < n; h += MBENCH_BATCH) {
+          size_t m = n - h < MBENCH_BATCH ? n - h : MBENCH_BATCH;
+          double t = mbench_now();
+          int e = b->put(d, refs + h, m);
+          t = mbench_now() - t;
+          if (e != 0 || mbench_record(&s, t, m) != 0) {
+            goto error_capacity;
+          }
+        }
+        b->dispose(d);
+        d = NULL;
+      }
+      mbench_print(&s, b->name, "put", n);
+      static const char *ops[] = {
+        "sort-random", "sort-sorted", "sort-reversed", "sort-dups",
+      };
+      for (int input = 0; input < NINPUTS; ++input) {
+        state = seed;
+        for (size_t j = 0; j < repeats; ++j) {
+          fill(refs, n, keys, sorted, input, &state);
+          d = b->empty();
+          if (d == NULL || b->put(d, refs, n) != 0) {
+            goto error_capacity;
+          }
+          double t = mbench_now();
+          b->sort(d);
+          t = mbench_now() - t;
+          if (mbench_record(&s, t, n) != 0) {
+            goto error_capacity;
+          }
+          const char *least = refs[0];
+          for (size_t h = 1; h < n; ++h) {
+            if (strcmp(refs[h], least) < 0) {
+              least = refs[h];
+            }
+          }
+          if (strcmp(b->first(d), least) != 0) {
+            fprintf(stderr, "%s: %s: %s: not sorted\n", argv[0], b->name,
+                ops[input]);
+            goto error;
+          }
+          b->dispose(d);
+          d = NULL;
+        }
+        mbench_print(&s, b->name, ops[input], n);
+      }
+    }
+    free(keys);
+    free(sorted);
+    free(refs);
+    keys = NULL;
+    sorted = NULL;
+    refs = NULL;
+  }
+  goto dispose;
+error_capacity:
+  fprintf(stderr, "Error: Not enough memory\n");
+  goto error;
+error:
+  r = EXIT_FAILURE;
+  goto dispose;
+dispose:
+  if (d != NULL) {
+    b->dispose(d);
+  }
+  mbench_dispose(&s);
+  free(keys);
+  free(sorted);
+  free(refs);
+  free(sizes);
+  return r;
+}
+
+void fill(char **refs, size_t n, char *keys, char **sorted, int input,
+    uint64_t *stateptr) {
+  switch (input) {
+    case INPUT_RANDOM:
+      memcpy(refs, sorted, n * sizeof *refs);
+      mbench_shuffle(refs, n, sizeof *refs, stateptr);
+      break;
+    case INPUT_SORTED:
+      memcpy(refs, sorted, n * sizeof *refs);
+      break;
+    case INPUT_REVERSED:
+      for (size_t k = 0; k < n; ++k) {
+        refs[k] = sorted[n - 1 - k];
+      }
+      break;
+    case INPUT_DUPS:
+      for (size_t k = 0; k < n; ++k) {
+        size_t j = (size_t) (mbench_random(stateptr) % DUPS_DISTINCT);
+        refs[k] = keys + (j < n ? j : 0) * MBENCH_KEY_SIZE;
+      }
+      break;
+  }
+}
+
+void *ha_empty(void) {
+  return holdall_empty();
+}
+
+int ha_put(holdall *ha, char **refs, size_t n) {
+  for (size_t k = 0; k < n; ++k) {
+    if (holdall_put(ha, refs[k]) != 0) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+void ha_sort(holdall *ha) {
+  holdall_sort(ha, (int (*)(const void *, const void *))strcmp);
+}
+
+void *ha_first(holdall *ha) {
+  void *ref = NULL;
+  holdall_apply_context(ha, &ref,
+      (void *(*)(void *, void *))ha_first_ref, ha_stop);
+  return ref;
+}
+
+void *ha_first_ref(void **refptr, void *ref) {
+  *refptr = ref;
+  return ref;
+}
+
+int ha_stop([[maybe_unused]] void *ref, [[maybe_unused]] void *resultfun1) {
+  return 1;
+}
+
+void ha_dispose(holdall *ha) {
+  holdall_dispose(&ha);
+}
+
+void *array_empty(void) {
+  return calloc(1, sizeof(array));
+}
+
+int array_put(array *a, char **refs, size_t n) {
+  for (size_t k = 0; k < n; ++k) {
+    if (a->len == a->cap) {
+      if (a->cap > SIZE_MAX / ARRAY_CAPACITY_MUL / sizeof *a->refs) {
+        return -1;
+      }
+      size_t cap = a->cap == 0 ? ARRAY_CAPACITY_MIN
+          : a->cap * ARRAY_CAPACITY_MUL;
+      void **p = realloc(a->refs, cap * sizeof *p);
+      if (p == NULL) {
+        return -1;
+      }
+      a->refs = p;
+      a->cap = cap;
+    }
+    a->refs[a->len] = refs[k];
+    a->len += 1;
+  }
+  return 0;
+}
+
+void array_sort(array *a) {
+  qsort(a->refs, a->len, sizeof *a->refs, array_compar);
+}
+
+void *array_first(array *a) {
+  return a->len == 0 ? NULL : a->refs[0];
+}
+
+void array_dispose(array *a) {
+  free(a->refs);
+  free(a);
+}
+
+int array_compar(const void *p1, const void *p2) {
+  return strcmp(*(char *const *) p1, *(char *const *) p2);
+}
+
+void print_usage(const char *prog_name) {
+  fprintf(stderr, "Usage: %s [-b BACKEND,...] [-n SIZE,...] [-r REPEATS] "
+      "[-s SEED]\n", prog_name);
+  fprintf(stderr, "Backends: holdall, array\n");
+}
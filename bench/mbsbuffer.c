@@ -0,0 +1,324 @@
+//  mbsbuffer.c : micro-mesure du string buffer. Pour chaque longueur de mot
+//    len et chaque composant retenu, des mots de len lettres sont ajoutés
+//    caractère par caractère au buffer, jusqu'à un total d'octets fixé : le
+//    buffer est vidé avant chaque mot puis sa chaîne lue après, ou bien il
+//    n'est jamais vidé, ce qui mesure le coût de ses agrandissements. Les
+//    mots sont enfin ajoutés d'un bloc, comme le fait le découpage en mots de
+//    xwc pour un mot à cheval sur deux blocs lus. Les composants sont le module
+//    sbuffer et, pour comparaison, un tableau agrandi par realloc dont
+//    l'ajout est développé en ligne. Les durées sont données en nanosecondes
+//    par octet ajouté ; un lot de MBENCH_BATCH mots forme un échantillon.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <getopt.h>
+
+#include "sbuffer.h"
+#include "mbench.h"
+
+#define LENGTHS_DEF "4,8,16,64,1K"
+#define TOTAL_DEF   ((size_t) 1 << 24)
+#define REPEATS_DEF 5
+#define SEED_DEF    42
+
+#define ARRAY_CAPACITY_MIN  4
+#define ARRAY_CAPACITY_MUL  2
+
+//  array : type et nom de type pour une structure décrivant une chaîne de
+//    longueur len rangée dans le tableau s de capacité cap.
+typedef struct {
+  char *s;
+  size_t len;
+  size_t cap;
+} array;
+
+//  backend : type et nom de type pour une structure décrivant un composant
+//    mesuré, de nom name. La fonction empty tente de créer un buffer vide et
+//    renvoie NULL en cas d'échec. La fonction append tente d'ajouter au
+//    buffer les nwords mots de len octets lus dans word, d'un bloc si span est
+//    vrai, en le vidant avant chaque mot et en lisant sa chaîne après si clear
+//    est vrai, et renvoie une valeur non nulle en cas de dépassement de
+//    capacité. La fonction length renvoie la longueur de la chaîne du buffer.
+typedef struct {
+  const char *name;
+  void *(*empty)(void);
+  int (*append)(void *d, const char *word, size_t len, size_t nwords,
+      bool clear, bool span);
+  size_t (*length)(void *d);
+  void (*dispose)(void *d);
+} backend;
+
+static void *sb_empty(void);
+static int sb_append(sbuffer *sb, const char *word, size_t len, size_t nwords,
+    bool clear, bool span);
+static size_t sb_length(sbuffer *sb);
+static void sb_dispose(sbuffer *sb);
+
+static void *array_empty(void);
+static int array_append(array *a, const char *word, size_t len,
+    size_t nwords, bool clear, bool span);
+static size_t array_length(array *a);
+static void array_dispose(array *a);
+
+//  backends : composants mesurés.
+static const backend backends[] = {
+  {
+    "sbuffer", sb_empty,
+    (int (*)(void *, const char *, size_t, size_t, bool, bool))sb_append,
+    (size_t (*)(void *))sb_length,
+    (void (*)(void *))sb_dispose
+  },
+  {
+    "array", array_empty,
+    (int (*)(void *, const char *, size_t, size_t, bool, bool))array_append,
+    (size_t (*)(void *))array_length,
+    (void (*)(void *))array_dispose
+  },
+};
+
+#define NBACKENDS (sizeof backends / sizeof *backends)
+
+//  sink : reçoit le premier caractère de chaque chaîne lue, pour que sa
+//    lecture ne puisse être supprimée par le compilateur.
+static volatile char sink;
+
+static void print_usage(const char *prog_name);
+
+int main(int argc, char **argv) {
+  const char *list = NULL;
+  const char *lengths_arg = LENGTHS_DEF;
+  size_t total = TOTAL_DEF;
+  size_t repeats = REPEATS_DEF;
+  uint64_t seed = SEED_DEF;
+  int c;
+  while ((c = getopt(argc, argv, "b:l:t:r:s:")) != -1) {
+    switch (c) {
+      case 'b':
+        list = optarg;
+        break;
+      case 'l':
+        lengths_arg = optarg;
+        break;
+      case 't':
+      case 'r':
+      case 's':
+        char *end;
+        errno = 0;
+        unsigned long long int v = strtoull(optarg, &end, 10);
+        if (*end != '\0' || !isdigit((unsigned char) *optarg)
+            || errno == ERANGE || v == 0 || v > SIZE_MAX) {
+          fprintf(stderr, "%s: invalid value for -%c: '%s'\n", argv[0], c,
+              optarg);
+          return EXIT_FAILURE;
+        }
+        if (c == 't') {
+          total = (size_t) v;
+        } else if (c == 'r') {
+          repeats = (size_t) v;
+        } else {
+          seed = v;
+        }
+        break;
+      default:
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+  }
+  if (optind != argc) {
+    print_usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+  size_t *lengths;
+  size_t nlengths;
+  if (mbench_parse_sizes(lengths_arg, &lengths, &nlengths) != 0) {
+    fprintf(stderr, "%s: invalid value for -l: '%s'\n", argv[0],
+        lengths_arg);
+    return EXIT_FAILURE;
+  }
+  int r = EXIT_SUCCESS;
+  char *word = NULL;
+  void *d = NULL;
+  const backend *b = NULL;
+  mbench_samples s = { 0 };
+  mbench_print_header();
+  for (size_t i = 0; i < nlengths; ++i) {
+    size_t len = lengths[i];
+    size_t nwords = total / len == 0 ? 1 : total / len;
+    word = malloc(len);
+    if (word == NULL) {
+      goto error_capacity;
+    }
+    uint64_t state = seed;
+    for (size_t k = 0; k < len; ++k) {
+      word[k] = (char) ('a' + mbench_random(&state) % 26);
+    }
+    for (size_t k = 0; k < NBACKENDS; ++k) {
+      b = &backends[k];
+      if (!mbench_selected(list, b->name)) {
+        continue;
+      }
+      static const char *ops[] = {
+        "append-word", "append-grow", "append-span",
+      };
+      for (int op = 0; op < 3; ++op) {
+        bool clear = (op != 1);
+        bool span = (op == 2);
+        for (size_t j = 0; j < repeats; ++j) {
+          d = b->empty();
+          if (d == NULL) {
+            goto error_capacity;
+          }
+          for (size_t h = 0; h < nwords; h += MBENCH_BATCH) {
+            size_t m = nwords - h < MBENCH_BATCH ? nwords - h : MBENCH_BATCH;
+            double t = mbench_now();
+            int e = b->append(d, word, len, m, clear, span);
+            t = mbench_now() - t;
+            if (e != 0 || mbench_record(&s, t, m * len) != 0) {
+              goto error_capacity;
+            }
+          }
+          if (b->length(d) != (clear ? len : nwords * len)) {
+            fprintf(stderr, "%s: %s: wrong length\n", argv[0], b->name);
+            goto error;
+          }
+          b->dispose(d);
+          d = NULL;
+        }
+        mbench_print(&s, b->name, ops[op], len);
+      }
+    }
+    free(word);
+    word = NULL;
+  }
+  goto dispose;
+error_capacity:
+  fprintf(stderr, "Error: Not enough memory\n");
+  goto error;
+error:
+  r = EXIT_FAILURE;
+  goto dispose;
+dispose:
+  if (d != NULL) {
+    b->dispose(d);
+  }
+  mbench_dispose(&s);
+  free(word);
+  free(lengths);
+  return r;
+}
+
+void *sb_empty(void) {
+  return sbuffer_empty();
+}
+
+int sb_append(sbuffer *sb, const char *word, size_t len, size_t nwords,
+    bool clear, bool span) {
+  for (size_t k = 0; k < nwords; ++k) {
+    if (clear) {
+      sbuffer_clear(sb);
+    }
+    if (span && sbuffer_append_span(sb, word, len) != 0) {
+      return -1;
+    }
+    for (size_t j = 0; !span && j < len; ++j) {
+      if (sbuffer_append(sb, word[j]) != 0) {
+        return -1;
+      }
+    }
+    if (clear) {
+      sink = *sbuffer_get_str(sb);
+    }
+  }
+  return 0;
+}
+
+size_t sb_length(sbuffer *sb) {
+  return sbuffer_length(sb);
+}
+
+void sb_dispose(sbuffer *sb) {
+  sbuffer_dispose(&sb);
+}
+
+void *array_empty(void) {
+  array *a = malloc(sizeof *a);
+  if (a == NULL) {
+    return NULL;
+  }
+  a->s = malloc(ARRAY_CAPACITY_MIN);
+  if (a->s == NULL) {
+    free(a);
+    return NULL;
+  }
+  a->len = 0;
+  a->cap = ARRAY_CAPACITY_MIN;
+  return a;
+}
+
+int array_append(array *a, const char *word, size_t len, size_t nwords,
+    bool clear, bool span) {
+  for (size_t k = 0; k < nwords; ++k) {
+    if (clear) {
+      a->len = 0;
+    }
+    if (span) {
+      if (len >= a->cap - a->len) {
+        size_t cap = a->cap;
+        while (len >= cap - a->len) {
+          if (cap > SIZE_MAX / ARRAY_CAPACITY_MUL) {
+            return -1;
+          }
+          cap *= ARRAY_CAPACITY_MUL;
+        }
+        char *p = realloc(a->s, cap);
+        if (p == NULL) {
+          return -1;
+        }
+        a->s = p;
+        a->cap = cap;
+      }
+      memcpy(a->s + a->len, word, len);
+      a->len += len;
+    }
+    for (size_t j = 0; !span && j < len; ++j) {
+      if (a->len + 1 == a->cap) {
+        if (a->cap > SIZE_MAX / ARRAY_CAPACITY_MUL) {
+          return -1;
+        }
+        char *p = realloc(a->s, a->cap * ARRAY_CAPACITY_MUL);
+        if (p == NULL) {
+          return -1;
+        }
+        a->s = p;
+        a->cap *= ARRAY_CAPACITY_MUL;
+      }
+      a->s[a->len] = word[j];
+      a->len += 1;
+    }
+    if (clear) {
+      a->s[a->len] = '\0';
+      sink = a->s[0];
+    }
+  }
+  return 0;
+}
+
+size_t array_length(array *a) {
+  return a->len;
+}
+
+void array_dispose(array *a) {
+  free(a->s);
+  free(a);
+}
+
+void print_usage(const char *prog_name) {
+  fprintf(stderr, "Usage: %s [-b BACKEND,...] [-l LENGTH,...] [-t BYTES] "
+      "[-r REPEATS] [-s SEED]\n", prog_name);
+  fprintf(stderr, "Backends: sbuffer, array\n");
+}
@@ -0,0 +1,343 @@
+//  qlatency.c : mesure la latence des requêtes adressées au démon xwcd. Des
+//    mots tirés au hasard dans un fichier sont recherchés par des requêtes
+//    QUERY successives, sur une même connexion ; la durée de chaque aller et
+//    retour est mesurée et les centiles de la distribution sont donnés en
+//    microsecondes. Sont aussi mesurés, une fois chacun, l'ajout d'un fichier
+//    et le parcours trié de tous les mots exclusifs.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <time.h>
+#include <getopt.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "xwcd.h"
+
+#define NQUERIES_DEF    10000
+#define BATCH_DEF       1
+#define SEED_DEF        42
+
+//  Nombre et intervalle, en microsecondes, des tentatives de connexion : le
+//    démon peut être encore en train de compter les fichiers initiaux.
+#define CONNECT_TRIES   600
+#define CONNECT_WAIT_US 100000
+
+#define RESPONSE_CAPACITY_MIN 4096
+#define RESPONSE_CAPACITY_MUL 2
+
+#define MICRO 1e6
+
+//  response : type et nom de type pour une structure mémorisant la réponse
+//    reçue, de longueur len, dans buf, de capacité cap.
+typedef struct {
+  char *buf;
+  size_t len;
+  size_t cap;
+} response;
+
+//  now : renvoie la valeur courante en secondes d'une horloge monotone.
+static double now(void);
+
+//  connect_to : tente de se connecter à la socket de nom path, en renouvelant
+//    la tentative tant que la socket n'existe pas ou n'est pas écoutée.
+//    Renvoie la socket en cas de succès, -1 sinon.
+static int connect_to(const char *path);
+
+//  request : envoie sur fd la requête req, de longueur len, fin de ligne
+//    comprise, puis reçoit la réponse dans *rp. Renvoie une valeur non nulle
+//    en cas d'erreur ou si la réponse n'est pas un succès, zéro sinon.
+static int request(int fd, const char *req, size_t len, response *rp);
+
+//  load_words : lit le fichier de nom fname et renvoie son contenu, dont les
+//    mots, séparés par des caractères d'espacement, sont terminés par '\0' ;
+//    leurs adresses sont affectées aux *nptr premiers composants de *wordsptr.
+//    Renvoie NULL en cas d'erreur.
+static char *load_words(const char *fname, char ***wordsptr, size_t *nptr);
+
+//  compar_double : fonction de comparaison de qsort pour des double.
+static int compar_double(const void *a, const void *b);
+
+//  percentile : renvoie le centile p de la suite triée sorted de longueur n.
+static double percentile(const double *sorted, size_t n, double p);
+
+static void print_usage(const char *prog_name);
+
+int main(int argc, char **argv) {
+  const char *path = XWCD_SOCKET_DEF;
+  size_t nqueries = NQUERIES_DEF;
+  size_t batch = BATCH_DEF;
+  const char *add = NULL;
+  int c;
+  while ((c = getopt(argc, argv, "S:n:b:a:")) != -1) {
+    switch (c) {
+      case 'S':
+        path = optarg;
+        break;
+      case 'n':
+      case 'b':
+        char *end;
+        errno = 0;
+        unsigned long long int v = strtoull(optarg, &end, 10);
+        if (*end != '\0' || !isdigit((unsigned char) *optarg)
+            || errno == ERANGE || v == 0 || v > SIZE_MAX) {
+          fprintf(stderr, "%s: invalid value for -%c: '%s'\n", argv[0], c,
+              optarg);
+          return EXIT_FAILURE;
+        }
+        *(c == 'n' ? &nqueries : &batch) = (size_t) v;
+        break;
+      case 'a':
+        add = optarg;
+        break;
+      default:
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+  }
+  if (argc - optind != 1) {
+    print_usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+  int r = EXIT_SUCCESS;
+  int fd = -1;
+  char **words = NULL;
+  size_t nwords = 0;
+  double *lat = malloc(nqueries * sizeof *lat);
+  char *req = malloc(XWCD_LINE_MAX);
+  response resp = { NULL, 0, 0 };
+  char *text = load_words(argv[optind], &words, &nwords);
+  if (text == NULL || nwords == 0) {
+    fprintf(stderr, "%s: cannot read words from '%s'\n", argv[0],
+        argv[optind]);
+    goto error;
+  }
+  if (lat == NULL || req == NULL) {
+    fprintf(stderr, "Error: Not enough memory\n");
+    goto error;
+  }
+  fd = connect_to(path);
+  if (fd == -1) {
+    fprintf(stderr, "%s: cannot connect to '%s': %s\n", argv[0], path,
+        strerror(errno));
+    goto error;
+  }
+  if (add != NULL) {
+    int len = snprintf(req, XWCD_LINE_MAX, XWCD_CMD_ADD " %s\n", add);
+    double t = now();
+    if (len >= XWCD_LINE_MAX || request(fd, req, (size_t) len, &resp) != 0) {
+      goto error_request;
+    }
+    printf("add\t%.3f ms\n", (now() - t) * 1e3);
+  }
+  //  Tirage xorshift64* : la suite des requêtes est la même d'une exécution
+  //    à l'autre.
+  uint64_t state = SEED_DEF;
+  double tstart = now();
+  for (size_t k = 0; k < nqueries; ++k) {
+    size_t len = sizeof XWCD_CMD_QUERY - 1;
+    memcpy(req, XWCD_CMD_QUERY, len);
+    for (size_t j = 0; j < batch; ++j) {
+      state ^= state >> 12;
+      state ^= state << 25;
+      state ^= state >> 27;
+      const char *w = words[(state * 0x2545F4914F6CDD1DULL) % nwords];
+      size_t n = strlen(w);
+      if (len + 1 + n + 1 > XWCD_LINE_MAX) {
+        break;
+      }
+      req[len] = ' ';
+      memcpy(req + len + 1, w, n);
+      len += 1 + n;
+    }
+    req[len] = '\n';
+    double t = now();
+    if (request(fd, req, len + 1, &resp) != 0) {
+      goto error_request;
+    }
+    lat[k] = now() - t;
+  }
+  double total = now() - tstart;
+  qsort(lat, nqueries, sizeof *lat, compar_double);
+  printf("query\t%zu x %zu words\t%.0f queries/s\n", nqueries, batch,
+      (double) nqueries / total);
+  printf("query.p50\t%.1f us\n", percentile(lat, nqueries, 0.50) * MICRO);
+  printf("query.p90\t%.1f us\n", percentile(lat, nqueries, 0.90) * MICRO);
+  printf("query.p99\t%.1f us\n", percentile(lat, nqueries, 0.99) * MICRO);
+  printf("query.max\t%.1f us\n", lat[nqueries - 1] * MICRO);
+  static const char dump[] = XWCD_CMD_DUMP " " XWCD_ARG_SORT_LEX "\n";
+  double t = now();
+  if (request(fd, dump, sizeof dump - 1, &resp) != 0) {
+    goto error_request;
+  }
+  printf("dump\t%.3f ms\t%zu bytes\n", (now() - t) * 1e3, resp.len);
+  goto dispose;
+error_request:
+  fprintf(stderr, "%s: request failed", argv[0]);
+  if (resp.len > sizeof XWCD_STATUS_ERR
+      && memcmp(resp.buf, XWCD_STATUS_ERR " ", sizeof XWCD_STATUS_ERR) == 0) {
+    fprintf(stderr, ": %.*s", (int) strcspn(resp.buf, "\n"), resp.buf);
+  }
+  fprintf(stderr, "\n");
+  goto error;
+error:
+  r = EXIT_FAILURE;
+  goto dispose;
+dispose:
+  if (fd != -1) {
+    close(fd);
+  }
+  free(resp.buf);
+  free(req);
+  free(lat);
+  free(words);
+  free(text);
+  return r;
+}
+
+double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+int connect_to(const char *path) {
+  struct sockaddr_un addr;
+  if (strlen(path) >= sizeof addr.sun_path) {
+    errno = ENAMETOOLONG;
+    return -1;
+  }
+  memset(&addr, 0, sizeof addr);
+  addr.sun_family = AF_UNIX;
+  strcpy(addr.sun_path, path);
+  for (size_t k = 0; k < CONNECT_TRIES; ++k) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1) {
+      return -1;
+    }
+    if (connect(fd, (struct sockaddr *) &addr, sizeof addr) == 0) {
+      return fd;
+    }
+    int e = errno;
+    close(fd);
+    if (e != ENOENT && e != ECONNREFUSED) {
+      errno = e;
+      return -1;
+    }
+    struct timespec ts = { 0, CONNECT_WAIT_US * 1000L };
+    nanosleep(&ts, NULL);
+  }
+  return -1;
+}
+
+int request(int fd, const char *req, size_t len, response *rp) {
+  while (len != 0) {
+    ssize_t n = write(fd, req, len);
+    if (n == -1) {
+      return -1;
+    }
+    req += n;
+    len -= (size_t) n;
+  }
+  //  La réponse se termine à la première ligne vide.
+  rp->len = 0;
+  while (rp->len < 2 || memcmp(rp->buf + rp->len - 2, "\n\n", 2) != 0) {
+    if (rp->len == rp->cap) {
+      size_t cap = (rp->cap == 0 ? RESPONSE_CAPACITY_MIN
+          : rp->cap * RESPONSE_CAPACITY_MUL);
+      char *a = realloc(rp->buf, cap);
+      if (a == NULL) {
+        return -1;
+      }
+      rp->buf = a;
+      rp->cap = cap;
+    }
+    ssize_t n = read(fd, rp->buf + rp->len, rp->cap - rp->len);
+    if (n <= 0) {
+      return -1;
+    }
+    rp->len += (size_t) n;
+  }
+  return memcmp(rp->buf, XWCD_STATUS_OK "\n", sizeof XWCD_STATUS_OK) == 0
+    ? 0 : -1;
+}
+
+char *load_words(const char *fname, char ***wordsptr, size_t *nptr) {
+  FILE *f = fopen(fname, "r");
+  if (f == NULL) {
+    return NULL;
+  }
+  char *text = NULL;
+  size_t len = 0;
+  size_t cap = 0;
+  size_t n;
+  do {
+    if (len == cap) {
+      cap = (cap == 0 ? RESPONSE_CAPACITY_MIN : cap * RESPONSE_CAPACITY_MUL);
+      char *a = realloc(text, cap + 1);
+      if (a == NULL) {
+        goto error;
+      }
+      text = a;
+    }
+    n = fread(text + len, 1, cap - len, f);
+    len += n;
+  } while (n != 0);
+  if (ferror(f)) {
+    goto error;
+  }
+  fclose(f);
+  text[len] = '\0';
+  size_t nwords = 0;
+  bool in = false;
+  for (size_t k = 0; k < len; ++k) {
+    bool space = isspace((unsigned char) text[k]);
+    nwords += !space && !in;
+    in = !space;
+  }
+  char **words = malloc((nwords + 1) * sizeof *words);
+  if (words == NULL) {
+    free(text);
+    return NULL;
+  }
+  *nptr = 0;
+  in = false;
+  for (size_t k = 0; k < len; ++k) {
+    bool space = isspace((unsigned char) text[k]);
+    if (space) {
+      text[k] = '\0';
+    } else if (!in) {
+      words[*nptr] = text + k;
+      *nptr += 1;
+    }
+    in = !space;
+  }
+  *wordsptr = words;
+  return text;
+error:
+  fclose(f);
+  free(text);
+  return NULL;
+}
+
+int compar_double(const void *a, const void *b) {
+  double x = *(const double *) a;
+  double y = *(const double *) b;
+  return (x > y) - (x < y);
+}
+
+double percentile(const double *sorted, size_t n, double p) {
+  size_t k = (size_t) (p * (double) (n - 1) + 0.5);
+  return sorted[k];
+}
+
+void print_usage(const char *prog_name) {
+  fprintf(stderr, "Usage: %s [-S PATH] [-n QUERIES] [-b WORDS] [-a FILE] "
+      "FILE\n", prog_name);
+}
@@ -0,0 +1,313 @@
+//  zipfgen.c : générateur reproductible de corpus synthétiques dont les
+//    fréquences de mots suivent une loi de Zipf. Sert à alimenter les mesures
+//    de performance de xwc.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <math.h>
+#include <getopt.h>
+
+#define VOCAB_DEF       100000
+#define NFILES_DEF      4
+#define NWORDS_DEF      1000000
+#define WORDLEN_DEF     7
+#define PUNCT_DEF       0.05
+#define EXPONENT_DEF    1.0
+#define SEED_DEF        42
+#define PREFIX_DEF      "corpus"
+
+#define WORDS_PER_LINE  12
+#define ALPHABET        "abcdefghijklmnopqrstuvwxyz"
+#define ALPHABET_LEN    (sizeof ALPHABET - 1)
+#define PUNCT_CHARS     ",.;:!?'\"()-"
+#define PUNCT_LEN       (sizeof PUNCT_CHARS - 1)
+
+//  gen_options : type et nom de type pour une structure contenant les
+//    paramètres de génération.
+typedef struct {
+  size_t vocab;
+  size_t nfiles;
+  size_t nwords;
+  size_t wordlen;
+  double punct;
+  double exponent;
+  uint64_t seed;
+  const char *prefix;
+} gen_options;
+
+//  rng : type et nom de type pour l'état d'un générateur pseudo-aléatoire
+//    xorshift64*. Le générateur de la bibliothèque standard n'est pas employé
+//    afin que les corpus soient identiques d'une plateforme à l'autre.
+typedef struct {
+  uint64_t state;
+} rng;
+
+//  rng_seed : initialise le générateur pointé par g à partir de seed.
+static void rng_seed(rng *g, uint64_t seed);
+
+//  rng_next : renvoie le prochain entier pseudo-aléatoire de 64 bits du
+//    générateur pointé par g.
+static uint64_t rng_next(rng *g);
+
+//  rng_unif : renvoie un réel pseudo-aléatoire dans [0, 1[.
+static double rng_unif(rng *g);
+
+//  make_vocab : tente de construire un vocabulaire de o->vocab mots distincts
+//    dont la longueur moyenne est voisine de o->wordlen. Les mots sont rangés
+//    consécutivement, séparés par '\0', dans une zone allouée dont l'adresse
+//    est renvoyée ; les débuts de mots sont affectés à *wordsptr. Renvoie NULL
+//    en cas de dépassement de capacité.
+static char *make_vocab(const gen_options *o, rng *g, char ***wordsptr);
+
+//  make_cdf : tente d'allouer et de calculer la fonction de répartition de la
+//    loi de Zipf d'exposant o->exponent sur o->vocab rangs. Renvoie NULL en cas
+//    de dépassement de capacité.
+static double *make_cdf(const gen_options *o);
+
+//  draw_rank : renvoie un rang tiré selon la fonction de répartition cdf de
+//    longueur n.
+static size_t draw_rank(const double *cdf, size_t n, rng *g);
+
+//  write_file : écrit dans le fichier de nom fname o->nwords mots tirés selon
+//    cdf. Renvoie une valeur non nulle en cas d'erreur, zéro sinon.
+static int write_file(const gen_options *o, const char *fname, char **words,
+    const double *cdf, rng *g);
+
+//  parse_size : convertit la chaîne s en un entier affecté à *vptr, nul
+//    seulement si zero est vrai. Renvoie une valeur non nulle en cas d'échec,
+//    zéro sinon.
+static int parse_size(const char *s, size_t *vptr, bool zero);
+
+static void print_usage(const char *prog_name);
+
+int main(int argc, char **argv) {
+  gen_options o = {
+    .vocab = VOCAB_DEF,
+    .nfiles = NFILES_DEF,
+    .nwords = NWORDS_DEF,
+    .wordlen = WORDLEN_DEF,
+    .punct = PUNCT_DEF,
+    .exponent = EXPONENT_DEF,
+    .seed = SEED_DEF,
+    .prefix = PREFIX_DEF
+  };
+  int c;
+  while ((c = getopt(argc, argv, "v:n:w:l:p:a:s:o:")) != -1) {
+    size_t v;
+    char *end;
+    switch (c) {
+      case 'v':
+      case 'n':
+      case 'w':
+      case 'l':
+      case 's':
+        if (parse_size(optarg, &v, c == 's') != 0) {
+          fprintf(stderr, "%s: invalid value for -%c: '%s'\n", argv[0], c,
+              optarg);
+          return EXIT_FAILURE;
+        }
+        if (c == 'v') {
+          o.vocab = v;
+        } else if (c == 'n') {
+          o.nfiles = v;
+        } else if (c == 'w') {
+          o.nwords = v;
+        } else if (c == 'l') {
+          o.wordlen = v;
+        } else {
+          o.seed = v;
+        }
+        break;
+      case 'p':
+      case 'a':
+        errno = 0;
+        double d = strtod(optarg, &end);
+        if (*end != '\0' || errno == ERANGE || d < 0.0
+            || (c == 'p' && d > 1.0)) {
+          fprintf(stderr, "%s: invalid value for -%c: '%s'\n", argv[0], c,
+              optarg);
+          return EXIT_FAILURE;
+        }
+        *(c == 'p' ? &o.punct : &o.exponent) = d;
+        break;
+      case 'o':
+        o.prefix = optarg;
+        break;
+      default:
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+  }
+  int r = EXIT_SUCCESS;
+  rng g;
+  rng_seed(&g, o.seed);
+  char **words = NULL;
+  char *vocab = make_vocab(&o, &g, &words);
+  double *cdf = make_cdf(&o);
+  if (vocab == NULL || cdf == NULL) {
+    fprintf(stderr, "Error: Not enough memory\n");
+    r = EXIT_FAILURE;
+    goto dispose;
+  }
+  {
+    size_t fnamelen = strlen(o.prefix) + 32;
+    char fname[fnamelen];
+    for (size_t k = 0; k < o.nfiles; ++k) {
+      snprintf(fname, fnamelen, "%s.%zu.txt", o.prefix, k + 1);
+      if (write_file(&o, fname, words, cdf, &g) != 0) {
+        fprintf(stderr, "Error: An error has occurred while writing file "
+            "'%s'\n", fname);
+        r = EXIT_FAILURE;
+        break;
+      }
+      printf("%s\n", fname);
+    }
+  }
+dispose:
+  free(cdf);
+  free(words);
+  free(vocab);
+  return r;
+}
+
+void rng_seed(rng *g, uint64_t seed) {
+  //  splitmix64 sur la graine, pour éviter l'état nul.
+  uint64_t z = seed + 0x9E3779B97F4A7C15ULL;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  z ^= z >> 31;
+  g->state = (z == 0 ? 1 : z);
+}
+
+uint64_t rng_next(rng *g) {
+  uint64_t x = g->state;
+  x ^= x >> 12;
+  x ^= x << 25;
+  x ^= x >> 27;
+  g->state = x;
+  return x * 0x2545F4914F6CDD1DULL;
+}
+
+double rng_unif(rng *g) {
+  return (double) (rng_next(g) >> 11) * 0x1.0p-53;
+}
+
+char *make_vocab(const gen_options *o, rng *g, char ***wordsptr) {
+  //  Chaque mot est formé de lettres aléatoires suivies de l'écriture en base
+  //    ALPHABET_LEN de son rang, sur un nombre de chiffres width commun à tous
+  //    les mots : deux mots distincts ont des suffixes distincts, quelles que
+  //    soient les longueurs de leurs préfixes.
+  size_t width = 1;
+  for (size_t x = o->vocab - 1; x >= ALPHABET_LEN; x /= ALPHABET_LEN) {
+    ++width;
+  }
+  if (o->wordlen > (SIZE_MAX - 16) / 2) {
+    return NULL;
+  }
+  size_t maxlen = 2 * o->wordlen + 16;
+  if (o->vocab > SIZE_MAX / (maxlen + 1)
+      || o->vocab > SIZE_MAX / sizeof(char *)) {
+    return NULL;
+  }
+  char *vocab = malloc(o->vocab * (maxlen + 1));
+  char **words = malloc(o->vocab * sizeof *words);
+  if (vocab == NULL || words == NULL) {
+    free(vocab);
+    free(words);
+    return NULL;
+  }
+  char *p = vocab;
+  for (size_t k = 0; k < o->vocab; ++k) {
+    words[k] = p;
+    size_t len = 1 + (size_t) (rng_next(g) % (2 * o->wordlen - 1));
+    for (size_t i = width; i < len; ++i) {
+      *p++ = ALPHABET[rng_next(g) % ALPHABET_LEN];
+    }
+    size_t x = k;
+    for (size_t i = width; i > 0; --i) {
+      p[i - 1] = ALPHABET[x % ALPHABET_LEN];
+      x /= ALPHABET_LEN;
+    }
+    p += width;
+    *p++ = '\0';
+  }
+  *wordsptr = words;
+  return vocab;
+}
+
+double *make_cdf(const gen_options *o) {
+  if (o->vocab > SIZE_MAX / sizeof(double)) {
+    return NULL;
+  }
+  double *cdf = malloc(o->vocab * sizeof *cdf);
+  if (cdf == NULL) {
+    return NULL;
+  }
+  double s = 0.0;
+  for (size_t k = 0; k < o->vocab; ++k) {
+    s += 1.0 / pow((double) (k + 1), o->exponent);
+    cdf[k] = s;
+  }
+  for (size_t k = 0; k < o->vocab; ++k) {
+    cdf[k] /= s;
+  }
+  return cdf;
+}
+
+size_t draw_rank(const double *cdf, size_t n, rng *g) {
+  double u = rng_unif(g);
+  size_t lo = 0;
+  size_t hi = n - 1;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (cdf[mid] < u) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+int write_file(const gen_options *o, const char *fname, char **words,
+    const double *cdf, rng *g) {
+  FILE *f = fopen(fname, "w");
+  if (f == NULL) {
+    return -1;
+  }
+  for (size_t k = 0; k < o->nwords; ++k) {
+    fputs(words[draw_rank(cdf, o->vocab, g)], f);
+    if (rng_unif(g) < o->punct) {
+      fputc(PUNCT_CHARS[rng_next(g) % PUNCT_LEN], f);
+    }
+    fputc((k + 1) % WORDS_PER_LINE == 0 ? '\n' : ' ', f);
+  }
+  fputc('\n', f);
+  if (ferror(f)) {
+    fclose(f);
+    return -1;
+  }
+  return fclose(f) != 0;
+}
+
+int parse_size(const char *s, size_t *vptr, bool zero) {
+  char *end;
+  errno = 0;
+  unsigned long long int v = strtoull(s, &end, 10);
+  if (*end != '\0' || !isdigit((unsigned char) *s) || errno == ERANGE
+      || (v == 0 && !zero) || v > SIZE_MAX) {
+    return -1;
+  }
+  *vptr = (size_t) v;
+  return 0;
+}
+
+void print_usage(const char *prog_name) {
+  fprintf(stderr, "Usage: %s [-v VOCAB] [-n FILES] [-w WORDS] [-l WORDLEN] "
+      "[-p PUNCT] [-a EXPONENT] [-s SEED] [-o PREFIX]\n", prog_name);
+}
@@ -0,0 +1,242 @@
+//  chashtable.c : partie implantation d'un module polymorphe pour une table de
+//    hachage partagée entre plusieurs fils d'exécution.
+
+#include <stdalign.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "chashtable.h"
+#include "holdall.h"
+#include "holdall_ext.h"
+
+//  Chaque fragment est aligné sur CHT__CACHE_LINE octets afin que les verrous
+//    de fragments voisins ne partagent pas de ligne de cache.
+
+#define CHT__CACHE_LINE   64
+
+//  Le fragment d'une clé est désigné par les lbnshards bits de poids fort du
+//    produit de la valeur de pré-hachage par CHT__MIX_MUL : les bits de poids
+//    faible restent ainsi ceux qui choisissent le compartiment dans la table du
+//    fragment.
+
+#define CHT__MIX_MUL      0x9E3779B97F4A7C15ULL
+
+//  shard : type et nom de type d'un fragment. Le fourretout vals référence les
+//    valeurs de la table ht, dans l'ordre de leur ajout, afin de permettre le
+//    parcours de la table.
+typedef struct {
+  alignas(CHT__CACHE_LINE) pthread_mutex_t lock;
+  hashtable *ht;
+  holdall *vals;
+} shard;
+
+struct chashtable {
+  size_t (*hashfun)(const void *);
+  shard *shards;
+  size_t nshards;
+  size_t lbnshards;
+};
+
+//  cht__shard : renvoie l'adresse du fragment de la clé de référence keyref.
+static shard *cht__shard(chashtable *cht, const void *keyref) {
+  if (cht->lbnshards == 0) {
+    return cht->shards;
+  }
+  uint64_t h = (uint64_t) cht->hashfun(keyref) * CHT__MIX_MUL;
+  return &cht->shards[h >> (64 - cht->lbnshards)];
+}
+
+chashtable *chashtable_empty(int (*compar)(const void *, const void *),
+    size_t (*hashfun)(const void *), size_t nshards, size_t capacity) {
+  if (nshards == 0) {
+    return NULL;
+  }
+  size_t lb = 0;
+  while (((size_t) 1 << lb) < nshards) {
+    if (lb + 1 >= 64) {
+      return NULL;
+    }
+    ++lb;
+  }
+  nshards = (size_t) 1 << lb;
+  chashtable *cht = malloc(sizeof *cht);
+  if (cht == NULL) {
+    return NULL;
+  }
+  if (nshards > SIZE_MAX / sizeof *cht->shards) {
+    free(cht);
+    return NULL;
+  }
+  cht->shards = aligned_alloc(alignof(shard), nshards * sizeof *cht->shards);
+  if (cht->shards == NULL) {
+    free(cht);
+    return NULL;
+  }
+  cht->hashfun = hashfun;
+  cht->nshards = 0;
+  cht->lbnshards = lb;
+  for (size_t k = 0; k < nshards; ++k) {
+    shard *s = &cht->shards[k];
+    s->ht = hashtable_empty_with_capacity(compar, hashfun,
+        capacity / nshards + (capacity % nshards != 0));
+    s->vals = holdall_empty();
+    if (s->ht == NULL || s->vals == NULL
+        || pthread_mutex_init(&s->lock, NULL) != 0) {
+      hashtable_dispose(&s->ht);
+      holdall_dispose(&s->vals);
+      chashtable_dispose(&cht);
+      return NULL;
+    }
+    cht->nshards += 1;
+  }
+  return cht;
+}
+
+void chashtable_dispose(chashtable **chtptr) {
+  if (*chtptr == NULL) {
+    return;
+  }
+  for (size_t k = 0; k < (*chtptr)->nshards; ++k) {
+    shard *s = &(*chtptr)->shards[k];
+    pthread_mutex_destroy(&s->lock);
+    hashtable_dispose(&s->ht);
+    holdall_dispose(&s->vals);
+  }
+  free((*chtptr)->shards);
+  free(*chtptr);
+  *chtptr = NULL;
+}
+
+void *chashtable_search(chashtable *cht, const void *keyref) {
+  shard *s = cht__shard(cht, keyref);
+  pthread_mutex_lock(&s->lock);
+  void *valref = hashtable_search(s->ht, keyref);
+  pthread_mutex_unlock(&s->lock);
+  return valref;
+}
+
+int chashtable_add_or_update(chashtable *cht, const void *keyref,
+    void *context, void *(*add)(void *context, const void **keyrefptr),
+    void (*update)(void *context, void *valref)) {
+  shard *s = cht__shard(cht, keyref);
+  int r = 0;
+  pthread_mutex_lock(&s->lock);
+  void *valref = hashtable_search(s->ht, keyref);
+  if (valref != NULL) {
+    update(context, valref);
+    goto unlock;
+  }
+  valref = add(context, &keyref);
+  if (valref == NULL) {
+    goto unlock;
+  }
+  if (hashtable_add(s->ht, keyref, valref) == NULL) {
+    r = -1;
+    goto unlock;
+  }
+  if (holdall_put(s->vals, valref) != 0) {
+    hashtable_remove(s->ht, keyref);
+    r = -1;
+  }
+unlock:
+  pthread_mutex_unlock(&s->lock);
+  return r;
+}
+
+size_t chashtable_count(chashtable *cht) {
+  size_t n = 0;
+  for (size_t k = 0; k < cht->nshards; ++k) {
+    n += holdall_count(cht->shards[k].vals);
+  }
+  return n;
+}
+
+//  cht__apply_context : type du contexte transmis aux fonctions de parcours
+//    des fourretouts de valeurs par chashtable_apply.
+typedef struct {
+  void *context;
+  int (*fun)(void *context, void *valref);
+} cht__apply_context;
+
+//  cht__apply_self : renvoie ac.
+static void *cht__apply_self(void *ac, [[maybe_unused]] void *valref) {
+  return ac;
+}
+
+//  cht__apply_fun : renvoie la valeur de l'appel ac->fun(ac->context, valref).
+static int cht__apply_fun(void *valref, void *ac) {
+  cht__apply_context *a = ac;
+  return a->fun(a->context, valref);
+}
+
+int chashtable_apply(chashtable *cht, void *context,
+    int (*fun)(void *context, void *valref)) {
+  cht__apply_context ac = {
+    .context = context,
+    .fun = fun,
+  };
+  for (size_t k = 0; k < cht->nshards; ++k) {
+    int r = holdall_apply_context(cht->shards[k].vals, &ac, cht__apply_self,
+        cht__apply_fun);
+    if (r != 0) {
+      return r;
+    }
+  }
+  return 0;
+}
+
+size_t chashtable_memory(chashtable *cht, size_t *slotsptr,
+    size_t *cellsptr) {
+  size_t m = sizeof *cht + cht->nshards * sizeof *cht->shards;
+  size_t slots = 0;
+  size_t cells = 0;
+  for (size_t k = 0; k < cht->nshards; ++k) {
+    size_t sl;
+    size_t ce;
+    m += hashtable_memory(cht->shards[k].ht, &sl, &ce)
+      + holdall_memory(cht->shards[k].vals);
+    slots += sl;
+    cells += ce;
+  }
+  if (slotsptr != NULL) {
+    *slotsptr = slots;
+  }
+  if (cellsptr != NULL) {
+    *cellsptr = cells;
+  }
+  return m;
+}
+
+#if defined HASHTABLE_STATS && HASHTABLE_STATS != 0
+
+void chashtable_get_stats(chashtable *cht, struct hashtable_stats *htsptr,
+    struct hashtable_ext_stats *htesptr) {
+  struct hashtable_stats t = { 0 };
+  struct hashtable_ext_stats te = { 0 };
+  for (size_t k = 0; k < cht->nshards; ++k) {
+    struct hashtable_stats hts;
+    hashtable_get_stats(cht->shards[k].ht, &hts);
+    struct hashtable_ext_stats htes;
+    hashtable_get_ext_stats(cht->shards[k].ht, &htes);
+    t.nslots += hts.nslots;
+    t.nentries += hts.nentries;
+    t.ldfactmax = hts.ldfactmax;
+    if (hts.maxlen > t.maxlen) {
+      t.maxlen = hts.maxlen;
+    }
+    t.postheo += hts.postheo * (double) hts.nentries;
+    t.poscurr += hts.poscurr * (double) hts.nentries;
+    te.nresizes += htes.nresizes;
+    te.nreseeds += htes.nreseeds;
+  }
+  if (t.nentries != 0) {
+    t.postheo /= (double) t.nentries;
+    t.poscurr /= (double) t.nentries;
+  }
+  t.ldfactcurr = (t.nslots == 0 ? 0.0
+      : (double) t.nentries / (double) t.nslots);
+  *htsptr = t;
+  *htesptr = te;
+}
+
+#endif
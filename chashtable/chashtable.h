@@ -0,0 +1,100 @@
+//  chashtable.h : partie interface d'un module polymorphe pour une table de
+//    hachage partagée entre plusieurs fils d'exécution. La table est découpée
+//    en fragments, chacun étant une table du module hashtable protégée par son
+//    propre verrou.
+
+//  Le comportement du module est sensible à la définition préalable de la
+//    macroconstante HASHTABLE_STATS.
+
+#ifndef CHASHTABLE__H
+#define CHASHTABLE__H
+
+#include <stdlib.h>
+
+#include "hashtable.h"
+#include "hashtable_ext.h"
+
+//  Fonctionnement général :
+//  - comme pour le module hashtable, la structure de données ne stocke que des
+//      références vers des clés et des valeurs, NULL ne pouvant pas être une
+//      référence de valeur ;
+//  - le fragment d'une clé est choisi par les bits de poids fort de la valeur
+//      de sa fonction de pré-hachage ; deux fils d'exécution qui accèdent à
+//      des clés de fragments différents ne se gênent pas ;
+//  - les fonctions chashtable_search et chashtable_add_or_update peuvent être
+//      appelées simultanément par plusieurs fils d'exécution. Les autres
+//      fonctions ne le peuvent pas : elles sont destinées à être appelées
+//      avant le lancement ou après la fin des fils d'exécution.
+
+//  struct chashtable, chashtable : type et nom de type d'un contrôleur
+//    regroupant les informations nécessaires pour gérer une table partagée.
+typedef struct chashtable chashtable;
+
+//  chashtable_empty : tente d'allouer les ressources nécessaires pour gérer une
+//    nouvelle table partagée initialement vide, découpée en un nombre de
+//    fragments égal à la plus petite puissance de deux supérieure ou égale à
+//    nshards. Les paramètres compar et hashfun ont la même signification que
+//    pour hashtable_empty. Les fragments sont dimensionnés d'emblée pour
+//    recevoir ensemble environ capacity clés, capacity pouvant valoir zéro.
+//    Renvoie NULL si nshards vaut zéro ou en cas de dépassement de capacité.
+//    Renvoie sinon un pointeur vers le contrôleur associé à la table.
+extern chashtable *chashtable_empty(int (*compar)(const void *, const void *),
+    size_t (*hashfun)(const void *), size_t nshards, size_t capacity);
+
+//  chashtable_dispose : sans effet si *chtptr vaut NULL. Libère sinon les
+//    ressources allouées à la gestion de la table associée à *chtptr puis
+//    affecte NULL à *chtptr.
+extern void chashtable_dispose(chashtable **chtptr);
+
+//  chashtable_search : recherche dans la table associée à cht la référence
+//    d'une clé égale à celle de référence keyref. Renvoie NULL si la recherche
+//    est négative, la référence de la valeur correspondante sinon.
+extern void *chashtable_search(chashtable *cht, const void *keyref);
+
+//  chashtable_add_or_update : recherche dans la table associée à cht la
+//    référence d'une clé égale à celle de référence keyref, le fragment
+//    concerné étant verrouillé jusqu'au retour de la fonction. Si la recherche
+//    est positive, appelle update(context, valref) où valref est la référence
+//    de la valeur correspondante. Sinon, appelle add(context, &keyref) : si
+//    l'appel renvoie NULL, la table n'est pas modifiée ; sinon, tente d'ajouter
+//    à la table le couple formé de keyref, que add peut remplacer par la
+//    référence d'une clé égale destinée à être mémorisée, et de la valeur
+//    renvoyée. Renvoie une valeur non nulle si l'ajout échoue pour cause de
+//    dépassement de capacité, la valeur renvoyée par add n'étant alors pas
+//    mémorisée par la table. Renvoie zéro sinon.
+extern int chashtable_add_or_update(chashtable *cht, const void *keyref,
+    void *context, void *(*add)(void *context, const void **keyrefptr),
+    void (*update)(void *context, void *valref));
+
+//  chashtable_count : renvoie le nombre de clés de la table associée à cht.
+extern size_t chashtable_count(chashtable *cht);
+
+//  chashtable_apply : parcourt la table associée à cht en appelant
+//    fun(context, valref) pour chacune de ses références de valeurs. Si, lors
+//    du parcours, la valeur de l'appel n'est pas nulle, l'exécution de la
+//    fonction prend fin et la fonction renvoie cette valeur. Sinon, la
+//    fonction renvoie zéro. Les clés ne sont pas consultées lors du parcours :
+//    fun peut libérer les objets associés à la table.
+extern int chashtable_apply(chashtable *cht, void *context,
+    int (*fun)(void *context, void *valref));
+
+//  chashtable_memory : renvoie le nombre d'octets actuellement alloués pour la
+//    gestion de la table associée à cht, contrôleur compris. Si slotsptr ne
+//    vaut pas NULL, affecte à *slotsptr le nombre d'octets alloués aux
+//    tableaux de hachage des fragments. Si cellsptr ne vaut pas NULL, affecte
+//    à *cellsptr le nombre d'octets alloués aux cellules de leurs listes.
+extern size_t chashtable_memory(chashtable *cht, size_t *slotsptr,
+    size_t *cellsptr);
+
+#if defined HASHTABLE_STATS && HASHTABLE_STATS != 0
+
+//  chashtable_get_stats : effectue un bilan de santé de l'ensemble des
+//    fragments de la table associée à cht et affecte le résultat à *htsptr,
+//    le bilan complémentaire à *htesptr. Les moyennes sont pondérées par les
+//    nombres de clés des fragments, les nombres sont cumulés.
+extern void chashtable_get_stats(chashtable *cht,
+    struct hashtable_stats *htsptr, struct hashtable_ext_stats *htesptr);
+
+#endif
+
+#endif
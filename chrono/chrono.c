@@ -0,0 +1,36 @@
+//  chrono.c : partie implantation d'un module pour la mesure de durées
+//    écoulées en temps réel et en temps processeur.
+
+#include <time.h>
+
+#include "chrono.h"
+
+#define TIMESPEC_TO_SEC(ts) \
+  ((double) (ts).tv_sec + (double) (ts).tv_nsec * 1e-9)
+
+chrono chrono_now(void) {
+  struct timespec w;
+  struct timespec c;
+  if (clock_gettime(CLOCK_MONOTONIC, &w) != 0) {
+    w = (struct timespec) { 0, 0 };
+  }
+  if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &c) != 0) {
+    c = (struct timespec) { 0, 0 };
+  }
+  return (chrono) {
+    .wall = TIMESPEC_TO_SEC(w),
+    .cpu = TIMESPEC_TO_SEC(c),
+  };
+}
+
+chrono chrono_since(chrono start) {
+  chrono t = chrono_now();
+  return (chrono) {
+    .wall = t.wall - start.wall,
+    .cpu = t.cpu - start.cpu,
+  };
+}
+
+double chrono_rate(double n, double seconds) {
+  return seconds > 0.0 ? n / seconds : 0.0;
+}
@@ -0,0 +1,25 @@
+//  chrono.h : partie interface d'un module pour la mesure de durées écoulées
+//    en temps réel et en temps processeur.
+
+#ifndef CHRONO__H
+#define CHRONO__H
+
+//  chrono : type et nom de type d'une structure mémorisant un instant, exprimé
+//    en secondes, selon une horloge monotone (wall) et selon l'horloge du temps
+//    processeur consommé par le processus (cpu).
+typedef struct {
+  double wall;
+  double cpu;
+} chrono;
+
+//  chrono_now : renvoie l'instant courant.
+extern chrono chrono_now(void);
+
+//  chrono_since : renvoie la durée écoulée depuis l'instant start.
+extern chrono chrono_since(chrono start);
+
+//  chrono_rate : renvoie le débit correspondant au traitement de n unités en
+//    seconds secondes, ou 0.0 si seconds n'est pas strictement positif.
+extern double chrono_rate(double n, double seconds);
+
+#endif
@@ -0,0 +1,124 @@
+//  fileset.c : partie implantation d'un module pour la mémorisation compacte
+//    des fichiers dans lesquels apparaît un mot, avec son nombre d'occurrences
+//    dans chacun d'eux.
+
+#include <stdint.h>
+#include <string.h>
+
+#include "fileset.h"
+
+//  entry : type et nom de type pour une structure associant l'indice file d'un
+//    fichier à un nombre d'occurrences occ.
+typedef struct {
+  size_t file;
+  long int occ;
+} entry;
+
+//  struct fileset, fileset : les n premiers composants du tableau pointé par
+//    entries, de capacité cap, sont les couples de l'ensemble. Le tableau est
+//    inl tant que cap vaut FILESET_INLINE, un tableau alloué sinon.
+struct fileset {
+  size_t n;
+  size_t cap;
+  entry *entries;
+  entry inl[FILESET_INLINE];
+};
+
+//  fileset__find : renvoie le rang dans l'ensemble associé à fs du fichier
+//    d'indice file s'il y figure, celui auquel il serait inséré sinon.
+static size_t fileset__find(const fileset *fs, size_t file);
+
+fileset *fileset_empty(void) {
+  fileset *fs = malloc(sizeof *fs);
+  if (fs == NULL) {
+    return NULL;
+  }
+  fs->n = 0;
+  fs->cap = FILESET_INLINE;
+  fs->entries = fs->inl;
+  return fs;
+}
+
+void fileset_dispose(fileset **fsptr) {
+  if (*fsptr == NULL) {
+    return;
+  }
+  if ((*fsptr)->entries != (*fsptr)->inl) {
+    free((*fsptr)->entries);
+  }
+  free(*fsptr);
+  *fsptr = NULL;
+}
+
+int fileset_add(fileset *fs, size_t file, long int occ) {
+  size_t k = (fs->n == 0 || fs->entries[fs->n - 1].file < file ? fs->n
+      : fileset__find(fs, file));
+  if (k < fs->n && fs->entries[k].file == file) {
+    fs->entries[k].occ += occ;
+    return 0;
+  }
+  if (fs->n == fs->cap) {
+    if (fs->cap > SIZE_MAX / 2 / sizeof *fs->entries) {
+      return -1;
+    }
+    entry *a = malloc(2 * fs->cap * sizeof *a);
+    if (a == NULL) {
+      return -1;
+    }
+    memcpy(a, fs->entries, fs->n * sizeof *a);
+    if (fs->entries != fs->inl) {
+      free(fs->entries);
+    }
+    fs->entries = a;
+    fs->cap *= 2;
+  }
+  memmove(fs->entries + k + 1, fs->entries + k,
+      (fs->n - k) * sizeof *fs->entries);
+  fs->entries[k] = (entry) { file, occ };
+  fs->n += 1;
+  return 0;
+}
+
+long int fileset_take(fileset *fs, size_t file) {
+  if (fs->n == 0 || fs->entries[fs->n - 1].file < file) {
+    return 0;
+  }
+  size_t k = fileset__find(fs, file);
+  if (k == fs->n || fs->entries[k].file != file) {
+    return 0;
+  }
+  long int occ = fs->entries[k].occ;
+  memmove(fs->entries + k, fs->entries + k + 1,
+      (fs->n - k - 1) * sizeof *fs->entries);
+  fs->n -= 1;
+  return occ;
+}
+
+size_t fileset_count(const fileset *fs) {
+  return fs->n;
+}
+
+void fileset_get(const fileset *fs, size_t k, size_t *fileptr,
+    long int *occptr) {
+  *fileptr = fs->entries[k].file;
+  *occptr = fs->entries[k].occ;
+}
+
+size_t fileset_memory(const fileset *fs) {
+  return sizeof *fs
+    + (fs->entries == fs->inl ? 0 : fs->cap * sizeof *fs->entries);
+}
+
+size_t fileset__find(const fileset *fs, size_t file) {
+  size_t lo = 0;
+  size_t hi = fs->n;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (fs->entries[mid].file < file) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
@@ -0,0 +1,62 @@
+//  fileset.h : partie interface d'un module pour la mémorisation compacte des
+//    fichiers dans lesquels apparaît un mot, avec son nombre d'occurrences
+//    dans chacun d'eux.
+
+#ifndef FILESET__H
+#define FILESET__H
+
+#include <stdlib.h>
+
+//  Fonctionnement général :
+//  - un ensemble associe des indices de fichiers à des nombres d'occurrences.
+//      Les couples sont rangés par indices croissants ;
+//  - les FILESET_INLINE premiers couples sont rangés dans le contrôleur
+//      lui-même ; au-delà, ils le sont dans un tableau alloué à part, dont la
+//      capacité double à chaque agrandissement ;
+//  - l'ajout d'un fichier d'indice supérieur à tous ceux de l'ensemble, cas
+//      d'une lecture des fichiers dans l'ordre, se fait en temps constant
+//      amorti ; les autres recherches sont dichotomiques.
+
+#define FILESET_INLINE  2
+
+//  struct fileset, fileset : type et nom de type d'un contrôleur regroupant
+//    les informations nécessaires pour gérer un ensemble.
+typedef struct fileset fileset;
+
+//  fileset_empty : tente d'allouer les ressources nécessaires pour gérer un
+//    nouvel ensemble initialement vide. Renvoie NULL en cas de dépassement de
+//    capacité. Renvoie sinon un pointeur vers le contrôleur associé à
+//    l'ensemble.
+extern fileset *fileset_empty(void);
+
+//  fileset_dispose : sans effet si *fsptr vaut NULL. Libère sinon les
+//    ressources allouées à la gestion de l'ensemble associé à *fsptr puis
+//    affecte NULL à *fsptr.
+extern void fileset_dispose(fileset **fsptr);
+
+//  fileset_add : ajoute occ au nombre d'occurrences associé au fichier
+//    d'indice file dans l'ensemble associé à fs, en y ajoutant le fichier avec
+//    le nombre occ s'il n'y figure pas. Renvoie une valeur non nulle en cas de
+//    dépassement de capacité, zéro sinon.
+extern int fileset_add(fileset *fs, size_t file, long int occ);
+
+//  fileset_take : retire de l'ensemble associé à fs le fichier d'indice file
+//    et renvoie le nombre d'occurrences qui lui était associé. Renvoie zéro si
+//    le fichier n'y figure pas.
+extern long int fileset_take(fileset *fs, size_t file);
+
+//  fileset_count : renvoie le nombre de fichiers de l'ensemble associé à fs.
+extern size_t fileset_count(const fileset *fs);
+
+//  fileset_get : affecte à *fileptr et *occptr l'indice et le nombre
+//    d'occurrences du fichier de rang k, dans l'ordre croissant des indices,
+//    de l'ensemble associé à fs. k est supposé inférieur au nombre de
+//    fichiers de l'ensemble.
+extern void fileset_get(const fileset *fs, size_t k, size_t *fileptr,
+    long int *occptr);
+
+//  fileset_memory : renvoie le nombre d'octets alloués à la gestion de
+//    l'ensemble associé à fs, contrôleur compris.
+extern size_t fileset_memory(const fileset *fs);
+
+#endif
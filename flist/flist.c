@@ -0,0 +1,465 @@
+//  flist.c : partie implantation d'un module pour la constitution d'une liste
+//    de noms de fichiers à partir de noms isolés, de listes lues sur un flot
+//    et du parcours récursif de répertoires.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "flist.h"
+
+//  FLIST__CAPACITY_MIN : capacité minimale des tableaux alloués.
+#define FLIST__CAPACITY_MIN 8
+
+//  FLIST__READ_SIZE : nombre minimal d'octets demandés à chaque lecture d'une
+//    liste sur un flot.
+#define FLIST__READ_SIZE    ((size_t) 1 << 16)
+
+//  struct flist, flist : les n premiers composants du tableau names, de
+//    capacité cap, sont les noms de la liste. Le chemin errpath est celui
+//    qu'affiche flist_error_path, NULL s'il n'y en a pas.
+struct flist {
+  char **names;
+  size_t n;
+  size_t cap;
+  char *errpath;
+};
+
+//  item : type et nom de type pour une structure désignant un chemin path à
+//    examiner lors d'un parcours, issu du nom de rang root de la liste. Si
+//    top est vrai, path est ce nom lui-même, sinon une copie allouée que
+//    l'examen libère ou transmet.
+typedef struct {
+  char *path;
+  size_t root;
+  bool top;
+} item;
+
+//  walk : type et nom de type pour une structure regroupant l'état d'un
+//    parcours. Les chemins qui restent à examiner sont les nstack premiers
+//    composants de la pile stack, de capacité stackcap, busy est le nombre de
+//    chemins en cours d'examen et les fichiers ordinaires trouvés, avec le
+//    rang du nom dont ils sont issus, les nfound premiers composants de found,
+//    de capacité foundcap. Le composant de rang k de isdir indique que le nom
+//    de rang k est un répertoire. Le code r est celui du premier échec, errpath
+//    le chemin du répertoire qui n'a pu être lu. Tous les composants sauf
+//    isdir, écrit par le seul fil d'exécution qui examine le nom de rang k,
+//    sont protégés par lock ; cond signale qu'un chemin est empilé ou que le
+//    parcours est achevé.
+typedef struct {
+  item *stack;
+  size_t nstack;
+  size_t stackcap;
+  size_t busy;
+  item *found;
+  size_t nfound;
+  size_t foundcap;
+  bool *isdir;
+  int r;
+  char *errpath;
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+} walk;
+
+//  flist__reserve : tente de faire en sorte que le tableau *aptr, de capacité
+//    *capptr et dont les n premiers composants de taille size sont occupés,
+//    puisse en recevoir more de plus. Renvoie une valeur non nulle en cas de
+//    dépassement de capacité, zéro sinon.
+static int flist__reserve(void **aptr, size_t *capptr, size_t n, size_t more,
+    size_t size);
+
+//  flist__add : même spécification que flist_add pour le nom formé des len
+//    octets pointés par s.
+static int flist__add(flist *fl, const char *s, size_t len);
+
+//  flist__run : boucle d'un fil d'exécution du parcours pointé par w.
+static void *flist__run(walk *w);
+
+//  flist__visit : examine le chemin it du parcours pointé par w : ajoute un
+//    fichier ordinaire à w->found, lit un répertoire. Renvoie FLIST_SUCCESS
+//    en cas de succès, un code d'erreur sinon.
+static int flist__visit(walk *w, item it);
+
+//  flist__read_dir : empile dans w->stack les chemins des entrées du
+//    répertoire it. Renvoie FLIST_SUCCESS en cas de succès, un code d'erreur
+//    sinon.
+static int flist__read_dir(walk *w, item it);
+
+//  flist__compar : compare les fichiers trouvés pointés par i1 et i2 selon le
+//    rang du nom dont ils sont issus puis selon l'ordre des octets de leurs
+//    chemins.
+static int flist__compar(const item *i1, const item *i2);
+
+flist *flist_empty(void) {
+  flist *fl = malloc(sizeof *fl);
+  if (fl == NULL) {
+    return NULL;
+  }
+  fl->names = NULL;
+  fl->n = 0;
+  fl->cap = 0;
+  fl->errpath = NULL;
+  return fl;
+}
+
+void flist_dispose(flist **flptr) {
+  if (*flptr == NULL) {
+    return;
+  }
+  for (size_t k = 0; k < (*flptr)->n; ++k) {
+    free((*flptr)->names[k]);
+  }
+  free((*flptr)->names);
+  free((*flptr)->errpath);
+  free(*flptr);
+  *flptr = NULL;
+}
+
+int flist_add(flist *fl, const char *name) {
+  return flist__add(fl, name, strlen(name));
+}
+
+int flist_read(flist *fl, FILE *f) {
+  char *buf = NULL;
+  size_t len = 0;
+  size_t cap = 0;
+  int r = FLIST_SUCCESS;
+  while (true) {
+    if (flist__reserve((void **) &buf, &cap, len, FLIST__READ_SIZE, 1)
+        != 0) {
+      r = FLIST_ERR_CAPACITY;
+      goto dispose;
+    }
+    size_t k = fread(buf + len, 1, cap - len, f);
+    if (k == 0) {
+      break;
+    }
+    len += k;
+  }
+  if (ferror(f)) {
+    r = FLIST_ERR_READ;
+    goto dispose;
+  }
+  char sep = (memchr(buf, '\0', len) != NULL ? '\0' : '\n');
+  size_t i = 0;
+  while (i < len) {
+    const char *e = memchr(buf + i, sep, len - i);
+    size_t j = (e == NULL ? len : (size_t) (e - buf));
+    if (j > i && flist__add(fl, buf + i, j - i) != 0) {
+      r = FLIST_ERR_CAPACITY;
+      goto dispose;
+    }
+    i = j + 1;
+  }
+dispose:
+  free(buf);
+  return r;
+}
+
+int flist_expand(flist *fl, size_t nthreads) {
+  walk w = {
+    .stack = NULL,
+    .nstack = 0,
+    .stackcap = 0,
+    .busy = 0,
+    .found = NULL,
+    .nfound = 0,
+    .foundcap = 0,
+    .isdir = calloc(fl->n + 1, sizeof *w.isdir),
+    .r = FLIST_SUCCESS,
+    .errpath = NULL,
+  };
+  pthread_t *threads = malloc((nthreads == 0 ? 1 : nthreads)
+      * sizeof *threads);
+  char **names = NULL;
+  if (w.isdir == NULL || threads == NULL
+      || flist__reserve((void **) &w.stack, &w.stackcap, 0, fl->n,
+        sizeof *w.stack) != 0) {
+    w.r = FLIST_ERR_CAPACITY;
+    goto dispose;
+  }
+  //  Les noms sont empilés en ordre inverse, de sorte que le premier est
+  //    examiné le premier.
+  for (size_t k = fl->n; k > 0; --k) {
+    w.stack[w.nstack] = (item) { fl->names[k - 1], k - 1, true };
+    w.nstack += 1;
+  }
+  pthread_mutex_init(&w.lock, NULL);
+  pthread_cond_init(&w.cond, NULL);
+  size_t nlaunched = 0;
+  while (nlaunched < (nthreads == 0 ? 1 : nthreads)) {
+    if (pthread_create(&threads[nlaunched], NULL,
+        (void *(*)(void *))flist__run, &w) != 0) {
+      pthread_mutex_lock(&w.lock);
+      w.r = FLIST_ERR_THREADS;
+      pthread_cond_broadcast(&w.cond);
+      pthread_mutex_unlock(&w.lock);
+      break;
+    }
+    ++nlaunched;
+  }
+  for (size_t k = 0; k < nlaunched; ++k) {
+    pthread_join(threads[k], NULL);
+  }
+  pthread_mutex_destroy(&w.lock);
+  pthread_cond_destroy(&w.cond);
+  if (w.r != FLIST_SUCCESS) {
+    goto dispose;
+  }
+  qsort(w.found, w.nfound, sizeof *w.found,
+      (int (*)(const void *, const void *))flist__compar);
+  size_t ndirs = 0;
+  for (size_t k = 0; k < fl->n; ++k) {
+    ndirs += w.isdir[k];
+  }
+  size_t cap = fl->n - ndirs + w.nfound;
+  names = malloc((cap == 0 ? 1 : cap) * sizeof *names);
+  if (names == NULL) {
+    w.r = FLIST_ERR_CAPACITY;
+    goto dispose;
+  }
+  size_t n = 0;
+  size_t j = 0;
+  for (size_t k = 0; k < fl->n; ++k) {
+    if (!w.isdir[k]) {
+      names[n] = fl->names[k];
+      n += 1;
+      continue;
+    }
+    free(fl->names[k]);
+    for (; j < w.nfound && w.found[j].root == k; ++j) {
+      names[n] = w.found[j].path;
+      n += 1;
+    }
+  }
+  free(fl->names);
+  fl->names = names;
+  fl->n = n;
+  fl->cap = (cap == 0 ? 1 : cap);
+  w.nfound = 0;
+dispose:
+  for (size_t k = 0; k < w.nstack; ++k) {
+    if (!w.stack[k].top) {
+      free(w.stack[k].path);
+    }
+  }
+  for (size_t k = 0; k < w.nfound; ++k) {
+    free(w.found[k].path);
+  }
+  if (w.errpath != NULL) {
+    free(fl->errpath);
+    fl->errpath = w.errpath;
+  }
+  free(w.stack);
+  free(w.found);
+  free(w.isdir);
+  free(threads);
+  return w.r;
+}
+
+const char *flist_error_path(const flist *fl) {
+  return fl->errpath;
+}
+
+size_t flist_count(const flist *fl) {
+  return fl->n;
+}
+
+const char *flist_get(const flist *fl, size_t k) {
+  return fl->names[k];
+}
+
+int flist__reserve(void **aptr, size_t *capptr, size_t n, size_t more,
+    size_t size) {
+  if (more <= *capptr - n) {
+    return 0;
+  }
+  if (more > SIZE_MAX / size - n) {
+    return -1;
+  }
+  size_t cap = (*capptr < FLIST__CAPACITY_MIN ? FLIST__CAPACITY_MIN
+      : *capptr);
+  while (cap < n + more) {
+    cap = (cap > SIZE_MAX / size / 2 ? n + more : 2 * cap);
+  }
+  void *a = realloc(*aptr, cap * size);
+  if (a == NULL) {
+    return -1;
+  }
+  *aptr = a;
+  *capptr = cap;
+  return 0;
+}
+
+int flist__add(flist *fl, const char *s, size_t len) {
+  if (len == SIZE_MAX
+      || flist__reserve((void **) &fl->names, &fl->cap, fl->n, 1,
+        sizeof *fl->names) != 0) {
+    return FLIST_ERR_CAPACITY;
+  }
+  char *t = malloc(len + 1);
+  if (t == NULL) {
+    return FLIST_ERR_CAPACITY;
+  }
+  memcpy(t, s, len);
+  t[len] = '\0';
+  fl->names[fl->n] = t;
+  fl->n += 1;
+  return FLIST_SUCCESS;
+}
+
+void *flist__run(walk *w) {
+  pthread_mutex_lock(&w->lock);
+  while (true) {
+    while (w->nstack == 0 && w->busy != 0 && w->r == FLIST_SUCCESS) {
+      pthread_cond_wait(&w->cond, &w->lock);
+    }
+    //  Le parcours est achevé lorsque la pile est vide et qu'aucun examen,
+    //    susceptible d'y ajouter des chemins, n'est en cours.
+    if (w->nstack == 0 || w->r != FLIST_SUCCESS) {
+      break;
+    }
+    w->nstack -= 1;
+    item it = w->stack[w->nstack];
+    w->busy += 1;
+    pthread_mutex_unlock(&w->lock);
+    int r = flist__visit(w, it);
+    pthread_mutex_lock(&w->lock);
+    w->busy -= 1;
+    if (r != FLIST_SUCCESS && w->r == FLIST_SUCCESS) {
+      w->r = r;
+    }
+    if (w->busy == 0 || w->r != FLIST_SUCCESS) {
+      pthread_cond_broadcast(&w->cond);
+    }
+  }
+  pthread_mutex_unlock(&w->lock);
+  return NULL;
+}
+
+int flist__visit(walk *w, item it) {
+  struct stat st;
+  //  Un nom de la liste qui ne peut être examiné est conservé : l'erreur sera
+  //    constatée à l'ouverture du fichier. Une entrée de répertoire disparue
+  //    depuis la lecture de celui-ci est ignorée.
+  if ((it.top ? stat(it.path, &st) : lstat(it.path, &st)) != 0
+      || (it.top && !S_ISDIR(st.st_mode))) {
+    if (!it.top) {
+      free(it.path);
+    }
+    return FLIST_SUCCESS;
+  }
+  if (S_ISDIR(st.st_mode)) {
+    if (it.top) {
+      w->isdir[it.root] = true;
+    }
+    return flist__read_dir(w, it);
+  }
+  if (!S_ISREG(st.st_mode)) {
+    free(it.path);
+    return FLIST_SUCCESS;
+  }
+  pthread_mutex_lock(&w->lock);
+  if (flist__reserve((void **) &w->found, &w->foundcap, w->nfound, 1,
+      sizeof *w->found) != 0) {
+    pthread_mutex_unlock(&w->lock);
+    free(it.path);
+    return FLIST_ERR_CAPACITY;
+  }
+  w->found[w->nfound] = it;
+  w->nfound += 1;
+  pthread_mutex_unlock(&w->lock);
+  return FLIST_SUCCESS;
+}
+
+int flist__read_dir(walk *w, item it) {
+  int r = FLIST_SUCCESS;
+  item *children = NULL;
+  size_t n = 0;
+  size_t cap = 0;
+  size_t len = strlen(it.path);
+  size_t sep = (len != 0 && it.path[len - 1] == '/' ? 0 : 1);
+  DIR *d = opendir(it.path);
+  if (d == NULL) {
+    goto error_read;
+  }
+  while (true) {
+    errno = 0;
+    struct dirent *e = readdir(d);
+    if (e == NULL) {
+      if (errno != 0) {
+        goto error_read;
+      }
+      break;
+    }
+    if (strcmp(e->d_name, ".") == 0 || strcmp(e->d_name, "..") == 0) {
+      continue;
+    }
+    size_t elen = strlen(e->d_name);
+    if (elen > SIZE_MAX - len - sep - 1
+        || flist__reserve((void **) &children, &cap, n, 1, sizeof *children)
+        != 0) {
+      goto error_capacity;
+    }
+    char *s = malloc(len + sep + elen + 1);
+    if (s == NULL) {
+      goto error_capacity;
+    }
+    memcpy(s, it.path, len);
+    s[len] = '/';
+    memcpy(s + len + sep, e->d_name, elen + 1);
+    children[n] = (item) { s, it.root, false };
+    n += 1;
+  }
+  pthread_mutex_lock(&w->lock);
+  if (flist__reserve((void **) &w->stack, &w->stackcap, w->nstack, n,
+      sizeof *w->stack) != 0) {
+    pthread_mutex_unlock(&w->lock);
+    goto error_capacity;
+  }
+  memcpy(w->stack + w->nstack, children, n * sizeof *children);
+  w->nstack += n;
+  pthread_cond_broadcast(&w->cond);
+  pthread_mutex_unlock(&w->lock);
+  n = 0;
+  goto dispose;
+error_read:
+  r = FLIST_ERR_READ;
+  pthread_mutex_lock(&w->lock);
+  if (w->errpath == NULL) {
+    w->errpath = malloc(len + 1);
+    if (w->errpath != NULL) {
+      memcpy(w->errpath, it.path, len + 1);
+    } else {
+      r = FLIST_ERR_CAPACITY;
+    }
+  }
+  pthread_mutex_unlock(&w->lock);
+  goto dispose;
+error_capacity:
+  r = FLIST_ERR_CAPACITY;
+  goto dispose;
+dispose:
+  if (d != NULL) {
+    closedir(d);
+  }
+  for (size_t k = 0; k < n; ++k) {
+    free(children[k].path);
+  }
+  free(children);
+  if (!it.top) {
+    free(it.path);
+  }
+  return r;
+}
+
+int flist__compar(const item *i1, const item *i2) {
+  if (i1->root != i2->root) {
+    return i1->root < i2->root ? -1 : 1;
+  }
+  return strcmp(i1->path, i2->path);
+}
@@ -0,0 +1,79 @@
+//  flist.h : partie interface d'un module pour la constitution d'une liste de
+//    noms de fichiers à partir de noms isolés, de listes lues sur un flot et
+//    du parcours récursif de répertoires.
+
+#ifndef FLIST__H
+#define FLIST__H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+//  Fonctionnement général :
+//  - les noms sont conservés dans l'ordre de leur ajout ; chacun est une copie
+//      qui demeure jusqu'à la libération de la liste ;
+//  - une liste lue sur un flot est formée de noms séparés par le caractère
+//      nul, comme celle qu'écrit find -print0, ou, si le flot n'en contient
+//      aucun, par la fin de ligne. Les noms vides sont ignorés ;
+//  - le parcours remplace chaque nom de répertoire par ceux des fichiers
+//      ordinaires de son arborescence, dans l'ordre croissant des octets de
+//      leurs chemins : le résultat ne dépend ni du système de fichiers ni de
+//      l'ordre dans lequel les fils d'exécution du parcours lisent les
+//      répertoires et consultent les attributs des fichiers. Les liens
+//      symboliques rencontrés dans une arborescence sont ignorés, ce qui
+//      exclut les cycles ; ceux qui figurent dans la liste sont suivis.
+
+//  Valeurs renvoyées par les fonctions du module.
+enum {
+  FLIST_SUCCESS,
+  FLIST_ERR_CAPACITY,   //  dépassement de capacité
+  FLIST_ERR_READ,       //  erreur de lecture du flot ou d'un répertoire
+  FLIST_ERR_THREADS,    //  lancement des fils d'exécution impossible
+};
+
+//  struct flist, flist : type et nom de type d'un contrôleur regroupant les
+//    informations nécessaires pour gérer une liste de noms de fichiers.
+typedef struct flist flist;
+
+//  flist_empty : tente d'allouer les ressources nécessaires pour gérer une
+//    nouvelle liste initialement vide. Renvoie NULL en cas de dépassement de
+//    capacité. Renvoie sinon un pointeur vers le contrôleur associé à la
+//    liste.
+extern flist *flist_empty(void);
+
+//  flist_dispose : sans effet si *flptr vaut NULL. Libère sinon les
+//    ressources allouées à la gestion de la liste associée à *flptr, noms
+//    compris, puis affecte NULL à *flptr.
+extern void flist_dispose(flist **flptr);
+
+//  flist_add : tente d'ajouter à la fin de la liste associée à fl une copie
+//    du nom name. Renvoie FLIST_ERR_CAPACITY en cas de dépassement de
+//    capacité, FLIST_SUCCESS sinon.
+extern int flist_add(flist *fl, const char *name);
+
+//  flist_read : tente d'ajouter à la fin de la liste associée à fl les noms
+//    lus jusqu'à la fin du flot f. Renvoie FLIST_ERR_READ en cas d'erreur de
+//    lecture, FLIST_ERR_CAPACITY en cas de dépassement de capacité,
+//    FLIST_SUCCESS sinon.
+extern int flist_read(flist *fl, FILE *f);
+
+//  flist_expand : remplace dans la liste associée à fl les noms de
+//    répertoires par ceux des fichiers ordinaires de leurs arborescences,
+//    parcourues par nthreads fils d'exécution, au moins un. Renvoie
+//    FLIST_ERR_READ si un répertoire ne peut être lu, FLIST_ERR_THREADS si
+//    les fils d'exécution ne peuvent être lancés, FLIST_ERR_CAPACITY en cas
+//    de dépassement de capacité, FLIST_SUCCESS sinon. En cas d'échec, la
+//    liste est inchangée.
+extern int flist_expand(flist *fl, size_t nthreads);
+
+//  flist_error_path : renvoie, après un échec de flist_expand de code
+//    FLIST_ERR_READ, le chemin de l'un des répertoires qui n'ont pu être lus.
+extern const char *flist_error_path(const flist *fl);
+
+//  flist_count : renvoie le nombre de noms de la liste associée à fl.
+extern size_t flist_count(const flist *fl);
+
+//  flist_get : renvoie le nom de rang k de la liste associée à fl, k étant
+//    supposé strictement inférieur à flist_count(fl).
+extern const char *flist_get(const flist *fl, size_t k);
+
+#endif
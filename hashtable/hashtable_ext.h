@@ -0,0 +1,51 @@
+//  hashtable_ext.h : compléments au module hashtable, propres à xwc. Ils sont
+//    déclarés à part, l'interface hashtable.h ne pouvant être modifiée.
+
+//  Le comportement du module est sensible à la définition préalable de la
+//    macroconstante HASHTABLE_STATS.
+
+#ifndef HASHTABLE_EXT__H
+#define HASHTABLE_EXT__H
+
+#include <stdlib.h>
+
+#include "hashtable.h"
+
+//  hashtable_empty_with_capacity : même fonction que hashtable_empty, le
+//    tableau de hachage étant cependant dimensionné d'emblée pour que n clés
+//    puissent être ajoutées sans qu'il soit agrandi. Renvoie également NULL si
+//    ce dimensionnement provoque un dépassement de capacité.
+extern hashtable *hashtable_empty_with_capacity(
+    int (*compar)(const void *, const void *),
+    size_t (*hashfun)(const void *), size_t n);
+
+//  hashtable_memory : renvoie le nombre d'octets actuellement alloués pour la
+//    gestion de la table de hachage associée à ht, contrôleur compris. Affecte
+//    à *slotsptr la part du tableau de hachage et à *cellsptr celle des
+//    cellules des listes si ces pointeurs ne valent pas NULL.
+extern size_t hashtable_memory(hashtable *ht, size_t *slotsptr,
+    size_t *cellsptr);
+
+//  hashtable_add_memory : renvoie le nombre d'octets que tenterait d'allouer en
+//    plus l'ajout à la table de hachage associée à ht d'une clé qui n'y figure
+//    pas, agrandissement éventuel du tableau de hachage compris.
+extern size_t hashtable_add_memory(hashtable *ht);
+
+#if defined HASHTABLE_STATS && HASHTABLE_STATS != 0
+
+//  struct hashtable_ext_stats : structure regroupant les informations qui
+//    complètent celles de la structure hashtable_stats.
+struct hashtable_ext_stats {
+  size_t nresizes;    //  nombre d'allocations ou d'agrandissements du tableau
+                      //    de hachage
+  size_t nreseeds;    //  nombre de changements de la fonction de pré-hachage
+};
+
+//  hashtable_get_ext_stats : effectue le bilan complémentaire de la table de
+//    hachage associée à ht et affecte le résultat à *htesptr.
+extern void hashtable_get_ext_stats(hashtable *ht,
+    struct hashtable_ext_stats *htesptr);
+
+#endif
+
+#endif
@@ -0,0 +1,565 @@
+//  hashtable_tpl.h : patron de table de hachage par chainage séparé, spécialisé
+//    à la compilation selon le type des clés, leur fonction de pré-hachage et
+//    leur fonction d'égalité. Les fonctions engendrées ont le même
+//    comportement que leurs homologues du module hashtable ; les appels de
+//    fonctions de pré-hachage et d'égalité n'ont cependant plus lieu via des
+//    pointeurs et peuvent être développés en ligne par le compilateur.
+
+//  Le comportement du patron est sensible à la définition préalable de la
+//    macroconstante HASHTABLE_STATS.
+
+//  Mode d'emploi : définir les macros qui suivent puis inclure ce fichier.
+//    L'inclusion supprime ces définitions ; le fichier peut ainsi être inclus
+//    plusieurs fois dans une même unité de traduction.
+//  - HASHTABLE_TPL_NAME : nom du type de la table engendrée ;
+//  - HASHTABLE_TPL_PREFIX : préfixe des noms des fonctions engendrées ;
+//  - HASHTABLE_TPL_KEY : type des clés, mémorisées par valeur dans la table ;
+//  - HASHTABLE_TPL_VALUE : type des objets dont la table mémorise les
+//      références de valeurs ;
+//  - HASHTABLE_TPL_HASH(ht, kp) : expression de type size_t, valeur de
+//      pré-hachage de la clé pointée par kp ;
+//  - HASHTABLE_TPL_EQUAL(ht, kp1, kp2) : expression non nulle si et seulement
+//      si les clés pointées par kp1 et kp2 sont égales ;
+//  - HASHTABLE_TPL_MEMBERS : facultative, déclarations de composants
+//      supplémentaires du contrôleur, accessibles aux deux macros précédentes
+//      via ht et laissés à l'initiative de l'utilisateur ;
+//  - HASHTABLE_TPL_KEY_DATA(kp) : facultative, adresse des données extérieures
+//      à la clé pointée par kp consultées par HASHTABLE_TPL_EQUAL, que
+//      P_prefetch demande alors de charger ;
+//  - HASHTABLE_TPL_RESEED(ht) : facultative, instruction qui change la fonction
+//      de pré-hachage de la table, en tirant par exemple une nouvelle graine
+//      parmi les composants HASHTABLE_TPL_MEMBERS. Elle est exécutée à la
+//      création de la table puis, tant que la table n'en a pas épuisé le
+//      nombre maximal HT__RESEEDS_MAX, chaque fois qu'un ajout porte la
+//      longueur d'une liste au-delà de HT__CHAIN_MAX ; toutes les clés sont
+//      alors réparties à nouveau. Une fonction de pré-hachage à clé secrète
+//      borne ainsi la longueur des listes même face à des clés choisies pour
+//      entrer en collision.
+
+//  Fonctions engendrées, pour le préfixe P, le type T de la table, le type K
+//    des clés et le type V des valeurs :
+//  - T *P_empty(void) ;
+//  - T *P_empty_with_capacity(size_t n) ;
+//  - void P_dispose(T **htptr) ;
+//  - V *P_add(T *ht, const K *kp, V *valref) : la clé pointée par kp est
+//      recopiée dans la table en cas d'ajout ;
+//  - V *P_remove(T *ht, const K *kp) ;
+//  - V *P_search(T *ht, const K *kp) ;
+//  - size_t P_memory(T *ht, size_t *slotsptr, size_t *cellsptr) ;
+//  - size_t P_add_memory(T *ht) ;
+//  - void P_get_stats(T *ht, struct hashtable_stats *htsptr) et
+//      void P_get_ext_stats(T *ht, struct hashtable_ext_stats *htesptr), si
+//      HASHTABLE_STATS est définie et que sa macro-évaluation donne un entier
+//      non nul.
+//  - size_t P_reseeds(const T *ht) : renvoie le nombre de changements de la
+//      fonction de pré-hachage de la table depuis sa création, si
+//      HASHTABLE_TPL_RESEED est définie.
+//  Les spécifications sont celles des fonctions hashtable_* correspondantes,
+//    déclarées dans hashtable.h et hashtable_ext.h.
+//  Les fonctions qui suivent permettent en outre de traiter les clés par lots :
+//  - size_t P_hash(const T *ht, const K *kp) : renvoie la valeur de
+//      pré-hachage de la clé pointée par kp ;
+//  - V *P_search_hashed(T *ht, const K *kp, size_t h),
+//      V *P_add_hashed(T *ht, const K *kp, size_t h, V *valref) : mêmes
+//      fonctions que P_search et P_add, h étant la valeur de P_hash pour kp.
+//      Les valeurs de P_hash calculées avant un appel de P_add_hashed ne sont
+//      plus valides si cet appel change la valeur de P_reseeds ;
+//  - void P_prefetch(const T *ht, size_t n, const K *kps, size_t *hashes) :
+//      affecte à hashes[k] la valeur de P_hash pour kps[k], pour tout k < n,
+//      puis demande au processeur de charger, par étapes successives portant
+//      chacune sur tout le lot, les compartiments des n clés, les cellules de
+//      tête de leurs listes, les données extérieures de leurs clés et leurs
+//      valeurs. Les défauts de cache d'une clé se recouvrent ainsi avec ceux
+//      des autres clés du lot au lieu de s'enchainer. La table n'est pas
+//      modifiée : les ajouts et mises à jour qui suivent restent libres.
+
+#if !defined HASHTABLE_TPL_NAME || !defined HASHTABLE_TPL_PREFIX              \
+  || !defined HASHTABLE_TPL_KEY || !defined HASHTABLE_TPL_VALUE                \
+  || !defined HASHTABLE_TPL_HASH || !defined HASHTABLE_TPL_EQUAL
+#error Missing HASHTABLE_TPL_ parameter.
+#endif
+
+#ifndef HASHTABLE_TPL__H
+#define HASHTABLE_TPL__H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <limits.h>
+
+#include "hashtable_ext.h"
+#include "hugemem.h"
+
+//  Le tableau de hachage est alloué par le module hugemem : au-delà du seuil de
+//    ce dernier, il est rangé sur des pages géantes, ce qui épargne le TLB lors
+//    des accès aléatoires aux compartiments.
+
+//  Le nombre de compartiments du tableau de hachage est une puissance de 2. Il
+//    vaut initialement « 2 ^ HT__LBNSLOTS_MIN ». Dès que le taux de remplissage
+//    de la table de hachage est strictement supérieur à
+//    « (double) HT__LDFACT_MAX_NUMER / (double) HT__LDFACT_MAX_DENOM », le
+//    nombre de compartiments est multiplié par 2.
+
+#define HT__LBNSLOTS_MIN      6
+#define HT__LDFACT_MAX_NUMER  1
+#define HT__LDFACT_MAX_DENOM  1
+
+//  Les définitions précédentes vont pour un nombre de compartiments initial de
+//    64 et un seuil maximum de 1.0 ; ces définitions peuvent être modifiées.
+//    Les directives qui suivent s'assurent de leur cohérence ; ces directives
+//    ne doivent pas être modifiées.
+
+#define HT__NSLOTS_MIN \
+  (1ULL << HT__LBNSLOTS_MIN)
+#define HT__NENTRIESMAX_MIN \
+  (HT__NSLOTS_MIN / HT__LDFACT_MAX_DENOM * HT__LDFACT_MAX_NUMER)
+
+#if HT__LBNSLOTS_MIN < 0                                                       \
+  || HT__LDFACT_MAX_NUMER < 0                                                  \
+  || HT__LDFACT_MAX_DENOM < 1                                                  \
+  || HT__NSLOTS_MIN == 0                                                       \
+  || HT__NSLOTS_MIN > SIZE_MAX                                                 \
+  || HT__NENTRIESMAX_MIN == 0
+#error Bad choice of HT__ constants.
+#endif
+
+#undef HT__NSLOTS_MIN
+#undef HT__NENTRIESMAX_MIN
+
+//  Lorsque HASHTABLE_TPL_RESEED est définie, un ajout qui porte la longueur
+//    d'une liste strictement au-delà de HT__CHAIN_MAX change la fonction de
+//    pré-hachage de la table, au plus HT__RESEEDS_MAX fois. Avec un taux de
+//    remplissage d'au plus 1.0 et une fonction de pré-hachage uniforme, une
+//    liste de HT__CHAIN_MAX cellules n'apparait pour ainsi dire jamais : le
+//    seuil n'est atteint que sur des clés conçues pour entrer en collision.
+
+#define HT__CHAIN_MAX         32
+#define HT__RESEEDS_MAX       16
+
+#define HT__MAKE_BLANK(ht)                                                     \
+  (ht)->hasharray = &(ht)->null;                                               \
+  (ht)->null = NULL;                                                           \
+  (ht)->lbnslots = 0
+
+#define HT__IS_BLANK(ht)                                                       \
+  ((ht)->lbnslots == 0)
+
+#define HALF(k) ((k) >> 1)
+#define POW2(n) ((size_t) 1 << (n))
+
+#define HT__CAT_(a, b) a ## b
+#define HT__CAT(a, b) HT__CAT_(a, b)
+
+#if defined __GNUC__
+#define HT__PREFETCH(p) __builtin_prefetch(p)
+#else
+#define HT__PREFETCH(p) ((void) (p))
+#endif
+
+#endif
+
+#define HT__T     HASHTABLE_TPL_NAME
+#define HT__K     HASHTABLE_TPL_KEY
+#define HT__V     HASHTABLE_TPL_VALUE
+#define HT__F(s)  HT__CAT(HASHTABLE_TPL_PREFIX, s)
+#define HT__CELL  HT__F(__cell)
+
+#define HT__SLOT(h, lbnslots)                                                  \
+  ((h) & (POW2(lbnslots) - 1))
+
+//  Les composants du contrôleur ont la même signification que pour le module
+//    hashtable. L'ajout d'une nouvelle entrée a lieu en queue de liste. L'ordre
+//    induit est respecté lors de tout agrandissement du tableau de hachage,
+//    mais pas lors d'un changement de la fonction de pré-hachage ; nreseeds est
+//    le nombre de ces changements.
+
+typedef struct HT__T HT__T;
+typedef struct HT__CELL HT__CELL;
+
+struct HT__CELL {
+  HT__K key;
+  HT__V *valref;
+  HT__CELL *next;
+};
+
+struct HT__T {
+  HT__CELL **hasharray;
+  HT__CELL *null;
+  size_t lbnslots;
+  size_t nfreeentries;
+#if defined HASHTABLE_STATS && HASHTABLE_STATS != 0
+  size_t nresizes;
+#endif
+#ifdef HASHTABLE_TPL_RESEED
+  size_t nreseeds;
+#endif
+#ifdef HASHTABLE_TPL_MEMBERS
+  HASHTABLE_TPL_MEMBERS
+#endif
+};
+
+static inline size_t HT__F(_hash)([[maybe_unused]] const HT__T *ht,
+    const HT__K *kp) {
+  return HASHTABLE_TPL_HASH(ht, kp);
+}
+
+//  P__search : recherche dans la table de hachage associée à ht une clé égale
+//    à celle pointée par kp, de valeur de pré-hachage h. Renvoie l'adresse du
+//    pointeur qui repère la cellule qui contient cette occurrence si elle
+//    existe. Renvoie sinon l'adresse du pointeur qui marque la fin de la
+//    liste.
+static inline HT__CELL **HT__F(__search)(const HT__T *ht, const HT__K *kp,
+    size_t h) {
+  size_t k = HT__SLOT(h, ht->lbnslots);
+  HT__CELL * const *pp = &ht->hasharray[k];
+  while (*pp != NULL && !(HASHTABLE_TPL_EQUAL(ht, kp, &(*pp)->key))) {
+    pp = &(*pp)->next;
+  }
+  return (HT__CELL **) pp;
+}
+
+//  P__add_enlarge : initialise ou agrandit le tableau de hachage de la table de
+//    hachage associée à ht. Il est supposé que la valeur de nfreeentries est
+//    nulle. Renvoie une valeur non nulle en cas de dépassement de capacité.
+//    Renvoie sinon zéro.
+static inline int HT__F(__add_enlarge)(HT__T *ht) {
+  int b;
+  size_t lbm;
+  size_t m;
+  size_t m_;
+  if ((b = HT__IS_BLANK(ht))) {
+    lbm = HT__LBNSLOTS_MIN;
+    m = POW2(lbm);
+    m_ = 0;
+    ht->hasharray = NULL;
+  } else {
+    lbm = ht->lbnslots + 1;
+    m = POW2(lbm);
+    m_ = HALF(m);
+  }
+  HT__CELL **a;
+  if (m > SIZE_MAX / sizeof *a
+      || (HT__LDFACT_MAX_NUMER > sizeof *a
+      && HT__LDFACT_MAX_NUMER > HT__LDFACT_MAX_DENOM
+      && m > SIZE_MAX / HT__LDFACT_MAX_NUMER * HT__LDFACT_MAX_DENOM)
+      || (a = hugemem_realloc(ht->hasharray, m_ * sizeof *a,
+        m * sizeof *a)) == NULL) {
+    if (b) {
+      HT__MAKE_BLANK(ht);
+    }
+    return -1;
+  }
+  if (b) {
+    for (size_t k = 0; k < m; ++k) {
+      a[k] = NULL;
+    }
+  } else {
+    for (size_t k_ = 0; k_ < m_; ++k_) {
+      HT__CELL **pp_ = &a[k_];
+      HT__CELL **pp = &a[k_ + m_];
+      while (*pp_ != NULL) {
+        if (HT__SLOT(HT__F(_hash)(ht, &(*pp_)->key), lbm) < m_) {
+          pp_ = &(*pp_)->next;
+        } else {
+          *pp = *pp_;
+          *pp_ = (*pp_)->next;
+          pp = &(*pp)->next;
+        }
+      }
+      *pp = NULL;
+    }
+  }
+  ht->hasharray = a;
+  ht->lbnslots = lbm;
+#if defined HASHTABLE_STATS && HASHTABLE_STATS != 0
+  ht->nresizes += 1;
+#endif
+  ht->nfreeentries
+    = m / HT__LDFACT_MAX_DENOM * HT__LDFACT_MAX_NUMER
+      - m_ / HT__LDFACT_MAX_DENOM * HT__LDFACT_MAX_NUMER;
+  return 0;
+}
+
+static inline HT__T *HT__F(_empty)(void) {
+  HT__T *ht = malloc(sizeof *ht);
+  if (ht == NULL) {
+    return NULL;
+  }
+  HT__MAKE_BLANK(ht);
+  ht->nfreeentries = 0;
+#if defined HASHTABLE_STATS && HASHTABLE_STATS != 0
+  ht->nresizes = 0;
+#endif
+#ifdef HASHTABLE_TPL_RESEED
+  ht->nreseeds = 0;
+  HASHTABLE_TPL_RESEED(ht);
+#endif
+  return ht;
+}
+
+static inline void HT__F(_dispose)(HT__T **htptr) {
+  if (*htptr == NULL) {
+    return;
+  }
+  if (!HT__IS_BLANK(*htptr)) {
+    size_t m = POW2((*htptr)->lbnslots);
+    for (size_t k = 0; k < m; ++k) {
+      HT__CELL *p = (*htptr)->hasharray[k];
+      while (p != NULL) {
+        HT__CELL *t = p;
+        p = p->next;
+        free(t);
+      }
+    }
+    hugemem_free((*htptr)->hasharray);
+  }
+  free(*htptr);
+  *htptr = NULL;
+}
+
+static inline HT__T *HT__F(_empty_with_capacity)(size_t n) {
+  HT__T *ht = HT__F(_empty)();
+  if (ht == NULL || n == 0) {
+    return ht;
+  }
+  size_t lbm = HT__LBNSLOTS_MIN;
+  while (POW2(lbm) / HT__LDFACT_MAX_DENOM * HT__LDFACT_MAX_NUMER < n) {
+    if (lbm + 2 >= sizeof(size_t) * CHAR_BIT) {
+      HT__F(_dispose)(&ht);
+      return NULL;
+    }
+    ++lbm;
+  }
+  size_t m = POW2(lbm);
+  HT__CELL **a;
+  if (m > SIZE_MAX / sizeof *a
+      || (a = hugemem_alloc(m * sizeof *a)) == NULL) {
+    HT__F(_dispose)(&ht);
+    return NULL;
+  }
+  for (size_t k = 0; k < m; ++k) {
+    a[k] = NULL;
+  }
+  ht->hasharray = a;
+  ht->lbnslots = lbm;
+#if defined HASHTABLE_STATS && HASHTABLE_STATS != 0
+  ht->nresizes += 1;
+#endif
+  ht->nfreeentries = m / HT__LDFACT_MAX_DENOM * HT__LDFACT_MAX_NUMER;
+  return ht;
+}
+
+#ifdef HASHTABLE_TPL_RESEED
+
+//  P__reseed : change la fonction de pré-hachage de la table de hachage
+//    associée à ht puis répartit à nouveau ses cellules selon leurs nouvelles
+//    valeurs de pré-hachage. Les cellules sont d'abord enchainées en une seule
+//    liste puis insérées une à une en tête de leur nouveau compartiment : la
+//    répartition n'alloue aucune mémoire.
+static inline void HT__F(__reseed)(HT__T *ht) {
+  HASHTABLE_TPL_RESEED(ht);
+  ht->nreseeds += 1;
+  size_t m = POW2(ht->lbnslots);
+  HT__CELL *list = NULL;
+  for (size_t k = 0; k < m; ++k) {
+    HT__CELL *p = ht->hasharray[k];
+    while (p != NULL) {
+      HT__CELL *t = p;
+      p = p->next;
+      t->next = list;
+      list = t;
+    }
+    ht->hasharray[k] = NULL;
+  }
+  while (list != NULL) {
+    HT__CELL *t = list;
+    list = list->next;
+    HT__CELL **pp = &ht->hasharray[HT__SLOT(HT__F(_hash)(ht, &t->key),
+        ht->lbnslots)];
+    t->next = *pp;
+    *pp = t;
+  }
+}
+
+static inline size_t HT__F(_reseeds)(const HT__T *ht) {
+  return ht->nreseeds;
+}
+
+#endif
+
+static inline HT__V *HT__F(_add_hashed)(HT__T *ht, const HT__K *kp, size_t h,
+    HT__V *valref) {
+  if (valref == NULL) {
+    return NULL;
+  }
+  HT__CELL **pp = HT__F(__search)(ht, kp, h);
+  if (*pp != NULL) {
+    HT__V *r = (*pp)->valref;
+    (*pp)->valref = valref;
+    return r;
+  }
+  if (ht->nfreeentries == 0) {
+    if (HT__F(__add_enlarge)(ht) != 0) {
+      return NULL;
+    }
+    pp = HT__F(__search)(ht, kp, h);
+  }
+  HT__CELL *p = malloc(sizeof *p);
+  if (p == NULL) {
+    return NULL;
+  }
+  p->key = *kp;
+  p->valref = valref;
+  p->next = *pp;
+  *pp = p;
+  ht->nfreeentries -= 1;
+#ifdef HASHTABLE_TPL_RESEED
+  if (ht->nreseeds < HT__RESEEDS_MAX) {
+    size_t len = 0;
+    for (const HT__CELL *q = ht->hasharray[HT__SLOT(h, ht->lbnslots)];
+        q != NULL && len <= HT__CHAIN_MAX; q = q->next) {
+      ++len;
+    }
+    if (len > HT__CHAIN_MAX) {
+      HT__F(__reseed)(ht);
+    }
+  }
+#endif
+  return valref;
+}
+
+static inline HT__V *HT__F(_add)(HT__T *ht, const HT__K *kp, HT__V *valref) {
+  return HT__F(_add_hashed)(ht, kp, HT__F(_hash)(ht, kp), valref);
+}
+
+static inline HT__V *HT__F(_remove)(HT__T *ht, const HT__K *kp) {
+  HT__CELL **pp = HT__F(__search)(ht, kp, HT__F(_hash)(ht, kp));
+  if (*pp == NULL) {
+    return NULL;
+  }
+  HT__CELL *p = *pp;
+  HT__V *r = p->valref;
+  *pp = p->next;
+  free(p);
+  ht->nfreeentries += 1;
+  return r;
+}
+
+static inline HT__V *HT__F(_search_hashed)(HT__T *ht, const HT__K *kp,
+    size_t h) {
+  const HT__CELL *p = *HT__F(__search)(ht, kp, h);
+  return p == NULL ? NULL : p->valref;
+}
+
+static inline HT__V *HT__F(_search)(HT__T *ht, const HT__K *kp) {
+  return HT__F(_search_hashed)(ht, kp, HT__F(_hash)(ht, kp));
+}
+
+static inline void HT__F(_prefetch)(const HT__T *ht, size_t n,
+    const HT__K *kps, size_t *hashes) {
+  //  Si le tableau de hachage n'est pas alloué, lbnslots est nul et tous les
+  //    compartiments désignent le champ null.
+  for (size_t k = 0; k < n; ++k) {
+    hashes[k] = HT__F(_hash)(ht, &kps[k]);
+    HT__PREFETCH(&ht->hasharray[HT__SLOT(hashes[k], ht->lbnslots)]);
+  }
+  for (size_t k = 0; k < n; ++k) {
+    const HT__CELL *p = ht->hasharray[HT__SLOT(hashes[k], ht->lbnslots)];
+    if (p != NULL) {
+      HT__PREFETCH(p);
+    }
+  }
+  for (size_t k = 0; k < n; ++k) {
+    const HT__CELL *p = ht->hasharray[HT__SLOT(hashes[k], ht->lbnslots)];
+    if (p != NULL) {
+#ifdef HASHTABLE_TPL_KEY_DATA
+      HT__PREFETCH(HASHTABLE_TPL_KEY_DATA(&p->key));
+#endif
+      HT__PREFETCH(p->valref);
+    }
+  }
+}
+
+static inline size_t HT__F(_memory)(HT__T *ht, size_t *slotsptr,
+    size_t *cellsptr) {
+  size_t m = (HT__IS_BLANK(ht) ? 0 : POW2(ht->lbnslots));
+  size_t n = m / HT__LDFACT_MAX_DENOM * HT__LDFACT_MAX_NUMER - ht->nfreeentries;
+  size_t slots = m * sizeof *ht->hasharray;
+  size_t cells = n * sizeof(HT__CELL);
+  if (slotsptr != NULL) {
+    *slotsptr = slots;
+  }
+  if (cellsptr != NULL) {
+    *cellsptr = cells;
+  }
+  return sizeof *ht + slots + cells;
+}
+
+static inline size_t HT__F(_add_memory)(HT__T *ht) {
+  if (ht->nfreeentries != 0) {
+    return sizeof(HT__CELL);
+  }
+  size_t m = (HT__IS_BLANK(ht) ? 0 : POW2(ht->lbnslots));
+  size_t m2 = (HT__IS_BLANK(ht) ? POW2(HT__LBNSLOTS_MIN) : 2 * m);
+  return sizeof(HT__CELL) + (m2 - m) * sizeof *ht->hasharray;
+}
+
+#if defined HASHTABLE_STATS && HASHTABLE_STATS != 0
+
+static inline void HT__F(_get_stats)(HT__T *ht,
+    struct hashtable_stats *htsptr) {
+  size_t m = (HT__IS_BLANK(ht) ? 0 : POW2(ht->lbnslots));
+  size_t n = m / HT__LDFACT_MAX_DENOM * HT__LDFACT_MAX_NUMER - ht->nfreeentries;
+  size_t g = 0;
+  double s = 0.0;
+  for (size_t k = 0; k < m; ++k) {
+    size_t f = 0;
+    const HT__CELL *p = ht->hasharray[k];
+    while (p != NULL) {
+      ++f;
+      p = p->next;
+    }
+    if (f > g) {
+      g = f;
+    }
+    s += (double) f * (double) (f + 1) / 2.0;
+  }
+  double r = (m == 0 ? 0.0 : (double) n / (double) m);
+  *htsptr = (struct hashtable_stats) {
+    .nslots = m,
+    .nentries = n,
+    .ldfactmax = (double) HT__LDFACT_MAX_NUMER / (double) HT__LDFACT_MAX_DENOM,
+    .ldfactcurr = r,
+    .maxlen = g,
+    .postheo = (n == 0 ? 0.0 : 1.0 + (r - 1.0 / (double) m) / 2.0),
+    .poscurr = (n == 0 ? 0.0 : s / (double) n),
+  };
+}
+
+static inline void HT__F(_get_ext_stats)(HT__T *ht,
+    struct hashtable_ext_stats *htesptr) {
+  *htesptr = (struct hashtable_ext_stats) {
+    .nresizes = ht->nresizes,
+#ifdef HASHTABLE_TPL_RESEED
+    .nreseeds = ht->nreseeds,
+#endif
+  };
+}
+
+#endif
+
+#undef HT__T
+#undef HT__K
+#undef HT__V
+#undef HT__F
+#undef HT__CELL
+#undef HT__SLOT
+
+#undef HASHTABLE_TPL_NAME
+#undef HASHTABLE_TPL_PREFIX
+#undef HASHTABLE_TPL_KEY
+#undef HASHTABLE_TPL_VALUE
+#undef HASHTABLE_TPL_HASH
+#undef HASHTABLE_TPL_EQUAL
+#undef HASHTABLE_TPL_MEMBERS
+#undef HASHTABLE_TPL_KEY_DATA
+#undef HASHTABLE_TPL_RESEED
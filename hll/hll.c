@@ -0,0 +1,83 @@
+//  hll.c : partie implantation d'un module pour l'estimation du nombre de
+//    valeurs distinctes d'une suite par l'algorithme HyperLogLog.
+
+#include <math.h>
+
+#include "hll.h"
+
+//  struct hll, hll : le tableau regs, de longueur 2 ^ lbnregs, mémorise pour
+//    chaque registre le rang maximal du premier bit à 1 des valeurs brassées
+//    qui lui ont été attribuées, zéro si aucune ne l'a été.
+struct hll {
+  size_t lbnregs;
+  unsigned char *regs;
+};
+
+//  hll__mix : finalisation de MurmurHash3 sur 64 bits.
+static uint64_t hll__mix(uint64_t x) {
+  x ^= x >> 33;
+  x *= 0xFF51AFD7ED558CCDULL;
+  x ^= x >> 33;
+  x *= 0xC4CEB9FE1A85EC53ULL;
+  x ^= x >> 33;
+  return x;
+}
+
+hll *hll_empty(size_t lbnregs) {
+  if (lbnregs < HLL_LBNREGS_MIN || lbnregs > HLL_LBNREGS_MAX) {
+    return NULL;
+  }
+  hll *h = malloc(sizeof *h);
+  if (h == NULL) {
+    return NULL;
+  }
+  h->lbnregs = lbnregs;
+  h->regs = calloc((size_t) 1 << lbnregs, sizeof *h->regs);
+  if (h->regs == NULL) {
+    free(h);
+    return NULL;
+  }
+  return h;
+}
+
+void hll_dispose(hll **hptr) {
+  if (*hptr == NULL) {
+    return;
+  }
+  free((*hptr)->regs);
+  free(*hptr);
+  *hptr = NULL;
+}
+
+void hll_add(hll *h, uint64_t hash) {
+  uint64_t x = hll__mix(hash);
+  size_t k = (size_t) (x >> (64 - h->lbnregs));
+  //  Le bit sentinelle borne le rang lorsque les bits restants sont nuls.
+  uint64_t w = (x << h->lbnregs) | ((uint64_t) 1 << (h->lbnregs - 1));
+  unsigned char rank = (unsigned char) (__builtin_clzll(w) + 1);
+  if (rank > h->regs[k]) {
+    h->regs[k] = rank;
+  }
+}
+
+double hll_count(const hll *h) {
+  size_t m = (size_t) 1 << h->lbnregs;
+  double s = 0.0;
+  size_t zeros = 0;
+  for (size_t k = 0; k < m; ++k) {
+    s += ldexp(1.0, -h->regs[k]);
+    if (h->regs[k] == 0) {
+      ++zeros;
+    }
+  }
+  double dm = (double) m;
+  double alpha = (m == 16 ? 0.673 : m == 32 ? 0.697 : m == 64 ? 0.709
+      : 0.7213 / (1.0 + 1.079 / dm));
+  double e = alpha * dm * dm / s;
+  //  Correction pour les petits effectifs : comptage linéaire des registres
+  //    restés nuls.
+  if (e <= 2.5 * dm && zeros != 0) {
+    e = dm * log(dm / (double) zeros);
+  }
+  return e;
+}
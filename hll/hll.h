@@ -0,0 +1,47 @@
+//  hll.h : partie interface d'un module pour l'estimation du nombre de valeurs
+//    distinctes d'une suite par l'algorithme HyperLogLog.
+
+#ifndef HLL__H
+#define HLL__H
+
+#include <stdlib.h>
+#include <stdint.h>
+
+//  Fonctionnement général :
+//  - les valeurs sont identifiées par leurs valeurs de hachage sur 64 bits, que
+//      l'utilisateurice fournit. Le module les brasse avant usage : des valeurs
+//      de hachage mal réparties, telles que celles des fonctions de pré-hachage
+//      du module hashtable, conviennent ;
+//  - l'estimation occupe 2 ^ lbnregs octets ; son erreur relative type vaut
+//      environ 1.04 / sqrt(2 ^ lbnregs).
+
+//  struct hll, hll : type et nom de type d'un contrôleur regroupant les
+//    informations nécessaires pour gérer une estimation.
+typedef struct hll hll;
+
+//  HLL_LBNREGS_MIN, HLL_LBNREGS_MAX : bornes du logarithme binaire du nombre de
+//    registres.
+#define HLL_LBNREGS_MIN 4
+#define HLL_LBNREGS_MAX 18
+
+//  hll_empty : tente d'allouer les ressources nécessaires pour gérer une
+//    nouvelle estimation, initialement sans aucune valeur, à l'aide de
+//    2 ^ lbnregs registres. Renvoie NULL si lbnregs n'est pas compris entre
+//    HLL_LBNREGS_MIN et HLL_LBNREGS_MAX ou en cas de dépassement de capacité.
+//    Renvoie sinon un pointeur vers le contrôleur associé à l'estimation.
+extern hll *hll_empty(size_t lbnregs);
+
+//  hll_dispose : sans effet si *hptr vaut NULL. Libère sinon les ressources
+//    allouées à la gestion de l'estimation associée à *hptr puis affecte NULL
+//    à *hptr.
+extern void hll_dispose(hll **hptr);
+
+//  hll_add : prend en compte dans l'estimation associée à h la valeur de valeur
+//    de hachage hash.
+extern void hll_add(hll *h, uint64_t hash);
+
+//  hll_count : renvoie l'estimation du nombre de valeurs distinctes prises en
+//    compte par l'estimation associée à h.
+extern double hll_count(const hll *h);
+
+#endif
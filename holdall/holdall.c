@@ -1,56 +1,100 @@
 //  Partie implantation du module holdall.
 
+#include <stdbool.h>
+#include <stdint.h>
 #include "holdall.h"
+#include "holdall_ext.h"
 
 #define HOLDALL_WANT_EXT 1
 
-//  struct holdall, holdall : implantation par liste dynamique simplement
-//    chainée.
+//  struct holdall, holdall : implantation par blocs de références de longueur
+//    fixe. Les références sont rangées consécutivement, dans l'ordre de leur
+//    insertion, dans les blocs dont les adresses figurent dans le répertoire
+//    dir ; seul le dernier bloc peut ne pas être plein. Le répertoire, alloué
+//    dynamiquement, a pour capacité dircap et contient nchunks adresses. La
+//    référence de rang i, dans l'ordre des insertions, est ainsi accessible en
+//    temps constant ; aucune insertion ne donne lieu à une allocation, hormis
+//    celles qui ouvrent un nouveau bloc.
 
 //  Si la macroconstante HOLDALL_PUT_TAIL est définie et que sa macro-évaluation
 //    donne un entier non nul, l'insertion dans la liste a lieu en queue. Dans
-//    le cas contraire, elle a lieu en tête.
+//    le cas contraire, elle a lieu en tête : la liste est alors parcourue du
+//    dernier rang au premier.
 
-typedef struct choldall choldall;
+//  Le nombre de références d'un bloc vaut « 2 ^ HA__CHUNK_LB ». Le répertoire
+//    est alloué avec une capacité initiale de HA__DIR_MIN adresses, doublée à
+//    chaque agrandissement. Les intervalles de longueur au plus
+//    HA__INSERTION_MAX sont triés par insertion.
 
-struct choldall {
-  void *ref;
-  choldall *next;
-};
+#define HA__CHUNK_LB        8
+#define HA__CHUNK_LEN       ((size_t) 1 << HA__CHUNK_LB)
+#define HA__DIR_MIN         4
+#define HA__INSERTION_MAX   12
+
+#if HA__INSERTION_MAX < 3
+#error Bad choice of HA__INSERTION_MAX.
+#endif
 
-struct holdall {
-  choldall *head;
 #if defined HOLDALL_PUT_TAIL && HOLDALL_PUT_TAIL != 0
-  choldall **tailptr;
+#define HA__REVERSED false
+#else
+#define HA__REVERSED true
 #endif
+
+typedef struct {
+  void *refs[HA__CHUNK_LEN];
+} chunk;
+
+struct holdall {
+  chunk **dir;
+  size_t dircap;
+  size_t nchunks;
   size_t count;
 };
 
-//  quicksort : trie les cellules entre head et tail (exclue) selon la fonction
-//    de comparaison compar.
-static void quicksort(choldall *head, choldall *tail,
-    int (*compar)(const void *, const void *));
+//  HA__SLOT : adresse de l'emplacement de la référence de rang i, dans l'ordre
+//    des insertions, du fourretout associé à ha.
+#define HA__SLOT(ha, i)                                                        \
+  (&(ha)->dir[(i) >> HA__CHUNK_LB]->refs[(i) & (HA__CHUNK_LEN - 1)])
+
+//  HA__RANK : rang, dans l'ordre des insertions, de la référence qui figure à
+//    la position k de la liste du fourretout associé à ha.
+#define HA__RANK(ha, k)                                                        \
+  (HA__REVERSED ? (ha)->count - 1 - (k) : (k))
+
+//  sorter : type et nom de type pour une structure regroupant les paramètres
+//    d'un tri : le fourretout ha, la fonction de comparaison compar et le fait
+//    que l'ordre des rangs soit l'inverse de celui de la liste.
+typedef struct {
+  holdall *ha;
+  int (*compar)(const void *, const void *);
+  bool reversed;
+} sorter;
 
-//  partition : choisit un pivot et réarrange le contenu des cellules entre
-//    head et tail (exclue) avec, dans l'ordre, les éléments strictement
-//    inférieur au pivot, le pivot, les éléments strictement supérieurs. Si
-//    tail == NULL, toute la liste est traitée. Si la liste est vide, renvoie
-//    NULL; renvoie un pointeur vers le pivot sinon.
-static choldall *partition(choldall *head, choldall *tail,
-    int (*compar)(const void *, const void *));
+//  sorter_compar : compare les références ref1 et ref2 selon l'ordre dans
+//    lequel elles doivent être rangées par rangs croissants.
+static int sorter_compar(const sorter *s, const void *ref1, const void *ref2);
 
-//  swap : échange le contenu des cellules pointées par p1 et p2.
-static void swap(choldall *p1, choldall *p2);
+//  swap : échange les références de rangs i et j du fourretout associé à ha.
+static void swap(holdall *ha, size_t i, size_t j);
+
+//  quicksort : trie les références de rangs compris entre lo et hi (exclu).
+//    Le pivot est la médiane des références de rangs lo, hi - 1 et de celle du
+//    milieu ; la récursion porte sur la plus petite des deux parties.
+static void quicksort(const sorter *s, size_t lo, size_t hi);
+
+//  insertion_sort : trie par insertion les références de rangs compris entre
+//    lo et hi (exclu).
+static void insertion_sort(const sorter *s, size_t lo, size_t hi);
 
 holdall *holdall_empty(void) {
   holdall *ha = malloc(sizeof *ha);
   if (ha == NULL) {
     return NULL;
   }
-  ha->head = NULL;
-#if defined HOLDALL_PUT_TAIL && HOLDALL_PUT_TAIL != 0
-  ha->tailptr = &ha->head;
-#endif
+  ha->dir = NULL;
+  ha->dircap = 0;
+  ha->nchunks = 0;
   ha->count = 0;
   return ha;
 }
@@ -59,30 +103,36 @@ void holdall_dispose(holdall **haptr) {
   if (*haptr == NULL) {
     return;
   }
-  choldall *p = (*haptr)->head;
-  while (p != NULL) {
-    choldall *t = p;
-    p = p->next;
-    free(t);
+  for (size_t k = 0; k < (*haptr)->nchunks; ++k) {
+    free((*haptr)->dir[k]);
   }
+  free((*haptr)->dir);
   free(*haptr);
   *haptr = NULL;
 }
 
 int holdall_put(holdall *ha, void *ref) {
-  choldall *p = malloc(sizeof *p);
-  if (p == NULL) {
-    return -1;
+  if (ha->count == ha->nchunks * HA__CHUNK_LEN) {
+    if (ha->nchunks == ha->dircap) {
+      size_t cap = (ha->dircap == 0 ? HA__DIR_MIN : 2 * ha->dircap);
+      if (cap > SIZE_MAX / 2 / sizeof *ha->dir) {
+        return -1;
+      }
+      chunk **a = realloc(ha->dir, cap * sizeof *a);
+      if (a == NULL) {
+        return -1;
+      }
+      ha->dir = a;
+      ha->dircap = cap;
+    }
+    chunk *c = malloc(sizeof *c);
+    if (c == NULL) {
+      return -1;
+    }
+    ha->dir[ha->nchunks] = c;
+    ha->nchunks += 1;
   }
-  p->ref = ref;
-#if defined HOLDALL_PUT_TAIL && HOLDALL_PUT_TAIL != 0
-  p->next = NULL;
-  *ha->tailptr = p;
-  ha->tailptr = &p->next;
-#else
-  p->next = ha->head;
-  ha->head = p;
-#endif
+  *HA__SLOT(ha, ha->count) = ref;
   ha->count += 1;
   return 0;
 }
@@ -91,10 +141,27 @@ size_t holdall_count(holdall *ha) {
   return ha->count;
 }
 
+size_t holdall_memory(holdall *ha) {
+  return sizeof *ha + ha->dircap * sizeof *ha->dir
+    + ha->nchunks * sizeof(chunk);
+}
+
+size_t holdall_put_memory(holdall *ha) {
+  if (ha->count != ha->nchunks * HA__CHUNK_LEN) {
+    return 0;
+  }
+  size_t m = sizeof(chunk);
+  if (ha->nchunks == ha->dircap) {
+    size_t cap = (ha->dircap == 0 ? HA__DIR_MIN : 2 * ha->dircap);
+    m += (cap - ha->dircap) * sizeof *ha->dir;
+  }
+  return m;
+}
+
 int holdall_apply(holdall *ha,
     int (*fun)(void *)) {
-  for (const choldall *p = ha->head; p != NULL; p = p->next) {
-    int r = fun(p->ref);
+  for (size_t k = 0; k < ha->count; ++k) {
+    int r = fun(*HA__SLOT(ha, HA__RANK(ha, k)));
     if (r != 0) {
       return r;
     }
@@ -105,8 +172,9 @@ int holdall_apply(holdall *ha,
 int holdall_apply_context(holdall *ha,
     void *context, void *(*fun1)(void *context, void *ptr),
     int (*fun2)(void *ptr, void *resultfun1)) {
-  for (const choldall *p = ha->head; p != NULL; p = p->next) {
-    int r = fun2(p->ref, fun1(context, p->ref));
+  for (size_t k = 0; k < ha->count; ++k) {
+    void *ref = *HA__SLOT(ha, HA__RANK(ha, k));
+    int r = fun2(ref, fun1(context, ref));
     if (r != 0) {
       return r;
     }
@@ -117,8 +185,9 @@ int holdall_apply_context(holdall *ha,
 int holdall_apply_context2(holdall *ha,
     void *context1, void *(*fun1)(void *context1, void *ptr),
     void *context2, int (*fun2)(void *context2, void *ptr, void *resultfun1)) {
-  for (const choldall *p = ha->head; p != NULL; p = p->next) {
-    int r = fun2(context2, p->ref, fun1(context1, p->ref));
+  for (size_t k = 0; k < ha->count; ++k) {
+    void *ref = *HA__SLOT(ha, HA__RANK(ha, k));
+    int r = fun2(context2, ref, fun1(context1, ref));
     if (r != 0) {
       return r;
     }
@@ -129,48 +198,81 @@ int holdall_apply_context2(holdall *ha,
 #if defined HOLDALL_WANT_EXT && HOLDALL_WANT_EXT != 0
 
 void holdall_sort(holdall *ha, int (*compar)(const void *, const void *)) {
-  quicksort(ha->head, NULL, compar);
+  sorter s = {
+    .ha = ha,
+    .compar = compar,
+    .reversed = HA__REVERSED,
+  };
+  quicksort(&s, 0, ha->count);
 }
 
-void quicksort(choldall *head, choldall *tail,
-    int (*compar)(const void *, const void *)) {
-  if (head == tail) {
-    return;
-  }
-  choldall *p = partition(head, tail, compar);
-  if (p != NULL) {
-    if (head != p) {
-      quicksort(head, p, compar);
+int sorter_compar(const sorter *s, const void *ref1, const void *ref2) {
+  return s->reversed ? s->compar(ref2, ref1) : s->compar(ref1, ref2);
+}
+
+void swap(holdall *ha, size_t i, size_t j) {
+  void **p1 = HA__SLOT(ha, i);
+  void **p2 = HA__SLOT(ha, j);
+  void *t = *p1;
+  *p1 = *p2;
+  *p2 = t;
+}
+
+void quicksort(const sorter *s, size_t lo, size_t hi) {
+  holdall *ha = s->ha;
+  while (hi - lo > HA__INSERTION_MAX) {
+    //  Après ces échanges, les références de rangs lo, mid et hi - 1 sont
+    //    rangées ; celle de rang lo sert de sentinelle à j, le pivot, placé au
+    //    rang hi - 2, de sentinelle à i.
+    size_t mid = lo + (hi - lo) / 2;
+    if (sorter_compar(s, *HA__SLOT(ha, mid), *HA__SLOT(ha, lo)) < 0) {
+      swap(ha, mid, lo);
+    }
+    if (sorter_compar(s, *HA__SLOT(ha, hi - 1), *HA__SLOT(ha, mid)) < 0) {
+      swap(ha, hi - 1, mid);
+      if (sorter_compar(s, *HA__SLOT(ha, mid), *HA__SLOT(ha, lo)) < 0) {
+        swap(ha, mid, lo);
+      }
+    }
+    swap(ha, mid, hi - 2);
+    const void *pivot = *HA__SLOT(ha, hi - 2);
+    size_t i = lo;
+    size_t j = hi - 2;
+    while (true) {
+      do {
+        ++i;
+      } while (sorter_compar(s, *HA__SLOT(ha, i), pivot) < 0);
+      do {
+        --j;
+      } while (sorter_compar(s, pivot, *HA__SLOT(ha, j)) < 0);
+      if (i >= j) {
+        break;
+      }
+      swap(ha, i, j);
     }
-    if (p->next != NULL) {
-      quicksort(p->next, tail, compar);
+    swap(ha, i, hi - 2);
+    if (i - lo < hi - i - 1) {
+      quicksort(s, lo, i);
+      lo = i + 1;
+    } else {
+      quicksort(s, i + 1, hi);
+      hi = i;
     }
   }
+  insertion_sort(s, lo, hi);
 }
 
-choldall *partition(choldall *head, choldall *tail,
-    int (*compar)(const void *, const void *)) {
-  if (head == NULL) {
-    return NULL;
-  }
-  choldall *pivot = head;
-  choldall *rep = head;
-  choldall *curr = head->next;
-  while (curr != tail && curr != NULL) {
-    if (compar(curr->ref, pivot->ref) < 0) {
-      swap(rep->next, curr);
-      rep = rep->next;
+void insertion_sort(const sorter *s, size_t lo, size_t hi) {
+  holdall *ha = s->ha;
+  for (size_t k = lo + 1; k < hi; ++k) {
+    void *ref = *HA__SLOT(ha, k);
+    size_t j = k;
+    while (j > lo && sorter_compar(s, ref, *HA__SLOT(ha, j - 1)) < 0) {
+      *HA__SLOT(ha, j) = *HA__SLOT(ha, j - 1);
+      --j;
     }
-    curr = curr->next;
+    *HA__SLOT(ha, j) = ref;
   }
-  swap(pivot, rep);
-  return rep;
-}
-
-void swap(choldall *p1, choldall *p2) {
-  void *t = p1->ref;
-  p1->ref = p2->ref;
-  p2->ref = t;
 }
 
 #endif
@@ -0,0 +1,19 @@
+//  holdall_ext.h : compléments au module holdall, propres à xwc. Ils sont
+//    déclarés à part, l'interface holdall.h ne pouvant être modifiée.
+
+#ifndef HOLDALL_EXT__H
+#define HOLDALL_EXT__H
+
+#include <stdlib.h>
+
+#include "holdall.h"
+
+//  holdall_memory : renvoie le nombre d'octets actuellement alloués pour la
+//    gestion du fourretout associé à ha, contrôleur compris.
+extern size_t holdall_memory(holdall *ha);
+
+//  holdall_put_memory : renvoie le nombre d'octets que tenterait d'allouer la
+//    prochaine insertion dans le fourretout associé à ha.
+extern size_t holdall_put_memory(holdall *ha);
+
+#endif
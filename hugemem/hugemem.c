@@ -0,0 +1,253 @@
+//  hugemem.c : partie implantation d'un module pour l'allocation de grandes
+//    zones de mémoire sur des pages géantes transparentes.
+
+//  MAP_ANONYMOUS, madvise et MADV_HUGEPAGE ne sont pas POSIX : ils ne sont
+//    déclarés qu'à la demande de l'unité de traduction.
+#define _DEFAULT_SOURCE
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/mman.h>
+
+#include "hugemem.h"
+
+#if defined MAP_ANONYMOUS && defined MADV_HUGEPAGE
+#define HUGEMEM__MAPPABLE 1
+#else
+#define HUGEMEM__MAPPABLE 0
+#endif
+
+#define HUGEMEM__SMAPS      "/proc/self/smaps_rollup"
+#define HUGEMEM__SMAPS_KEY  "AnonHugePages:"
+#define HUGEMEM__THP        "/sys/kernel/mm/transparent_hugepage/enabled"
+#define HUGEMEM__LINE_MAX   256
+
+//  zone : type et nom de type pour une structure décrivant une zone projetée
+//    d'adresse addr et de longueur len, signalée au noyau si advised est vrai.
+typedef struct {
+  void *addr;
+  size_t len;
+  bool advised;
+} zone;
+
+//  Les zones projetées sont rangées dans les nzones premiers composants du
+//    tableau zones, de capacité zonescap, sous la protection de lock. Comme
+//    elles sont peu nombreuses, elles y sont recherchées séquentiellement.
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static zone *zones = NULL;
+static size_t nzones = 0;
+static size_t zonescap = 0;
+static size_t mapped = 0;
+static size_t advised = 0;
+static size_t fallbacks = 0;
+static atomic_size_t threshold = HUGEMEM_THRESHOLD_DEF;
+
+//  hugemem__map : tente d'allouer une zone de size octets par projection.
+//    Renvoie NULL en cas d'échec, l'adresse de la zone sinon.
+static void *hugemem__map(size_t size);
+
+//  hugemem__find : renvoie le rang dans zones de la zone d'adresse p si elle
+//    y figure, nzones sinon. lock est supposé verrouillé.
+static size_t hugemem__find(const void *p);
+
+//  hugemem__read_thp : renvoie la valeur en octets du champ AnonHugePages du
+//    bilan mémoire du processus, zéro s'il ne peut être lu.
+static size_t hugemem__read_thp(void);
+
+//  hugemem__read_mode : renvoie le réglage, entre crochets dans le fichier du
+//    noyau, des pages géantes transparentes.
+static const char *hugemem__read_mode(void);
+
+void hugemem_set_threshold(size_t t) {
+  atomic_store_explicit(&threshold, t, memory_order_relaxed);
+}
+
+size_t hugemem_threshold(void) {
+  return atomic_load_explicit(&threshold, memory_order_relaxed);
+}
+
+void *hugemem_alloc(size_t size) {
+  if (size == 0 || size < hugemem_threshold()) {
+    return malloc(size);
+  }
+  void *p = hugemem__map(size);
+  if (p != NULL) {
+    return p;
+  }
+  pthread_mutex_lock(&lock);
+  fallbacks += 1;
+  pthread_mutex_unlock(&lock);
+  return malloc(size);
+}
+
+void *hugemem_calloc(size_t n, size_t size) {
+  if (size != 0 && n > SIZE_MAX / size) {
+    return NULL;
+  }
+  if (n * size == 0 || n * size < hugemem_threshold()) {
+    return calloc(n, size);
+  }
+  //  Une projection anonyme est initialisée à zéro par le noyau.
+  void *p = hugemem__map(n * size);
+  if (p != NULL) {
+    return p;
+  }
+  pthread_mutex_lock(&lock);
+  fallbacks += 1;
+  pthread_mutex_unlock(&lock);
+  return calloc(n, size);
+}
+
+void *hugemem_realloc(void *p, size_t oldsize, size_t size) {
+  if (p == NULL) {
+    return hugemem_alloc(size);
+  }
+  pthread_mutex_lock(&lock);
+  size_t k = hugemem__find(p);
+  bool m = k < nzones;
+  bool fits = m && size <= zones[k].len;
+  pthread_mutex_unlock(&lock);
+  if (fits) {
+    return p;
+  }
+  if (!m && size < hugemem_threshold()) {
+    return realloc(p, size);
+  }
+  void *q = hugemem_alloc(size);
+  if (q == NULL) {
+    return NULL;
+  }
+  memcpy(q, p, oldsize < size ? oldsize : size);
+  hugemem_free(p);
+  return q;
+}
+
+void hugemem_free(void *p) {
+  if (p == NULL) {
+    return;
+  }
+  pthread_mutex_lock(&lock);
+  size_t k = hugemem__find(p);
+  if (k == nzones) {
+    pthread_mutex_unlock(&lock);
+    free(p);
+    return;
+  }
+  zone z = zones[k];
+  zones[k] = zones[nzones - 1];
+  nzones -= 1;
+  mapped -= z.len;
+  advised -= (z.advised ? z.len : 0);
+  pthread_mutex_unlock(&lock);
+  munmap(z.addr, z.len);
+}
+
+void hugemem_get_stats(struct hugemem_stats *hmsptr) {
+  pthread_mutex_lock(&lock);
+  *hmsptr = (struct hugemem_stats) {
+    .threshold = hugemem_threshold(),
+    .maps = nzones,
+    .mapped = mapped,
+    .advised = advised,
+    .fallbacks = fallbacks,
+  };
+  pthread_mutex_unlock(&lock);
+  hmsptr->thp = hugemem__read_thp();
+  hmsptr->mode = hugemem__read_mode();
+}
+
+void *hugemem__map(size_t size) {
+#if HUGEMEM__MAPPABLE
+  //  La projection est allongée d'une page géante afin d'en retenir une partie
+  //    alignée ; le surplus, de part et d'autre, est aussitôt rendu.
+  if (size > SIZE_MAX - 2 * HUGEMEM_PAGE) {
+    return NULL;
+  }
+  size_t len = (size + HUGEMEM_PAGE - 1) / HUGEMEM_PAGE * HUGEMEM_PAGE;
+  char *a = mmap(NULL, len + HUGEMEM_PAGE, PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (a == MAP_FAILED) {
+    return NULL;
+  }
+  size_t head = (HUGEMEM_PAGE - (uintptr_t) a % HUGEMEM_PAGE) % HUGEMEM_PAGE;
+  if (head != 0) {
+    munmap(a, head);
+  }
+  munmap(a + head + len, HUGEMEM_PAGE - head);
+  a += head;
+  bool adv = madvise(a, len, MADV_HUGEPAGE) == 0;
+  pthread_mutex_lock(&lock);
+  if (nzones == zonescap) {
+    size_t cap = (zonescap == 0 ? 8 : 2 * zonescap);
+    zone *t = realloc(zones, cap * sizeof *t);
+    if (t == NULL) {
+      pthread_mutex_unlock(&lock);
+      munmap(a, len);
+      return NULL;
+    }
+    zones = t;
+    zonescap = cap;
+  }
+  zones[nzones] = (zone) { a, len, adv };
+  nzones += 1;
+  mapped += len;
+  advised += (adv ? len : 0);
+  pthread_mutex_unlock(&lock);
+  return a;
+#else
+  (void) size;
+  return NULL;
+#endif
+}
+
+size_t hugemem__find(const void *p) {
+  size_t k = 0;
+  while (k < nzones && zones[k].addr != p) {
+    ++k;
+  }
+  return k;
+}
+
+size_t hugemem__read_thp(void) {
+  FILE *f = fopen(HUGEMEM__SMAPS, "r");
+  if (f == NULL) {
+    return 0;
+  }
+  size_t kb = 0;
+  char line[HUGEMEM__LINE_MAX];
+  while (fgets(line, sizeof line, f) != NULL) {
+    if (strncmp(line, HUGEMEM__SMAPS_KEY, sizeof HUGEMEM__SMAPS_KEY - 1)
+        == 0) {
+      kb = (size_t) strtoull(line + sizeof HUGEMEM__SMAPS_KEY - 1, NULL, 10);
+      break;
+    }
+  }
+  fclose(f);
+  return kb * 1024;
+}
+
+const char *hugemem__read_mode(void) {
+  static const char *modes[] = {
+    "always", "madvise", "never",
+  };
+  FILE *f = fopen(HUGEMEM__THP, "r");
+  if (f == NULL) {
+    return "unknown";
+  }
+  char line[HUGEMEM__LINE_MAX];
+  char *s = fgets(line, sizeof line, f);
+  fclose(f);
+  if (s == NULL || (s = strchr(line, '[')) == NULL) {
+    return "unknown";
+  }
+  for (size_t k = 0; k < sizeof modes / sizeof *modes; ++k) {
+    size_t n = strlen(modes[k]);
+    if (strncmp(s + 1, modes[k], n) == 0 && s[1 + n] == ']') {
+      return modes[k];
+    }
+  }
+  return "unknown";
+}
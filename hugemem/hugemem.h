@@ -0,0 +1,68 @@
+//  hugemem.h : partie interface d'un module pour l'allocation de grandes zones
+//    de mémoire sur des pages géantes transparentes.
+
+#ifndef HUGEMEM__H
+#define HUGEMEM__H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+//  Fonctionnement général :
+//  - une zone d'au moins hugemem_threshold() octets est projetée en mémoire
+//      anonyme, à une adresse et sur une longueur multiples de HUGEMEM_PAGE,
+//      puis signalée au noyau par madvise(MADV_HUGEPAGE). Les accès aléatoires
+//      à un grand tableau n'occupent alors qu'une entrée du TLB par page
+//      géante au lieu d'une par page ordinaire ;
+//  - les zones plus petites, ainsi que celles dont la projection échoue ou
+//      lorsque le système ne connait pas les pages géantes transparentes, sont
+//      allouées par malloc. Toutes sont libérées par hugemem_free ;
+//  - le seuil et le bilan sont communs à tout le processus. Les fonctions
+//      peuvent être appelées simultanément par plusieurs fils d'exécution.
+
+//  HUGEMEM_PAGE : taille d'une page géante.
+#define HUGEMEM_PAGE  ((size_t) 1 << 21)
+
+//  HUGEMEM_THRESHOLD_DEF : seuil initial. HUGEMEM_NEVER : seuil qui réserve
+//    toutes les allocations à malloc.
+#define HUGEMEM_THRESHOLD_DEF HUGEMEM_PAGE
+#define HUGEMEM_NEVER         SIZE_MAX
+
+//  hugemem_set_threshold, hugemem_threshold : fixe et renvoie la taille à
+//    partir de laquelle une zone est allouée sur des pages géantes.
+extern void hugemem_set_threshold(size_t threshold);
+extern size_t hugemem_threshold(void);
+
+//  hugemem_alloc, hugemem_calloc : mêmes spécifications que malloc et calloc.
+extern void *hugemem_alloc(size_t size);
+extern void *hugemem_calloc(size_t n, size_t size);
+
+//  hugemem_realloc : même spécification que realloc, oldsize étant la taille
+//    de la zone d'adresse p si p ne vaut pas NULL.
+extern void *hugemem_realloc(void *p, size_t oldsize, size_t size);
+
+//  hugemem_free : sans effet si p vaut NULL. Libère sinon la zone d'adresse p,
+//    préalablement renvoyée par l'une des trois fonctions précédentes.
+extern void hugemem_free(void *p);
+
+//  struct hugemem_stats : bilan des allocations du processus. Les composants
+//    maps et mapped sont le nombre et la longueur totale des zones actuellement
+//    projetées, advised la part de cette longueur signalée au noyau, fallbacks
+//    le nombre de zones allouées par malloc faute d'avoir pu être projetées,
+//    thp le nombre d'octets de mémoire anonyme du processus effectivement
+//    rangés sur des pages géantes, nul s'il ne peut être déterminé, et mode
+//    le réglage des pages géantes transparentes du système : "always",
+//    "madvise", "never" ou "unknown".
+struct hugemem_stats {
+  size_t threshold;
+  size_t maps;
+  size_t mapped;
+  size_t advised;
+  size_t fallbacks;
+  size_t thp;
+  const char *mode;
+};
+
+//  hugemem_get_stats : affecte à *hmsptr le bilan des allocations.
+extern void hugemem_get_stats(struct hugemem_stats *hmsptr);
+
+#endif
@@ -0,0 +1,2740 @@
+//  libxwc.c : partie implantation de la bibliothèque de comptage exclusif de
+//    mots.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <locale.h>
+#include <limits.h>
+#include <stdatomic.h>
+#include <math.h>
+#include <sys/stat.h>
+#include <pthread.h>
+
+#include "libxwc.h"
+#include "hashtable.h"
+#include "hashtable_ext.h"
+#include "holdall.h"
+#include "holdall_ext.h"
+#include "sbuffer.h"
+#include "chrono.h"
+#include "spill.h"
+#include "arena.h"
+#include "mfile.h"
+#include "chashtable.h"
+#include "hll.h"
+#include "utf8.h"
+#include "art.h"
+#include "siphash.h"
+#include "topk.h"
+#include "owners.h"
+#include "fileset.h"
+#include "hugemem.h"
+#include "zpipe.h"
+
+//  Nombre de fragments de la table partagée par fil d'exécution, arrondi par le
+//    module chashtable à une puissance de deux.
+#define SHARDS_PER_THREAD 16
+
+//  WORD_ADD_MEMORY : nombre d'octets que tenterait d'allouer en plus l'ajout à
+//    *ct d'un mot de longueur len, copié si stable est faux.
+#define WORD_ADD_MEMORY(ct, len, stable)                                       \
+  ((stable ? 0 : arena_alloc_memory((ct)->ar, len)) + sizeof(word_info)        \
+  + holdall_put_memory((ct)->has) + word_table_add_memory((ct)->ht))
+
+//  Longueur des blocs lus sur les fichiers qui ne peuvent pas être projetés en
+//    mémoire.
+#define READ_BUFSIZE      65536
+
+//  Nombre maximal de mots d'un bloc dont les recherches dans la table de
+//    hachage sont préparées ensemble par word_table_prefetch.
+#define WORD_BATCH        32
+
+//  Capacité initiale du tableau qui reçoit les mots pliés par l'option -f.
+#define FOLD_BUFSIZE_MIN  4096
+
+//  Nombre maximal d'octets lus en tête des fichiers pour estimer le nombre de
+//    mots distincts, et logarithme binaire du nombre de registres de
+//    l'estimation HyperLogLog associée.
+#define ESTIMATE_SAMPLE   1048576
+#define ESTIMATE_LBNREGS  14
+
+//  Nombre de rangées de l'esquisse d'appartenance du mode approché.
+#define SKETCH_DEPTH      4
+
+//- STRUCTURES -----------------------------------------------------------------
+
+//  options : nom de type des options d'un comptage.
+typedef struct xwc_options options;
+
+//  word : type et nom de type pour une structure repérant un mot par l'adresse
+//    de son premier caractère et par sa longueur. Le mot n'est pas terminé par
+//    '\0' : il peut désigner directement une partie d'un fichier projeté en
+//    mémoire.
+typedef struct {
+  const char *s;
+  size_t len;
+} word;
+
+//  word_info : type et nom de type pour une structure contenant les
+//    informations sur un mot lu. Le mot est le premier composant : l'adresse
+//    d'une structure word_info est aussi celle de son mot, qui sert de clé
+//    dans la table de hachage et de référence dans le fourretout.
+typedef struct {
+  word key;
+  long int occ;
+  size_t file;
+} word_info;
+
+//  word_sets : type et nom de type pour une structure contenant les
+//    informations sur un mot lu avec l'option membership. Le composant wi
+//    décrit le dernier fichier dans lequel le mot a été lu ; son nombre
+//    d'occurrences n'est nul que pour un mot du seul fichier de restriction.
+//    Les autres fichiers sont rangés dans fs, qui vaut NULL si le mot est
+//    exclusif.
+typedef struct {
+  word_info wi;
+  fileset *fs;
+} word_sets;
+
+//  hash_key : clé de la fonction SipHash utilisée par str_hashfun, tirée au
+//    hasard une fois par exécution, lors de la création du premier contexte.
+static uint64_t hash_key[2];
+static pthread_once_t hash_key_once = PTHREAD_ONCE_INIT;
+
+//  str_hashfun : valeur de pré-hachage du mot pointé par w par la fonction
+//    SipHash de clé hash_key. La clé étant inconnue d'un texte lu, un texte ne
+//    peut pas être conçu pour que ses mots entrent en collision.
+static size_t str_hashfun(const word *w);
+
+//  word_compar : renvoie zéro si les mots pointés par w1 et w2 sont égaux, une
+//    valeur non nulle sinon.
+static int word_compar(const word *w1, const word *w2);
+
+//  word_table : type et nom de type pour une table de hachage associant des
+//    mots, mémorisés par valeur, à leurs structures word_info. Instance du
+//    patron hashtable_tpl.h : pré-hachage et comparaison des mots sont
+//    développés en ligne. Le pré-hachage est celui de SipHash pour la clé
+//    key propre à la table, tirée à sa création et à nouveau chaque fois
+//    qu'une liste devient anormalement longue.
+#define HASHTABLE_TPL_NAME    word_table
+#define HASHTABLE_TPL_PREFIX  word_table
+#define HASHTABLE_TPL_KEY     word
+#define HASHTABLE_TPL_VALUE   word_info
+#define HASHTABLE_TPL_HASH(ht, kp) \
+  ((size_t) siphash((kp)->s, (kp)->len, (ht)->key))
+#define HASHTABLE_TPL_EQUAL(ht, kp1, kp2) \
+  (word_compar(kp1, kp2) == 0)
+#define HASHTABLE_TPL_KEY_DATA(kp) \
+  ((kp)->s)
+#define HASHTABLE_TPL_MEMBERS \
+  uint64_t key[2];
+#define HASHTABLE_TPL_RESEED(ht) \
+  siphash_key_random((ht)->key)
+#include "hashtable_tpl.h"
+
+//  read_stats : type et nom de type pour une structure regroupant les
+//    compteurs relatifs à la lecture d'un fichier. Le composant mapped est le
+//    nombre d'octets lus au travers d'une projection en mémoire, compressed
+//    celui des octets compressés dont la décompression a produit les bytes
+//    octets lus.
+typedef struct {
+  size_t bytes;
+  size_t tokens;
+  size_t mapped;
+  size_t compressed;
+} read_stats;
+
+//  words_stats : type et nom de type pour une structure regroupant les
+//    effectifs des différentes catégories de mots mémorisés.
+typedef struct {
+  size_t exclusive;
+  size_t disqualified;
+  size_t unseen;
+  size_t selected;
+} words_stats;
+
+//  run_context : type et nom de type pour une structure désignant la partition
+//    d'indice part de sp.
+typedef struct {
+  spill *sp;
+  size_t part;
+} run_context;
+
+//  emitter : type et nom de type pour une structure servant de contexte aux
+//    fonctions de parcours de xwc_apply : la fonction fun est appelée avec
+//    context pour chacun des mots exclusifs, les effectifs des catégories de
+//    mots sont cumulés dans *ws et stopped indique que fun a interrompu le
+//    parcours. Avec l'option membership, qu'indique sets, et pour
+//    xwc_apply_sets, la fonction sfun est appelée à la place de fun pour
+//    chacun des mots présents dans au moins min_files et au plus max_files
+//    fichiers, occs étant le tableau qui reçoit leurs nombres d'occurrences.
+typedef struct {
+  void *context;
+  int (*fun)(void *context, const char *w, size_t len, size_t file,
+      long int occ);
+  int (*sfun)(void *context, const char *w, size_t len,
+      const struct xwc_occ *occs, size_t n);
+  size_t min_files;
+  size_t max_files;
+  struct xwc_occ *occs;
+  bool sets;
+  words_stats *ws;
+  bool stopped;
+} emitter;
+
+//  counter : type et nom de type pour une structure regroupant l'état du
+//    comptage. Le tableau delim indique, pour chaque valeur d'octet, si elle
+//    sépare les mots. Le fourretout has référence les mots mémorisés par la
+//    table de hachage ht ou, si le comptage est partagé entre plusieurs fils
+//    d'exécution, par la table partagée cht ; dans ce dernier cas, ht vaut
+//    NULL, has n'est rempli qu'à la fin de la lecture et les structures
+//    word_info appartiennent à cht. Avec l'option --dictionary=art, les mots
+//    sont mémorisés par l'arbre tree, à qui appartiennent les structures
+//    word_info ; ht vaut alors NULL et has n'est rempli que si le tri ne peut
+//    pas suivre l'ordre de l'arbre. Les copies des mots qui ne peuvent pas
+//    être repérés dans une projection sont rangées dans l'arène ar ; le buffer
+//    sb reçoit les mots à cheval sur deux blocs lus. Le composant word_info_mem
+//    est le nombre d'octets alloués aux structures word_info, peers_mem celui
+//    alloué aux arènes et buffers des autres fils d'exécution, maxlen la
+//    longueur maximale des mots mémorisés, nmapped et ncopied les nombres de
+//    mots mémorisés respectivement sans et avec copie. Les composants nfile,
+//    skip, nchars et rs décrivent la lecture du fichier courant : son indice,
+//    le fait que la fin d'un mot coupé reste à ignorer, le nombre de
+//    caractères du mot conservé dans sb, tenu à jour seulement avec l'option
+//    -i, et les compteurs de lecture. Les nbatch premiers composants de batch,
+//    cut, stable et hashes sont les mots du bloc courant en attente de
+//    comptage, le fait qu'ils sont coupés, le fait qu'ils sont stables au sens
+//    de scan_block et leurs valeurs de pré-hachage. Avec l'option -f, les mots
+//    qui comportent des majuscules sont pliés dans le tableau fold, de
+//    capacité foldcap, dont les foldlen premiers octets sont occupés par des
+//    mots du lot. La fonction pointée par scan est la variante de scan_block
+//    choisie selon les options. En mode approché, ht vaut NULL : les mots sont
+//    marqués dans l'esquisse own et suivis par la recherche top du fichier
+//    courant ; has n'est rempli que lors du parcours.
+typedef struct counter {
+  const options *p;
+  bool delim[UCHAR_MAX + 1];
+  word_table *ht;
+  chashtable *cht;
+  art *tree;
+  holdall *has;
+  arena *ar;
+  sbuffer *sb;
+  size_t word_info_mem;
+  size_t peers_mem;
+  size_t maxlen;
+  size_t nmapped;
+  size_t ncopied;
+  spill *parts;
+  size_t nflushes;
+  size_t nfile;
+  bool skip;
+  size_t nchars;
+  read_stats rs;
+  size_t nbatch;
+  word batch[WORD_BATCH];
+  bool cut[WORD_BATCH];
+  bool stable[WORD_BATCH];
+  size_t hashes[WORD_BATCH];
+  char *fold;
+  size_t foldcap;
+  size_t foldlen;
+  int (*scan)(struct counter *ct, const char *buf, size_t n, bool stable);
+  owners *own;
+  topk *top;
+} counter;
+
+//  shared_count : type et nom de type pour une structure servant de contexte
+//    aux fonctions add_word_info et update_word_info lors de la mise à jour de
+//    la table partagée par le compteur ct avec un mot, stable ou non au sens
+//    de scan_block. Le composant wi mémorise la dernière structure allouée, r
+//    le code d'erreur éventuel.
+typedef struct {
+  counter *ct;
+  bool stable;
+  word_info *wi;
+  int r;
+} shared_count;
+
+//  sketch_context : type et nom de type pour une structure servant de contexte
+//    à rsketch_word : le compteur ct, l'esquisse own, l'indice file du fichier
+//    dont les mots sont parcourus et les effectifs ws.
+typedef struct {
+  counter *ct;
+  const owners *own;
+  size_t file;
+  words_stats *ws;
+} sketch_context;
+
+//  job : type et nom de type pour une structure décrivant la lecture par un
+//    fil d'exécution du fichier d'indice nfile et de nom fname : son résultat
+//    r, ses compteurs rs et sa durée t.
+typedef struct {
+  char *fname;
+  size_t nfile;
+  int r;
+  read_stats rs;
+  chrono t;
+} job;
+
+//  job_queue : type et nom de type pour une structure regroupant les njobs
+//    lectures du tableau jobs. Le composant next est l'indice de la prochaine
+//    lecture à attribuer, stop indique qu'une lecture a échoué.
+typedef struct {
+  job *jobs;
+  size_t njobs;
+  atomic_size_t next;
+  atomic_bool stop;
+} job_queue;
+
+//  worker : type et nom de type pour une structure regroupant l'état d'un fil
+//    d'exécution de lecture : son identifiant thread, le fait qu'il ait été
+//    lancé, son compteur ct, qui partage la table de celui du fil principal,
+//    le fourretout maps de ses projections, son buffer de lecture buf et les
+//    lectures q qu'il se partage avec les autres fils.
+typedef struct {
+  pthread_t thread;
+  bool started;
+  counter ct;
+  holdall *maps;
+  char *buf;
+  job_queue *q;
+} worker;
+
+//  file_entry : type et nom de type pour une structure regroupant le bilan de
+//    lecture fs d'un fichier et le fait qu'il ait été lu.
+typedef struct {
+  bool seen;
+  struct xwc_file_stats fs;
+} file_entry;
+
+//  struct xwc : le composant p mémorise les options du comptage, ct le
+//    compteur du fil appelant, qui partage la table cht avec les fils
+//    d'exécution workers s'il y en a plusieurs. Le fourretout maps référence
+//    les projections des fichiers lus par le fil appelant, buf est son buffer
+//    de lecture, dont les kept premiers octets débutent, avec l'option utf8,
+//    un codage incomplet reçu par xwc_feed. Le composant open indique qu'un
+//    fichier, d'indice ct.nfile, est en cours de lecture, fed que la table
+//    partagée a reçu des mots depuis qu'ils ont été rassemblés dans ct.has.
+//    Les lectures différées sont décrites par q, de capacité jobscap ; les
+//    nworkers fils d'exécution qui les ont effectuées, workers, demeurent
+//    jusqu'à la libération du contexte. Les nfiles premiers composants de
+//    files sont les bilans de lecture, par indice de fichier. Les partitions
+//    runs reçoivent les résultats triés de chaque partition de ct.parts ;
+//    drained indique que ces dernières ont été consommées. Enfin, errindex est
+//    l'indice du fichier ou de la partition du dernier échec, ws et ndistinct
+//    les effectifs du dernier parcours, qbuf, de capacité qcap, le tableau où
+//    xwc_query plie les mots recherchés, occs, de capacité occscap, celui où
+//    xwc_apply_sets range les nombres d'occurrences d'un mot. En mode
+//    approché, own est l'esquisse d'appartenance et les ntops premiers
+//    composants de tops les recherches des mots les plus fréquents, par
+//    indice de fichier, NULL pour un fichier non lu.
+struct xwc {
+  options p;
+  counter ct;
+  chashtable *cht;
+  holdall *maps;
+  char *buf;
+  size_t kept;
+  bool open;
+  bool fed;
+  job_queue q;
+  size_t jobscap;
+  worker *workers;
+  size_t nworkers;
+  file_entry *files;
+  size_t nfiles;
+  spill *runs;
+  bool drained;
+  size_t errindex;
+  words_stats ws;
+  size_t ndistinct;
+  char *qbuf;
+  size_t qcap;
+  struct xwc_occ *occs;
+  size_t occscap;
+  owners *own;
+  topk **tops;
+  size_t ntops;
+};
+
+//- PROTOTYPES -----------------------------------------------------------------
+
+//  apply_words : fonction commune à xwc_apply et xwc_apply_sets, em étant le
+//    contexte des fonctions de parcours.
+static int apply_words(xwc *x, xwc_order order, int (*start)(void *context),
+    emitter *em);
+
+//  hash_key_init : tire la clé hash_key.
+static void hash_key_init(void);
+
+//  word_info_of : renvoie l'adresse de la structure word_info dont w est
+//    l'adresse du mot. Le paramètre context n'est pas utilisé ; il permet
+//    l'usage de la fonction par holdall_apply_context.
+static word_info *word_info_of(void *context, word *w);
+
+//  word_key : renvoie l'adresse du mot de wi et affecte sa longueur à *lenptr.
+//    Fonction des clés de l'arbre de l'option --dictionary=art.
+static const char *word_key(const word_info *wi, size_t *lenptr);
+
+//  file_entry_of : renvoie l'adresse du bilan de lecture du fichier d'indice
+//    file de x, après avoir agrandi au besoin le tableau des bilans. Renvoie
+//    NULL en cas de dépassement de capacité.
+static file_entry *file_entry_of(xwc *x, size_t file);
+
+//  file_begin : termine, s'il est d'indice différent de file, le fichier en
+//    cours de x, puis prépare au besoin la lecture du fichier d'indice file.
+//    Renvoie XWC_SUCCESS en cas de succès, un code d'erreur sinon.
+static int file_begin(xwc *x, size_t file);
+
+//  file_end : sans effet si aucun fichier n'est en cours de lecture pour x.
+//    Compte sinon les octets et le mot qui restent en attente, puis cumule les
+//    compteurs de lecture dans le bilan du fichier. Renvoie XWC_SUCCESS en cas
+//    de succès, un code d'erreur sinon.
+static int file_end(xwc *x);
+
+//  file_time : cumule, si l'option stats est vraie, la durée écoulée depuis
+//    start dans le bilan du fichier d'indice file de x.
+static void file_time(xwc *x, size_t file, chrono start);
+
+//  sketch_of : renvoie l'adresse de la recherche des mots les plus fréquents du
+//    fichier d'indice file de x, créée au besoin. Renvoie NULL en cas de
+//    dépassement de capacité.
+static topk *sketch_of(xwc *x, size_t file);
+
+//  sketch_collect : ajoute au fourretout de x->ct, pour chaque fichier, des
+//    structures word_info pour ceux des mots suivis dont l'esquisse prouve
+//    l'exclusivité, et cumule les autres dans les effectifs de x. Renvoie
+//    XWC_SUCCESS en cas de succès, un code d'erreur sinon.
+static int sketch_collect(xwc *x);
+
+//  run_jobs : effectue les lectures différées de x. Renvoie XWC_SUCCESS en cas
+//    de succès, un code d'erreur sinon.
+static int run_jobs(xwc *x);
+
+//  counter_init : tente d'initialiser *ct pour un comptage selon les options
+//    pointées par p. Si cht ne vaut pas NULL, le comptage a lieu dans la
+//    table partagée associée à cht ; sinon, la table de *ct est dimensionnée
+//    d'emblée pour recevoir environ capacity mots. Renvoie une valeur non
+//    nulle en cas de dépassement de capacité, zéro sinon. Dans tous les cas,
+//    *ct peut ensuite être passé à counter_dispose.
+static int counter_init(counter *ct, const options *p, chashtable *cht,
+    size_t capacity);
+
+//  counter_dispose : libère les ressources allouées à la gestion de *ct. La
+//    table partagée éventuelle et les structures word_info qu'elle référence
+//    ne sont pas libérées.
+static void counter_dispose(counter *ct);
+
+//  run_workers : lit en parallèle, à l'aide des nworkers fils d'exécution de
+//    workers, les fichiers décrits par q, en comptant leurs mots dans la table
+//    partagée cht. Renvoie une valeur non nulle si un fil d'exécution n'a pu
+//    être préparé ou lancé, zéro sinon ; dans ce dernier cas, les résultats
+//    figurent dans q->jobs.
+static int run_workers(worker *workers, size_t nworkers, job_queue *q,
+    const options *p, chashtable *cht);
+
+//  work : fonction exécutée par le fil d'exécution de *w. Attribue à *w les
+//    lectures de w->q jusqu'à épuisement ou échec de l'une d'elles.
+static void *work(worker *w);
+
+//  collect_word : ajoute la clé de wi au fourretout has. Renvoie une valeur non
+//    nulle en cas de dépassement de capacité, zéro sinon.
+static int collect_word(holdall *has, word_info *wi);
+
+//  words_empty : tente d'allouer une table de hachage vide destinée à associer
+//    les mots à leurs structures word_info, dimensionnée pour recevoir environ
+//    capacity mots. Renvoie NULL en cas de dépassement de capacité.
+static word_table *words_empty(size_t capacity);
+
+//  set_delims : affecte à delim[c], pour tout caractère c, le fait que c
+//    sépare les mots selon les options pointées par p. La classification est
+//    celle de la localisation « C », quelle que soit la catégorie LC_CTYPE
+//    courante.
+static void set_delims(bool delim[static UCHAR_MAX + 1], const options *p);
+
+//  dispose_words : libère les structures word_info, allouées selon les options
+//    pointées par p, référencées par le fourretout associé à *hasptr, les
+//    copies de mots de l'arène ar, puis la table de hachage associée à *htptr
+//    et le fourretout. Chacun des deux contrôleurs peut valoir NULL.
+static void dispose_words(const options *p, word_table **htptr,
+    holdall **hasptr, arena *ar);
+
+//  read_file : lit le fichier f, d'indice ct->nfile, et compte ses mots. Si le
+//    fichier est compressé, il est lu par read_compressed. Si le fichier peut
+//    être projeté en mémoire, les mots mémorisés désignent directement la
+//    projection, qui est alors ajoutée au fourretout maps et demeure jusqu'à
+//    la fin. Sinon, le fichier est lu par blocs dans le buffer buf de longueur
+//    bufsize. Renvoie XWC_SUCCESS en cas de succès, un code d'erreur sinon.
+static int read_file(counter *ct, FILE *f, holdall *maps, char *buf,
+    size_t bufsize);
+
+//  read_compressed : même spécification que read_file pour le fichier f
+//    compressé au format format du module zpipe, décompressé par un fil
+//    d'exécution dédié pendant que ses mots sont comptés. Renvoie
+//    XWC_ERR_DECOMPRESS si le format n'est pas pris en charge ou si les
+//    données compressées ne peuvent être décompressées.
+static int read_compressed(counter *ct, FILE *f, int format);
+
+//  scan_block : découpe en mots les n octets pointés par buf et les compte. Le
+//    dernier mot du bloc est conservé dans ct->sb s'il peut se poursuivre dans
+//    le bloc suivant. Si stable est vrai, les octets restent valides jusqu'à la
+//    fin du comptage et les mots mémorisés peuvent les désigner directement ;
+//    le bloc constitue alors la totalité du contenu du fichier.
+//    Renvoie XWC_SUCCESS en cas de succès, un code d'erreur sinon.
+static int scan_block(counter *ct, const char *buf, size_t n, bool stable);
+
+//  scan_block_tpl : même fonction que scan_block, les paramètres punct, capped,
+//    utf8 et fold valant respectivement ct->p->punct, ct->p->init != 0,
+//    ct->p->utf8 et ct->p->fold. La fonction est destinée à être développée en
+//    ligne avec des valeurs constantes de ces paramètres : les tests qui en
+//    dépendent disparaissent alors de la boucle de découpage. Si utf8 est
+//    vrai, les n octets sont supposés ne pas se terminer par un codage
+//    incomplet.
+static inline int scan_block_tpl(counter *ct, const char *buf, size_t n,
+    bool stable, bool punct, bool capped, bool utf8, bool fold);
+
+//  char_at : renvoie la longueur du caractère qui débute à l'adresse q, avant
+//    end, et affecte à *delimptr le fait qu'il sépare les mots, selon les
+//    mêmes significations de punct et utf8 que pour scan_block_tpl. Si fold
+//    est vrai et que le caractère change par pliage de casse, affecte true à
+//    *upperptr.
+static inline size_t char_at(const counter *ct, const char *q,
+    const char *end, bool punct, bool utf8, bool fold, bool *delimptr,
+    bool *upperptr);
+
+//  fold_word : plie la casse des len octets pointés par *wptr, selon la même
+//    signification de utf8 que pour scan_block_tpl, dans le tableau fold de
+//    ct, puis affecte à *wptr l'adresse du mot plié. Le lot de ct est
+//    préalablement compté si le tableau ne peut plus recevoir le mot.
+//    Renvoie XWC_SUCCESS en cas de succès, un code d'erreur sinon.
+static int fold_word(counter *ct, const char **wptr, size_t len, bool utf8);
+
+//  fold_span : écrit à l'adresse dst les n octets pointés par src après
+//    pliage de leur casse, selon la même signification de utf8 que pour
+//    scan_block_tpl. Les lettres ASCII sont traitées par paquets de SWAR_LEN
+//    octets.
+static void fold_span(char *dst, const char *src, size_t n, bool utf8);
+
+//  scan_variant : renvoie la variante de scan_block, développement de
+//    scan_block_tpl, qui correspond aux options pointées par p.
+static int (*scan_variant(const options *p))(counter *, const char *, size_t,
+    bool);
+
+//  scan_end : compte le mot éventuellement conservé dans ct->sb à la fin de la
+//    lecture d'un fichier. Renvoie XWC_SUCCESS en cas de succès, un code
+//    d'erreur sinon.
+static int scan_end(counter *ct);
+
+//  emit_word : compte le mot w de longueur len, coupé si cut est vrai, selon la
+//    même signification de stable que pour scan_block. Renvoie XWC_SUCCESS en
+//    cas de succès, un code d'erreur sinon.
+static int emit_word(counter *ct, const char *w, size_t len, bool stable,
+    bool cut);
+
+//  note_word : prend en compte dans les compteurs de lecture de ct le mot w de
+//    longueur len et le signale à la fonction cut des options s'il est coupé,
+//    ce qu'indique cut.
+static void note_word(counter *ct, const char *w, size_t len, bool cut);
+
+//  batch_word : ajoute le mot w de longueur len, coupé si cut est vrai, au lot
+//    de ct, puis compte les mots du lot s'il est plein. Les octets du mot
+//    doivent rester valides jusqu'au comptage. Renvoie XWC_SUCCESS en cas de
+//    succès, un code d'erreur sinon.
+static int batch_word(counter *ct, const char *w, size_t len, bool stable,
+    bool cut);
+
+//  flush_batch : compte, dans leur ordre d'ajout, les mots du lot de ct, après
+//    avoir demandé le chargement anticipé des données de la table de hachage
+//    qui les concernent ou les avoir recherchés ensemble dans l'arbre, puis
+//    vide le lot et le tableau fold de ct. Renvoie XWC_SUCCESS en cas de
+//    succès, un code d'erreur sinon.
+static int flush_batch(counter *ct);
+
+//  new_word_info : tente d'allouer une structure word_info pour le mot w de
+//    longueur len lu dans le fichier courant, copié dans ct->ar si stable est
+//    faux. Renvoie NULL en cas de dépassement de capacité.
+static word_info *new_word_info(counter *ct, const char *w, size_t len,
+    bool stable);
+
+//  word_info_seen : met à jour *wi selon les règles du comptage exclusif pour
+//    une occurrence de son mot dans le fichier d'indice nfile. Un mot apparu
+//    dans deux fichiers distincts reste disqualifié quel que soit l'ordre de
+//    lecture.
+static void word_info_seen(word_info *wi, size_t nfile);
+
+//  word_sets_seen : met à jour *ws pour une occurrence de son mot dans le
+//    fichier courant de ct, avec l'option membership. Renvoie XWC_SUCCESS en
+//    cas de succès, un code d'erreur sinon.
+static int word_sets_seen(counter *ct, word_sets *ws);
+
+//  word_seen : met à jour *wi pour une occurrence de son mot dans le fichier
+//    courant de ct, par word_sets_seen avec l'option membership, par
+//    word_info_seen sinon. Renvoie XWC_SUCCESS en cas de succès, un code
+//    d'erreur sinon.
+static inline int word_seen(counter *ct, word_info *wi);
+
+//  add_word_info, update_word_info : fonctions de création et de mise à jour
+//    des structures word_info passées à chashtable_add_or_update.
+static word_info *add_word_info(shared_count *sc, const word **keyrefptr);
+static void update_word_info(shared_count *sc, word_info *wi);
+
+//  count_word : met à jour la table de hachage avec le mot w de longueur len
+//    lu dans le fichier courant, selon les règles du comptage exclusif et la
+//    même signification de stable que pour scan_block. Renvoie XWC_SUCCESS
+//    en cas de succès, un code d'erreur sinon.
+static int count_word(counter *ct, const char *w, size_t len, bool stable);
+
+//  count_word_tree : même fonction que count_word, dans le cas où les mots sont
+//    mémorisés par l'arbre ct->tree.
+static int count_word_tree(counter *ct, const char *w, size_t len,
+    bool stable);
+
+//  count_word_sketched : même fonction que count_word, en mode approché.
+static int count_word_sketched(counter *ct, const char *w, size_t len);
+
+//  count_word_hashed : même fonction que count_word, dans le cas où le
+//    comptage n'est pas partagé, h étant la valeur de pré-hachage du mot pour
+//    ct->ht. Si la table est vidée dans les partitions, h est recalculé pour
+//    la nouvelle table.
+static int count_word_hashed(counter *ct, const char *w, size_t len,
+    bool stable, size_t h);
+
+//  flush_words : écrit dans les partitions de ct->parts, créées au besoin, les
+//    n-uplets de tous les mots mémorisés puis vide la table de hachage, le
+//    fourretout et l'arène. Renvoie XWC_SUCCESS en cas de succès, un code
+//    d'erreur sinon.
+static int flush_words(counter *ct);
+
+//  spill_words : écrit dans la partition qui lui revient de sp le n-uplet
+//    (mot, fichier, nombre d'occurrences) de chacun des mots de has. Renvoie
+//    une valeur non nulle en cas d'erreur d'écriture, zéro sinon.
+static int spill_words(spill *sp, holdall *has);
+
+//  load_partition : tente d'ajouter à ct->ht et ct->has les mots des n-uplets
+//    de la partition d'indice part de sp en cumulant leurs nombres
+//    d'occurrences selon les règles du comptage exclusif. Si la mémoire est
+//    limitée, échoue dès que la limite est dépassée. Renvoie XWC_SUCCESS en
+//    cas de succès, un code d'erreur sinon.
+static int load_partition(counter *ct, spill *sp, size_t part);
+
+//  rspill_word_info : écrit dans sp le n-uplet (w, wi->file, wi->occ). Renvoie
+//    une valeur non nulle en cas d'erreur d'écriture, zéro sinon.
+static int rspill_word_info(spill *sp, word *w, word_info *wi);
+
+//  rrun_word_info : si wi->occ est non nul, écrit le n-uplet (w, wi->file,
+//    wi->occ) à la fin de la partition désignée par rc. Renvoie une valeur non
+//    nulle en cas d'erreur d'écriture, zéro sinon.
+static int rrun_word_info(run_context *rc, word *w, word_info *wi);
+
+//  remit_word_info : cumule dans *em->ws la catégorie du mot décrit par wi
+//    puis, si wi->occ est non nul, renvoie la valeur de l'appel de em->fun
+//    pour le mot w. Renvoie sinon 0. Avec l'option membership, renvoie la
+//    valeur de remit_word_sets.
+static int remit_word_info(emitter *em, word *w, word_info *wi);
+
+//  remit_word_sets : cumule dans *em->ws la catégorie du mot décrit par ws
+//    puis renvoie la valeur de l'appel de em->sfun pour le mot w s'il est
+//    retenu ou, en l'absence de em->sfun, de em->fun s'il est exclusif.
+//    Renvoie sinon 0.
+static int remit_word_sets(emitter *em, word *w, word_sets *ws);
+
+//  remit_tree_word_info : même fonction que remit_word_info pour le mot de wi,
+//    à l'usage de art_apply.
+static int remit_tree_word_info(emitter *em, word_info *wi);
+
+//  remit_tuple : renvoie la valeur de l'appel de em->fun pour le mot w, terminé
+//    par '\0', le fichier d'indice file et le nombre d'occurrences occ. Si la
+//    valeur n'est pas nulle, affecte true à em->stopped.
+static int remit_tuple(emitter *em, const char *w, size_t file, long int occ);
+
+//  rsketch_word : si l'esquisse de sc prouve l'exclusivité du mot s de
+//    longueur len et de valeur de hachage hash, l'ajoute au fourretout de
+//    sc->ct avec le nombre d'occurrences count. Le cumule sinon dans les
+//    mots disqualifiés. Renvoie une valeur non nulle en cas de dépassement de
+//    capacité, zéro sinon.
+static int rsketch_word(sketch_context *sc, const char *s, size_t len,
+    uint64_t hash, size_t count, size_t err);
+
+//  rcount_word_info : incrémente le compteur de *ws correspondant à la
+//    catégorie du mot décrit par wi et retourne 0.
+static int rcount_word_info(words_stats *ws, word *w, word_info *wi);
+
+//  free_word_info : libère la structure word_info pointée par wi, allouée
+//    selon les options pointées par p.
+static void free_word_info(const options *p, word_info *wi);
+
+//  rfree_word_info, rcfree_word_info : libèrent par free_word_info la
+//    structure pointée par wi et retournent 0.
+static int rfree_word_info(const options *p, word *w, word_info *wi);
+static int rcfree_word_info(const options *p, word_info *wi);
+
+//  rmunmap : libère la projection associée à mf et retourne 0.
+static int rmunmap(mfile *mf);
+
+//  collate_init : prépare les comparaisons de mots selon la catégorie
+//    LC_COLLATE de la locale courante pour des mots de longueur au plus maxlen.
+//    Renvoie une valeur non nulle en cas de dépassement de capacité, zéro
+//    sinon.
+static int collate_init(size_t maxlen);
+
+//  collate_is_bytewise : renvoie vrai si, d'après le dernier appel à
+//    collate_init, les mots sont comparés octet par octet, faux sinon.
+static bool collate_is_bytewise(void);
+
+//  collate_dispose : libère les ressources allouées par collate_init.
+static void collate_dispose(void);
+
+//  word_strcoll, rev_word_strcoll : renvoient respectivement le résultat de la
+//    comparaison par strcoll des mots pointés par w1 et w2 et son inverse.
+//    collate_init doit avoir été appelée pour une longueur suffisante.
+static int word_strcoll(const word *w1, const word *w2);
+static int rev_word_strcoll(const word *w1, const word *w2);
+
+//  str_collate, rev_str_collate : renvoient respectivement le résultat de la
+//    comparaison par strcoll des chaînes s1 et s2 et son inverse.
+static int str_collate(const char *s1, const char *s2);
+static int rev_str_collate(const char *s1, const char *s2);
+
+//  mem_total : renvoie le nombre total d'octets alloués pour la gestion des
+//    structures de *ct et des objets qu'elles référencent, y compris la table
+//    partagée et les arènes et buffers des autres fils d'exécution. Les
+//    projections en mémoire des fichiers ne sont pas décomptées.
+static size_t mem_total(const counter *ct);
+
+//- INTERFACE ------------------------------------------------------------------
+
+void xwc_options_init(struct xwc_options *opts) {
+  *opts = (struct xwc_options) {
+    .punct = false,
+    .init = 0,
+    .utf8 = false,
+    .fold = false,
+    .restricted = false,
+    .dictionary = XWC_HASHTABLE,
+    .max_memory = 0,
+    .spill_dir = NULL,
+    .spill_nparts = XWC_SPILL_NPARTS_DEF,
+    .nthreads = 1,
+    .expected = 0,
+    .stats = false,
+    .sketch = 0,
+    .sketch_cells = XWC_SKETCH_CELLS_DEF,
+    .membership = false,
+    .huge_pages = XWC_HUGE_PAGES_DEF,
+    .cut_context = NULL,
+    .cut = NULL
+  };
+}
+
+xwc *xwc_create(const struct xwc_options *opts) {
+  if (opts->nthreads == 0 || opts->spill_nparts == 0
+      || (opts->nthreads > 1 && opts->max_memory != 0)
+      || (opts->dictionary == XWC_RADIX_TREE
+      && (opts->nthreads > 1 || opts->max_memory != 0))
+      || (opts->sketch != 0 && (opts->nthreads > 1 || opts->max_memory != 0
+      || opts->dictionary == XWC_RADIX_TREE || opts->restricted))
+      || (opts->membership && (opts->max_memory != 0 || opts->sketch != 0))) {
+    return NULL;
+  }
+  pthread_once(&hash_key_once, hash_key_init);
+  hugemem_set_threshold(opts->huge_pages);
+  xwc *x = malloc(sizeof *x);
+  if (x == NULL) {
+    return NULL;
+  }
+  x->p = *opts;
+  x->cht = NULL;
+  x->maps = holdall_empty();
+  x->buf = malloc(READ_BUFSIZE);
+  x->kept = 0;
+  x->open = false;
+  x->fed = false;
+  x->q.jobs = NULL;
+  x->q.njobs = 0;
+  atomic_init(&x->q.next, 0);
+  atomic_init(&x->q.stop, false);
+  x->jobscap = 0;
+  x->workers = NULL;
+  x->nworkers = 0;
+  x->files = NULL;
+  x->nfiles = 0;
+  x->runs = NULL;
+  x->drained = false;
+  x->errindex = 0;
+  x->ws = (words_stats) { 0, 0, 0, 0 };
+  x->ndistinct = 0;
+  x->qbuf = NULL;
+  x->qcap = 0;
+  x->occs = NULL;
+  x->occscap = 0;
+  x->own = NULL;
+  x->tops = NULL;
+  x->ntops = 0;
+  if (x->p.sketch != 0) {
+    size_t width = x->p.sketch_cells / SKETCH_DEPTH;
+    x->own = owners_empty(width == 0 ? 1 : width, SKETCH_DEPTH);
+  }
+  if (x->p.nthreads > 1) {
+    x->cht = chashtable_empty((int (*)(const void *, const void *))word_compar,
+        (size_t (*)(const void *))str_hashfun,
+        x->p.nthreads * SHARDS_PER_THREAD, x->p.expected);
+  }
+  if (counter_init(&x->ct, &x->p, x->cht, x->p.expected) != 0
+      || x->maps == NULL || x->buf == NULL
+      || (x->p.nthreads > 1 && x->cht == NULL)
+      || (x->p.sketch != 0 && x->own == NULL)) {
+    xwc_dispose(&x);
+    return NULL;
+  }
+  x->ct.own = x->own;
+  return x;
+}
+
+void xwc_dispose(xwc **xptr) {
+  if (*xptr == NULL) {
+    return;
+  }
+  xwc *x = *xptr;
+  counter_dispose(&x->ct);
+  if (x->cht != NULL) {
+    chashtable_apply(x->cht, (void *) &x->p,
+        (int (*)(void *, void *))rcfree_word_info);
+    chashtable_dispose(&x->cht);
+  }
+  if (x->workers != NULL) {
+    for (size_t k = 0; k < x->nworkers; ++k) {
+      counter_dispose(&x->workers[k].ct);
+      if (x->workers[k].maps != NULL) {
+        holdall_apply(x->workers[k].maps, (int (*)(void *))rmunmap);
+        holdall_dispose(&x->workers[k].maps);
+      }
+      free(x->workers[k].buf);
+    }
+    free(x->workers);
+  }
+  for (size_t k = 0; k < x->q.njobs; ++k) {
+    free(x->q.jobs[k].fname);
+  }
+  free(x->q.jobs);
+  collate_dispose();
+  if (x->maps != NULL) {
+    holdall_apply(x->maps, (int (*)(void *))rmunmap);
+    holdall_dispose(&x->maps);
+  }
+  free(x->buf);
+  free(x->files);
+  free(x->qbuf);
+  free(x->occs);
+  for (size_t k = 0; k < x->ntops; ++k) {
+    topk_dispose(&x->tops[k]);
+  }
+  free(x->tops);
+  owners_dispose(&x->own);
+  spill_dispose(&x->runs);
+  free(x);
+  *xptr = NULL;
+}
+
+int xwc_feed(xwc *x, size_t file, const void *buf, size_t n) {
+  chrono t = { 0.0, 0.0 };
+  if (x->p.stats) {
+    t = chrono_now();
+  }
+  int r = file_begin(x, file);
+  if (r != XWC_SUCCESS) {
+    return r;
+  }
+  counter *ct = &x->ct;
+  ct->rs.bytes += n;
+  if (!x->p.utf8) {
+    r = scan_block(ct, buf, n, false);
+  } else {
+    //  Les octets sont recopiés par blocs dans x->buf : les x->kept derniers
+    //    octets d'un bloc, qui débutent un codage incomplet, sont reportés en
+    //    tête du bloc suivant, éventuellement fourni par l'appel suivant.
+    const char *s = buf;
+    while (r == XWC_SUCCESS && n != 0) {
+      size_t k = READ_BUFSIZE - x->kept;
+      k = (k < n ? k : n);
+      memcpy(x->buf + x->kept, s, k);
+      s += k;
+      n -= k;
+      k += x->kept;
+      x->kept = utf8_incomplete_tail(x->buf, k);
+      r = scan_block(ct, x->buf, k - x->kept, false);
+      memmove(x->buf, x->buf + k - x->kept, x->kept);
+    }
+  }
+  if (r != XWC_SUCCESS) {
+    x->open = false;
+    x->errindex = file;
+    return r;
+  }
+  file_time(x, file, t);
+  return XWC_SUCCESS;
+}
+
+int xwc_feed_stream(xwc *x, size_t file, FILE *f) {
+  chrono t = { 0.0, 0.0 };
+  if (x->p.stats) {
+    t = chrono_now();
+  }
+  int r = file_end(x);
+  if (r != XWC_SUCCESS) {
+    return r;
+  }
+  r = file_begin(x, file);
+  if (r != XWC_SUCCESS) {
+    return r;
+  }
+  r = read_file(&x->ct, f, x->maps, x->buf, READ_BUFSIZE);
+  if (r != XWC_SUCCESS) {
+    x->open = false;
+    x->errindex = file;
+    return r;
+  }
+  r = file_end(x);
+  if (r != XWC_SUCCESS) {
+    return r;
+  }
+  file_time(x, file, t);
+  return XWC_SUCCESS;
+}
+
+int xwc_feed_path(xwc *x, size_t file, const char *fname) {
+  int r = file_end(x);
+  if (r != XWC_SUCCESS) {
+    return r;
+  }
+  if (x->cht != NULL && x->workers == NULL && file != XWC_RESTRICT_FILE) {
+    //  Lecture confiée aux fils d'exécution.
+    if (x->drained) {
+      return XWC_ERR_STATE;
+    }
+    if (x->q.njobs == x->jobscap) {
+      size_t cap = (x->jobscap == 0 ? 8 : 2 * x->jobscap);
+      if (cap > SIZE_MAX / sizeof *x->q.jobs) {
+        return XWC_ERR_CAPACITY;
+      }
+      job *a = realloc(x->q.jobs, cap * sizeof *a);
+      if (a == NULL) {
+        return XWC_ERR_CAPACITY;
+      }
+      x->q.jobs = a;
+      x->jobscap = cap;
+    }
+    size_t len = strlen(fname);
+    char *s = malloc(len + 1);
+    if (s == NULL) {
+      return XWC_ERR_CAPACITY;
+    }
+    memcpy(s, fname, len + 1);
+    x->q.jobs[x->q.njobs] = (job) { s, file, XWC_SUCCESS, { 0, 0, 0, 0 },
+      { 0.0, 0.0 } };
+    x->q.njobs += 1;
+    return XWC_SUCCESS;
+  }
+  FILE *f = fopen(fname, "r");
+  if (f == NULL) {
+    x->errindex = file;
+    return XWC_ERR_READ;
+  }
+  r = xwc_feed_stream(x, file, f);
+  if (fclose(f) != 0 && r == XWC_SUCCESS) {
+    x->errindex = file;
+    r = XWC_ERR_READ;
+  }
+  return r;
+}
+
+int xwc_finish(xwc *x) {
+  int r = file_end(x);
+  if (r != XWC_SUCCESS) {
+    return r;
+  }
+  if (x->q.njobs != 0 && x->workers == NULL) {
+    r = run_jobs(x);
+    if (r != XWC_SUCCESS) {
+      return r;
+    }
+  }
+  if (x->fed) {
+    //  Les mots de la table partagée sont rassemblés dans le fourretout, vidé
+    //    au préalable s'ils l'ont déjà été.
+    x->fed = false;
+    holdall_dispose(&x->ct.has);
+    x->ct.has = holdall_empty();
+    if (x->ct.has == NULL || chashtable_apply(x->cht, x->ct.has,
+        (int (*)(void *, void *))collect_word) != 0) {
+      return XWC_ERR_CAPACITY;
+    }
+  }
+  return XWC_SUCCESS;
+}
+
+int xwc_apply(xwc *x, xwc_order order, void *context,
+    int (*start)(void *context),
+    int (*fun)(void *context, const char *w, size_t len, size_t file,
+      long int occ)) {
+  emitter em = {
+    .context = context,
+    .fun = fun,
+    .sets = x->p.membership
+  };
+  return apply_words(x, order, start, &em);
+}
+
+int xwc_apply_sets(xwc *x, xwc_order order, size_t min_files,
+    size_t max_files, void *context, int (*start)(void *context),
+    int (*fun)(void *context, const char *w, size_t len,
+      const struct xwc_occ *occs, size_t n)) {
+  if (!x->p.membership) {
+    return XWC_ERR_STATE;
+  }
+  emitter em = {
+    .context = context,
+    .sfun = fun,
+    .min_files = min_files,
+    .max_files = max_files,
+    .sets = true
+  };
+  return apply_words(x, order, start, &em);
+}
+
+int apply_words(xwc *x, xwc_order order, int (*start)(void *context),
+    emitter *em) {
+  if (x->drained) {
+    return XWC_ERR_STATE;
+  }
+  int r = xwc_finish(x);
+  if (r != XWC_SUCCESS) {
+    return r;
+  }
+  counter *ct = &x->ct;
+  x->ws = (words_stats) { 0, 0, 0, 0 };
+  x->ndistinct = 0;
+  em->ws = &x->ws;
+  em->stopped = false;
+  void *context = em->context;
+  if (em->sfun != NULL) {
+    //  Un mot apparaît au plus dans chacun des fichiers lus, dont le nombre
+    //    remplace XWC_ALL_FILES.
+    size_t nread = 0;
+    for (size_t k = XWC_FIRST_FILE; k < x->nfiles; ++k) {
+      nread += x->files[k].seen;
+    }
+    em->min_files = (em->min_files == XWC_ALL_FILES ? nread : em->min_files);
+    em->max_files = (em->max_files == XWC_ALL_FILES ? nread : em->max_files);
+    if (nread > x->occscap) {
+      struct xwc_occ *a = realloc(x->occs, nread * sizeof *a);
+      if (a == NULL) {
+        return XWC_ERR_CAPACITY;
+      }
+      x->occs = a;
+      x->occscap = nread;
+    }
+    em->occs = x->occs;
+  }
+  if (x->own != NULL) {
+    r = sketch_collect(x);
+    if (r != XWC_SUCCESS) {
+      return r;
+    }
+  }
+  int (*compar)(const word *, const word *)
+    = (order == XWC_ORDER_DESCENDING ? rev_word_strcoll : word_strcoll);
+  if (ct->parts != NULL) {
+    //  Comptage par partition. Si un tri est demandé, les résultats triés de
+    //    chaque partition sont écrits dans la partition de même indice de
+    //    x->runs puis fusionnés.
+    x->drained = true;
+    r = flush_words(ct);
+    if (r != XWC_SUCCESS) {
+      return r;
+    }
+    if (order != XWC_ORDER_NONE) {
+      x->runs = spill_empty(x->p.spill_dir, x->p.spill_nparts);
+      if (x->runs == NULL) {
+        return XWC_ERR_TEMP;
+      }
+    } else if (start != NULL && start(context) != 0) {
+      return XWC_STOPPED;
+    }
+    for (size_t k = 0; k < x->p.spill_nparts; k++) {
+      r = load_partition(ct, ct->parts, k);
+      if (r != XWC_SUCCESS) {
+        x->errindex = k;
+        return r;
+      }
+      x->ndistinct += holdall_count(ct->has);
+      if (x->runs != NULL) {
+        if (collate_init(ct->maxlen) != 0) {
+          return XWC_ERR_CAPACITY;
+        }
+        holdall_apply_context2(ct->has,
+            NULL, (void *(*)(void *, void *))word_info_of, &x->ws,
+            (int (*)(void *, void *, void *))rcount_word_info);
+        holdall_sort(ct->has, (int (*)(const void *, const void *))compar);
+        if (holdall_apply_context2(ct->has,
+            NULL, (void *(*)(void *, void *))word_info_of,
+            &(run_context) { x->runs, k },
+            (int (*)(void *, void *, void *))rrun_word_info) != 0) {
+          return XWC_ERR_SPILL;
+        }
+      } else if (holdall_apply_context2(ct->has,
+          NULL, (void *(*)(void *, void *))word_info_of, em,
+          (int (*)(void *, void *, void *))remit_word_info) != 0) {
+        return XWC_STOPPED;
+      }
+      if (k + 1 < x->p.spill_nparts) {
+        dispose_words(ct->p, &ct->ht, &ct->has, ct->ar);
+        ct->word_info_mem = 0;
+        ct->ht = words_empty(0);
+        ct->has = holdall_empty();
+        if (ct->ht == NULL || ct->has == NULL) {
+          return XWC_ERR_CAPACITY;
+        }
+      }
+    }
+    if (x->runs != NULL) {
+      if (start != NULL && start(context) != 0) {
+        return XWC_STOPPED;
+      }
+      if (spill_merge(x->runs, order == XWC_ORDER_DESCENDING
+          ? rev_str_collate : str_collate, em,
+          (int (*)(void *, const char *, size_t, long int))remit_tuple)
+          != 0) {
+        return em->stopped ? XWC_STOPPED : XWC_ERR_SPILL;
+      }
+    }
+    return XWC_SUCCESS;
+  }
+  //  L'arbre est parcouru dans l'ordre des octets, qui n'est celui du tri que
+  //    si la locale compare les mots octet par octet. Sinon, ses mots sont
+  //    rassemblés dans le fourretout pour y être triés.
+  bool walk = ct->tree != NULL;
+  if (order != XWC_ORDER_NONE) {
+    if (collate_init(ct->maxlen) != 0) {
+      return XWC_ERR_CAPACITY;
+    }
+    if (walk && !collate_is_bytewise()) {
+      holdall_dispose(&ct->has);
+      ct->has = holdall_empty();
+      if (ct->has == NULL || art_apply(ct->tree, false, ct->has,
+          (int (*)(void *, void *))collect_word) != 0) {
+        return XWC_ERR_CAPACITY;
+      }
+      walk = false;
+    }
+    if (!walk) {
+      holdall_sort(ct->has, (int (*)(const void *, const void *))compar);
+    }
+  }
+  if (start != NULL && start(context) != 0) {
+    return XWC_STOPPED;
+  }
+  int s;
+  if (walk) {
+    x->ndistinct = art_count(ct->tree);
+    s = art_apply(ct->tree, order == XWC_ORDER_DESCENDING, em,
+        (int (*)(void *, void *))remit_tree_word_info);
+  } else {
+    //  En mode approché, les mots suivis disqualifiés ont déjà été cumulés par
+    //    sketch_collect ; ils ne le sont sinon que lors du parcours.
+    x->ndistinct = holdall_count(ct->has) + x->ws.disqualified;
+    s = holdall_apply_context2(ct->has,
+        NULL, (void *(*)(void *, void *))word_info_of, em,
+        (int (*)(void *, void *, void *))remit_word_info);
+  }
+  return s != 0 ? XWC_STOPPED : XWC_SUCCESS;
+}
+
+int xwc_query(xwc *x, const char *w, size_t len, size_t *fileptr,
+    long int *occptr) {
+  if (x->ct.parts != NULL || x->own != NULL) {
+    return XWC_ERR_STATE;
+  }
+  int r = xwc_finish(x);
+  if (r != XWC_SUCCESS) {
+    return r;
+  }
+  if (x->p.init != 0) {
+    size_t n = 0;
+    size_t k = 0;
+    while (k < len && n < x->p.init) {
+      uint32_t cp;
+      k += x->p.utf8 ? utf8_decode(w + k, len - k, &cp) : 1;
+      ++n;
+    }
+    len = k;
+  }
+  if (x->p.fold) {
+    if (len > x->qcap) {
+      char *a = realloc(x->qbuf, len);
+      if (a == NULL) {
+        return XWC_ERR_CAPACITY;
+      }
+      x->qbuf = a;
+      x->qcap = len;
+    }
+    fold_span(x->qbuf, w, len, x->p.utf8);
+    w = x->qbuf;
+  }
+  word_info *wi;
+  if (x->cht != NULL) {
+    wi = chashtable_search(x->cht, &(word) { w, len });
+  } else if (x->ct.tree != NULL) {
+    wi = art_search(x->ct.tree, w, len);
+  } else {
+    wi = word_table_search(x->ct.ht, &(word) { w, len });
+  }
+  *occptr = 0;
+  if (wi != NULL && wi->occ != 0
+      && (!x->p.membership || ((word_sets *) wi)->fs == NULL)) {
+    *fileptr = wi->file;
+    *occptr = wi->occ;
+  }
+  return XWC_SUCCESS;
+}
+
+size_t xwc_error_index(const xwc *x) {
+  return x->errindex;
+}
+
+size_t xwc_estimate_words(const struct xwc_options *opts,
+    const char *const *fnames, size_t nfnames) {
+  size_t total = 0;
+  for (size_t k = 0; k < nfnames; ++k) {
+    struct stat st;
+    if (stat(fnames[k], &st) != 0 || !S_ISREG(st.st_mode)) {
+      return 0;
+    }
+    //  La taille d'un fichier compressé ne dit rien du nombre de ses mots.
+    FILE *f = fopen(fnames[k], "r");
+    if (f == NULL) {
+      return 0;
+    }
+    int format = zpipe_format(fileno(f));
+    fclose(f);
+    if (format != ZPIPE_PLAIN) {
+      return 0;
+    }
+    total += (size_t) st.st_size;
+  }
+  if (total == 0) {
+    return 0;
+  }
+  size_t r = 0;
+  bool delim[UCHAR_MAX + 1];
+  set_delims(delim, opts);
+  hll *h = hll_empty(ESTIMATE_LBNREGS);
+  char *buf = malloc(READ_BUFSIZE);
+  if (h == NULL || buf == NULL) {
+    goto dispose;
+  }
+  //  Le mot en cours, limité à ses opts->init premiers caractères, est haché
+  //    au fil de la lecture par l'une des fonctions de pré-hachage conseillées
+  //    par Kernighan et Pike : un mot à cheval sur deux blocs ne demande ainsi
+  //    aucune copie. Une entrée conçue pour que ses mots entrent en collision
+  //    ne fausse que l'estimation, jamais le comptage.
+  size_t sample = (total < ESTIMATE_SAMPLE ? total : ESTIMATE_SAMPLE);
+  size_t nread = 0;
+  size_t ntokens = 0;
+  size_t ntokens_half = 0;
+  double ndistinct_half = 0.0;
+  size_t wh = 0;
+  size_t wlen = 0;
+  for (size_t k = 0; k < nfnames && nread < sample; ++k) {
+    FILE *f = fopen(fnames[k], "r");
+    if (f == NULL) {
+      goto dispose;
+    }
+    while (nread < sample) {
+      size_t n = sample - nread;
+      n = fread(buf, 1, n < READ_BUFSIZE ? n : READ_BUFSIZE, f);
+      if (n == 0) {
+        break;
+      }
+      for (size_t j = 0; j < n; ++j) {
+        unsigned char c = (unsigned char) buf[j];
+        if (!delim[c]) {
+          if (opts->init == 0 || wlen < opts->init) {
+            wh = 37 * wh + c;
+          }
+          wlen += 1;
+        } else if (wlen != 0) {
+          hll_add(h, wh);
+          ntokens += 1;
+          wh = 0;
+          wlen = 0;
+        }
+      }
+      nread += n;
+      if (ntokens_half == 0 && nread >= sample / 2) {
+        ntokens_half = ntokens;
+        ndistinct_half = hll_count(h);
+      }
+    }
+    fclose(f);
+    if (wlen != 0) {
+      hll_add(h, wh);
+      ntokens += 1;
+      wh = 0;
+      wlen = 0;
+    }
+  }
+  double ndistinct = hll_count(h);
+  if (nread >= total || ntokens_half == 0 || ntokens == ntokens_half
+      || ndistinct_half < 1.0) {
+    r = (size_t) ndistinct;
+    goto dispose;
+  }
+  //  Loi de Heaps : le nombre de mots distincts croît comme la puissance beta
+  //    du nombre de mots ; beta est mesuré entre la moitié et la fin de
+  //    l'échantillon.
+  double beta = log(ndistinct / ndistinct_half)
+    / log((double) ntokens / (double) ntokens_half);
+  beta = (beta < 0.0 ? 0.0 : beta > 1.0 ? 1.0 : beta);
+  double scale = (double) total / (double) nread;
+  double e = ndistinct * pow(scale, beta);
+  double emax = (double) ntokens * scale;
+  r = (size_t) (e < emax ? e : emax);
+dispose:
+  free(buf);
+  hll_dispose(&h);
+  return r;
+}
+
+int xwc_get_file_stats(const xwc *x, size_t file,
+    struct xwc_file_stats *fsptr) {
+  if (file >= x->nfiles || !x->files[file].seen) {
+    return -1;
+  }
+  *fsptr = x->files[file].fs;
+  if (file < x->ntops && x->tops[file] != NULL) {
+    fsptr->sketch_error = topk_min(x->tops[file]);
+  }
+  return 0;
+}
+
+void xwc_get_stats(const xwc *x, struct xwc_stats *stsptr) {
+  const counter *ct = &x->ct;
+  *stsptr = (struct xwc_stats) { 0 };
+  for (size_t k = 0; k < x->nfiles; ++k) {
+    stsptr->read.bytes += x->files[k].fs.bytes;
+    stsptr->read.mapped += x->files[k].fs.mapped;
+    stsptr->read.compressed += x->files[k].fs.compressed;
+    stsptr->read.tokens += x->files[k].fs.tokens;
+  }
+  stsptr->words.distinct = x->ndistinct;
+  stsptr->words.exclusive = x->ws.exclusive;
+  stsptr->words.disqualified = x->ws.disqualified;
+  stsptr->words.unseen = x->ws.unseen;
+  stsptr->words.selected = x->ws.selected;
+  stsptr->words.zero_copy = ct->nmapped;
+  stsptr->words.copied = ct->ncopied;
+  stsptr->threads = (x->nworkers == 0 ? 1 : x->nworkers);
+  struct hashtable_stats hts = { 0 };
+  struct hashtable_ext_stats htes = { 0 };
+  if (x->cht != NULL) {
+    chashtable_get_stats(x->cht, &hts, &htes);
+  } else if (ct->ht != NULL) {
+    word_table_get_stats(ct->ht, &hts);
+    word_table_get_ext_stats(ct->ht, &htes);
+  }
+  stsptr->hashtable.nslots = hts.nslots;
+  stsptr->hashtable.nentries = hts.nentries;
+  stsptr->hashtable.ldfactmax = hts.ldfactmax;
+  stsptr->hashtable.ldfactcurr = hts.ldfactcurr;
+  stsptr->hashtable.maxlen = hts.maxlen;
+  stsptr->hashtable.postheo = hts.postheo;
+  stsptr->hashtable.poscurr = hts.poscurr;
+  stsptr->hashtable.nresizes = htes.nresizes;
+  stsptr->hashtable.nreseeds = htes.nreseeds;
+  if (ct->tree != NULL) {
+    struct art_stats arts;
+    art_get_stats(ct->tree, &arts);
+    stsptr->art.used = true;
+    memcpy(stsptr->art.nnodes, arts.nnodes, sizeof arts.nnodes);
+    stsptr->art.height = arts.height;
+    stsptr->art.prefix = arts.prefix;
+  }
+  if (ct->parts != NULL) {
+    stsptr->spill.used = true;
+    stsptr->spill.partitions = spill_nparts(ct->parts);
+    stsptr->spill.flushes = ct->nflushes;
+    stsptr->spill.tuples = spill_count(ct->parts);
+    stsptr->spill.bytes = spill_bytes(ct->parts)
+      + (x->runs == NULL ? 0 : spill_bytes(x->runs));
+  }
+  if (x->own != NULL) {
+    size_t width = x->p.sketch_cells / SKETCH_DEPTH;
+    stsptr->sketch.used = true;
+    stsptr->sketch.capacity = x->p.sketch;
+    stsptr->sketch.cells = (width == 0 ? 1 : width) * SKETCH_DEPTH;
+    stsptr->sketch.depth = SKETCH_DEPTH;
+    stsptr->sketch.shared = owners_shared(x->own);
+    stsptr->sketch.miss = pow(stsptr->sketch.shared, SKETCH_DEPTH);
+  }
+  struct hugemem_stats hms;
+  hugemem_get_stats(&hms);
+  stsptr->hugepages.threshold = hms.threshold;
+  stsptr->hugepages.maps = hms.maps;
+  stsptr->hugepages.mapped = hms.mapped;
+  stsptr->hugepages.advised = hms.advised;
+  stsptr->hugepages.fallbacks = hms.fallbacks;
+  stsptr->hugepages.thp = hms.thp;
+  stsptr->hugepages.mode = hms.mode;
+}
+
+void xwc_get_memory(const xwc *x, struct xwc_memory *memptr) {
+  const counter *ct = &x->ct;
+  size_t slots = 0;
+  size_t cells = 0;
+  if (ct->ht != NULL) {
+    word_table_memory(ct->ht, &slots, &cells);
+  } else if (ct->cht != NULL) {
+    chashtable_memory(ct->cht, &slots, &cells);
+  }
+  size_t sketch = 0;
+  if (x->own != NULL) {
+    sketch = owners_memory(x->own) + x->ntops * sizeof *x->tops;
+    for (size_t k = 0; k < x->ntops; ++k) {
+      sketch += (x->tops[k] == NULL ? 0 : topk_memory(x->tops[k]));
+    }
+  }
+  *memptr = (struct xwc_memory) {
+    .strings = (ct->ar == NULL ? 0 : arena_memory(ct->ar)),
+    .word_info = ct->word_info_mem,
+    .slots = slots,
+    .cells = cells,
+    .art = (ct->tree == NULL ? 0 : art_memory(ct->tree)),
+    .holdall = (ct->has == NULL ? 0 : holdall_memory(ct->has)),
+    .sbuffer = (ct->sb == NULL ? 0 : sbuffer_memory(ct->sb)),
+    .fold = ct->foldcap,
+    .threads = ct->peers_mem,
+    .sketch = sketch,
+    .total = mem_total(ct) + sketch,
+    .limit = x->p.max_memory
+  };
+}
+
+//- FICHIERS -------------------------------------------------------------------
+
+void hash_key_init(void) {
+  siphash_key_random(hash_key);
+}
+
+file_entry *file_entry_of(xwc *x, size_t file) {
+  if (file >= x->nfiles) {
+    size_t n = (file < 2 * x->nfiles ? 2 * x->nfiles : file + 1);
+    if (n > SIZE_MAX / sizeof *x->files) {
+      return NULL;
+    }
+    file_entry *a = realloc(x->files, n * sizeof *a);
+    if (a == NULL) {
+      return NULL;
+    }
+    memset(a + x->nfiles, 0, (n - x->nfiles) * sizeof *a);
+    x->files = a;
+    x->nfiles = n;
+  }
+  return &x->files[file];
+}
+
+int file_begin(xwc *x, size_t file) {
+  if (x->open && x->ct.nfile == file) {
+    return XWC_SUCCESS;
+  }
+  int r = file_end(x);
+  if (r != XWC_SUCCESS) {
+    return r;
+  }
+  if (x->drained || (file == XWC_RESTRICT_FILE && !x->p.restricted)) {
+    return XWC_ERR_STATE;
+  }
+  if (file == XWC_RESTRICT_FILE) {
+    //  Les mots des autres fichiers ne sont comptés que s'ils figurent déjà
+    //    dans la table : le fichier de restriction doit être lu en premier.
+    if (x->q.njobs != 0) {
+      return XWC_ERR_STATE;
+    }
+    for (size_t k = XWC_FIRST_FILE; k < x->nfiles; ++k) {
+      if (x->files[k].seen) {
+        return XWC_ERR_STATE;
+      }
+    }
+  }
+  file_entry *fe = file_entry_of(x, file);
+  if (fe == NULL) {
+    return XWC_ERR_CAPACITY;
+  }
+  counter *ct = &x->ct;
+  if (x->own != NULL) {
+    if (file > OWNERS_FILE_MAX) {
+      return XWC_ERR_CAPACITY;
+    }
+    ct->top = sketch_of(x, file);
+    if (ct->top == NULL) {
+      return XWC_ERR_CAPACITY;
+    }
+  }
+  fe->seen = true;
+  ct->nfile = file;
+  ct->skip = false;
+  ct->rs = (read_stats) { 0, 0, 0, 0 };
+  sbuffer_clear(ct->sb);
+  x->kept = 0;
+  x->open = true;
+  x->fed = x->fed || x->cht != NULL;
+  return XWC_SUCCESS;
+}
+
+int file_end(xwc *x) {
+  if (!x->open) {
+    return XWC_SUCCESS;
+  }
+  x->open = false;
+  counter *ct = &x->ct;
+  int r = XWC_SUCCESS;
+  if (x->kept != 0) {
+    r = scan_block(ct, x->buf, x->kept, false);
+    x->kept = 0;
+  }
+  if (r == XWC_SUCCESS) {
+    r = scan_end(ct);
+  }
+  if (r != XWC_SUCCESS) {
+    x->errindex = ct->nfile;
+    return r;
+  }
+  struct xwc_file_stats *fs = &x->files[ct->nfile].fs;
+  fs->bytes += ct->rs.bytes;
+  fs->mapped += ct->rs.mapped;
+  fs->compressed += ct->rs.compressed;
+  fs->tokens += ct->rs.tokens;
+  ct->rs = (read_stats) { 0, 0, 0, 0 };
+  return XWC_SUCCESS;
+}
+
+void file_time(xwc *x, size_t file, chrono start) {
+  if (x->p.stats) {
+    chrono t = chrono_since(start);
+    x->files[file].fs.wall += t.wall;
+    x->files[file].fs.cpu += t.cpu;
+  }
+}
+
+topk *sketch_of(xwc *x, size_t file) {
+  if (file >= x->ntops) {
+    size_t n = (file < 2 * x->ntops ? 2 * x->ntops : file + 1);
+    if (n > SIZE_MAX / sizeof *x->tops) {
+      return NULL;
+    }
+    topk **a = realloc(x->tops, n * sizeof *a);
+    if (a == NULL) {
+      return NULL;
+    }
+    memset(a + x->ntops, 0, (n - x->ntops) * sizeof *a);
+    x->tops = a;
+    x->ntops = n;
+  }
+  if (x->tops[file] == NULL) {
+    x->tops[file] = topk_empty(x->p.sketch);
+  }
+  return x->tops[file];
+}
+
+int sketch_collect(xwc *x) {
+  //  Les structures word_info désignent les copies des recherches, qui
+  //    demeurent jusqu'à la libération du contexte ; celles d'un parcours
+  //    précédent sont libérées.
+  counter *ct = &x->ct;
+  dispose_words(ct->p, &ct->ht, &ct->has, NULL);
+  ct->has = holdall_empty();
+  if (ct->has == NULL) {
+    return XWC_ERR_CAPACITY;
+  }
+  sketch_context sc = { ct, x->own, 0, &x->ws };
+  for (size_t k = 0; k < x->ntops; ++k) {
+    if (x->tops[k] == NULL) {
+      continue;
+    }
+    sc.file = k;
+    if (topk_apply(x->tops[k], &sc,
+        (int (*)(void *, const char *, size_t, uint64_t, size_t, size_t))
+        rsketch_word) != 0) {
+      return XWC_ERR_CAPACITY;
+    }
+  }
+  return XWC_SUCCESS;
+}
+
+int run_jobs(xwc *x) {
+  job_queue *q = &x->q;
+  x->nworkers = (x->p.nthreads < q->njobs ? x->p.nthreads : q->njobs);
+  x->workers = calloc(x->nworkers, sizeof *x->workers);
+  if (x->workers == NULL) {
+    x->nworkers = 0;
+    return XWC_ERR_CAPACITY;
+  }
+  if (run_workers(x->workers, x->nworkers, q, &x->p, x->cht) != 0) {
+    return XWC_ERR_THREADS;
+  }
+  x->fed = true;
+  counter *ct = &x->ct;
+  for (size_t k = 0; k < x->nworkers; ++k) {
+    counter *wct = &x->workers[k].ct;
+    ct->word_info_mem += wct->word_info_mem;
+    ct->peers_mem += arena_memory(wct->ar) + sbuffer_memory(wct->sb)
+      + wct->foldcap;
+    ct->nmapped += wct->nmapped;
+    ct->ncopied += wct->ncopied;
+    if (wct->maxlen > ct->maxlen) {
+      ct->maxlen = wct->maxlen;
+    }
+  }
+  for (size_t k = 0; k < q->njobs; ++k) {
+    const job *jb = &q->jobs[k];
+    if (jb->r != XWC_SUCCESS) {
+      x->errindex = jb->nfile;
+      return jb->r;
+    }
+    file_entry *fe = file_entry_of(x, jb->nfile);
+    if (fe == NULL) {
+      return XWC_ERR_CAPACITY;
+    }
+    fe->seen = true;
+    fe->fs.bytes += jb->rs.bytes;
+    fe->fs.mapped += jb->rs.mapped;
+    fe->fs.compressed += jb->rs.compressed;
+    fe->fs.tokens += jb->rs.tokens;
+    fe->fs.wall += jb->t.wall;
+    fe->fs.cpu += jb->t.cpu;
+  }
+  return XWC_SUCCESS;
+}
+
+//- COMPTAGE -------------------------------------------------------------------
+
+size_t str_hashfun(const word *w) {
+  return (size_t) siphash(w->s, w->len, hash_key);
+}
+
+int word_compar(const word *w1, const word *w2) {
+  return w1->len != w2->len || memcmp(w1->s, w2->s, w1->len) != 0;
+}
+
+word_info *word_info_of([[maybe_unused]] void *context, word *w) {
+  return (word_info *) w;
+}
+
+const char *word_key(const word_info *wi, size_t *lenptr) {
+  *lenptr = wi->key.len;
+  return wi->key.s;
+}
+
+int counter_init(counter *ct, const options *p, chashtable *cht,
+    size_t capacity) {
+  *ct = (counter) {
+    .p = p,
+    .ht = (cht == NULL && p->dictionary == XWC_HASHTABLE && p->sketch == 0
+        ? words_empty(capacity) : NULL),
+    .cht = cht,
+    .tree = (cht == NULL && p->dictionary == XWC_RADIX_TREE
+        ? art_empty((const char *(*)(const void *, size_t *))word_key)
+        : NULL),
+    .has = holdall_empty(),
+    .ar = arena_empty(),
+    .sb = sbuffer_empty(),
+  };
+  set_delims(ct->delim, p);
+  ct->scan = scan_variant(p);
+  return (ct->ht == NULL && ct->cht == NULL && ct->tree == NULL
+      && p->sketch == 0)
+    || ct->has == NULL
+    || ct->ar == NULL || ct->sb == NULL;
+}
+
+void counter_dispose(counter *ct) {
+  if (ct->tree != NULL) {
+    //  Le fourretout ne référence, au plus, que des structures de l'arbre.
+    art_apply(ct->tree, false, (void *) ct->p,
+        (int (*)(void *, void *))rcfree_word_info);
+    art_dispose(&ct->tree);
+    holdall_dispose(&ct->has);
+  } else if (ct->cht == NULL) {
+    dispose_words(ct->p, &ct->ht, &ct->has, NULL);
+  } else {
+    holdall_dispose(&ct->has);
+  }
+  arena_dispose(&ct->ar);
+  sbuffer_dispose(&ct->sb);
+  free(ct->fold);
+  spill_dispose(&ct->parts);
+}
+
+int run_workers(worker *workers, size_t nworkers, job_queue *q,
+    const options *p, chashtable *cht) {
+  int r = 0;
+  for (size_t k = 0; k < nworkers; ++k) {
+    worker *w = &workers[k];
+    w->q = q;
+    w->maps = holdall_empty();
+    w->buf = malloc(READ_BUFSIZE);
+    if (counter_init(&w->ct, p, cht, 0) != 0 || w->maps == NULL
+        || w->buf == NULL) {
+      r = -1;
+      break;
+    }
+  }
+  for (size_t k = 0; r == 0 && k < nworkers; ++k) {
+    worker *w = &workers[k];
+    if (pthread_create(&w->thread, NULL, (void *(*)(void *))work, w) != 0) {
+      r = -1;
+      break;
+    }
+    w->started = true;
+  }
+  if (r != 0) {
+    atomic_store(&q->stop, true);
+  }
+  for (size_t k = 0; k < nworkers; ++k) {
+    if (workers[k].started) {
+      pthread_join(workers[k].thread, NULL);
+    }
+  }
+  return r;
+}
+
+void *work(worker *w) {
+  counter *ct = &w->ct;
+  job_queue *q = w->q;
+  while (!atomic_load(&q->stop)) {
+    size_t k = atomic_fetch_add(&q->next, 1);
+    if (k >= q->njobs) {
+      break;
+    }
+    job *jb = &q->jobs[k];
+    ct->nfile = jb->nfile;
+    ct->skip = false;
+    ct->rs = (read_stats) { 0, 0, 0, 0 };
+    sbuffer_clear(ct->sb);
+    chrono t = { 0.0, 0.0 };
+    if (ct->p->stats) {
+      t = chrono_now();
+    }
+    FILE *f = fopen(jb->fname, "r");
+    if (f == NULL) {
+      jb->r = XWC_ERR_READ;
+    } else {
+      jb->r = read_file(ct, f, w->maps, w->buf, READ_BUFSIZE);
+      if (fclose(f) != 0 && jb->r == XWC_SUCCESS) {
+        jb->r = XWC_ERR_READ;
+      }
+    }
+    if (ct->p->stats) {
+      jb->t = chrono_since(t);
+    }
+    jb->rs = ct->rs;
+    if (jb->r != XWC_SUCCESS) {
+      atomic_store(&q->stop, true);
+    }
+  }
+  return NULL;
+}
+
+int collect_word(holdall *has, word_info *wi) {
+  return holdall_put(has, &wi->key);
+}
+
+word_table *words_empty(size_t capacity) {
+  return word_table_empty_with_capacity(capacity);
+}
+
+//  IS_C_SPACE, IS_C_PUNCT : valent vrai si l'octet c est respectivement un
+//    caractère d'espacement, un caractère de ponctuation de la localisation
+//    « C ».
+#define IS_C_SPACE(c)                                                          \
+  ((c) == ' ' || (unsigned char) ((c) - '\t') < 5)
+#define IS_C_PUNCT(c)                                                          \
+  ((unsigned char) ((c) - '!') < 0x7F - '!'                                    \
+  && (unsigned char) (((c) | 0x20) - 'a') >= 26                                \
+  && (unsigned char) ((c) - '0') >= 10)
+
+void set_delims(bool delim[static UCHAR_MAX + 1], const options *p) {
+  for (int c = 0; c <= UCHAR_MAX; ++c) {
+    delim[c] = IS_C_SPACE(c) || (p->punct && IS_C_PUNCT(c));
+  }
+}
+
+void dispose_words(const options *p, word_table **htptr, holdall **hasptr,
+    arena *ar) {
+  if (*hasptr != NULL) {
+    holdall_apply_context2(*hasptr,
+        NULL, (void *(*)(void *, void *))word_info_of, (void *) p,
+        (int (*)(void *, void *, void *))rfree_word_info);
+    holdall_dispose(hasptr);
+  }
+  word_table_dispose(htptr);
+  if (ar != NULL) {
+    arena_clear(ar);
+  }
+}
+
+int read_file(counter *ct, FILE *f, holdall *maps, char *buf,
+    size_t bufsize) {
+  //  L'entrée standard n'est jamais projetée : elle peut être lue plusieurs
+  //    fois et sa position courante doit être respectée.
+  if (f != stdin) {
+    int format = zpipe_format(fileno(f));
+    if (format != ZPIPE_PLAIN) {
+      return read_compressed(ct, f, format);
+    }
+    mfile *mf = mfile_map(fileno(f));
+    if (mf != NULL) {
+      if (holdall_put(maps, mf) != 0) {
+        mfile_unmap(&mf);
+        return XWC_ERR_CAPACITY;
+      }
+      ct->rs.bytes += mfile_size(mf);
+      ct->rs.mapped += mfile_size(mf);
+      return scan_block(ct, mfile_data(mf), mfile_size(mf), true);
+    }
+  }
+  //  En UTF-8, les kept derniers octets d'un bloc, qui débutent un codage
+  //    incomplet, sont reportés en tête du bloc suivant.
+  size_t kept = 0;
+  size_t n;
+  while ((n = fread(buf + kept, 1, bufsize - kept, f)) > 0) {
+    ct->rs.bytes += n;
+    n += kept;
+    kept = (ct->p->utf8 ? utf8_incomplete_tail(buf, n) : 0);
+    int r = scan_block(ct, buf, n - kept, false);
+    if (r != XWC_SUCCESS) {
+      return r;
+    }
+    memmove(buf, buf + n - kept, kept);
+  }
+  if (ferror(f)) {
+    return XWC_ERR_READ;
+  }
+  if (kept != 0) {
+    int r = scan_block(ct, buf, kept, false);
+    if (r != XWC_SUCCESS) {
+      return r;
+    }
+  }
+  return scan_end(ct);
+}
+
+int read_compressed(counter *ct, FILE *f, int format) {
+  if (!zpipe_supported(format)) {
+    return XWC_ERR_DECOMPRESS;
+  }
+  zpipe *zp = zpipe_open(f, format);
+  if (zp == NULL) {
+    return XWC_ERR_CAPACITY;
+  }
+  //  En UTF-8, les kept derniers octets d'un buffer, qui débutent un codage
+  //    incomplet, sont recopiés devant le buffer suivant.
+  char tail[ZPIPE_HEADROOM];
+  size_t kept = 0;
+  int r = XWC_SUCCESS;
+  char *s;
+  size_t n;
+  while ((s = zpipe_next(zp, &n)) != NULL) {
+    ct->rs.bytes += n;
+    s -= kept;
+    memcpy(s, tail, kept);
+    n += kept;
+    kept = (ct->p->utf8 ? utf8_incomplete_tail(s, n) : 0);
+    r = scan_block(ct, s, n - kept, false);
+    if (r != XWC_SUCCESS) {
+      break;
+    }
+    memcpy(tail, s + n - kept, kept);
+  }
+  ct->rs.compressed += zpipe_in(zp);
+  if (zpipe_close(&zp) != 0 && r == XWC_SUCCESS) {
+    r = XWC_ERR_DECOMPRESS;
+  }
+  if (r == XWC_SUCCESS && kept != 0) {
+    r = scan_block(ct, tail, kept, false);
+  }
+  return r == XWC_SUCCESS ? scan_end(ct) : r;
+}
+
+int scan_block(counter *ct, const char *buf, size_t n, bool stable) {
+  return ct->scan(ct, buf, n, stable);
+}
+
+//  IS_DELIM : vaut vrai si l'octet c sépare les mots pour le compteur ct, selon
+//    la valeur de punct. Sans l'option -p, le test se réduit à IS_C_SPACE et ne
+//    consulte pas ct->delim, rempli par set_delims avec le même test.
+#define IS_DELIM(ct, c, punct)                                                 \
+  ((punct) ? (ct)->delim[(unsigned char) (c)] : IS_C_SPACE(c))
+
+//  Sans limite de longueur, les mots sont parcourus par paquets de SWAR_LEN
+//    octets, à l'aide de swar_stop. La numérotation des octets d'un paquet
+//    suppose une mémoire petit-boutiste.
+#if defined __BYTE_ORDER__ && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define SWAR_ENABLED      1
+#else
+#define SWAR_ENABLED      0
+#endif
+#define SWAR_LEN          sizeof(uint64_t)
+#define SWAR_ONES         UINT64_C(0x0101010101010101)
+#define SWAR_HIGHS        UINT64_C(0x8080808080808080)
+
+//  SWAR_IN_RANGE : mot dont le bit de poids fort de chaque octet est levé si
+//    l'octet correspondant de x, supposé inférieur à 0x80, est compris entre
+//    lo et hi.
+#define SWAR_IN_RANGE(x, lo, hi)                                               \
+  (((x) + SWAR_ONES * (0x80 - (lo))) & ~((x) + SWAR_ONES * (0x7F - (hi)))      \
+  & SWAR_HIGHS)
+
+//  swar_stop : renvoie, pour le paquet x, un mot dont le bit de poids fort de
+//    chaque octet est levé si l'octet correspondant de x peut séparer les mots
+//    ou n'est pas un caractère ASCII, selon la valeur de punct, et nul si
+//    aucun octet du paquet ne sépare les mots. Le premier bit levé ne précède
+//    aucun séparateur : les octets qui le précèdent appartiennent au mot, les
+//    suivants restent à examiner un par un.
+static inline uint64_t swar_stop(uint64_t x, bool punct, bool utf8) {
+  if (!punct) {
+    //  Octets inférieurs à 0x21, ce qui inclut les caractères d'espacement.
+    return (((x - SWAR_ONES * 0x21) & ~x) | (utf8 ? x : 0)) & SWAR_HIGHS;
+  }
+  //  Avec -p, seuls les caractères alphanumériques sont à coup sûr dans un
+  //    mot ; l'octet 0x20 met les lettres en minuscules sans modifier les
+  //    chiffres.
+  uint64_t y = (x & ~SWAR_HIGHS) | SWAR_ONES * 0x20;
+  uint64_t alnum = SWAR_IN_RANGE(y, 'a', 'z') | SWAR_IN_RANGE(y, '0', '9');
+  return (~alnum | x) & SWAR_HIGHS;
+}
+
+inline size_t char_at(const counter *ct, const char *q, const char *end,
+    bool punct, bool utf8, bool fold, bool *delimptr, bool *upperptr) {
+  if (!utf8 || (unsigned char) *q < 0x80) {
+    *delimptr = IS_DELIM(ct, *q, punct);
+    if (fold && (unsigned char) (*q - 'A') < 26) {
+      *upperptr = true;
+    }
+    return 1;
+  }
+  uint32_t cp;
+  size_t len = utf8_decode(q, (size_t) (end - q), &cp);
+  *delimptr = utf8_is_space(cp) || (punct && utf8_is_punct(cp));
+  if (fold && len == 2 && utf8_fold(cp) != cp) {
+    *upperptr = true;
+  }
+  return len;
+}
+
+[[gnu::always_inline]]
+inline int scan_block_tpl(counter *ct, const char *buf, size_t n,
+    bool stable, bool punct, bool capped, bool utf8, bool fold) {
+  const char *end = buf + n;
+  const char *q = buf;
+  bool d;
+  bool up;
+  size_t clen;
+  while (q < end) {
+    //  Sans limite de longueur, aucun mot n'est coupé et il n'y a jamais de fin
+    //    de mot à ignorer.
+    if (capped && ct->skip) {
+      while (q < end
+          && (clen = char_at(ct, q, end, punct, utf8, false, &d, &up), !d)) {
+        q += clen;
+      }
+      if (q == end) {
+        break;
+      }
+      ct->skip = false;
+    }
+    size_t carried = sbuffer_length(ct->sb);
+    if (carried == 0) {
+      while (q < end
+          && (clen = char_at(ct, q, end, punct, utf8, false, &d, &up), d)) {
+        q += clen;
+      }
+      if (q == end) {
+        break;
+      }
+    }
+    const char *s = q;
+    bool cut = false;
+    size_t nchars = 0;
+    up = false;
+    if (capped) {
+      //  Le mot est limité aux ct->p->init premiers caractères, dont les
+      //    ct->nchars de ct->sb.
+      size_t lim = ct->p->init - (carried == 0 ? 0 : ct->nchars);
+      while (q < end
+          && (clen = char_at(ct, q, end, punct, utf8, fold, &d, &up), !d)
+          && nchars < lim) {
+        q += clen;
+        ++nchars;
+      }
+      //  Le mot est coupé si le caractère qui suit sa limite n'est pas un
+      //    séparateur.
+      cut = q < end && !d;
+    } else {
+      while (q < end) {
+        if (SWAR_ENABLED && (size_t) (end - q) >= SWAR_LEN) {
+          uint64_t x;
+          memcpy(&x, q, SWAR_LEN);
+          uint64_t m = swar_stop(x, punct, utf8);
+          if (fold) {
+            //  Majuscules ASCII parmi les octets qui précèdent le premier
+            //    octet signalé par m.
+            up |= (SWAR_IN_RANGE(x & ~SWAR_HIGHS, 'A', 'Z') & ~x
+                & (m == 0 ? ~UINT64_C(0) : (m & -m) - 1)) != 0;
+          }
+          if (m == 0) {
+            q += SWAR_LEN;
+            continue;
+          }
+          q += (size_t) __builtin_ctzll(m) / CHAR_BIT;
+        }
+        clen = char_at(ct, q, end, punct, utf8, fold, &d, &up);
+        if (d) {
+          break;
+        }
+        q += clen;
+      }
+    }
+    size_t len = (size_t) (q - s);
+    //  Un mot plié désigne le tableau fold de ct : il n'est pas stable.
+    bool wstable = stable;
+    if (fold && up) {
+      int r = fold_word(ct, &s, len, utf8);
+      if (r != XWC_SUCCESS) {
+        return r;
+      }
+      wstable = false;
+    }
+    if (q == end && !stable) {
+      if (sbuffer_append_span(ct->sb, s, len) != 0) {
+        return XWC_ERR_CAPACITY;
+      }
+      ct->nchars = (carried == 0 ? 0 : ct->nchars) + nchars;
+      break;
+    }
+    int r;
+    if (carried != 0) {
+      //  Le lot est compté avant le mot conservé, pour respecter l'ordre.
+      r = flush_batch(ct);
+      if (r != XWC_SUCCESS) {
+        return r;
+      }
+      if (sbuffer_append_span(ct->sb, s, len) != 0) {
+        return XWC_ERR_CAPACITY;
+      }
+      size_t wlen;
+      const char *w = sbuffer_get_span(ct->sb, &wlen);
+      r = emit_word(ct, w, wlen, false, cut);
+      sbuffer_clear(ct->sb);
+    } else if (ct->ht != NULL || ct->tree != NULL) {
+      r = batch_word(ct, s, len, wstable, cut);
+    } else {
+      r = emit_word(ct, s, len, wstable, cut);
+    }
+    if (r != XWC_SUCCESS) {
+      return r;
+    }
+    ct->skip = cut;
+  }
+  //  Les mots du lot désignent buf, qui peut être réutilisé après le retour.
+  return flush_batch(ct);
+}
+
+//  SCAN_VARIANT : définit la fonction scan_block_##suffix, développement de
+//    scan_block_tpl pour les valeurs punct, capped, utf8 et fold.
+#define SCAN_VARIANT(suffix, punct, capped, utf8, fold)                        \
+  static int scan_block_##suffix(counter *ct, const char *buf, size_t n,       \
+      bool stable) {                                                           \
+    return scan_block_tpl(ct, buf, n, stable, punct, capped, utf8, fold);      \
+  }
+
+SCAN_VARIANT(plain, false, false, false, false)
+SCAN_VARIANT(fold, false, false, false, true)
+SCAN_VARIANT(capped, false, true, false, false)
+SCAN_VARIANT(capped_fold, false, true, false, true)
+SCAN_VARIANT(punct, true, false, false, false)
+SCAN_VARIANT(punct_fold, true, false, false, true)
+SCAN_VARIANT(punct_capped, true, true, false, false)
+SCAN_VARIANT(punct_capped_fold, true, true, false, true)
+SCAN_VARIANT(utf8, false, false, true, false)
+SCAN_VARIANT(utf8_fold, false, false, true, true)
+SCAN_VARIANT(utf8_capped, false, true, true, false)
+SCAN_VARIANT(utf8_capped_fold, false, true, true, true)
+SCAN_VARIANT(utf8_punct, true, false, true, false)
+SCAN_VARIANT(utf8_punct_fold, true, false, true, true)
+SCAN_VARIANT(utf8_punct_capped, true, true, true, false)
+SCAN_VARIANT(utf8_punct_capped_fold, true, true, true, true)
+
+int (*scan_variant(const options *p))(counter *, const char *, size_t, bool) {
+  //  Indices : utf8, punct, capped, fold.
+  static int (*const variants[2][2][2][2])(counter *, const char *, size_t,
+      bool) = {
+    {
+      {
+        { scan_block_plain, scan_block_fold },
+        { scan_block_capped, scan_block_capped_fold },
+      },
+      {
+        { scan_block_punct, scan_block_punct_fold },
+        { scan_block_punct_capped, scan_block_punct_capped_fold },
+      },
+    },
+    {
+      {
+        { scan_block_utf8, scan_block_utf8_fold },
+        { scan_block_utf8_capped, scan_block_utf8_capped_fold },
+      },
+      {
+        { scan_block_utf8_punct, scan_block_utf8_punct_fold },
+        { scan_block_utf8_punct_capped, scan_block_utf8_punct_capped_fold },
+      },
+    },
+  };
+  return variants[p->utf8][p->punct][p->init != 0][p->fold];
+}
+
+int fold_word(counter *ct, const char **wptr, size_t len, bool utf8) {
+  if (len > ct->foldcap - ct->foldlen) {
+    int r = flush_batch(ct);
+    if (r != XWC_SUCCESS) {
+      return r;
+    }
+    if (len > ct->foldcap) {
+      size_t cap = (ct->foldcap == 0 ? FOLD_BUFSIZE_MIN : ct->foldcap);
+      while (cap < len) {
+        if (cap > SIZE_MAX / 2) {
+          return XWC_ERR_CAPACITY;
+        }
+        cap *= 2;
+      }
+      char *a = realloc(ct->fold, cap);
+      if (a == NULL) {
+        return XWC_ERR_CAPACITY;
+      }
+      ct->fold = a;
+      ct->foldcap = cap;
+    }
+  }
+  char *dst = ct->fold + ct->foldlen;
+  fold_span(dst, *wptr, len, utf8);
+  ct->foldlen += len;
+  *wptr = dst;
+  return XWC_SUCCESS;
+}
+
+void fold_span(char *dst, const char *src, size_t n, bool utf8) {
+  size_t k = 0;
+  for (; n - k >= SWAR_LEN; k += SWAR_LEN) {
+    uint64_t x;
+    memcpy(&x, src + k, SWAR_LEN);
+    if (utf8 && (x & SWAR_HIGHS) != 0) {
+      break;
+    }
+    //  Le bit de poids fort d'une majuscule, décalé de deux rangs, est celui
+    //    qui distingue les minuscules des majuscules.
+    x |= (SWAR_IN_RANGE(x & ~SWAR_HIGHS, 'A', 'Z') & ~x) >> 2;
+    memcpy(dst + k, &x, SWAR_LEN);
+  }
+  if (utf8) {
+    utf8_fold_span(dst + k, src + k, n - k);
+    return;
+  }
+  for (; k < n; ++k) {
+    unsigned char c = (unsigned char) src[k];
+    dst[k] = (char) ((unsigned char) (c - 'A') < 26
+        ? c + ('a' - 'A') : c);
+  }
+}
+
+int scan_end(counter *ct) {
+  ct->skip = false;
+  if (sbuffer_length(ct->sb) == 0) {
+    return XWC_SUCCESS;
+  }
+  size_t len;
+  const char *w = sbuffer_get_span(ct->sb, &len);
+  int r = emit_word(ct, w, len, false, false);
+  sbuffer_clear(ct->sb);
+  return r;
+}
+
+int emit_word(counter *ct, const char *w, size_t len, bool stable,
+    bool cut) {
+  if (w == NULL) {
+    return XWC_ERR_CAPACITY;
+  }
+  note_word(ct, w, len, cut);
+  return count_word(ct, w, len, stable);
+}
+
+void note_word(counter *ct, const char *w, size_t len, bool cut) {
+  ct->rs.tokens += 1;
+  if (cut && ct->p->cut != NULL) {
+    ct->p->cut(ct->p->cut_context, ct->nfile, w, len);
+  }
+}
+
+int batch_word(counter *ct, const char *w, size_t len, bool stable,
+    bool cut) {
+  ct->batch[ct->nbatch] = (word) { w, len };
+  ct->cut[ct->nbatch] = cut;
+  ct->stable[ct->nbatch] = stable;
+  ct->nbatch += 1;
+  if (ct->nbatch == WORD_BATCH) {
+    return flush_batch(ct);
+  }
+  return XWC_SUCCESS;
+}
+
+int flush_batch(counter *ct) {
+  size_t n = ct->nbatch;
+  ct->nbatch = 0;
+  ct->foldlen = 0;
+  if (n == 0) {
+    return XWC_SUCCESS;
+  }
+  if (ct->tree != NULL) {
+    //  Les mots absents de l'arbre lors de la recherche groupée peuvent avoir
+    //    été ajoutés depuis par un mot égal du lot : ils sont recherchés à
+    //    nouveau par count_word_tree.
+    const char *keys[WORD_BATCH];
+    size_t lens[WORD_BATCH];
+    void *wis[WORD_BATCH];
+    for (size_t k = 0; k < n; ++k) {
+      keys[k] = ct->batch[k].s;
+      lens[k] = ct->batch[k].len;
+    }
+    art_search_batch(ct->tree, n, keys, lens, wis);
+    for (size_t k = 0; k < n; ++k) {
+      const word *w = &ct->batch[k];
+      note_word(ct, w->s, w->len, ct->cut[k]);
+      if (wis[k] != NULL) {
+        int r = word_seen(ct, wis[k]);
+        if (r != XWC_SUCCESS) {
+          return r;
+        }
+        continue;
+      }
+      int r = count_word_tree(ct, w->s, w->len, ct->stable[k]);
+      if (r != XWC_SUCCESS) {
+        return r;
+      }
+    }
+    return XWC_SUCCESS;
+  }
+  word_table_prefetch(ct->ht, n, ct->batch, ct->hashes);
+  size_t nflushes = ct->nflushes;
+  size_t nreseeds = word_table_reseeds(ct->ht);
+  for (size_t k = 0; k < n; ++k) {
+    const word *w = &ct->batch[k];
+    note_word(ct, w->s, w->len, ct->cut[k]);
+    int r = count_word_hashed(ct, w->s, w->len, ct->stable[k],
+        ct->hashes[k]);
+    if (r != XWC_SUCCESS) {
+      return r;
+    }
+    //  Une table vidée dans les partitions est remplacée par une autre, de clé
+    //    différente, et une table peut changer de clé : les valeurs de
+    //    pré-hachage des mots suivants du lot sont alors recalculées.
+    if (ct->nflushes != nflushes || word_table_reseeds(ct->ht) != nreseeds) {
+      for (size_t j = k + 1; j < n; ++j) {
+        ct->hashes[j] = word_table_hash(ct->ht, &ct->batch[j]);
+      }
+      nflushes = ct->nflushes;
+      nreseeds = word_table_reseeds(ct->ht);
+    }
+  }
+  return XWC_SUCCESS;
+}
+
+word_info *new_word_info(counter *ct, const char *w, size_t len,
+    bool stable) {
+  size_t size = (ct->p->membership ? sizeof(word_sets) : sizeof(word_info));
+  word_info *wi = malloc(size);
+  if (wi == NULL) {
+    return NULL;
+  }
+  if (!stable) {
+    char *s = arena_alloc(ct->ar, len);
+    if (s == NULL) {
+      free(wi);
+      return NULL;
+    }
+    memcpy(s, w, len);
+    w = s;
+  }
+  wi->key = (word) { w, len };
+  wi->file = ct->nfile;
+  wi->occ = (ct->nfile == XWC_RESTRICT_FILE ? 0 : 1);
+  if (ct->p->membership) {
+    ((word_sets *) wi)->fs = NULL;
+  }
+  ct->word_info_mem += size;
+  if (stable) {
+    ct->nmapped += 1;
+  } else {
+    ct->ncopied += 1;
+  }
+  if (len > ct->maxlen) {
+    ct->maxlen = len;
+  }
+  return wi;
+}
+
+void word_info_seen(word_info *wi, size_t nfile) {
+  if (nfile == XWC_RESTRICT_FILE) {
+    return;
+  }
+  if (wi->file != nfile) {
+    if (wi->file == XWC_RESTRICT_FILE) {
+      wi->file = nfile;
+      wi->occ = 1;
+    } else {
+      wi->occ = 0;
+    }
+  } else if (wi->occ != 0) {
+    wi->occ += 1;
+  }
+}
+
+int word_sets_seen(counter *ct, word_sets *ws) {
+  word_info *wi = &ws->wi;
+  size_t nfile = ct->nfile;
+  if (nfile == XWC_RESTRICT_FILE) {
+    return XWC_SUCCESS;
+  }
+  if (wi->file == nfile) {
+    wi->occ += 1;
+    return XWC_SUCCESS;
+  }
+  if (wi->occ == 0) {
+    wi->file = nfile;
+    wi->occ = 1;
+    return XWC_SUCCESS;
+  }
+  //  Le dernier fichier rejoint les autres ; le fichier courant en est retiré
+  //    s'il y figure. Lus dans l'ordre, les fichiers sont ajoutés en fin
+  //    d'ensemble et n'y sont jamais trouvés.
+  if (ws->fs == NULL) {
+    ws->fs = fileset_empty();
+    if (ws->fs == NULL) {
+      return XWC_ERR_CAPACITY;
+    }
+    ct->word_info_mem += fileset_memory(ws->fs);
+  }
+  size_t m = fileset_memory(ws->fs);
+  if (fileset_add(ws->fs, wi->file, wi->occ) != 0) {
+    return XWC_ERR_CAPACITY;
+  }
+  wi->file = nfile;
+  wi->occ = fileset_take(ws->fs, nfile) + 1;
+  ct->word_info_mem += fileset_memory(ws->fs) - m;
+  return XWC_SUCCESS;
+}
+
+int word_seen(counter *ct, word_info *wi) {
+  if (ct->p->membership) {
+    return word_sets_seen(ct, (word_sets *) wi);
+  }
+  word_info_seen(wi, ct->nfile);
+  return XWC_SUCCESS;
+}
+
+word_info *add_word_info(shared_count *sc, const word **keyrefptr) {
+  counter *ct = sc->ct;
+  if (ct->nfile != XWC_RESTRICT_FILE && ct->p->restricted) {
+    return NULL;
+  }
+  sc->wi = new_word_info(ct, (*keyrefptr)->s, (*keyrefptr)->len, sc->stable);
+  if (sc->wi == NULL) {
+    sc->r = XWC_ERR_CAPACITY;
+    return NULL;
+  }
+  *keyrefptr = &sc->wi->key;
+  return sc->wi;
+}
+
+void update_word_info(shared_count *sc, word_info *wi) {
+  int r = word_seen(sc->ct, wi);
+  if (r != XWC_SUCCESS) {
+    sc->r = r;
+  }
+}
+
+int count_word(counter *ct, const char *w, size_t len, bool stable) {
+  if (ct->own != NULL) {
+    return count_word_sketched(ct, w, len);
+  }
+  if (ct->tree != NULL) {
+    return count_word_tree(ct, w, len, stable);
+  }
+  if (ct->cht != NULL) {
+    shared_count sc = { ct, stable, NULL, XWC_SUCCESS };
+    if (chashtable_add_or_update(ct->cht, &(word) { w, len }, &sc,
+        (void *(*)(void *, const void **))add_word_info,
+        (void (*)(void *, void *))update_word_info) != 0) {
+      free(sc.wi);
+      return XWC_ERR_CAPACITY;
+    }
+    return sc.r;
+  }
+  return count_word_hashed(ct, w, len, stable,
+      word_table_hash(ct->ht, &(word) { w, len }));
+}
+
+int count_word_tree(counter *ct, const char *w, size_t len, bool stable) {
+  word_info *wi = art_search(ct->tree, w, len);
+  if (wi != NULL) {
+    return word_seen(ct, wi);
+  }
+  if (ct->nfile != XWC_RESTRICT_FILE && ct->p->restricted) {
+    return XWC_SUCCESS;
+  }
+  wi = new_word_info(ct, w, len, stable);
+  if (wi == NULL) {
+    return XWC_ERR_CAPACITY;
+  }
+  if (art_add(ct->tree, wi) == NULL) {
+    free(wi);
+    return XWC_ERR_CAPACITY;
+  }
+  return XWC_SUCCESS;
+}
+
+int count_word_sketched(counter *ct, const char *w, size_t len) {
+  uint64_t h = siphash(w, len, hash_key);
+  owners_mark(ct->own, h, ct->nfile);
+  return topk_add(ct->top, w, len, h) != 0 ? XWC_ERR_CAPACITY : XWC_SUCCESS;
+}
+
+int count_word_hashed(counter *ct, const char *w, size_t len, bool stable,
+    size_t h) {
+  const options *p = ct->p;
+  word_info *wi = word_table_search_hashed(ct->ht, &(word) { w, len }, h);
+  if (wi != NULL) {
+    return word_seen(ct, wi);
+  }
+  if (ct->nfile != XWC_RESTRICT_FILE && p->restricted) {
+    return XWC_SUCCESS;
+  }
+  if (p->max_memory != 0 && p->spill_dir != NULL
+      && ct->nfile != XWC_RESTRICT_FILE
+      && mem_total(ct) + WORD_ADD_MEMORY(ct, len, stable) > p->max_memory) {
+    int r = flush_words(ct);
+    if (r != XWC_SUCCESS) {
+      return r;
+    }
+    h = word_table_hash(ct->ht, &(word) { w, len });
+  }
+  if (p->max_memory != 0
+      && mem_total(ct) + WORD_ADD_MEMORY(ct, len, stable) > p->max_memory) {
+    return XWC_ERR_LIMIT;
+  }
+  wi = new_word_info(ct, w, len, stable);
+  if (wi == NULL) {
+    return XWC_ERR_CAPACITY;
+  }
+  if (holdall_put(ct->has, &wi->key) != 0) {
+    free(wi);
+    return XWC_ERR_CAPACITY;
+  }
+  //  Désormais référencée par le fourretout, la structure sera libérée avec
+  //    lui, même si son ajout à la table échoue.
+  if (word_table_add_hashed(ct->ht, &wi->key, h, wi) == NULL) {
+    return XWC_ERR_CAPACITY;
+  }
+  return XWC_SUCCESS;
+}
+
+int flush_words(counter *ct) {
+  if (ct->parts == NULL) {
+    ct->parts = spill_empty(ct->p->spill_dir, ct->p->spill_nparts);
+    if (ct->parts == NULL) {
+      return XWC_ERR_TEMP;
+    }
+  }
+  if (spill_words(ct->parts, ct->has) != 0) {
+    return XWC_ERR_SPILL;
+  }
+  dispose_words(ct->p, &ct->ht, &ct->has, ct->ar);
+  ct->word_info_mem = 0;
+  ct->nflushes += 1;
+  ct->ht = words_empty(0);
+  ct->has = holdall_empty();
+  if (ct->ht == NULL || ct->has == NULL) {
+    return XWC_ERR_CAPACITY;
+  }
+  return XWC_SUCCESS;
+}
+
+int spill_words(spill *sp, holdall *has) {
+  return holdall_apply_context2(has,
+      NULL, (void *(*)(void *, void *))word_info_of, sp,
+      (int (*)(void *, void *, void *))rspill_word_info);
+}
+
+int load_partition(counter *ct, spill *sp, size_t part) {
+  if (spill_rewind(sp, part) != 0) {
+    return XWC_ERR_SPILL;
+  }
+  const char *w;
+  size_t len;
+  size_t file;
+  long int occ;
+  int g;
+  while ((g = spill_get(sp, part, &w, &len, &file, &occ)) == 0) {
+    word_info *wi = word_table_search(ct->ht, &(word) { w, len });
+    if (wi != NULL) {
+      if (wi->file != file || occ == 0) {
+        wi->occ = 0;
+      } else if (wi->occ != 0) {
+        wi->occ += occ;
+      }
+      continue;
+    }
+    if (ct->p->max_memory != 0
+        && mem_total(ct) + WORD_ADD_MEMORY(ct, len, false)
+        > ct->p->max_memory) {
+      return XWC_ERR_LIMIT;
+    }
+    wi = malloc(sizeof *wi);
+    char *s = arena_alloc(ct->ar, len);
+    if (wi == NULL || s == NULL) {
+      free(wi);
+      return XWC_ERR_CAPACITY;
+    }
+    memcpy(s, w, len);
+    wi->key = (word) { s, len };
+    wi->file = file;
+    wi->occ = occ;
+    if (holdall_put(ct->has, &wi->key) != 0) {
+      free(wi);
+      return XWC_ERR_CAPACITY;
+    }
+    ct->word_info_mem += sizeof *wi;
+    if (word_table_add(ct->ht, &wi->key, wi) == NULL) {
+      return XWC_ERR_CAPACITY;
+    }
+    if (len > ct->maxlen) {
+      ct->maxlen = len;
+    }
+  }
+  return g < 0 ? XWC_ERR_SPILL : XWC_SUCCESS;
+}
+
+int rspill_word_info(spill *sp, word *w, word_info *wi) {
+  return spill_put(sp, spill_partition(sp, w->s, w->len), w->s, w->len,
+      wi->file, wi->occ);
+}
+
+int rrun_word_info(run_context *rc, word *w, word_info *wi) {
+  if (wi->occ == 0) {
+    return 0;
+  }
+  return spill_put(rc->sp, rc->part, w->s, w->len, wi->file, wi->occ);
+}
+
+int remit_word_info(emitter *em, word *w, word_info *wi) {
+  if (em->sets) {
+    return remit_word_sets(em, w, (word_sets *) wi);
+  }
+  if (wi->occ == 0) {
+    rcount_word_info(em->ws, w, wi);
+    return 0;
+  }
+  em->ws->exclusive += 1;
+  return em->fun(em->context, w->s, w->len, wi->file, wi->occ);
+}
+
+int remit_word_sets(emitter *em, word *w, word_sets *ws) {
+  const word_info *wi = &ws->wi;
+  size_t n = (wi->occ != 0) + (ws->fs == NULL ? 0 : fileset_count(ws->fs));
+  if (n == 0) {
+    em->ws->unseen += 1;
+    return 0;
+  }
+  if (n == 1) {
+    em->ws->exclusive += 1;
+  } else {
+    em->ws->disqualified += 1;
+  }
+  if (em->sfun == NULL) {
+    return n == 1 ? em->fun(em->context, w->s, w->len, wi->file, wi->occ) : 0;
+  }
+  if (n < em->min_files || n > em->max_files) {
+    return 0;
+  }
+  em->ws->selected += 1;
+  //  Le dernier fichier est inséré à son rang parmi les autres.
+  size_t j = 0;
+  bool placed = false;
+  for (size_t k = 0; k + 1 < n; ++k) {
+    struct xwc_occ o;
+    fileset_get(ws->fs, k, &o.file, &o.occ);
+    if (!placed && wi->file < o.file) {
+      em->occs[j++] = (struct xwc_occ) { wi->file, wi->occ };
+      placed = true;
+    }
+    em->occs[j++] = o;
+  }
+  if (!placed) {
+    em->occs[j] = (struct xwc_occ) { wi->file, wi->occ };
+  }
+  return em->sfun(em->context, w->s, w->len, em->occs, n);
+}
+
+int remit_tree_word_info(emitter *em, word_info *wi) {
+  return remit_word_info(em, &wi->key, wi);
+}
+
+int remit_tuple(emitter *em, const char *w, size_t file, long int occ) {
+  if (em->fun(em->context, w, strlen(w), file, occ) != 0) {
+    em->stopped = true;
+    return -1;
+  }
+  return 0;
+}
+
+int rsketch_word(sketch_context *sc, const char *s, size_t len,
+    uint64_t hash, size_t count, [[maybe_unused]] size_t err) {
+  if (!owners_exclusive(sc->own, hash, sc->file)) {
+    sc->ws->disqualified += 1;
+    return 0;
+  }
+  word_info *wi = malloc(sizeof *wi);
+  if (wi == NULL) {
+    return -1;
+  }
+  wi->key = (word) { s, len };
+  wi->file = sc->file;
+  wi->occ = (long int) count;
+  if (holdall_put(sc->ct->has, &wi->key) != 0) {
+    free(wi);
+    return -1;
+  }
+  if (len > sc->ct->maxlen) {
+    sc->ct->maxlen = len;
+  }
+  return 0;
+}
+
+int rcount_word_info(words_stats *ws, [[maybe_unused]] word *w,
+    word_info *wi) {
+  if (wi->occ != 0) {
+    ws->exclusive += 1;
+  } else if (wi->file == XWC_RESTRICT_FILE) {
+    ws->unseen += 1;
+  } else {
+    ws->disqualified += 1;
+  }
+  return 0;
+}
+
+void free_word_info(const options *p, word_info *wi) {
+  if (p->membership) {
+    fileset_dispose(&((word_sets *) wi)->fs);
+  }
+  free(wi);
+}
+
+int rfree_word_info(const options *p, [[maybe_unused]] word *w,
+    word_info *wi) {
+  free_word_info(p, wi);
+  return 0;
+}
+
+int rcfree_word_info(const options *p, word_info *wi) {
+  free_word_info(p, wi);
+  return 0;
+}
+
+int rmunmap(mfile *mf) {
+  mfile_unmap(&mf);
+  return 0;
+}
+
+//  Les mots n'étant pas terminés par '\0', la comparaison par strcoll passe
+//    par des copies dans les buffers de collate_bufs. Dans les locales "C" et
+//    "POSIX", où strcoll équivaut à strcmp, les mots sont comparés directement.
+static _Thread_local struct {
+  bool bytewise;
+  char *bufs[2];
+  size_t cap;
+} collate;
+
+int collate_init(size_t maxlen) {
+  const char *name = setlocale(LC_COLLATE, NULL);
+  collate.bytewise = name != NULL
+      && (strcmp(name, "C") == 0 || strcmp(name, "POSIX") == 0);
+  if (collate.bytewise || maxlen < collate.cap) {
+    return 0;
+  }
+  for (size_t k = 0; k < 2; ++k) {
+    char *b = realloc(collate.bufs[k], maxlen + 1);
+    if (b == NULL) {
+      return -1;
+    }
+    collate.bufs[k] = b;
+  }
+  collate.cap = maxlen + 1;
+  return 0;
+}
+
+bool collate_is_bytewise(void) {
+  return collate.bytewise;
+}
+
+void collate_dispose(void) {
+  free(collate.bufs[0]);
+  free(collate.bufs[1]);
+  collate.bufs[0] = NULL;
+  collate.bufs[1] = NULL;
+  collate.cap = 0;
+}
+
+int word_strcoll(const word *w1, const word *w2) {
+  if (collate.bytewise) {
+    int c = memcmp(w1->s, w2->s, w1->len < w2->len ? w1->len : w2->len);
+    return c != 0 ? c : (w1->len > w2->len) - (w1->len < w2->len);
+  }
+  memcpy(collate.bufs[0], w1->s, w1->len);
+  collate.bufs[0][w1->len] = '\0';
+  memcpy(collate.bufs[1], w2->s, w2->len);
+  collate.bufs[1][w2->len] = '\0';
+  return strcoll(collate.bufs[0], collate.bufs[1]);
+}
+
+int rev_word_strcoll(const word *w1, const word *w2) {
+  return -1 * word_strcoll(w1, w2);
+}
+
+int str_collate(const char *s1, const char *s2) {
+  return strcoll(s1, s2);
+}
+
+int rev_str_collate(const char *s1, const char *s2) {
+  return -1 * strcoll(s1, s2);
+}
+
+size_t mem_total(const counter *ct) {
+  return (ct->ht == NULL ? 0 : word_table_memory(ct->ht, NULL, NULL))
+    + (ct->cht == NULL ? 0 : chashtable_memory(ct->cht, NULL, NULL))
+    + (ct->tree == NULL ? 0 : art_memory(ct->tree))
+    + (ct->has == NULL ? 0 : holdall_memory(ct->has))
+    + (ct->sb == NULL ? 0 : sbuffer_memory(ct->sb)) + ct->foldcap
+    + (ct->ar == NULL ? 0 : arena_memory(ct->ar))
+    + ct->word_info_mem + ct->peers_mem;
+}
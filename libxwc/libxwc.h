@@ -0,0 +1,379 @@
+//  libxwc.h : partie interface de la bibliothèque de comptage exclusif de mots,
+//    moteur du programme xwc utilisable sans passer par un processus.
+
+#ifndef LIBXWC__H
+#define LIBXWC__H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+//  Fonctionnement général :
+//  - un contexte de comptage est créé par xwc_create selon des options, puis
+//      alimenté par des suites d'octets, chacune étiquetée par l'indice du
+//      fichier dont elle provient. Les octets d'un même fichier sont transmis
+//      dans l'ordre, par un ou plusieurs appels successifs ; un mot peut être
+//      à cheval sur deux appels. Passer à un autre indice termine le fichier
+//      en cours ;
+//  - si l'option restricted est vraie, le fichier d'indice XWC_RESTRICT_FILE
+//      restreint le comptage à ses mots : il doit être transmis en premier. Les
+//      autres fichiers ont des indices à partir de XWC_FIRST_FILE ;
+//  - xwc_finish termine la lecture, xwc_apply parcourt ensuite les mots qui
+//      n'apparaissent que dans un seul fichier, triés ou non. Si l'option
+//      membership est vraie, xwc_apply_sets parcourt ceux qui apparaissent
+//      dans un nombre de fichiers donné, avec leurs nombres d'occurrences dans
+//      chacun ;
+//  - les fonctions de type de retour int renvoient XWC_SUCCESS en cas de
+//      succès, l'un des codes d'erreur XWC_ERR_* sinon. Après une erreur, le
+//      contexte ne peut plus qu'être consulté par les fonctions de bilan puis
+//      libéré par xwc_dispose ;
+//  - un contexte n'est pas partagé entre plusieurs fils d'exécution ; il en
+//      lance lui-même si l'option nthreads est strictement supérieure à 1.
+
+#define XWC_RESTRICT_FILE 0
+#define XWC_FIRST_FILE    1
+
+//  Nombre de fichiers temporaires par défaut.
+#define XWC_SPILL_NPARTS_DEF  64
+
+//  Nombre de cellules par défaut de l'esquisse d'appartenance du mode
+//    approché.
+#define XWC_SKETCH_CELLS_DEF  4194304
+
+//  Seuil par défaut d'allocation sur des pages géantes ; seuil désactivant
+//    les pages géantes.
+#define XWC_HUGE_PAGES_DEF    2097152
+#define XWC_HUGE_PAGES_NEVER  SIZE_MAX
+
+//  Borne de xwc_apply_sets désignant le nombre de fichiers lus.
+#define XWC_ALL_FILES         SIZE_MAX
+
+//  Valeurs renvoyées par les fonctions de la bibliothèque.
+enum {
+  XWC_SUCCESS,
+  XWC_ERR_CAPACITY,   //  dépassement de capacité
+  XWC_ERR_LIMIT,      //  limite de mémoire max_memory atteinte
+  XWC_ERR_READ,       //  erreur de lecture d'un fichier
+  XWC_ERR_SPILL,      //  erreur d'accès aux fichiers temporaires
+  XWC_ERR_TEMP,       //  création des fichiers temporaires impossible
+  XWC_ERR_THREADS,    //  préparation ou lancement des fils d'exécution
+                      //    impossible
+  XWC_ERR_STATE,      //  opération impossible dans l'état du contexte
+  XWC_ERR_DECOMPRESS, //  fichier compressé invalide ou dans un format non
+                      //    pris en charge
+  XWC_STOPPED         //  parcours interrompu par la fonction appelée
+};
+
+//  struct xwc_options : options d'un comptage. Hors décodage UTF-8, les
+//    caractères d'espacement et de ponctuation sont ceux de la localisation
+//    « C », quelle que soit la catégorie LC_CTYPE courante.
+//  - punct : la ponctuation sépare les mots, comme les caractères
+//      d'espacement ;
+//  - init : nombre maximal de caractères significatifs des mots, 0 pour
+//      aucune limite ;
+//  - utf8 : les octets sont décodés en UTF-8 ;
+//  - fold : la casse des mots est pliée ;
+//  - restricted : le fichier d'indice XWC_RESTRICT_FILE restreint le comptage ;
+//  - dictionary : structure de données qui mémorise les mots ;
+//  - max_memory : nombre maximal d'octets alloués pour les mots et les
+//      structures de données, 0 pour aucune limite ;
+//  - spill_dir : si max_memory est non nul, répertoire des fichiers
+//      temporaires où sont écrits les comptes lorsque la limite est atteinte,
+//      NULL pour échouer dans ce cas. La chaîne doit demeurer valide jusqu'à
+//      la libération du contexte ;
+//  - spill_nparts : nombre de fichiers temporaires ;
+//  - nthreads : nombre de fils d'exécution entre lesquels est partagée la
+//      lecture des fichiers transmis par xwc_feed_path ;
+//  - expected : nombre de mots distincts attendus, 0 si inconnu ;
+//  - stats : les durées de lecture de chaque fichier sont mesurées ;
+//  - sketch : si non nul, mode approché : au lieu de mémoriser tous les mots,
+//      seuls les sketch mots les plus fréquents de chaque fichier sont suivis,
+//      par l'algorithme SpaceSaving, et l'appartenance des mots aux fichiers
+//      est résumée par une esquisse de sketch_cells cellules. La mémoire
+//      occupée ne dépend pas du nombre de mots distincts ; les nombres
+//      d'occurrences sont des majorants et un mot exclusif peut être omis,
+//      jamais un mot présent dans plusieurs fichiers rapporté ;
+//  - sketch_cells : nombre de cellules de l'esquisse d'appartenance ;
+//  - membership : l'ensemble des fichiers dans lesquels apparaît chaque mot
+//      est mémorisé, avec le nombre d'occurrences du mot dans chacun, au lieu
+//      du seul fait qu'il est exclusif ;
+//  - huge_pages : taille à partir de laquelle les grands tableaux, tels que
+//      les compartiments de la table de hachage, les blocs des copies des mots
+//      et les structures du mode approché, sont alloués sur des pages géantes
+//      transparentes. Le réglage est commun à tout le processus : il est
+//      appliqué par xwc_create ;
+//  - cut : si elle ne vaut pas NULL, fonction appelée avec cut_context pour
+//      chaque mot coupé par la limite init, l'indice de son fichier, l'adresse
+//      de son premier octet et sa longueur. Avec plusieurs fils d'exécution,
+//      les appels peuvent être simultanés.
+struct xwc_options {
+  bool punct;
+  size_t init;
+  bool utf8;
+  bool fold;
+  bool restricted;
+  enum {
+    XWC_HASHTABLE,
+    XWC_RADIX_TREE
+  } dictionary;
+  size_t max_memory;
+  const char *spill_dir;
+  size_t spill_nparts;
+  size_t nthreads;
+  size_t expected;
+  bool stats;
+  size_t sketch;
+  size_t sketch_cells;
+  bool membership;
+  size_t huge_pages;
+  void *cut_context;
+  void (*cut)(void *cut_context, size_t file, const char *w, size_t len);
+};
+
+//  xwc_options_init : affecte à *opts les options par défaut : aucune, sinon
+//    une table de hachage, XWC_SPILL_NPARTS_DEF fichiers temporaires, un seul
+//    fil d'exécution, XWC_SKETCH_CELLS_DEF cellules d'esquisse et le seuil
+//    XWC_HUGE_PAGES_DEF.
+extern void xwc_options_init(struct xwc_options *opts);
+
+//  struct xwc, xwc : type et nom de type d'un contexte de comptage.
+typedef struct xwc xwc;
+
+//  xwc_create : tente d'allouer les ressources nécessaires pour un nouveau
+//    contexte de comptage selon les options pointées par opts, qui sont
+//    recopiées. Renvoie NULL si nthreads est nul, si nthreads est strictement
+//    supérieur à 1 et max_memory non nul, si l'arbre est demandé avec
+//    plusieurs fils d'exécution ou une limite de mémoire, si le mode approché
+//    est demandé avec l'une de ces options ou avec restricted, si membership
+//    est vrai avec une limite de mémoire ou le mode approché, ou en cas de
+//    dépassement de capacité. Renvoie sinon un pointeur vers le contexte.
+extern xwc *xwc_create(const struct xwc_options *opts);
+
+//  xwc_dispose : sans effet si *xptr vaut NULL. Libère sinon les ressources
+//    allouées à la gestion du contexte associé à *xptr puis affecte NULL à
+//    *xptr.
+extern void xwc_dispose(xwc **xptr);
+
+//  xwc_feed : compte les mots des n octets pointés par buf, suite du fichier
+//    d'indice file. Les octets peuvent être réutilisés dès le retour : les mots
+//    mémorisés en sont des copies.
+extern int xwc_feed(xwc *x, size_t file, const void *buf, size_t n);
+
+//  xwc_feed_stream : compte les mots du flot f, lu jusqu'à sa fin, comme
+//    contenu du fichier d'indice file. Le fichier en cours est d'abord terminé,
+//    même s'il a le même indice. Si f n'est pas l'entrée standard et désigne un
+//    fichier ordinaire, il est projeté en mémoire et les mots mémorisés
+//    désignent directement la projection, qui demeure jusqu'à la libération du
+//    contexte.
+extern int xwc_feed_stream(xwc *x, size_t file, FILE *f);
+
+//  xwc_feed_path : même fonction que xwc_feed_stream pour le fichier de nom
+//    fname. Avec plusieurs fils d'exécution, la lecture des fichiers d'indice
+//    différent de XWC_RESTRICT_FILE est différée jusqu'à l'appel de xwc_finish
+//    qui suit ; la chaîne fname est recopiée.
+extern int xwc_feed_path(xwc *x, size_t file, const char *fname);
+
+//  xwc_finish : termine le fichier en cours puis effectue les lectures
+//    différées. Des fichiers peuvent encore être transmis après l'appel. Les
+//    fils d'exécution ne sont lancés qu'une fois : les fichiers transmis par
+//    xwc_feed_path après une lecture en parallèle sont lus par le fil
+//    appelant.
+extern int xwc_finish(xwc *x);
+
+//  xwc_order : ordre du parcours de xwc_apply. L'ordre lexicographique est
+//    celui de la catégorie LC_COLLATE de la locale courante.
+typedef enum {
+  XWC_ORDER_NONE,
+  XWC_ORDER_ASCENDING,
+  XWC_ORDER_DESCENDING
+} xwc_order;
+
+//  xwc_apply : appelle xwc_finish puis parcourt, dans l'ordre order, les mots
+//    qui n'apparaissent que dans un seul fichier, en appelant pour chacun
+//    fun(context, w, len, file, occ), où w est l'adresse du premier octet du
+//    mot, len sa longueur, file l'indice du fichier et occ le nombre
+//    d'occurrences. Si start ne vaut pas NULL, start(context) est appelée une
+//    fois, juste avant le premier mot éventuel, une fois le tri achevé. Si un
+//    appel de start ou de fun renvoie une valeur non nulle, le parcours prend
+//    fin et la fonction renvoie XWC_STOPPED. Si des comptes ont été écrits dans
+//    des fichiers temporaires, le parcours les consomme : la fonction ne peut
+//    alors être appelée qu'une fois. En mode approché, les mots parcourus sont
+//    ceux des mots suivis de chaque fichier dont l'esquisse prouve
+//    l'exclusivité, occ étant l'estimation de leur nombre d'occurrences.
+extern int xwc_apply(xwc *x, xwc_order order, void *context,
+    int (*start)(void *context),
+    int (*fun)(void *context, const char *w, size_t len, size_t file,
+      long int occ));
+
+//  struct xwc_occ : nombre d'occurrences occ d'un mot dans le fichier d'indice
+//    file.
+struct xwc_occ {
+  size_t file;
+  long int occ;
+};
+
+//  xwc_apply_sets : même fonction que xwc_apply, les mots parcourus étant ceux
+//    qui apparaissent dans au moins min_files et au plus max_files fichiers,
+//    fun(context, w, len, occs, n) étant appelée pour chacun, où occs est
+//    l'adresse d'un tableau de n structures xwc_occ rangées par indices de
+//    fichiers croissants. L'une ou l'autre borne peut valoir XWC_ALL_FILES,
+//    qui désigne le nombre de fichiers lus, le fichier de restriction non
+//    compris. Le tableau peut être réutilisé après le retour de fun. Renvoie
+//    XWC_ERR_STATE si l'option membership est fausse.
+extern int xwc_apply_sets(xwc *x, xwc_order order, size_t min_files,
+    size_t max_files, void *context, int (*start)(void *context),
+    int (*fun)(void *context, const char *w, size_t len,
+      const struct xwc_occ *occs, size_t n));
+
+//  xwc_query : appelle xwc_finish puis recherche le mot w de longueur len,
+//    tronqué et plié comme ceux des fichiers selon les options init et fold.
+//    Si le mot n'apparaît que dans un seul fichier, affecte à *fileptr
+//    l'indice de ce fichier et à *occptr son nombre d'occurrences ; affecte
+//    sinon zéro à *occptr. Renvoie XWC_ERR_STATE si des comptes ont été écrits
+//    dans des fichiers temporaires ou en mode approché.
+extern int xwc_query(xwc *x, const char *w, size_t len, size_t *fileptr,
+    long int *occptr);
+
+//  xwc_error_index : renvoie, après un échec de lecture ou de limite de
+//    mémoire, l'indice du fichier dont la lecture a échoué ou, si l'échec est
+//    survenu lors du parcours de xwc_apply, celui du fichier temporaire.
+extern size_t xwc_error_index(const xwc *x);
+
+//  xwc_estimate_words : estime le nombre de mots distincts des fichiers de noms
+//    fnames[0], ..., fnames[nfnames - 1] selon les options pointées par opts.
+//    Un échantillon de taille bornée est lu en tête des fichiers ; le nombre
+//    de mots distincts de l'échantillon est estimé par HyperLogLog à sa moitié
+//    et à sa fin, puis extrapolé à la taille totale des fichiers selon la loi
+//    de Heaps. Renvoie zéro si l'estimation est impossible, notamment si l'un
+//    des fichiers n'est pas un fichier ordinaire ou est compressé.
+extern size_t xwc_estimate_words(const struct xwc_options *opts,
+    const char *const *fnames, size_t nfnames);
+
+//  struct xwc_file_stats : bilan de lecture d'un fichier : nombre d'octets lus,
+//    dont au travers d'une projection en mémoire, nombre d'octets compressés
+//    dont la décompression a produit les octets lus, nombre de mots et, si
+//    l'option stats est vraie, durées de lecture en temps réel et en temps
+//    processeur, exprimées en secondes. En mode approché, sketch_error est la
+//    borne de l'erreur des nombres d'occurrences des mots du fichier : chacun
+//    excède d'au plus sketch_error le nombre réel.
+struct xwc_file_stats {
+  size_t bytes;
+  size_t mapped;
+  size_t compressed;
+  size_t tokens;
+  double wall;
+  double cpu;
+  size_t sketch_error;
+};
+
+//  xwc_get_file_stats : affecte à *fsptr le bilan de lecture du fichier
+//    d'indice file. Renvoie une valeur non nulle si aucune lecture n'a été
+//    effectuée pour cet indice, zéro sinon.
+extern int xwc_get_file_stats(const xwc *x, size_t file,
+    struct xwc_file_stats *fsptr);
+
+//  struct xwc_stats : bilan d'un comptage. Les effectifs des mots distincts,
+//    exclusifs, disqualifiés, de restriction jamais rencontrés et retenus par
+//    xwc_apply_sets sont ceux du dernier parcours. Les composants de hashtable
+//    ont la signification de ceux de la structure hashtable_stats du module
+//    hashtable ; ceux de art, significatifs si used est vrai, celle de ceux de
+//    la structure art_stats ; ceux de spill, significatifs si used est vrai,
+//    décrivent les fichiers temporaires ; ceux de sketch, significatifs si
+//    used est vrai, le mode approché : nombre de mots suivis par fichier,
+//    nombre de cellules et de rangées de l'esquisse d'appartenance,
+//    proportion de cellules partagées et probabilité qu'un mot exclusif pris
+//    au hasard ne soit pas reconnu comme tel ; ceux de hugepages ont la
+//    signification de ceux de la structure hugemem_stats du module hugemem et
+//    portent sur tout le processus.
+struct xwc_stats {
+  struct {
+    size_t bytes;
+    size_t mapped;
+    size_t compressed;
+    size_t tokens;
+  } read;
+  struct {
+    size_t distinct;
+    size_t exclusive;
+    size_t disqualified;
+    size_t unseen;
+    size_t selected;
+    size_t zero_copy;
+    size_t copied;
+  } words;
+  size_t threads;
+  struct {
+    size_t nslots;
+    size_t nentries;
+    double ldfactmax;
+    double ldfactcurr;
+    size_t maxlen;
+    double postheo;
+    double poscurr;
+    size_t nresizes;
+    size_t nreseeds;
+  } hashtable;
+  struct {
+    bool used;
+    size_t nnodes[4];
+    size_t height;
+    size_t prefix;
+  } art;
+  struct {
+    bool used;
+    size_t partitions;
+    size_t flushes;
+    size_t tuples;
+    size_t bytes;
+  } spill;
+  struct {
+    bool used;
+    size_t capacity;
+    size_t cells;
+    size_t depth;
+    double shared;
+    double miss;
+  } sketch;
+  struct {
+    size_t threshold;
+    size_t maps;
+    size_t mapped;
+    size_t advised;
+    size_t fallbacks;
+    size_t thp;
+    const char *mode;
+  } hugepages;
+};
+
+//  xwc_get_stats : effectue un bilan du comptage du contexte associé à x et
+//    affecte le résultat à *stsptr.
+extern void xwc_get_stats(const xwc *x, struct xwc_stats *stsptr);
+
+//  struct xwc_memory : détail du nombre d'octets alloués pour les copies des
+//    mots, leurs informations, les compartiments et les cellules de la table
+//    de hachage, l'arbre, le fourretout, le buffer des mots à cheval sur deux
+//    blocs, le tableau des mots pliés, les autres fils d'exécution et les
+//    structures du mode approché ; total et limite fixée, nulle en l'absence
+//    de limite. Les projections en mémoire des fichiers ne sont pas
+//    décomptées.
+struct xwc_memory {
+  size_t strings;
+  size_t word_info;
+  size_t slots;
+  size_t cells;
+  size_t art;
+  size_t holdall;
+  size_t sbuffer;
+  size_t fold;
+  size_t threads;
+  size_t sketch;
+  size_t total;
+  size_t limit;
+};
+
+//  xwc_get_memory : affecte à *memptr le détail de la mémoire allouée par le
+//    contexte associé à x.
+extern void xwc_get_memory(const xwc *x, struct xwc_memory *memptr);
+
+#endif
@@ -0,0 +1,62 @@
+//  mfile.c : partie implantation d'un module pour la projection en mémoire,
+//    en lecture seule, du contenu de fichiers ordinaires.
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include "mfile.h"
+
+struct mfile {
+  void *addr;
+  size_t size;
+};
+
+//  Nombre de projections en cours, toutes réservées par mfile_map.
+static atomic_size_t nmaps = 0;
+
+mfile *mfile_map(int fd) {
+  struct stat st;
+  if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0
+      || (uintmax_t) st.st_size > SIZE_MAX) {
+    return NULL;
+  }
+  if (atomic_fetch_add(&nmaps, 1) >= MFILE_MAPS_MAX) {
+    atomic_fetch_sub(&nmaps, 1);
+    return NULL;
+  }
+  mfile *mf = malloc(sizeof *mf);
+  if (mf == NULL) {
+    atomic_fetch_sub(&nmaps, 1);
+    return NULL;
+  }
+  mf->size = (size_t) st.st_size;
+  mf->addr = mmap(NULL, mf->size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (mf->addr == MAP_FAILED) {
+    atomic_fetch_sub(&nmaps, 1);
+    free(mf);
+    return NULL;
+  }
+  posix_madvise(mf->addr, mf->size, POSIX_MADV_SEQUENTIAL);
+  return mf;
+}
+
+void mfile_unmap(mfile **mfptr) {
+  if (*mfptr == NULL) {
+    return;
+  }
+  munmap((*mfptr)->addr, (*mfptr)->size);
+  atomic_fetch_sub(&nmaps, 1);
+  free(*mfptr);
+  *mfptr = NULL;
+}
+
+const char *mfile_data(mfile *mf) {
+  return mf->addr;
+}
+
+size_t mfile_size(mfile *mf) {
+  return mf->size;
+}
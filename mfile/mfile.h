@@ -0,0 +1,37 @@
+//  mfile.h : partie interface d'un module pour la projection en mémoire, en
+//    lecture seule, du contenu de fichiers ordinaires.
+
+#ifndef MFILE__H
+#define MFILE__H
+
+#include <stdlib.h>
+
+//  MFILE_MAPS_MAX : nombre maximal de projections simultanées du processus.
+//    Le noyau borne le nombre de zones projetées d'un processus, par défaut à
+//    un peu moins de 65536, et malloc lui-même en consomme : au-delà de cette
+//    limite, les fichiers sont lus par les moyens habituels.
+#define MFILE_MAPS_MAX 16384
+
+//  struct mfile, mfile : type et nom de type d'un contrôleur regroupant les
+//    informations relatives à la projection d'un fichier.
+typedef struct mfile mfile;
+
+//  mfile_map : tente de projeter en mémoire l'intégralité du fichier ouvert
+//    associé au descripteur fd. Renvoie NULL si le fichier n'est pas un fichier
+//    ordinaire, s'il est vide, si MFILE_MAPS_MAX projections sont en cours, en
+//    cas de dépassement de capacité ou d'échec de la projection ; dans ce cas,
+//    le fichier peut être lu par les moyens habituels. Renvoie sinon un
+//    pointeur vers le contrôleur associé à la projection. La projection reste
+//    valide après la fermeture de fd.
+extern mfile *mfile_map(int fd);
+
+//  mfile_unmap : sans effet si *mfptr vaut NULL. Libère sinon les ressources
+//    allouées à la projection associée à *mfptr puis affecte NULL à *mfptr.
+extern void mfile_unmap(mfile **mfptr);
+
+//  mfile_data, mfile_size : renvoient respectivement l'adresse et la longueur
+//    de la projection associée à mf.
+extern const char *mfile_data(mfile *mf);
+extern size_t mfile_size(mfile *mf);
+
+#endif
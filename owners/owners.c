@@ -0,0 +1,102 @@
+//  owners.c : partie implantation d'un module pour une esquisse de
+//    l'appartenance de mots à des fichiers.
+
+#include "owners.h"
+#include "hugemem.h"
+
+//  Une cellule vaut OWNERS__EMPTY si aucun mot ne lui a été associé,
+//    OWNERS__SHARED si des mots de plusieurs fichiers l'ont été, l'indice du
+//    fichier augmenté de un sinon. Les depth cellules d'un mot sont choisies
+//    par double hachage : la k-ième est de rang h1 + k * h2 modulo width, où
+//    h1 est la valeur de hachage du mot et h2 une valeur impaire qui en est
+//    dérivée par brassage.
+
+#define OWNERS__EMPTY   0
+#define OWNERS__SHARED  UINT32_MAX
+
+//  struct owners, owners : le tableau cells, de longueur depth * width, range
+//    les rangées l'une après l'autre ; nshared est le nombre de cellules
+//    partagées. Le tableau, parcouru au hasard, est alloué par le module
+//    hugemem.
+struct owners {
+  size_t width;
+  size_t depth;
+  uint32_t *cells;
+  size_t nshared;
+};
+
+//  owners__mix : finalisation de MurmurHash3 sur 64 bits.
+static uint64_t owners__mix(uint64_t x) {
+  x ^= x >> 33;
+  x *= 0xFF51AFD7ED558CCDULL;
+  x ^= x >> 33;
+  x *= 0xC4CEB9FE1A85EC53ULL;
+  x ^= x >> 33;
+  return x;
+}
+
+owners *owners_empty(size_t width, size_t depth) {
+  if (width == 0 || depth == 0 || width > SIZE_MAX / depth
+      || width * depth > SIZE_MAX / sizeof(uint32_t)) {
+    return NULL;
+  }
+  owners *o = malloc(sizeof *o);
+  if (o == NULL) {
+    return NULL;
+  }
+  o->width = width;
+  o->depth = depth;
+  o->cells = hugemem_calloc(width * depth, sizeof *o->cells);
+  o->nshared = 0;
+  if (o->cells == NULL) {
+    free(o);
+    return NULL;
+  }
+  return o;
+}
+
+void owners_dispose(owners **optr) {
+  if (*optr == NULL) {
+    return;
+  }
+  hugemem_free((*optr)->cells);
+  free(*optr);
+  *optr = NULL;
+}
+
+void owners_mark(owners *o, uint64_t hash, size_t file) {
+  uint32_t v = (uint32_t) file + 1;
+  uint64_t h2 = owners__mix(hash) | 1;
+  uint32_t *row = o->cells;
+  for (size_t k = 0; k < o->depth; ++k) {
+    uint32_t *c = &row[(size_t) ((hash + k * h2) % o->width)];
+    if (*c == OWNERS__EMPTY) {
+      *c = v;
+    } else if (*c != v && *c != OWNERS__SHARED) {
+      *c = OWNERS__SHARED;
+      o->nshared += 1;
+    }
+    row += o->width;
+  }
+}
+
+bool owners_exclusive(const owners *o, uint64_t hash, size_t file) {
+  uint32_t v = (uint32_t) file + 1;
+  uint64_t h2 = owners__mix(hash) | 1;
+  const uint32_t *row = o->cells;
+  for (size_t k = 0; k < o->depth; ++k) {
+    if (row[(size_t) ((hash + k * h2) % o->width)] == v) {
+      return true;
+    }
+    row += o->width;
+  }
+  return false;
+}
+
+double owners_shared(const owners *o) {
+  return (double) o->nshared / (double) (o->width * o->depth);
+}
+
+size_t owners_memory(const owners *o) {
+  return sizeof *o + o->width * o->depth * sizeof *o->cells;
+}
@@ -0,0 +1,63 @@
+//  owners.h : partie interface d'un module pour une esquisse, en mémoire
+//    bornée, de l'appartenance de mots à des fichiers, qui permet de prouver
+//    qu'un mot n'apparaît que dans un seul fichier.
+
+#ifndef OWNERS__H
+#define OWNERS__H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+//  Fonctionnement général :
+//  - l'esquisse est formée de depth rangées de width cellules. Chaque mot est
+//      associé à une cellule par rangée, choisie d'après sa valeur de hachage
+//      sur 64 bits, que l'utilisateurice fournit. Une cellule mémorise
+//      l'indice du seul fichier dont des mots lui ont été associés, ou le fait
+//      que plusieurs fichiers l'ont été ;
+//  - l'erreur est unilatérale : un mot présent dans plusieurs fichiers n'est
+//      jamais déclaré exclusif, car toutes ses cellules sont partagées ; un
+//      mot exclusif peut ne pas être reconnu comme tel si chacune de ses
+//      cellules est aussi celle d'un mot d'un autre fichier. Pour un mot pris
+//      au hasard, cela survient avec une probabilité voisine de la proportion
+//      de cellules partagées élevée à la puissance depth ;
+//  - la mémoire occupée ne dépend que de width et de depth.
+
+//  struct owners, owners : type et nom de type d'un contrôleur regroupant les
+//    informations nécessaires pour gérer une esquisse.
+typedef struct owners owners;
+
+//  OWNERS_FILE_MAX : plus grand indice de fichier.
+#define OWNERS_FILE_MAX (UINT32_MAX - 2)
+
+//  owners_empty : tente d'allouer les ressources nécessaires pour gérer une
+//    nouvelle esquisse, initialement sans aucun mot, de depth rangées de width
+//    cellules. Renvoie NULL si width ou depth est nul ou en cas de dépassement
+//    de capacité. Renvoie sinon un pointeur vers le contrôleur associé à
+//    l'esquisse.
+extern owners *owners_empty(size_t width, size_t depth);
+
+//  owners_dispose : sans effet si *optr vaut NULL. Libère sinon les ressources
+//    allouées à la gestion de l'esquisse associée à *optr puis affecte NULL à
+//    *optr.
+extern void owners_dispose(owners **optr);
+
+//  owners_mark : prend en compte dans l'esquisse associée à o la présence du
+//    mot de valeur de hachage hash dans le fichier d'indice file, supposé au
+//    plus égal à OWNERS_FILE_MAX.
+extern void owners_mark(owners *o, uint64_t hash, size_t file);
+
+//  owners_exclusive : renvoie true s'il est certain que le mot de valeur de
+//    hachage hash, présent dans le fichier d'indice file, n'apparaît dans
+//    aucun autre fichier, false sinon.
+extern bool owners_exclusive(const owners *o, uint64_t hash, size_t file);
+
+//  owners_shared : renvoie la proportion de cellules de l'esquisse associée à
+//    o marquées comme partagées entre plusieurs fichiers.
+extern double owners_shared(const owners *o);
+
+//  owners_memory : renvoie le nombre d'octets alloués à la gestion de
+//    l'esquisse associée à o.
+extern size_t owners_memory(const owners *o);
+
+#endif
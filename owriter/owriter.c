@@ -0,0 +1,298 @@
+//  owriter.c : partie implantation d'un module pour la mise en forme, par
+//    plusieurs fils d'exécution, d'une suite d'enregistrements écrits dans
+//    leur ordre sur un flot.
+
+#include <stdalign.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "owriter.h"
+
+//  Un lot est soumis dès que ses enregistrements occupent au moins
+//    OWRITER__BATCH_SIZE octets. Le nombre de lots en cours est
+//    OWRITER__BATCHES_PER_THREAD par fil d'exécution, de sorte que le fil
+//    appelant remplit un lot pendant que les autres sont mis en forme.
+
+#define OWRITER__BATCH_SIZE         ((size_t) 1 << 20)
+#define OWRITER__BATCHES_PER_THREAD 2
+
+//  Chaque enregistrement est précédé de sa taille ; l'un et l'autre occupent
+//    un multiple de OWRITER__ALIGN octets.
+
+#define OWRITER__ALIGN  alignof(max_align_t)
+#define OWRITER__ROUND(n)                                                      \
+  (((n) + OWRITER__ALIGN - 1) / OWRITER__ALIGN * OWRITER__ALIGN)
+#define OWRITER__HEADER OWRITER__ROUND(sizeof(size_t))
+
+//  batch : type et nom de type pour une structure décrivant un lot : ses
+//    enregistrements, qui occupent les len premiers octets du tableau recs de
+//    capacité cap, leur mise en forme, qui occupe les outlen premiers octets
+//    du tableau out de capacité outcap, le fait qu'elle soit achevée et celui
+//    qu'elle ait échoué faute de mémoire.
+typedef struct {
+  char *recs;
+  size_t len;
+  size_t cap;
+  char *out;
+  size_t outlen;
+  size_t outcap;
+  bool done;
+  bool failed;
+} batch;
+
+//  struct owriter, owriter : les lots sont numérotés dans l'ordre et rangés
+//    dans le tableau circulaire batches de nbatches composants, le lot de
+//    numéro n au rang n modulo nbatches. Le lot de numéro fill est en cours
+//    de remplissage ; ceux de numéros compris entre head et fill (exclu)
+//    attendent d'être écrits, ceux à partir de next d'être pris en charge par
+//    un fil d'exécution. Les numéros et les indicateurs done sont protégés par
+//    lock ; work signale aux fils d'exécution qu'un lot est soumis ou que
+//    l'écriture est close, ready au fil appelant qu'un lot est mis en forme.
+struct owriter {
+  FILE *stream;
+  void *context;
+  size_t (*format)(void *context, const void *rec, char *dest, size_t room);
+  batch *batches;
+  size_t nbatches;
+  size_t fill;
+  size_t head;
+  size_t next;
+  bool closing;
+  bool failed;
+  pthread_t *threads;
+  size_t nthreads;
+  pthread_mutex_t lock;
+  pthread_cond_t work;
+  pthread_cond_t ready;
+};
+
+//  owriter__run : boucle d'un fil d'exécution de l'écriture associée à ow.
+static void *owriter__run(owriter *ow);
+
+//  owriter__format : met en forme les enregistrements du lot pointé par b.
+static void owriter__format(owriter *ow, batch *b);
+
+//  owriter__write : écrit sur le flot la mise en forme du lot pointé par b,
+//    supposée achevée, puis vide le lot.
+static void owriter__write(owriter *ow, batch *b);
+
+//  owriter__submit : soumet le lot en cours de remplissage et écrit les lots
+//    déjà mis en forme, en attendant si besoin que le prochain lot à remplir
+//    soit disponible.
+static void owriter__submit(owriter *ow);
+
+owriter *owriter_create(FILE *stream, size_t nthreads, void *context,
+    size_t (*format)(void *context, const void *rec, char *dest,
+      size_t room)) {
+  if (nthreads > SIZE_MAX / OWRITER__BATCHES_PER_THREAD) {
+    return NULL;
+  }
+  owriter *ow = malloc(sizeof *ow);
+  if (ow == NULL) {
+    return NULL;
+  }
+  ow->stream = stream;
+  ow->context = context;
+  ow->format = format;
+  ow->nbatches = (nthreads == 0 ? 1 : OWRITER__BATCHES_PER_THREAD * nthreads);
+  ow->batches = calloc(ow->nbatches, sizeof *ow->batches);
+  ow->fill = 0;
+  ow->head = 0;
+  ow->next = 0;
+  ow->closing = false;
+  ow->failed = false;
+  ow->threads = (nthreads == 0 ? NULL
+      : malloc(nthreads * sizeof *ow->threads));
+  ow->nthreads = 0;
+  if (ow->batches == NULL || (nthreads != 0 && ow->threads == NULL)) {
+    goto error_capacity;
+  }
+  pthread_mutex_init(&ow->lock, NULL);
+  pthread_cond_init(&ow->work, NULL);
+  pthread_cond_init(&ow->ready, NULL);
+  for (; ow->nthreads < nthreads; ++ow->nthreads) {
+    if (pthread_create(&ow->threads[ow->nthreads], NULL,
+        (void *(*)(void *))owriter__run, ow) != 0) {
+      owriter_close(&ow);
+      return NULL;
+    }
+  }
+  return ow;
+error_capacity:
+  free(ow->batches);
+  free(ow->threads);
+  free(ow);
+  return NULL;
+}
+
+void *owriter_record(owriter *ow, size_t size) {
+  batch *b = &ow->batches[ow->fill % ow->nbatches];
+  if (b->len >= OWRITER__BATCH_SIZE) {
+    owriter__submit(ow);
+    b = &ow->batches[ow->fill % ow->nbatches];
+  }
+  if (size > SIZE_MAX - OWRITER__HEADER - OWRITER__ALIGN) {
+    return NULL;
+  }
+  size_t n = OWRITER__HEADER + OWRITER__ROUND(size);
+  if (n > b->cap - b->len) {
+    if (b->len > SIZE_MAX / 2 - n) {
+      return NULL;
+    }
+    size_t cap = 2 * b->len + n;
+    if (cap < OWRITER__BATCH_SIZE) {
+      cap = OWRITER__BATCH_SIZE;
+    }
+    char *a = realloc(b->recs, cap);
+    if (a == NULL) {
+      return NULL;
+    }
+    b->recs = a;
+    b->cap = cap;
+  }
+  char *r = b->recs + b->len;
+  memcpy(r, &size, sizeof size);
+  b->len += n;
+  return r + OWRITER__HEADER;
+}
+
+int owriter_close(owriter **owptr) {
+  owriter *ow = *owptr;
+  if (ow == NULL) {
+    return 0;
+  }
+  if (ow->batches[ow->fill % ow->nbatches].len != 0) {
+    owriter__submit(ow);
+  }
+  pthread_mutex_lock(&ow->lock);
+  while (ow->head < ow->fill) {
+    batch *b = &ow->batches[ow->head % ow->nbatches];
+    while (!b->done) {
+      pthread_cond_wait(&ow->ready, &ow->lock);
+    }
+    pthread_mutex_unlock(&ow->lock);
+    owriter__write(ow, b);
+    pthread_mutex_lock(&ow->lock);
+    ow->head += 1;
+  }
+  ow->closing = true;
+  pthread_cond_broadcast(&ow->work);
+  pthread_mutex_unlock(&ow->lock);
+  for (size_t k = 0; k < ow->nthreads; ++k) {
+    pthread_join(ow->threads[k], NULL);
+  }
+  pthread_mutex_destroy(&ow->lock);
+  pthread_cond_destroy(&ow->work);
+  pthread_cond_destroy(&ow->ready);
+  for (size_t k = 0; k < ow->nbatches; ++k) {
+    free(ow->batches[k].recs);
+    free(ow->batches[k].out);
+  }
+  int r = ow->failed ? -1 : 0;
+  free(ow->batches);
+  free(ow->threads);
+  free(ow);
+  *owptr = NULL;
+  return r;
+}
+
+void *owriter__run(owriter *ow) {
+  pthread_mutex_lock(&ow->lock);
+  while (true) {
+    while (ow->next == ow->fill && !ow->closing) {
+      pthread_cond_wait(&ow->work, &ow->lock);
+    }
+    if (ow->next == ow->fill) {
+      break;
+    }
+    batch *b = &ow->batches[ow->next % ow->nbatches];
+    ow->next += 1;
+    pthread_mutex_unlock(&ow->lock);
+    owriter__format(ow, b);
+    pthread_mutex_lock(&ow->lock);
+    b->done = true;
+    pthread_cond_broadcast(&ow->ready);
+  }
+  pthread_mutex_unlock(&ow->lock);
+  return NULL;
+}
+
+void owriter__format(owriter *ow, batch *b) {
+  b->outlen = 0;
+  if (b->out == NULL) {
+    b->out = malloc(OWRITER__BATCH_SIZE);
+    if (b->out == NULL) {
+      b->failed = true;
+      return;
+    }
+    b->outcap = OWRITER__BATCH_SIZE;
+  }
+  size_t k = 0;
+  while (k < b->len) {
+    size_t size;
+    memcpy(&size, b->recs + k, sizeof size);
+    const void *rec = b->recs + k + OWRITER__HEADER;
+    size_t room = b->outcap - b->outlen;
+    size_t n = ow->format(ow->context, rec, b->out + b->outlen, room);
+    if (n > room) {
+      if (b->outlen > SIZE_MAX / 2 - n) {
+        b->failed = true;
+        return;
+      }
+      size_t cap = 2 * b->outlen + n;
+      char *a = realloc(b->out, cap);
+      if (a == NULL) {
+        b->failed = true;
+        return;
+      }
+      b->out = a;
+      b->outcap = cap;
+      n = ow->format(ow->context, rec, b->out + b->outlen, cap - b->outlen);
+    }
+    b->outlen += n;
+    k += OWRITER__HEADER + OWRITER__ROUND(size);
+  }
+}
+
+void owriter__write(owriter *ow, batch *b) {
+  if (b->failed) {
+    ow->failed = true;
+  } else if (b->outlen != 0) {
+    fwrite(b->out, 1, b->outlen, ow->stream);
+  }
+  b->len = 0;
+  b->outlen = 0;
+  b->done = false;
+  b->failed = false;
+}
+
+void owriter__submit(owriter *ow) {
+  if (ow->nthreads == 0) {
+    batch *b = &ow->batches[0];
+    owriter__format(ow, b);
+    owriter__write(ow, b);
+    return;
+  }
+  pthread_mutex_lock(&ow->lock);
+  ow->fill += 1;
+  pthread_cond_signal(&ow->work);
+  //  Le prochain lot à remplir est libre dès que le plus ancien est écrit.
+  while (ow->head < ow->fill) {
+    batch *b = &ow->batches[ow->head % ow->nbatches];
+    if (!b->done) {
+      if (ow->fill - ow->head < ow->nbatches) {
+        break;
+      }
+      pthread_cond_wait(&ow->ready, &ow->lock);
+      continue;
+    }
+    pthread_mutex_unlock(&ow->lock);
+    owriter__write(ow, b);
+    pthread_mutex_lock(&ow->lock);
+    ow->head += 1;
+  }
+  pthread_mutex_unlock(&ow->lock);
+}
@@ -0,0 +1,58 @@
+//  owriter.h : partie interface d'un module pour la mise en forme, par
+//    plusieurs fils d'exécution, d'une suite d'enregistrements écrits dans
+//    leur ordre sur un flot.
+
+#ifndef OWRITER__H
+#define OWRITER__H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+//  Fonctionnement général :
+//  - l'utilisateurice réserve les enregistrements l'un après l'autre et les
+//      remplit avec des données de son choix. Les enregistrements sont
+//      regroupés par lots consécutifs ; chaque lot complet est mis en forme
+//      par l'un des fils d'exécution du module dans un buffer qui lui est
+//      propre ;
+//  - les buffers sont écrits sur le flot par le fil d'exécution appelant,
+//      dans l'ordre des lots, lors des réservations et de la fermeture : la
+//      sortie est celle d'une mise en forme séquentielle. Le nombre de lots
+//      en cours est borné, de sorte que la mémoire occupée ne dépend pas du
+//      nombre d'enregistrements ;
+//  - sans fil d'exécution, chaque lot est mis en forme puis écrit par le fil
+//      d'exécution appelant ;
+//  - les erreurs d'écriture sont laissées à l'indicateur d'erreur du flot.
+
+//  struct owriter, owriter : type et nom de type d'un contrôleur regroupant les
+//    informations nécessaires pour gérer une écriture.
+typedef struct owriter owriter;
+
+//  owriter_create : tente d'allouer les ressources nécessaires pour gérer une
+//    nouvelle écriture sur le flot stream avec nthreads fils d'exécution, 0
+//    pour n'en lancer aucun. La fonction de mise en forme est pointée par
+//    format : elle est appelée avec context pour chaque enregistrement rec et
+//    doit renvoyer la longueur de sa mise en forme, qu'elle n'écrit à
+//    l'adresse dest que si cette longueur est au plus room. Elle peut être
+//    appelée simultanément par plusieurs fils d'exécution. Renvoie NULL en cas
+//    de dépassement de capacité ou si les fils d'exécution ne peuvent être
+//    lancés. Renvoie sinon un pointeur vers le contrôleur associé à
+//    l'écriture.
+extern owriter *owriter_create(FILE *stream, size_t nthreads, void *context,
+    size_t (*format)(void *context, const void *rec, char *dest,
+      size_t room));
+
+//  owriter_record : tente de réserver un nouvel enregistrement de size octets
+//    pour l'écriture associée à ow. L'enregistrement doit être rempli avant
+//    l'appel suivant d'une fonction du module. Renvoie NULL en cas de
+//    dépassement de capacité. Renvoie sinon l'adresse de l'enregistrement,
+//    convenablement alignée pour tout type.
+extern void *owriter_record(owriter *ow, size_t size);
+
+//  owriter_close : met en forme et écrit les enregistrements de l'écriture
+//    associée à *owptr qui ne l'ont pas encore été, libère les ressources
+//    allouées à sa gestion puis affecte NULL à *owptr. Sans effet si *owptr
+//    vaut NULL. Renvoie une valeur non nulle si un dépassement de capacité est
+//    survenu lors de la mise en forme, zéro sinon.
+extern int owriter_close(owriter **owptr);
+
+#endif
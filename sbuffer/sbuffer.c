@@ -7,28 +7,32 @@
 
 #include "sbuffer.h"
 
-#define BUFF__CAPACITY_MIN  4
 #define BUFF__CAPACITY_MUL  2
 
+//  struct sbuffer : la chaîne occupe les length premiers octets du tableau
+//    array, de capacité capacity strictement supérieure à length. Le tableau
+//    array est inline tant que sa capacité suffit, alloué sinon.
 struct sbuffer {
   char *array;
   size_t length;
   size_t capacity;
+  char inline_array[SBUFFER_INLINE_CAPACITY];
 };
 
+//  sbuffer__grow : tente d'agrandir le tableau du buffer pointé par sb pour
+//    qu'il puisse recevoir n octets de plus que sa longueur, caractère de fin
+//    de chaîne non compris. Renvoie 0 en cas de succès, une valeur non nulle
+//    en cas de dépassement de capacité.
+static int sbuffer__grow(sbuffer *sb, size_t n);
+
 sbuffer *sbuffer_empty() {
   sbuffer *sb = malloc(sizeof *sb);
   if (sb == NULL) {
     return NULL;
   }
-  char *arr = malloc(BUFF__CAPACITY_MIN * sizeof *arr);
-  if (arr == NULL) {
-    free(sb);
-    return NULL;
-  }
-  sb->array = arr;
+  sb->array = sb->inline_array;
   sb->length = 0;
-  sb->capacity = BUFF__CAPACITY_MIN;
+  sb->capacity = SBUFFER_INLINE_CAPACITY;
   return sb;
 }
 
@@ -36,7 +40,9 @@ void sbuffer_dispose(sbuffer **sb) {
   if (*sb == NULL) {
     return;
   }
-  free((*sb)->array);
+  if ((*sb)->array != (*sb)->inline_array) {
+    free((*sb)->array);
+  }
   free(*sb);
   *sb = NULL;
 }
@@ -45,37 +51,75 @@ size_t sbuffer_length(sbuffer *sb) {
   return sb->length;
 }
 
+size_t sbuffer_memory(sbuffer *sb) {
+  return sizeof *sb + (sb->array == sb->inline_array ? 0
+      : sb->capacity * sizeof *sb->array);
+}
+
 void sbuffer_clear(sbuffer *sb) {
   sb->length = 0;
 }
 
+int sbuffer_reserve(sbuffer *sb, size_t n) {
+  if (n < sb->capacity - sb->length) {
+    return 0;
+  }
+  return sbuffer__grow(sb, n);
+}
+
 int sbuffer_append(sbuffer *sb, char c) {
-  if (sb->length > 0 && sb->array[sb->length - 1] == '\0') {
+  if (sb->length + 1 == sb->capacity && sbuffer__grow(sb, 1) != 0) {
     return 1;
   }
-  if (sb->length == sb->capacity) {
-    if (sb->capacity * sizeof *sb->array > SIZE_MAX / BUFF__CAPACITY_MUL) {
-      return 2;
-    }
-    char *arr = realloc(sb->array, sb->capacity * BUFF__CAPACITY_MUL
-        * sizeof *sb->array);
-    if (arr == NULL) {
-      free(arr);
-      return 3;
-    }
-    sb->array = arr;
-    sb->capacity *= BUFF__CAPACITY_MUL;
-  }
   sb->array[sb->length] = c;
   sb->length += 1;
   return 0;
 }
 
+int sbuffer_append_span(sbuffer *sb, const char *s, size_t n) {
+  if (n >= sb->capacity - sb->length && sbuffer__grow(sb, n) != 0) {
+    return 1;
+  }
+  if (n != 0) {
+    memcpy(sb->array + sb->length, s, n);
+  }
+  sb->length += n;
+  return 0;
+}
+
 char *sbuffer_get_str(sbuffer *sb) {
-  if (sb->length == 0 || sb->array[sb->length - 1] != '\0') {
-    if (sbuffer_append(sb, '\0') != 0) {
-      return NULL;
+  sb->array[sb->length] = '\0';
+  return sb->array;
+}
+
+char *sbuffer_get_span(sbuffer *sb, size_t *lenptr) {
+  *lenptr = sb->length;
+  return sbuffer_get_str(sb);
+}
+
+int sbuffer__grow(sbuffer *sb, size_t n) {
+  if (n > SIZE_MAX / sizeof *sb->array - 1 - sb->length) {
+    return 1;
+  }
+  size_t need = sb->length + n + 1;
+  size_t capacity = sb->capacity;
+  while (capacity < need) {
+    capacity = capacity > SIZE_MAX / sizeof *sb->array / BUFF__CAPACITY_MUL
+        ? need : capacity * BUFF__CAPACITY_MUL;
+  }
+  char *arr;
+  if (sb->array == sb->inline_array) {
+    arr = malloc(capacity * sizeof *arr);
+    if (arr != NULL) {
+      memcpy(arr, sb->inline_array, sb->length);
     }
+  } else {
+    arr = realloc(sb->array, capacity * sizeof *arr);
   }
-  return sb->array;
+  if (arr == NULL) {
+    return 1;
+  }
+  sb->array = arr;
+  sb->capacity = capacity;
+  return 0;
 }
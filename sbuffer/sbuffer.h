@@ -4,6 +4,21 @@
 #ifndef SBUFFER__H
 #define SBUFFER__H
 
+#include <stdlib.h>
+
+//  Fonctionnement général :
+//  - le buffer mémorise une suite d'octets de longueur explicite, qui peut
+//      contenir le caractère nul ;
+//  - une place est toujours réservée après le dernier octet pour le caractère
+//      de fin de chaîne, qui ne fait pas partie de la suite ;
+//  - les octets sont d'abord rangés dans un tableau interne au contrôleur, de
+//      SBUFFER_INLINE_CAPACITY octets : les mots courts ne provoquent aucune
+//      allocation.
+
+//  SBUFFER_INLINE_CAPACITY : capacité du tableau interne, caractère de fin de
+//    chaîne compris.
+#define SBUFFER_INLINE_CAPACITY 32
+
 //  struct sbuffer, sbuffer : type et nom de type d'un contrôleur regroupant
 //    les informations nécessaires pour gérer un buffer de caractères.
 typedef struct sbuffer sbuffer;
@@ -22,21 +37,36 @@ extern void sbuffer_dispose(sbuffer **sb);
 //    par le buffer pointé par sb.
 extern size_t sbuffer_length(sbuffer *sb);
 
-//  sbuffer_clear : vide le buffer pointé par sb.
+//  sbuffer_memory : renvoie le nombre d'octets actuellement alloués pour la
+//    gestion du buffer pointé par sb, contrôleur compris.
+extern size_t sbuffer_memory(sbuffer *sb);
+
+//  sbuffer_clear : vide le buffer pointé par sb. Sa capacité est conservée.
 extern void sbuffer_clear(sbuffer *sb);
 
+//  sbuffer_reserve : tente de faire en sorte que n caractères puissent être
+//    ajoutés au buffer pointé par sb sans qu'il soit agrandi. Renvoie 0 en cas
+//    de succès, une valeur non nulle en cas de dépassement de capacité.
+extern int sbuffer_reserve(sbuffer *sb, size_t n);
+
 //  sbuffer_append : tente d'ajouter le caractère c à la fin de la chaîne de
-//    caractères représentée par le buffer pointé par sb. Il n'est pas possible
-//    d'insérer un nouveau caractère si le buffer contient le caractère de fin
-//    de chaîne '\0'. Renvoie 0 en cas de succès, une valeur non nulle si le
-//    buffer contient le caractère de fin de chaîne ou en cas de dépassement de
-//    capacité.
+//    caractères représentée par le buffer pointé par sb. Renvoie 0 en cas de
+//    succès, une valeur non nulle en cas de dépassement de capacité.
 extern int sbuffer_append(sbuffer *sb, char c);
 
-//  sbuffer_get_str : si le buffer pointé par sb contient déjà le caractère de
-//    fin de chaîne '\0', renvoie la chaîne qu'il contient. Sinon, tente
-//    d'ajouter '\0' à la fin du buffer et renvoie NULL en cas de dépassement de
-//    capacité; la chaîne si tout s'est bien passé.
+//  sbuffer_append_span : tente d'ajouter les n octets pointés par s à la fin
+//    de la chaîne de caractères représentée par le buffer pointé par sb.
+//    Renvoie 0 en cas de succès, une valeur non nulle en cas de dépassement de
+//    capacité, le buffer étant alors inchangé.
+extern int sbuffer_append_span(sbuffer *sb, const char *s, size_t n);
+
+//  sbuffer_get_str : termine par le caractère de fin de chaîne '\0' la chaîne
+//    représentée par le buffer pointé par sb, sans changer sa longueur, et la
+//    renvoie. La chaîne reste valide jusqu'au prochain ajout.
 extern char *sbuffer_get_str(sbuffer *sb);
 
+//  sbuffer_get_span : même fonction que sbuffer_get_str, la longueur de la
+//    chaîne étant de plus affectée à *lenptr.
+extern char *sbuffer_get_span(sbuffer *sb, size_t *lenptr);
+
 #endif
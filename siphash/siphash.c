@@ -0,0 +1,117 @@
+//  siphash.c : partie implantation d'un module pour le hachage à clé secrète de
+//    suites d'octets par la fonction SipHash-1-3.
+
+#include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "siphash.h"
+
+#define ROTL(x, b) (((x) << (b)) | ((x) >> (64 - (b))))
+
+//  SIPROUND : une ronde de SipHash sur l'état v0, v1, v2, v3.
+#define SIPROUND(v0, v1, v2, v3)                                               \
+  do {                                                                         \
+    v0 += v1;                                                                  \
+    v1 = ROTL(v1, 13);                                                         \
+    v1 ^= v0;                                                                  \
+    v0 = ROTL(v0, 32);                                                         \
+    v2 += v3;                                                                  \
+    v3 = ROTL(v3, 16);                                                         \
+    v3 ^= v2;                                                                  \
+    v0 += v3;                                                                  \
+    v3 = ROTL(v3, 21);                                                         \
+    v3 ^= v0;                                                                  \
+    v2 += v1;                                                                  \
+    v1 = ROTL(v1, 17);                                                         \
+    v1 ^= v2;                                                                  \
+    v2 = ROTL(v2, 32);                                                         \
+  } while (0)
+
+//  siphash__load : renvoie le mot de 64 bits formé des huit octets d'adresse p,
+//    lus dans l'ordre de la machine. La fonction n'est pas portable d'une
+//    architecture à l'autre ; les valeurs de hachage n'ont pas à l'être.
+static inline uint64_t siphash__load(const unsigned char *p) {
+  uint64_t m;
+  memcpy(&m, p, sizeof m);
+  return m;
+}
+
+uint64_t siphash(const void *data, size_t len, const uint64_t key[2]) {
+  const unsigned char *p = data;
+  uint64_t v0 = key[0] ^ 0x736F6D6570736575ULL;
+  uint64_t v1 = key[1] ^ 0x646F72616E646F6DULL;
+  uint64_t v2 = key[0] ^ 0x6C7967656E657261ULL;
+  uint64_t v3 = key[1] ^ 0x7465646279746573ULL;
+  const unsigned char *end = p + (len & ~(size_t) 7);
+  for (; p != end; p += 8) {
+    uint64_t m = siphash__load(p);
+    v3 ^= m;
+    SIPROUND(v0, v1, v2, v3);
+    v0 ^= m;
+  }
+  uint64_t b = (uint64_t) len << 56;
+  switch (len & 7) {
+    case 7:
+      b |= (uint64_t) p[6] << 48;
+      [[fallthrough]];
+    case 6:
+      b |= (uint64_t) p[5] << 40;
+      [[fallthrough]];
+    case 5:
+      b |= (uint64_t) p[4] << 32;
+      [[fallthrough]];
+    case 4:
+      b |= (uint64_t) p[3] << 24;
+      [[fallthrough]];
+    case 3:
+      b |= (uint64_t) p[2] << 16;
+      [[fallthrough]];
+    case 2:
+      b |= (uint64_t) p[1] << 8;
+      [[fallthrough]];
+    case 1:
+      b |= (uint64_t) p[0];
+      break;
+    default:
+      break;
+  }
+  v3 ^= b;
+  SIPROUND(v0, v1, v2, v3);
+  v0 ^= b;
+  v2 ^= 0xFF;
+  SIPROUND(v0, v1, v2, v3);
+  SIPROUND(v0, v1, v2, v3);
+  SIPROUND(v0, v1, v2, v3);
+  return v0 ^ v1 ^ v2 ^ v3;
+}
+
+//  siphash__counter : nombre de clés dérivées sans /dev/urandom.
+static atomic_uint_fast64_t siphash__counter;
+
+void siphash_key_random(uint64_t key[2]) {
+  FILE *f = fopen("/dev/urandom", "rb");
+  if (f != NULL) {
+    size_t n = fread(key, sizeof *key, 2, f);
+    fclose(f);
+    if (n == 2) {
+      return;
+    }
+  }
+  struct timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  uint64_t s[4] = {
+    (uint64_t) ts.tv_sec,
+    (uint64_t) ts.tv_nsec,
+    (uint64_t) getpid(),
+    atomic_fetch_add(&siphash__counter, 1),
+  };
+  const uint64_t k0[2] = {
+    (uint64_t) (uintptr_t) &ts, (uint64_t) (uintptr_t) key
+  };
+  key[0] = siphash(s, sizeof s, k0);
+  s[3] = ~s[3];
+  key[1] = siphash(s, sizeof s, k0);
+}
@@ -0,0 +1,32 @@
+//  siphash.h : partie interface d'un module pour le hachage à clé secrète de
+//    suites d'octets par la fonction SipHash-1-3.
+
+#ifndef SIPHASH__H
+#define SIPHASH__H
+
+#include <stdlib.h>
+#include <stdint.h>
+
+//  Fonctionnement général :
+//  - la valeur de hachage d'une suite d'octets dépend d'une clé secrète de 128
+//      bits, mémorisée dans un tableau de deux entiers sur 64 bits. Sans
+//      connaitre la clé, il n'est pas possible de fabriquer en nombre des
+//      suites de même valeur de hachage : une table de hachage dont la fonction
+//      de pré-hachage repose sur ce module résiste ainsi aux entrées conçues
+//      pour saturer l'une de ses listes ;
+//  - la variante 1-3 de SipHash, une ronde par mot et trois de finalisation,
+//      est celle des tables de hachage de Python et de Rust : elle est plus
+//      rapide que la variante 2-4 d'origine et reste hors de portée des
+//      attaques connues dans cet usage.
+
+//  siphash : renvoie la valeur de hachage pour la clé key de la suite des len
+//    octets d'adresse data.
+extern uint64_t siphash(const void *data, size_t len, const uint64_t key[2]);
+
+//  siphash_key_random : tire une nouvelle clé et l'affecte à key[0] et key[1].
+//    La clé est lue sur /dev/urandom. Si la lecture échoue, elle est dérivée
+//    de l'heure, du numéro du processus et d'un compteur propre au module :
+//    deux appels renvoient alors tout de même des clés distinctes.
+extern void siphash_key_random(uint64_t key[2]);
+
+#endif
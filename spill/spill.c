@@ -0,0 +1,265 @@
+//  spill.c : partie implantation d'un module pour la mémorisation sur disque
+//    de n-uplets (mot, fichier, nombre d'occurrences) répartis en partitions.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "spill.h"
+
+//  Le nom des fichiers temporaires est formé du nom du répertoire suivi de
+//    SPILL__TEMPLATE.
+
+#define SPILL__TEMPLATE       "/xwc-spill-XXXXXX"
+#define SPILL__BUF_MIN        64
+#define SPILL__BUF_MUL        2
+
+//  Un n-uplet est écrit sous forme binaire : la longueur du mot (size_t), les
+//    octets du mot, l'indice du fichier (size_t) puis le nombre d'occurrences
+//    (long int). Les fichiers n'ont pas vocation à être relus sur une autre
+//    machine.
+
+//  partition : type et nom de type d'une partition. Le composant buf mémorise
+//    le dernier mot lu, de longueur len, de capacité cap ; file et occ les
+//    autres composantes du dernier n-uplet lu.
+typedef struct {
+  FILE *f;
+  char *buf;
+  size_t cap;
+  size_t len;
+  size_t file;
+  long int occ;
+} partition;
+
+struct spill {
+  partition *parts;
+  size_t nparts;
+  size_t count;
+  size_t bytes;
+};
+
+//  spill__fnv1a : fonction de hachage FNV-1a sur 64 bits.
+static uint64_t spill__fnv1a(const char *w, size_t len) {
+  uint64_t h = 0xCBF29CE484222325ULL;
+  for (size_t k = 0; k < len; ++k) {
+    h ^= (unsigned char) w[k];
+    h *= 0x100000001B3ULL;
+  }
+  return h;
+}
+
+spill *spill_empty(const char *dir, size_t nparts) {
+  if (nparts == 0) {
+    return NULL;
+  }
+  spill *sp = malloc(sizeof *sp);
+  if (sp == NULL) {
+    return NULL;
+  }
+  sp->parts = calloc(nparts, sizeof *sp->parts);
+  size_t dirlen = strlen(dir);
+  char *name = malloc(dirlen + sizeof SPILL__TEMPLATE);
+  if (sp->parts == NULL || name == NULL) {
+    free(name);
+    free(sp->parts);
+    free(sp);
+    return NULL;
+  }
+  sp->nparts = nparts;
+  sp->count = 0;
+  sp->bytes = 0;
+  for (size_t k = 0; k < nparts; ++k) {
+    strcpy(name, dir);
+    strcpy(name + dirlen, SPILL__TEMPLATE);
+    int fd = mkstemp(name);
+    if (fd == -1) {
+      goto error;
+    }
+    unlink(name);
+    sp->parts[k].f = fdopen(fd, "w+b");
+    if (sp->parts[k].f == NULL) {
+      close(fd);
+      goto error;
+    }
+  }
+  free(name);
+  return sp;
+error:
+  free(name);
+  spill_dispose(&sp);
+  return NULL;
+}
+
+void spill_dispose(spill **spptr) {
+  if (*spptr == NULL) {
+    return;
+  }
+  for (size_t k = 0; k < (*spptr)->nparts; ++k) {
+    if ((*spptr)->parts[k].f != NULL) {
+      fclose((*spptr)->parts[k].f);
+    }
+    free((*spptr)->parts[k].buf);
+  }
+  free((*spptr)->parts);
+  free(*spptr);
+  *spptr = NULL;
+}
+
+size_t spill_nparts(spill *sp) {
+  return sp->nparts;
+}
+
+size_t spill_partition(spill *sp, const char *w, size_t len) {
+  return (size_t) (spill__fnv1a(w, len) % sp->nparts);
+}
+
+int spill_put(spill *sp, size_t part, const char *w, size_t len,
+    size_t file, long int occ) {
+  FILE *f = sp->parts[part].f;
+  if (fwrite(&len, sizeof len, 1, f) != 1
+      || fwrite(w, 1, len, f) != len
+      || fwrite(&file, sizeof file, 1, f) != 1
+      || fwrite(&occ, sizeof occ, 1, f) != 1) {
+    return -1;
+  }
+  sp->count += 1;
+  sp->bytes += sizeof len + len + sizeof file + sizeof occ;
+  return 0;
+}
+
+int spill_rewind(spill *sp, size_t part) {
+  FILE *f = sp->parts[part].f;
+  return fflush(f) != 0 || ferror(f) || fseek(f, 0, SEEK_SET) != 0 ? -1 : 0;
+}
+
+int spill_get(spill *sp, size_t part, const char **wptr, size_t *lenptr,
+    size_t *fileptr, long int *occptr) {
+  partition *pt = &sp->parts[part];
+  size_t len;
+  if (fread(&len, sizeof len, 1, pt->f) != 1) {
+    return feof(pt->f) ? 1 : -1;
+  }
+  if (len >= pt->cap) {
+    size_t cap = (pt->cap == 0 ? SPILL__BUF_MIN : pt->cap);
+    while (len >= cap) {
+      if (cap > SIZE_MAX / SPILL__BUF_MUL) {
+        return -1;
+      }
+      cap *= SPILL__BUF_MUL;
+    }
+    char *buf = realloc(pt->buf, cap);
+    if (buf == NULL) {
+      return -1;
+    }
+    pt->buf = buf;
+    pt->cap = cap;
+  }
+  if (fread(pt->buf, 1, len, pt->f) != len
+      || fread(&pt->file, sizeof pt->file, 1, pt->f) != 1
+      || fread(&pt->occ, sizeof pt->occ, 1, pt->f) != 1) {
+    return -1;
+  }
+  pt->buf[len] = '\0';
+  pt->len = len;
+  *wptr = pt->buf;
+  *lenptr = len;
+  *fileptr = pt->file;
+  *occptr = pt->occ;
+  return 0;
+}
+
+//  spill__less : teste si le n-uplet courant de la partition d'indice i
+//    précède celui de la partition d'indice j selon compar, l'indice de
+//    partition départageant les égalités.
+static int spill__less(spill *sp, size_t i, size_t j,
+    int (*compar)(const char *, const char *)) {
+  int c = compar(sp->parts[i].buf, sp->parts[j].buf);
+  return c < 0 || (c == 0 && i < j);
+}
+
+//  spill__sift_down : rétablit la propriété de tas min, selon spill__less, du
+//    tas heap de longueur n à partir de la position k.
+static void spill__sift_down(spill *sp, size_t *heap, size_t n, size_t k,
+    int (*compar)(const char *, const char *)) {
+  for (;;) {
+    size_t m = k;
+    size_t l = 2 * k + 1;
+    size_t r = l + 1;
+    if (l < n && spill__less(sp, heap[l], heap[m], compar)) {
+      m = l;
+    }
+    if (r < n && spill__less(sp, heap[r], heap[m], compar)) {
+      m = r;
+    }
+    if (m == k) {
+      return;
+    }
+    size_t t = heap[k];
+    heap[k] = heap[m];
+    heap[m] = t;
+    k = m;
+  }
+}
+
+int spill_merge(spill *sp, int (*compar)(const char *, const char *),
+    void *context, int (*fun)(void *context, const char *w, size_t file,
+      long int occ)) {
+  size_t *heap = malloc(sp->nparts * sizeof *heap);
+  if (heap == NULL) {
+    return -1;
+  }
+  int r = 0;
+  size_t n = 0;
+  for (size_t k = 0; k < sp->nparts; ++k) {
+    const char *w;
+    size_t len;
+    size_t file;
+    long int occ;
+    int g;
+    if (spill_rewind(sp, k) != 0
+        || (g = spill_get(sp, k, &w, &len, &file, &occ)) < 0) {
+      r = -1;
+      goto dispose;
+    }
+    if (g == 0) {
+      heap[n] = k;
+      ++n;
+    }
+  }
+  for (size_t k = n / 2; k > 0; --k) {
+    spill__sift_down(sp, heap, n, k - 1, compar);
+  }
+  while (n > 0) {
+    partition *pt = &sp->parts[heap[0]];
+    r = fun(context, pt->buf, pt->file, pt->occ);
+    if (r != 0) {
+      goto dispose;
+    }
+    const char *w;
+    size_t len;
+    size_t file;
+    long int occ;
+    int g = spill_get(sp, heap[0], &w, &len, &file, &occ);
+    if (g < 0) {
+      r = -1;
+      goto dispose;
+    }
+    if (g > 0) {
+      --n;
+      heap[0] = heap[n];
+    }
+    spill__sift_down(sp, heap, n, 0, compar);
+  }
+dispose:
+  free(heap);
+  return r;
+}
+
+size_t spill_count(spill *sp) {
+  return sp->count;
+}
+
+size_t spill_bytes(spill *sp) {
+  return sp->bytes;
+}
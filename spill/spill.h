@@ -0,0 +1,68 @@
+//  spill.h : partie interface d'un module pour la mémorisation sur disque de
+//    n-uplets (mot, fichier, nombre d'occurrences) répartis en partitions.
+//    Chaque partition est un fichier temporaire qui est lu séquentiellement
+//    dans l'ordre d'écriture.
+
+#ifndef SPILL__H
+#define SPILL__H
+
+#include <stdlib.h>
+
+//  struct spill, spill : type et nom de type d'un contrôleur regroupant les
+//    informations nécessaires pour gérer un ensemble de partitions.
+typedef struct spill spill;
+
+//  spill_empty : tente de créer nparts partitions vides sous la forme de
+//    fichiers temporaires dans le répertoire de nom dir. Les fichiers sont
+//    supprimés du répertoire dès leur création. Renvoie NULL en cas d'échec.
+//    Renvoie sinon un pointeur vers le contrôleur associé aux partitions.
+extern spill *spill_empty(const char *dir, size_t nparts);
+
+//  spill_dispose : sans effet si *spptr vaut NULL. Libère sinon les ressources
+//    allouées à la gestion des partitions associées à *spptr puis affecte NULL
+//    à *spptr.
+extern void spill_dispose(spill **spptr);
+
+//  spill_nparts : renvoie le nombre de partitions associées à sp.
+extern size_t spill_nparts(spill *sp);
+
+//  spill_partition : renvoie l'indice de la partition à laquelle revient le mot
+//    w de longueur len selon une fonction de hachage propre au module, sans
+//    corrélation avec les fonctions de pré-hachage usuelles des tables.
+extern size_t spill_partition(spill *sp, const char *w, size_t len);
+
+//  spill_put : tente d'écrire le n-uplet (w, file, occ), où w est un mot de
+//    longueur len, à la fin de la partition d'indice part de sp. Renvoie une
+//    valeur non nulle en cas d'erreur d'écriture, zéro sinon.
+extern int spill_put(spill *sp, size_t part, const char *w, size_t len,
+    size_t file, long int occ);
+
+//  spill_rewind : prépare la lecture depuis son début de la partition d'indice
+//    part de sp. Renvoie une valeur non nulle en cas d'erreur, zéro sinon.
+extern int spill_rewind(spill *sp, size_t part);
+
+//  spill_get : tente de lire le prochain n-uplet de la partition d'indice part
+//    de sp. En cas de succès, affecte à *wptr l'adresse du mot lu, terminé par
+//    '\0' et valide jusqu'à la prochaine lecture dans la même partition, à
+//    *lenptr sa longueur, à *fileptr et *occptr les autres composantes, puis
+//    renvoie zéro. Renvoie une valeur strictement positive si la fin de la
+//    partition est atteinte, strictement négative en cas d'erreur.
+extern int spill_get(spill *sp, size_t part, const char **wptr, size_t *lenptr,
+    size_t *fileptr, long int *occptr);
+
+//  spill_merge : lit simultanément toutes les partitions de sp, supposées
+//    chacune triée selon compar, et appelle fun(context, w, file, occ) pour
+//    chacun des n-uplets dans l'ordre de la fusion. Si, lors du parcours, la
+//    valeur de l'appel n'est pas nulle, l'exécution prend fin et la fonction
+//    renvoie cette valeur. Renvoie -1 en cas d'erreur de lecture ou de
+//    dépassement de capacité. Renvoie sinon zéro.
+extern int spill_merge(spill *sp, int (*compar)(const char *, const char *),
+    void *context, int (*fun)(void *context, const char *w, size_t file,
+      long int occ));
+
+//  spill_count, spill_bytes : renvoient respectivement le nombre de n-uplets et
+//    le nombre d'octets écrits dans l'ensemble des partitions de sp.
+extern size_t spill_count(spill *sp);
+extern size_t spill_bytes(spill *sp);
+
+#endif
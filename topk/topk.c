@@ -0,0 +1,257 @@
+//  topk.c : partie implantation d'un module pour la recherche approchée des
+//    mots les plus fréquents d'une suite par l'algorithme SpaceSaving.
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "topk.h"
+#include "hugemem.h"
+
+//  Les mots suivis sont rangés dans le tableau entries. Le tas binaire heap
+//    range leurs indices selon leurs estimations, la plus petite à la racine :
+//    c'est le mot remplacé lors de l'ajout d'un mot non suivi. La table index,
+//    à adressage ouvert et sondage linéaire, associe à chaque mot suivi son
+//    indice augmenté de un, zéro désignant un emplacement libre ; sa taille
+//    est une puissance de deux au moins égale au double de la capacité. Ces
+//    trois tableaux sont alloués par le module hugemem.
+
+#define TOPK__INDEX_LOAD  2
+
+//  entry : type et nom de type pour une structure décrivant un mot suivi : sa
+//    copie s, de longueur len, dans un tableau de capacité cap, sa valeur de
+//    hachage hash, son estimation count, son erreur err et sa position pos
+//    dans le tas.
+typedef struct {
+  char *s;
+  size_t len;
+  size_t cap;
+  uint64_t hash;
+  size_t count;
+  size_t err;
+  size_t pos;
+} entry;
+
+struct topk {
+  size_t capacity;
+  size_t n;
+  size_t total;
+  entry *entries;
+  size_t *heap;
+  size_t *index;
+  size_t mask;
+  size_t strings;
+};
+
+//  index_find : renvoie la position dans la table index du mot s de longueur
+//    len et de valeur de hachage hash s'il est suivi, celle de l'emplacement
+//    libre où il serait rangé sinon.
+static size_t index_find(const topk *t, const char *s, size_t len,
+    uint64_t hash);
+
+//  index_remove : retire de la table index le mot d'indice k. Les mots qui le
+//    suivent dans sa suite de sondage sont ramenés en arrière, de sorte que
+//    les recherches n'aient pas à franchir d'emplacement marqué.
+static void index_remove(topk *t, size_t k);
+
+//  heap_swap : échange les positions p et q du tas.
+static void heap_swap(topk *t, size_t p, size_t q);
+
+//  heap_down, heap_up : rétablissent la propriété du tas après que
+//    l'estimation du mot en position p a augmenté ou diminué.
+static void heap_down(topk *t, size_t p);
+static void heap_up(topk *t, size_t p);
+
+topk *topk_empty(size_t capacity) {
+  if (capacity == 0 || capacity > SIZE_MAX / (2 * TOPK__INDEX_LOAD)) {
+    return NULL;
+  }
+  topk *t = malloc(sizeof *t);
+  if (t == NULL) {
+    return NULL;
+  }
+  size_t nslots = 1;
+  while (nslots < TOPK__INDEX_LOAD * capacity) {
+    nslots *= 2;
+  }
+  t->capacity = capacity;
+  t->n = 0;
+  t->total = 0;
+  t->entries = hugemem_alloc(capacity * sizeof *t->entries);
+  t->heap = hugemem_alloc(capacity * sizeof *t->heap);
+  t->index = hugemem_calloc(nslots, sizeof *t->index);
+  t->mask = nslots - 1;
+  t->strings = 0;
+  if (t->entries == NULL || t->heap == NULL || t->index == NULL) {
+    topk_dispose(&t);
+    return NULL;
+  }
+  return t;
+}
+
+void topk_dispose(topk **tptr) {
+  if (*tptr == NULL) {
+    return;
+  }
+  topk *t = *tptr;
+  for (size_t k = 0; k < t->n; ++k) {
+    free(t->entries[k].s);
+  }
+  hugemem_free(t->entries);
+  hugemem_free(t->heap);
+  hugemem_free(t->index);
+  free(t);
+  *tptr = NULL;
+}
+
+int topk_add(topk *t, const char *s, size_t len, uint64_t hash) {
+  size_t i = index_find(t, s, len, hash);
+  if (t->index[i] != 0) {
+    entry *e = &t->entries[t->index[i] - 1];
+    e->count += 1;
+    t->total += 1;
+    heap_down(t, e->pos);
+    return 0;
+  }
+  size_t k;
+  size_t m = 0;
+  if (t->n < t->capacity) {
+    k = t->n;
+    t->entries[k] = (entry) { NULL, 0, 0, 0, 0, 0, k };
+    t->heap[k] = k;
+  } else {
+    k = t->heap[0];
+    m = t->entries[k].count;
+  }
+  entry *e = &t->entries[k];
+  if (len > e->cap) {
+    char *a = realloc(e->s, len);
+    if (a == NULL) {
+      return -1;
+    }
+    t->strings += len - e->cap;
+    e->s = a;
+    e->cap = len;
+  }
+  if (t->n < t->capacity) {
+    t->n += 1;
+  } else {
+    index_remove(t, k);
+    i = index_find(t, s, len, hash);
+  }
+  memcpy(e->s, s, len);
+  e->len = len;
+  e->hash = hash;
+  e->count = m + 1;
+  e->err = m;
+  t->index[i] = k + 1;
+  t->total += 1;
+  if (m == 0) {
+    heap_up(t, e->pos);
+  } else {
+    heap_down(t, e->pos);
+  }
+  return 0;
+}
+
+size_t topk_count(const topk *t) {
+  return t->n;
+}
+
+size_t topk_total(const topk *t) {
+  return t->total;
+}
+
+size_t topk_min(const topk *t) {
+  return t->n < t->capacity ? 0 : t->entries[t->heap[0]].count;
+}
+
+int topk_apply(topk *t, void *context,
+    int (*fun)(void *context, const char *s, size_t len, uint64_t hash,
+      size_t count, size_t err)) {
+  for (size_t k = 0; k < t->n; ++k) {
+    const entry *e = &t->entries[k];
+    int r = fun(context, e->s, e->len, e->hash, e->count, e->err);
+    if (r != 0) {
+      return r;
+    }
+  }
+  return 0;
+}
+
+size_t topk_memory(const topk *t) {
+  return sizeof *t + t->capacity * (sizeof *t->entries + sizeof *t->heap)
+    + (t->mask + 1) * sizeof *t->index + t->strings;
+}
+
+size_t index_find(const topk *t, const char *s, size_t len, uint64_t hash) {
+  size_t i = (size_t) hash & t->mask;
+  while (t->index[i] != 0) {
+    const entry *e = &t->entries[t->index[i] - 1];
+    if (e->hash == hash && e->len == len && memcmp(e->s, s, len) == 0) {
+      break;
+    }
+    i = (i + 1) & t->mask;
+  }
+  return i;
+}
+
+void index_remove(topk *t, size_t k) {
+  size_t i = (size_t) t->entries[k].hash & t->mask;
+  while (t->index[i] != k + 1) {
+    i = (i + 1) & t->mask;
+  }
+  size_t j = i;
+  while (true) {
+    j = (j + 1) & t->mask;
+    if (t->index[j] == 0) {
+      break;
+    }
+    //  Le mot en position j peut combler le trou i si sa position d'origine
+    //    h n'est pas comprise, circulairement, entre i exclu et j inclus.
+    size_t h = (size_t) t->entries[t->index[j] - 1].hash & t->mask;
+    if (((j - h) & t->mask) >= ((j - i) & t->mask)) {
+      t->index[i] = t->index[j];
+      i = j;
+    }
+  }
+  t->index[i] = 0;
+}
+
+void heap_swap(topk *t, size_t p, size_t q) {
+  size_t a = t->heap[p];
+  size_t b = t->heap[q];
+  t->heap[p] = b;
+  t->heap[q] = a;
+  t->entries[a].pos = q;
+  t->entries[b].pos = p;
+}
+
+void heap_down(topk *t, size_t p) {
+  while (true) {
+    size_t l = 2 * p + 1;
+    if (l >= t->n) {
+      return;
+    }
+    size_t c = l;
+    if (l + 1 < t->n
+        && t->entries[t->heap[l + 1]].count < t->entries[t->heap[l]].count) {
+      c = l + 1;
+    }
+    if (t->entries[t->heap[p]].count <= t->entries[t->heap[c]].count) {
+      return;
+    }
+    heap_swap(t, p, c);
+    p = c;
+  }
+}
+
+void heap_up(topk *t, size_t p) {
+  while (p > 0) {
+    size_t q = (p - 1) / 2;
+    if (t->entries[t->heap[q]].count <= t->entries[t->heap[p]].count) {
+      return;
+    }
+    heap_swap(t, p, q);
+    p = q;
+  }
+}
@@ -0,0 +1,74 @@
+//  topk.h : partie interface d'un module pour la recherche approchée des mots
+//    les plus fréquents d'une suite par l'algorithme SpaceSaving, en mémoire
+//    bornée.
+
+#ifndef TOPK__H
+#define TOPK__H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+//  Fonctionnement général :
+//  - au plus capacity mots sont suivis, chacun avec un nombre d'occurrences
+//      estimé count et une erreur err : son nombre réel d'occurrences est
+//      compris entre count - err et count. Un mot qui n'est pas suivi
+//      lorsque les capacity emplacements sont occupés prend la place du mot
+//      suivi d'estimation minimale m, avec l'estimation m + 1 et l'erreur m ;
+//  - tout mot dont le nombre réel d'occurrences dépasse l'estimation minimale
+//      est suivi. Celle-ci est au plus égale au nombre de mots ajoutés divisé
+//      par capacity ;
+//  - les mots sont identifiés par leurs octets et une valeur de hachage sur
+//      64 bits, que l'utilisateurice fournit : deux mots égaux doivent avoir
+//      la même. Les mots suivis sont des copies ;
+//  - la mémoire occupée ne dépend que de capacity et de la longueur des mots
+//      suivis, pas du nombre de mots distincts ajoutés.
+
+//  struct topk, topk : type et nom de type d'un contrôleur regroupant les
+//    informations nécessaires pour gérer une recherche.
+typedef struct topk topk;
+
+//  topk_empty : tente d'allouer les ressources nécessaires pour gérer une
+//    nouvelle recherche, initialement sans aucun mot, qui suit au plus
+//    capacity mots. Renvoie NULL si capacity est nul ou en cas de dépassement
+//    de capacité. Renvoie sinon un pointeur vers le contrôleur associé à la
+//    recherche.
+extern topk *topk_empty(size_t capacity);
+
+//  topk_dispose : sans effet si *tptr vaut NULL. Libère sinon les ressources
+//    allouées à la gestion de la recherche associée à *tptr puis affecte NULL
+//    à *tptr.
+extern void topk_dispose(topk **tptr);
+
+//  topk_add : ajoute une occurrence du mot s de longueur len et de valeur de
+//    hachage hash à la recherche associée à t. Renvoie une valeur non nulle en
+//    cas de dépassement de capacité, zéro sinon.
+extern int topk_add(topk *t, const char *s, size_t len, uint64_t hash);
+
+//  topk_count : renvoie le nombre de mots suivis par la recherche associée à
+//    t.
+extern size_t topk_count(const topk *t);
+
+//  topk_total : renvoie le nombre d'occurrences ajoutées à la recherche
+//    associée à t.
+extern size_t topk_total(const topk *t);
+
+//  topk_min : renvoie l'estimation minimale des mots suivis si tous les
+//    emplacements sont occupés, zéro sinon. C'est une borne de l'erreur de
+//    toutes les estimations.
+extern size_t topk_min(const topk *t);
+
+//  topk_apply : exécute fun(context, s, len, hash, count, err) pour chacun
+//    des mots suivis par la recherche associée à t, dans un ordre quelconque,
+//    où s est l'adresse du premier octet du mot, len sa longueur et hash sa
+//    valeur de hachage. Si, pour un mot, fun renvoie une valeur non nulle,
+//    l'exécution prend fin et topk_apply renvoie cette valeur. Renvoie zéro
+//    sinon.
+extern int topk_apply(topk *t, void *context,
+    int (*fun)(void *context, const char *s, size_t len, uint64_t hash,
+      size_t count, size_t err));
+
+//  topk_memory : renvoie le nombre d'octets alloués à la gestion de la
+//    recherche associée à t, copies des mots comprises.
+extern size_t topk_memory(const topk *t);
+
+#endif
@@ -0,0 +1,300 @@
+//  utf8.c : partie implantation d'un module pour le décodage et la
+//    classification des caractères codés en UTF-8.
+
+#include <string.h>
+
+#include "utf8.h"
+
+//  range : type et nom de type d'un intervalle fermé de points de code.
+typedef struct {
+  uint32_t first;
+  uint32_t last;
+} range;
+
+//  Intervalles des caractères de ponctuation, disjoints et rangés par ordre
+//    croissant.
+static const range punct_ranges[] = {
+  { 0x0021, 0x0023 }, { 0x0025, 0x002A }, { 0x002C, 0x002F },
+  { 0x003A, 0x003B }, { 0x003F, 0x0040 }, { 0x005B, 0x005D },
+  { 0x005F, 0x005F }, { 0x007B, 0x007B }, { 0x007D, 0x007D },
+  { 0x00A1, 0x00A1 }, { 0x00A7, 0x00A7 }, { 0x00AB, 0x00AB },
+  { 0x00B6, 0x00B7 }, { 0x00BB, 0x00BB }, { 0x00BF, 0x00BF },
+  { 0x037E, 0x037E }, { 0x0387, 0x0387 }, { 0x055A, 0x055F },
+  { 0x0589, 0x058A }, { 0x05BE, 0x05BE }, { 0x05C0, 0x05C0 },
+  { 0x05C3, 0x05C3 }, { 0x05C6, 0x05C6 }, { 0x05F3, 0x05F4 },
+  { 0x0609, 0x060A }, { 0x060C, 0x060D }, { 0x061B, 0x061B },
+  { 0x061D, 0x061F }, { 0x066A, 0x066D }, { 0x06D4, 0x06D4 },
+  { 0x0700, 0x070D }, { 0x07F7, 0x07F9 }, { 0x0830, 0x083E },
+  { 0x085E, 0x085E }, { 0x0964, 0x0965 }, { 0x0970, 0x0970 },
+  { 0x09FD, 0x09FD }, { 0x0A76, 0x0A76 }, { 0x0AF0, 0x0AF0 },
+  { 0x0C77, 0x0C77 }, { 0x0C84, 0x0C84 }, { 0x0DF4, 0x0DF4 },
+  { 0x0E4F, 0x0E4F }, { 0x0E5A, 0x0E5B }, { 0x0F04, 0x0F12 },
+  { 0x0F14, 0x0F14 }, { 0x0F3A, 0x0F3D }, { 0x0F85, 0x0F85 },
+  { 0x0FD0, 0x0FD4 }, { 0x0FD9, 0x0FDA }, { 0x104A, 0x104F },
+  { 0x10FB, 0x10FB }, { 0x1360, 0x1368 }, { 0x1400, 0x1400 },
+  { 0x166E, 0x166E }, { 0x169B, 0x169C }, { 0x16EB, 0x16ED },
+  { 0x1735, 0x1736 }, { 0x17D4, 0x17D6 }, { 0x17D8, 0x17DA },
+  { 0x1800, 0x180A }, { 0x1944, 0x1945 }, { 0x1A1E, 0x1A1F },
+  { 0x1AA0, 0x1AA6 }, { 0x1AA8, 0x1AAD }, { 0x1B5A, 0x1B60 },
+  { 0x1B7D, 0x1B7E }, { 0x1BFC, 0x1BFF }, { 0x1C3B, 0x1C3F },
+  { 0x1C7E, 0x1C7F }, { 0x1CC0, 0x1CC7 }, { 0x1CD3, 0x1CD3 },
+  { 0x2010, 0x2027 }, { 0x2030, 0x2043 }, { 0x2045, 0x2051 },
+  { 0x2053, 0x205E }, { 0x207D, 0x207E }, { 0x208D, 0x208E },
+  { 0x2308, 0x230B }, { 0x2329, 0x232A }, { 0x2768, 0x2775 },
+  { 0x27C5, 0x27C6 }, { 0x27E6, 0x27EF }, { 0x2983, 0x2998 },
+  { 0x29D8, 0x29DB }, { 0x29FC, 0x29FD }, { 0x2CF9, 0x2CFC },
+  { 0x2CFE, 0x2CFF }, { 0x2D70, 0x2D70 }, { 0x2E00, 0x2E2E },
+  { 0x2E30, 0x2E4F }, { 0x2E52, 0x2E5D }, { 0x3001, 0x3003 },
+  { 0x3008, 0x3011 }, { 0x3014, 0x301F }, { 0x3030, 0x3030 },
+  { 0x303D, 0x303D }, { 0x30A0, 0x30A0 }, { 0x30FB, 0x30FB },
+  { 0xA4FE, 0xA4FF }, { 0xA60D, 0xA60F }, { 0xA673, 0xA673 },
+  { 0xA67E, 0xA67E }, { 0xA6F2, 0xA6F7 }, { 0xA874, 0xA877 },
+  { 0xA8CE, 0xA8CF }, { 0xA8F8, 0xA8FA }, { 0xA8FC, 0xA8FC },
+  { 0xA92E, 0xA92F }, { 0xA95F, 0xA95F }, { 0xA9C1, 0xA9CD },
+  { 0xA9DE, 0xA9DF }, { 0xAA5C, 0xAA5F }, { 0xAADE, 0xAADF },
+  { 0xAAF0, 0xAAF1 }, { 0xABEB, 0xABEB }, { 0xFD3E, 0xFD3F },
+  { 0xFE10, 0xFE19 }, { 0xFE30, 0xFE52 }, { 0xFE54, 0xFE61 },
+  { 0xFE63, 0xFE63 }, { 0xFE68, 0xFE68 }, { 0xFE6A, 0xFE6B },
+  { 0xFF01, 0xFF03 }, { 0xFF05, 0xFF0A }, { 0xFF0C, 0xFF0F },
+  { 0xFF1A, 0xFF1B }, { 0xFF1F, 0xFF20 }, { 0xFF3B, 0xFF3D },
+  { 0xFF3F, 0xFF3F }, { 0xFF5B, 0xFF5B }, { 0xFF5D, 0xFF5D },
+  { 0xFF5F, 0xFF65 }, { 0x10100, 0x10102 }, { 0x1039F, 0x1039F },
+  { 0x103D0, 0x103D0 }, { 0x1056F, 0x1056F }, { 0x10857, 0x10857 },
+  { 0x1091F, 0x1091F }, { 0x1093F, 0x1093F }, { 0x10A50, 0x10A58 },
+  { 0x10A7F, 0x10A7F }, { 0x10AF0, 0x10AF6 }, { 0x10B39, 0x10B3F },
+  { 0x10B99, 0x10B9C }, { 0x10EAD, 0x10EAD }, { 0x10F55, 0x10F59 },
+  { 0x10F86, 0x10F89 }, { 0x11047, 0x1104D }, { 0x110BB, 0x110BC },
+  { 0x110BE, 0x110C1 }, { 0x11140, 0x11143 }, { 0x11174, 0x11175 },
+  { 0x111C5, 0x111C8 }, { 0x111CD, 0x111CD }, { 0x111DB, 0x111DB },
+  { 0x111DD, 0x111DF }, { 0x11238, 0x1123D }, { 0x112A9, 0x112A9 },
+  { 0x1144B, 0x1144F }, { 0x1145A, 0x1145B }, { 0x1145D, 0x1145D },
+  { 0x114C6, 0x114C6 }, { 0x115C1, 0x115D7 }, { 0x11641, 0x11643 },
+  { 0x11660, 0x1166C }, { 0x116B9, 0x116B9 }, { 0x1173C, 0x1173E },
+  { 0x1183B, 0x1183B }, { 0x11944, 0x11946 }, { 0x119E2, 0x119E2 },
+  { 0x11A3F, 0x11A46 }, { 0x11A9A, 0x11A9C }, { 0x11A9E, 0x11AA2 },
+  { 0x11C41, 0x11C45 }, { 0x11C70, 0x11C71 }, { 0x11EF7, 0x11EF8 },
+  { 0x11FFF, 0x11FFF }, { 0x12470, 0x12474 }, { 0x12FF1, 0x12FF2 },
+  { 0x16A6E, 0x16A6F }, { 0x16AF5, 0x16AF5 }, { 0x16B37, 0x16B3B },
+  { 0x16B44, 0x16B44 }, { 0x16E97, 0x16E9A }, { 0x16FE2, 0x16FE2 },
+  { 0x1BC9F, 0x1BC9F }, { 0x1DA87, 0x1DA8B }, { 0x1E95E, 0x1E95F },
+};
+
+//  Intervalles des caractères d'espacement, disjoints et rangés par ordre
+//    croissant.
+static const range space_ranges[] = {
+  { 0x0009, 0x000D }, { 0x0020, 0x0020 }, { 0x0085, 0x0085 },
+  { 0x00A0, 0x00A0 }, { 0x1680, 0x1680 }, { 0x2000, 0x200A },
+  { 0x2028, 0x2029 }, { 0x202F, 0x202F }, { 0x205F, 0x205F },
+  { 0x3000, 0x3000 },
+};
+
+//  fold_range : type et nom de type d'une suite de points de code, de first à
+//    last par pas de stride, dont le pliage de casse s'obtient en ajoutant
+//    delta.
+typedef struct {
+  uint32_t first;
+  uint32_t last;
+  uint32_t stride;
+  int32_t delta;
+} fold_range;
+
+//  Pliages de casse simples des caractères codés sur deux octets vers des
+//    caractères codés sur deux octets, par suites disjointes et rangées par
+//    ordre croissant.
+static const fold_range fold_ranges[] = {
+  { 0x00B5, 0x00B5, 1, 775 }, { 0x00C0, 0x00D6, 1, 32 },
+  { 0x00D8, 0x00DE, 1, 32 }, { 0x0100, 0x012E, 2, 1 },
+  { 0x0132, 0x0136, 2, 1 }, { 0x0139, 0x0147, 2, 1 }, { 0x014A, 0x0176, 2, 1 },
+  { 0x0178, 0x0178, 1, -121 }, { 0x0179, 0x017D, 2, 1 },
+  { 0x0181, 0x0181, 1, 210 }, { 0x0182, 0x0184, 2, 1 },
+  { 0x0186, 0x0186, 1, 206 }, { 0x0187, 0x0187, 1, 1 },
+  { 0x0189, 0x018A, 1, 205 }, { 0x018B, 0x018B, 1, 1 },
+  { 0x018E, 0x018E, 1, 79 }, { 0x018F, 0x018F, 1, 202 },
+  { 0x0190, 0x0190, 1, 203 }, { 0x0191, 0x0191, 1, 1 },
+  { 0x0193, 0x0193, 1, 205 }, { 0x0194, 0x0194, 1, 207 },
+  { 0x0196, 0x0196, 1, 211 }, { 0x0197, 0x0197, 1, 209 },
+  { 0x0198, 0x0198, 1, 1 }, { 0x019C, 0x019C, 1, 211 },
+  { 0x019D, 0x019D, 1, 213 }, { 0x019F, 0x019F, 1, 214 },
+  { 0x01A0, 0x01A4, 2, 1 }, { 0x01A6, 0x01A6, 1, 218 },
+  { 0x01A7, 0x01A7, 1, 1 }, { 0x01A9, 0x01A9, 1, 218 },
+  { 0x01AC, 0x01AC, 1, 1 }, { 0x01AE, 0x01AE, 1, 218 },
+  { 0x01AF, 0x01AF, 1, 1 }, { 0x01B1, 0x01B2, 1, 217 },
+  { 0x01B3, 0x01B5, 2, 1 }, { 0x01B7, 0x01B7, 1, 219 },
+  { 0x01B8, 0x01B8, 1, 1 }, { 0x01BC, 0x01BC, 1, 1 }, { 0x01C4, 0x01C4, 1, 2 },
+  { 0x01C5, 0x01C5, 1, 1 }, { 0x01C7, 0x01C7, 1, 2 }, { 0x01C8, 0x01C8, 1, 1 },
+  { 0x01CA, 0x01CA, 1, 2 }, { 0x01CB, 0x01DB, 2, 1 }, { 0x01DE, 0x01EE, 2, 1 },
+  { 0x01F1, 0x01F1, 1, 2 }, { 0x01F2, 0x01F4, 2, 1 },
+  { 0x01F6, 0x01F6, 1, -97 }, { 0x01F7, 0x01F7, 1, -56 },
+  { 0x01F8, 0x021E, 2, 1 }, { 0x0220, 0x0220, 1, -130 },
+  { 0x0222, 0x0232, 2, 1 }, { 0x023B, 0x023B, 1, 1 },
+  { 0x023D, 0x023D, 1, -163 }, { 0x0241, 0x0241, 1, 1 },
+  { 0x0243, 0x0243, 1, -195 }, { 0x0244, 0x0244, 1, 69 },
+  { 0x0245, 0x0245, 1, 71 }, { 0x0246, 0x024E, 2, 1 },
+  { 0x0345, 0x0345, 1, 116 }, { 0x0370, 0x0372, 2, 1 },
+  { 0x0376, 0x0376, 1, 1 }, { 0x037F, 0x037F, 1, 116 },
+  { 0x0386, 0x0386, 1, 38 }, { 0x0388, 0x038A, 1, 37 },
+  { 0x038C, 0x038C, 1, 64 }, { 0x038E, 0x038F, 1, 63 },
+  { 0x0391, 0x03A1, 1, 32 }, { 0x03A3, 0x03AB, 1, 32 },
+  { 0x03C2, 0x03C2, 1, 1 }, { 0x03CF, 0x03CF, 1, 8 },
+  { 0x03D0, 0x03D0, 1, -30 }, { 0x03D1, 0x03D1, 1, -25 },
+  { 0x03D5, 0x03D5, 1, -15 }, { 0x03D6, 0x03D6, 1, -22 },
+  { 0x03D8, 0x03EE, 2, 1 }, { 0x03F0, 0x03F0, 1, -54 },
+  { 0x03F1, 0x03F1, 1, -48 }, { 0x03F4, 0x03F4, 1, -60 },
+  { 0x03F5, 0x03F5, 1, -64 }, { 0x03F7, 0x03F7, 1, 1 },
+  { 0x03F9, 0x03F9, 1, -7 }, { 0x03FA, 0x03FA, 1, 1 },
+  { 0x03FD, 0x03FF, 1, -130 }, { 0x0400, 0x040F, 1, 80 },
+  { 0x0410, 0x042F, 1, 32 }, { 0x0460, 0x0480, 2, 1 },
+  { 0x048A, 0x04BE, 2, 1 }, { 0x04C0, 0x04C0, 1, 15 },
+  { 0x04C1, 0x04CD, 2, 1 }, { 0x04D0, 0x052E, 2, 1 },
+  { 0x0531, 0x0556, 1, 48 },
+};
+
+//  UTF8__IS_CONT : vaut vrai si l'octet c est un octet de continuation.
+#define UTF8__IS_CONT(c)  (((c) & 0xC0) == 0x80)
+
+//  utf8__seq_length : renvoie la longueur du codage qui débute par l'octet c,
+//    zéro si c ne peut pas débuter un codage.
+static size_t utf8__seq_length(unsigned char c) {
+  if (c < 0x80) {
+    return 1;
+  }
+  if (c < 0xC2) {
+    return 0;
+  }
+  if (c < 0xE0) {
+    return 2;
+  }
+  if (c < 0xF0) {
+    return 3;
+  }
+  if (c < 0xF5) {
+    return 4;
+  }
+  return 0;
+}
+
+//  utf8__in : renvoie true si cp appartient à l'un des n intervalles du tableau
+//    a, disjoints et rangés par ordre croissant, false sinon.
+static bool utf8__in(uint32_t cp, const range *a, size_t n) {
+  size_t lo = 0;
+  size_t hi = n;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (cp < a[mid].first) {
+      hi = mid;
+    } else if (cp > a[mid].last) {
+      lo = mid + 1;
+    } else {
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t utf8_decode(const char *s, size_t n, uint32_t *cpptr) {
+  const unsigned char *p = (const unsigned char *) s;
+  size_t len = utf8__seq_length(p[0]);
+  if (len == 1) {
+    *cpptr = p[0];
+    return 1;
+  }
+  if (len == 0 || len > n) {
+    goto invalid;
+  }
+  //  Le deuxième octet est restreint pour exclure les codages trop longs, les
+  //    demi-codets et les points de code au-delà de U+10FFFF.
+  unsigned char lo = 0x80;
+  unsigned char hi = 0xBF;
+  switch (p[0]) {
+    case 0xE0:
+      lo = 0xA0;
+      break;
+    case 0xED:
+      hi = 0x9F;
+      break;
+    case 0xF0:
+      lo = 0x90;
+      break;
+    case 0xF4:
+      hi = 0x8F;
+      break;
+  }
+  if (p[1] < lo || p[1] > hi) {
+    goto invalid;
+  }
+  uint32_t cp = p[0] & (0x7F >> len);
+  for (size_t k = 1; k < len; ++k) {
+    if (!UTF8__IS_CONT(p[k])) {
+      goto invalid;
+    }
+    cp = (cp << 6) | (p[k] & 0x3F);
+  }
+  *cpptr = cp;
+  return len;
+invalid:
+  *cpptr = UTF8_INVALID;
+  return 1;
+}
+
+size_t utf8_incomplete_tail(const char *s, size_t n) {
+  const unsigned char *p = (const unsigned char *) s;
+  for (size_t k = 1; k <= 3 && k <= n; ++k) {
+    unsigned char c = p[n - k];
+    if (!UTF8__IS_CONT(c)) {
+      return utf8__seq_length(c) > k ? k : 0;
+    }
+  }
+  return 0;
+}
+
+uint32_t utf8_fold(uint32_t cp) {
+  if (cp < 0x80) {
+    return cp - 'A' < 26 ? cp + ('a' - 'A') : cp;
+  }
+  size_t lo = 0;
+  size_t hi = sizeof fold_ranges / sizeof *fold_ranges;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    const fold_range *r = &fold_ranges[mid];
+    if (cp < r->first) {
+      hi = mid;
+    } else if (cp > r->last) {
+      lo = mid + 1;
+    } else {
+      return (cp - r->first) % r->stride == 0
+        ? (uint32_t) ((int32_t) cp + r->delta) : cp;
+    }
+  }
+  return cp;
+}
+
+void utf8_fold_span(char *dst, const char *src, size_t n) {
+  size_t k = 0;
+  while (k < n) {
+    unsigned char c = (unsigned char) src[k];
+    if (c < 0x80) {
+      dst[k] = (char) ((unsigned char) (c - 'A') < 26
+          ? c + ('a' - 'A') : c);
+      ++k;
+      continue;
+    }
+    uint32_t cp;
+    size_t len = utf8_decode(src + k, n - k, &cp);
+    if (len == 2) {
+      cp = utf8_fold(cp);
+      dst[k] = (char) (0xC0 | (cp >> 6));
+      dst[k + 1] = (char) (0x80 | (cp & 0x3F));
+    } else {
+      memmove(dst + k, src + k, len);
+    }
+    k += len;
+  }
+}
+
+bool utf8_is_space(uint32_t cp) {
+  return utf8__in(cp, space_ranges, sizeof space_ranges / sizeof *space_ranges);
+}
+
+bool utf8_is_punct(uint32_t cp) {
+  return utf8__in(cp, punct_ranges, sizeof punct_ranges / sizeof *punct_ranges);
+}
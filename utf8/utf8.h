@@ -0,0 +1,56 @@
+//  utf8.h : partie interface d'un module pour le décodage et la
+//    classification des caractères codés en UTF-8.
+
+#ifndef UTF8__H
+#define UTF8__H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+//  Fonctionnement général :
+//  - un caractère est identifié par son point de code ;
+//  - un octet qui ne débute pas un codage valide (octet de continuation,
+//      codage trop long ou tronqué, demi-codet d'indirection, point de code
+//      supérieur à U+10FFFF) est considéré comme un caractère à lui seul, de
+//      point de code UTF8_INVALID ;
+//  - les tables de classification suivent la version 14.0 d'Unicode.
+
+//  UTF8_INVALID : point de code attribué aux octets qui ne débutent pas un
+//    codage valide.
+#define UTF8_INVALID UINT32_MAX
+
+//  utf8_decode : décode le caractère dont le codage débute à l'adresse s, n
+//    octets étant disponibles à partir de s, n étant supposé non nul. Affecte
+//    son point de code à *cpptr et renvoie la longueur de son codage.
+extern size_t utf8_decode(const char *s, size_t n, uint32_t *cpptr);
+
+//  utf8_incomplete_tail : renvoie le nombre d'octets qui, à la fin des n
+//    octets pointés par s, forment le début d'un codage sur plusieurs octets
+//    qui n'y tient pas en entier. Ces octets doivent être décodés avec ceux qui
+//    les suivent, par exemple dans le bloc lu suivant.
+extern size_t utf8_incomplete_tail(const char *s, size_t n);
+
+//  utf8_is_space : renvoie true si le caractère de point de code cp a la
+//    propriété White_Space, false sinon.
+extern bool utf8_is_space(uint32_t cp);
+
+//  utf8_is_punct : renvoie true si le caractère de point de code cp appartient
+//    à l'une des catégories générales de ponctuation (Pc, Pd, Ps, Pe, Pi, Pf,
+//    Po), false sinon.
+extern bool utf8_is_punct(uint32_t cp);
+
+//  utf8_fold : renvoie le point de code du pliage de casse simple du caractère
+//    de point de code cp, ou cp si ce pliage changerait la longueur du codage
+//    ou si cp n'est pas codé sur un ou deux octets. Les caractères concernés
+//    sont les lettres ASCII et celles des écritures latine (Latin-1 et Latin
+//    étendu), grecque, cyrillique et arménienne.
+extern uint32_t utf8_fold(uint32_t cp);
+
+//  utf8_fold_span : écrit à l'adresse dst les n octets pointés par src, chaque
+//    caractère étant remplacé par son pliage de casse au sens de utf8_fold.
+//    Les octets qui ne débutent pas un codage valide sont recopiés tels quels.
+//    Les zones pointées par dst et src sont soit confondues, soit disjointes.
+extern void utf8_fold_span(char *dst, const char *src, size_t n);
+
+#endif
@@ -1,17 +1,18 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
-#include <unistd.h>
 #include <ctype.h>
 #include <stdint.h>
 #include <errno.h>
 #include <getopt.h>
 #include <string.h>
 #include <locale.h>
+#include <limits.h>
 
-#include "hashtable.h"
-#include "holdall.h"
-#include "sbuffer.h"
+#include "libxwc.h"
+#include "chrono.h"
+#include "owriter.h"
+#include "flist.h"
 
 #define STR(s)  #s
 #define XSTR(s) STR(s)
@@ -31,13 +32,10 @@
 #define CHIGHLIGHT    "\x1b[107;30m"
 
 #define OPT_PARSE_ERR(msg, opt)                                                \
-  fprintf(stderr, "%s: %s -- '%c'\n", argv[0], msg, opt);                      \
+  print_opt_err(argv[0], msg, opt, opts, argv[optind - 1]);                    \
   suggest_help(argv[0]);                                                       \
   exit(EXIT_FAILURE);
 
-#define RESTRICT_FILE_INDEX       0
-#define INPUT_FILE_START_INDEX    1
-
 #define MAX_LINE_LEN      80
 #define HELP_DOC_COLUMN   16
 
@@ -47,75 +45,198 @@
   }
 
 #define OPT_GROUP_CHAR  '\0'
-#define OPT_END ((opt) {OPT_GROUP_CHAR, NULL, NULL, false})
-#define DEF_OPT(c, doc, group_prev) ((opt) {c, NULL, doc, group_prev})
-#define DEF_OPT_ARG(c, arg, doc, group_prev) ((opt) {c, arg, doc, group_prev})
-#define DEF_GROUP(doc) ((opt) {OPT_GROUP_CHAR, NULL, doc, false})
+#define OPT_END ((opt) {OPT_GROUP_CHAR, NULL, NULL, NULL, false})
+#define DEF_OPT(c, doc, group_prev) ((opt) {c, NULL, NULL, doc, group_prev})
+#define DEF_OPT_ARG(c, arg, doc, group_prev)                                   \
+  ((opt) {c, NULL, arg, doc, group_prev})
+#define DEF_LOPT(c, lname, doc, group_prev)                                    \
+  ((opt) {c, lname, NULL, doc, group_prev})
+#define DEF_LOPT_ARG(c, lname, arg, doc, group_prev)                           \
+  ((opt) {c, lname, arg, doc, group_prev})
+#define DEF_GROUP(doc) ((opt) {OPT_GROUP_CHAR, NULL, NULL, doc, false})
+
+//  Les options qui n'ont qu'un nom long sont identifiées par des valeurs qui ne
+//    peuvent pas être celles d'un caractère.
+#define OPT_LONG_ONLY(n)  (UCHAR_MAX + 1 + (n))
+#define IS_LONG_ONLY(c)   ((c) > UCHAR_MAX)
 
 #define OPT_INITIAL       'i'
+#define OPT_INITIAL_STR   "i"
+#define OPT_FOLD          'f'
 #define OPT_PUNCT         'p'
+#define OPT_PUNCT_STR     "p"
 #define OPT_RESTRICT      'r'
+#define OPT_RESTRICT_STR  "r"
 #define OPT_SORT          's'
 #define OPT_SORT_STR      "s"
 #define OPT_SORT_LEX      'l'
 #define OPT_SORT_NONE     'S'
 #define OPT_REVERSE       'R'
 #define OPT_HELP          '?'
+#define OPT_STATS         OPT_LONG_ONLY(0)
+#define OPT_MAX_MEMORY    OPT_LONG_ONLY(1)
+#define OPT_SPILL_DIR     OPT_LONG_ONLY(2)
+#define OPT_SPILL_PARTS   OPT_LONG_ONLY(3)
+#define OPT_THREADS       OPT_LONG_ONLY(4)
+#define OPT_EXPECTED      OPT_LONG_ONLY(5)
+#define OPT_UTF8          OPT_LONG_ONLY(6)
+#define OPT_DICTIONARY    OPT_LONG_ONLY(7)
+#define OPT_SKETCH        OPT_LONG_ONLY(8)
+#define OPT_SKETCH_CELLS  OPT_LONG_ONLY(9)
+#define OPT_IN_FILES      OPT_LONG_ONLY(10)
+#define OPT_HUGE_PAGES    OPT_LONG_ONLY(11)
+#define OPT_OUT_THREADS   OPT_LONG_ONLY(12)
+#define OPT_FILES_FROM    OPT_LONG_ONLY(13)
+#define OPT_RECURSIVE     OPT_LONG_ONLY(14)
 
 #define OPT_ARG_SORT_LEX  "lexicographical"
 #define OPT_ARG_SORT_NONE "none"
+#define OPT_ARG_DICT_HASH "hashtable"
+#define OPT_ARG_DICT_ART  "art"
+#define OPT_ARG_FILES_ALL "all"
+#define OPT_ARG_HUGE_NONE "never"
+
+#define STATS_PREFIX      "xwc."
+#define PRINT_STAT(key, format, ...)                                           \
+  fprintf(stderr, STATS_PREFIX key "=" format "\n", __VA_ARGS__)
+
+//  Longueur maximale de l'écriture décimale d'un long int.
+#define LONG_STR_MAX      (sizeof(long int) * CHAR_BIT / 3 + 2)
+
+//  Nombre de fils d'exécution du parcours des répertoires. La consultation des
+//    attributs des fichiers est limitée par la latence du système de fichiers
+//    plus que par le nombre de cœurs.
+#define WALK_THREADS      8
+
+//  Suffixes multiplicatifs reconnus pour les tailles mémoire.
+#define SIZE_SUFFIXES     "KMGT"
+#define SIZE_SUFFIX_BASE  1024
 
 //- STRUCTURES -----------------------------------------------------------------
 
 //  options : type et nom de type pour une structure contenant les valeurs
-//    des options rentrées par l'utilisateurice.
+//    des options rentrées par l'utilisateurice. Les options du comptage
+//    lui-même sont regroupées dans le composant xwc ; min_files et max_files
+//    sont les bornes de l'option --in-files, significatives si xwc.membership
+//    est vrai ; output_threads est le nombre de fils d'exécution de mise en
+//    forme de la sortie, celui de xwc.nthreads si output_threads_set est
+//    faux ; files_from est le nom de la liste de fichiers de l'option
+//    --files-from, NULL en son absence.
 typedef struct {
   char *restr_f;
-  bool punct;
-  size_t init;
+  char *files_from;
+  bool recursive;
   enum {
     NONE,
     LEXICOGRAPHICAL
   } sort_mode;
   bool sort_reversed;
+  bool stats;
+  bool expected_set;
+  size_t min_files;
+  size_t max_files;
+  size_t output_threads;
+  bool output_threads_set;
+  struct xwc_options xwc;
 } options;
 
-//  word_info : type et nom de type pour une structure contenant les
-//    informations sur un mot lu.
-typedef struct {
-  long int occ;
-  size_t file;
-} word_info;
-
 //  opt : type et nom de type pour une structure représentant une option
-//    utilisable sur la ligne de commande.
+//    utilisable sur la ligne de commande. Le composant c est le caractère de
+//    l'option courte ou, si l'option n'a qu'un nom long, une valeur
+//    OPT_LONG_ONLY ; le composant lname est le nom long de l'option ou NULL si
+//    elle n'en a pas.
 typedef struct {
-  char c;
+  int c;
+  const char *lname;
   const char *arg;
   const char *doc;
   bool group_prev;
 } opt;
 
+//  client : type et nom de type pour une structure servant de contexte aux
+//    fonctions appelées par la bibliothèque : le nom de l'exécutable
+//    prog_name, les nnames noms des fichiers, par indice, names[0] valant NULL
+//    en l'absence de fichier restreignant, et les instants mesurés pour
+//    l'option --stats, début de la phase en cours tphase et durée du tri
+//    tsort. Les lignes de la sortie sont confiées à ow.
+typedef struct {
+  const char *prog_name;
+  const char *const *names;
+  size_t nnames;
+  bool stats;
+  chrono tphase;
+  chrono tsort;
+  owriter *ow;
+} client;
+
+//  word_record : type et nom de type pour un enregistrement de la sortie
+//    d'un mot exclusif, de longueur len, présent occ fois dans le fichier
+//    d'indice file. Les octets du mot suivent l'enregistrement.
+typedef struct {
+  size_t len;
+  size_t file;
+  long int occ;
+} word_record;
+
+//  sets_record : type et nom de type pour un enregistrement de la sortie d'un
+//    mot de longueur len présent dans n fichiers. Les n couples indice de
+//    fichier, nombre d'occurrences suivent l'enregistrement, puis les octets
+//    du mot.
+typedef struct {
+  size_t len;
+  size_t n;
+} sets_record;
+
 //- PROTOTYPES -----------------------------------------------------------------
 
-//  str_hashfun : l'une des fonctions de pré-hachage conseillées par Kernighan
-//    et Pike pour les chaines de caractères.
-static size_t str_hashfun(const char *s);
+//  cut_word : signale sur la sortie erreur que le mot w de longueur len, lu
+//    dans le fichier d'indice file, est coupé. Le message est écrit d'un seul
+//    appel, pour qu'il ne soit pas entrecoupé par ceux d'autres fils
+//    d'exécution.
+static void cut_word(client *cl, size_t file, const char *w, size_t len);
+
+//  start_output : mesure la durée du tri si l'option --stats est donnée puis
+//    affiche la ligne d'en-tête. Renvoie zéro.
+static int start_output(client *cl);
 
-//  rprint_word_info : affiche sur la sortie standard la chaîne de caractères
-//    pointée par w dans la première colonne, puis le nombre d'occurrences dans
-//    la colonne correspondant au fichier dans lequel le mot apparaît, enfin
-//    retourne 0.
-static int rprint_word_info(char *w, word_info *wi);
+//  print_word : confie à cl->ow la ligne du mot w de longueur len, présent occ
+//    fois dans le fichier d'indice file. Renvoie une valeur non nulle en cas
+//    de dépassement de capacité, zéro sinon.
+static int print_word(client *cl, const char *w, size_t len, size_t file,
+    long int occ);
 
-//  rfree_word_info : libère la zone mémoire pointée par wi et retourne 0.
-static int rfree_word_info(char *w, word_info *wi);
+//  print_word_sets : confie à cl->ow la ligne du mot w de longueur len, dont
+//    les n nombres d'occurrences par fichier figurent dans occs. Renvoie une
+//    valeur non nulle en cas de dépassement de capacité, zéro sinon.
+static int print_word_sets(client *cl, const char *w, size_t len,
+    const struct xwc_occ *occs, size_t n);
 
-//  rfree : libère la zone mémoire pointée par w et retourne 0.
-static int rfree(char *w);
+//  format_word : met en forme l'enregistrement rec de type word_record : le
+//    mot dans la première colonne, puis le nombre d'occurrences dans la
+//    colonne correspondant au fichier. Écrit la ligne à l'adresse dest si sa
+//    longueur est au plus room. Renvoie cette longueur.
+static size_t format_word(const client *cl, const word_record *rec,
+    char *dest, size_t room);
 
-//  rev_strcoll : renvoie l'inverse de strcoll(s1, s2).
-static int rev_strcoll(const char *s1, const char *s2);
+//  format_word_sets : même fonction que format_word pour l'enregistrement rec
+//    de type sets_record, dont chaque nombre d'occurrences figure dans la
+//    colonne correspondant à son fichier.
+static size_t format_word_sets(const client *cl, const sets_record *rec,
+    char *dest, size_t room);
+
+//  long_to_str : écrit en décimal v à l'adresse s, sans caractère de fin de
+//    chaîne, et renvoie le nombre de caractères écrits.
+static size_t long_to_str(long int v, char s[static LONG_STR_MAX]);
+
+//  print_header : affiche sur la sortie standard la ligne d'en-tête pour les
+//    fichiers de cl, le fichier restreignant en première colonne s'il y en a
+//    un.
+static void print_header(const client *cl);
+
+//  print_stdin_mark : affiche sur la sortie standard le repère de début ou de
+//    fin, selon que what vaut "starts" ou "ends", de la lecture sur l'entrée
+//    standard du fichier d'indice nfile.
+static void print_stdin_mark(const char *what, size_t nfile);
 
 //  print_usage : affiche sur la sortie standard un court message expliquant
 //    l'utilisation du programme dont le nom de l'exécutable est prog_name.
@@ -131,6 +252,50 @@ static void suggest_help(char *prog_name);
 //    l'ensemble des options spécifiées dans opts.
 static void print_help(char *prog_name, opt opts[]);
 
+//  collect_names : ajoute à la liste associée à fl les nargs noms de fichiers
+//    de args, puis ceux de la liste de fichiers de l'option --files-from s'il
+//    y en a une, ou le nom de l'entrée standard s'il n'y a ni l'un ni l'autre.
+//    Remplace ensuite les noms de répertoires par ceux des fichiers de leurs
+//    arborescences si l'option --recursive est donnée, ce qu'indique p.
+//    Affiche un message sur la sortie erreur et renvoie une valeur non nulle
+//    en cas d'échec. Renvoie sinon zéro.
+static int collect_names(const options *p, int nargs, char **args,
+    flist *fl);
+
+//  parse_size : convertit la chaîne s, un entier positif écrit en chiffres
+//    décimaux, sans blanc ni signe en tête, éventuellement suivi de l'un des
+//    suffixes multiplicatifs de SIZE_SUFFIXES, en un nombre d'octets affecté
+//    à *vptr. Renvoie une valeur non nulle en cas d'échec, zéro sinon.
+static int parse_size(const char *s, size_t *vptr);
+
+//  parse_files_range : convertit la chaîne s, de la forme N, N-, N-M ou
+//    OPT_ARG_FILES_ALL, en bornes du nombre de fichiers, affectées à *minptr
+//    et *maxptr, XWC_ALL_FILES désignant tous les fichiers lus. Renvoie une
+//    valeur non nulle en cas d'échec, zéro sinon.
+static int parse_files_range(const char *s, size_t *minptr, size_t *maxptr);
+
+//  print_mem_stats : affiche sur la sortie erreur, au format clé=valeur, le
+//    détail de la mémoire allouée par le contexte associé à x ainsi que la
+//    limite fixée, nulle en l'absence de limite.
+static void print_mem_stats(const xwc *x);
+
+//  find_opt : renvoie l'adresse de l'option de opts identifiée par c si elle
+//    existe, NULL sinon.
+static const opt *find_opt(const opt opts[], int c);
+
+//  print_opt_err : affiche sur la sortie erreur le message d'erreur msg relatif
+//    à l'option c du programme dont le nom de l'exécutable est prog_name. Le
+//    nom de l'option est recherché dans opts si c désigne une option qui n'a
+//    qu'un nom long ; si c est nul, l'option est inconnue et arg est l'argument
+//    de la ligne de commande qui l'a introduite.
+static void print_opt_err(const char *prog_name, const char *msg, int c,
+    const opt opts[], const char *arg);
+
+//  print_read_stats : affiche sur la sortie erreur, au format clé=valeur, le
+//    bilan de lecture fs du fichier d'indice nfile et de nom fname.
+static void print_read_stats(size_t nfile, const char *fname,
+    const struct xwc_file_stats *fs);
+
 //  print_multi_line : affiche sur la sortie standard la chaîne de caractères s
 //    en la découpant de sorte à ce que chaque ligne ne dépasse pas MAX_LINE_LEN
 //    caractères. Chaque ligne, sauf la première, est précédée par pref_whitesp
@@ -153,19 +318,102 @@ int main(int argc, char **argv) {
     DEF_OPT_ARG(OPT_INITIAL, "VALUE", "Set the maximal number of "
         "significant initial letters for words to VALUE. 0 means without "
         "limitation. Default is 0.", true),
-    DEF_OPT(OPT_PUNCT, "Make the punctuation characters play the"
+    DEF_OPT(OPT_PUNCT, "Make the punctuation characters play the "
         "same role as white-space characters in the meaning of words.", false),
+    DEF_LOPT(OPT_UTF8, "utf8", "Decode FILEs as UTF-8: Unicode white-space "
+        "characters, and with -" OPT_PUNCT_STR " Unicode punctuation "
+        "characters, separate words, and the VALUE of -" OPT_INITIAL_STR " "
+        "counts characters instead of bytes. Each byte that does not start a "
+        "valid UTF-8 sequence counts as one character that belongs to words.",
+        false),
+    DEF_OPT(OPT_FOLD, "Fold case: count words regardless of case and print "
+        "them in lower case. ASCII letters are folded; with --utf8, so are the "
+        "Latin, Greek, Cyrillic and Armenian letters encoded on two bytes "
+        "whose lower case is encoded on two bytes.", false),
     DEF_OPT_ARG(OPT_RESTRICT, "FILE", "Limit the counting to the set of words "
         "that appear in FILE. FILE is displayed in the first column of the "
         "header line. If FILE is \"-\", read words from the standard input; in "
         "this case, \"\" is displayed in first column of the header line.",
         false),
+    DEF_LOPT_ARG(OPT_FILES_FROM, "files-from", "LIST", "Read, after the FILE "
+        "operands, the names of further FILEs from the file LIST, or from the "
+        "standard input if LIST is \"-\". The names are separated by null "
+        "characters, as written by 'find -print0', or else by newlines; empty "
+        "names are ignored. The standard input is not read by default when "
+        "this option is given.", false),
+    DEF_LOPT(OPT_RECURSIVE, "recursive", "Replace each FILE that is a "
+        "directory with the regular files of its tree, in the byte order of "
+        "their paths, so that the header does not depend on the file system. "
+        "Symbolic links met inside a tree are ignored. The trees are walked "
+        "by several threads.", false),
+    DEF_LOPT_ARG(OPT_DICTIONARY, "dictionary", "TYPE", "Store the words in "
+        "a dictionary of TYPE. The available values for TYPE are: '"
+        OPT_ARG_DICT_HASH "', a hashtable, and '" OPT_ARG_DICT_ART "', an "
+        "adaptive radix tree, which stores the common prefixes of words once "
+        "and yields the words in byte order, so that sorting costs nothing "
+        "when the locale compares words byte by byte, as the C locale does. '"
+        OPT_ARG_DICT_ART "' cannot be combined with --threads or "
+        "--max-memory. Default is '" OPT_ARG_DICT_HASH "'.", false),
+    DEF_LOPT_ARG(OPT_EXPECTED, "expected-words", "N", "Size the hashtable "
+        "from the start for about N distinct words. N may be followed by one "
+        "of the multiplicative suffixes K, M, G, T. 0 means no presizing. By "
+        "default, N is estimated from a sample taken at the head of the FILEs "
+        "and from their sizes, unless --max-memory is given.", false),
+    DEF_LOPT_ARG(OPT_HUGE_PAGES, "huge-pages", "SIZE", "Allocate the "
+        "arrays of at least SIZE bytes, such as the hashtable slots, on "
+        "transparent huge pages, which saves TLB entries on random accesses. "
+        "SIZE may be followed by one of the multiplicative suffixes K, M, G, "
+        "T. '" OPT_ARG_HUGE_NONE "' allocates every array with malloc. "
+        "Default is " XSTR(XWC_HUGE_PAGES_DEF) ".", false),
+    DEF_LOPT_ARG(OPT_THREADS, "threads", "N", "Read FILEs with N threads "
+        "that count words in a single table shared between them. The "
+        "restrict FILE and the standard input are read first by the main "
+        "thread. Without sorting, the output order may vary from one run to "
+        "another. Cannot be combined with --max-memory. Default is 1.", false),
+    DEF_LOPT_ARG(OPT_MAX_MEMORY, "max-memory", "SIZE", "Limit to SIZE bytes "
+        "the memory used for words and data structures. SIZE may be followed "
+        "by one of the multiplicative suffixes K, M, G, T (powers of 1024). "
+        "When the limit would be exceeded, stop reading, print the memory "
+        "usage to the standard error and exit with failure status. 0 means "
+        "without limitation. Default is 0.", false),
+    DEF_LOPT_ARG(OPT_SPILL_DIR, "spill-dir", "DIR", "When the limit set by "
+        "--max-memory is reached while reading FILEs, write the counts held "
+        "in memory to temporary files in DIR, partitioned by word hash, and "
+        "go on reading. At the end, each partition is counted on its own and "
+        "the results are merged. Words of the restrict FILE are always held "
+        "in memory.", true),
+    DEF_LOPT_ARG(OPT_SPILL_PARTS, "spill-partitions", "N", "Use N partitions "
+        "for --spill-dir. Each partition must fit within the limit set by "
+        "--max-memory. Default is " XSTR(XWC_SPILL_NPARTS_DEF) ".", true),
     DEF_GROUP("Output Control:"),
+    DEF_LOPT_ARG(OPT_IN_FILES, "in-files", "RANGE", "Instead of the "
+        "exclusive words, print the words that appear in a number of FILEs "
+        "within RANGE, with their number of occurrences in the column of "
+        "each FILE they appear in. RANGE is N for exactly N FILEs, N- for at "
+        "least N, N-M for N to M, or '" OPT_ARG_FILES_ALL "' for every FILE "
+        "read. The restrict FILE does not count. The whole set of FILEs of "
+        "each word is kept during the reading, which uses more memory. Cannot "
+        "be combined with --max-memory or --sketch.", true),
+    DEF_LOPT_ARG(OPT_SKETCH, "sketch", "K", "Approximate mode: instead of "
+        "storing every word, track only the K most frequent words of each FILE "
+        "with the SpaceSaving algorithm, and summarize which FILEs each word "
+        "appears in with a sketch of --sketch-cells cells, so that memory does "
+        "not depend on the number of distinct words. Print the tracked words "
+        "that the sketch proves exclusive; a word that appears in several "
+        "FILEs is never printed, an exclusive word may be missed. The printed "
+        "counts are upper bounds: with --stats, the error bound of each FILE "
+        "is given by file.N.sketch_error. Cannot be combined with --threads, "
+        "--max-memory, --dictionary=" OPT_ARG_DICT_ART " or -"
+        OPT_RESTRICT_STR ". 0 means exact counting. Default is 0.", false),
+    DEF_LOPT_ARG(OPT_SKETCH_CELLS, "sketch-cells", "N", "Use N cells for "
+        "the sketch of --sketch. N may be followed by one of the "
+        "multiplicative suffixes K, M, G, T. Default is "
+        XSTR(XWC_SKETCH_CELLS_DEF) ".", true),
     DEF_OPT_ARG(OPT_SORT, "TYPE", "Sort the results in ascending order, by "
         "default, according to TYPE. The available values for TYPE are: '"
         OPT_ARG_SORT_LEX "', sort on words, and '" OPT_ARG_SORT_NONE "', don't "
         "try to sort, take it as it comes. Default is '" OPT_ARG_SORT_NONE "'.",
-        true),
+        false),
     DEF_OPT(OPT_SORT_LEX, "Same as -" OPT_SORT_STR " " OPT_ARG_SORT_LEX ".",
         false),
     DEF_OPT(OPT_SORT_NONE, "Same as -" OPT_SORT_STR " " OPT_ARG_SORT_NONE ".",
@@ -174,15 +422,38 @@ int main(int argc, char **argv) {
         "key instead of ascending order. This option has no effect if sorting "
         "is disabled.",
         false),
+    DEF_LOPT_ARG(OPT_OUT_THREADS, "output-threads", "N", "Format the output "
+        "lines with N threads, each one formatting its own chunk of "
+        "consecutive lines; the chunks are written in order, so that the "
+        "output is the same as with a single thread. Default is the value of "
+        "--threads.", false),
+    DEF_LOPT(OPT_STATS, "stats", "Print to the standard error, one "
+        "'key=value' per line, the wall-clock and CPU times of each phase "
+        "(reading of each FILE, sort, output), the throughputs, the numbers of "
+        "distinct and disqualified words, the hashtable or radix tree "
+        "statistics and the huge pages in use.",
+        false),
     OPT_END
   };
   char optstr[2 * (sizeof opts / sizeof *opts - 1)];
+  struct option longopts[sizeof opts / sizeof *opts];
   size_t str_i = 0;
+  size_t lopt_i = 0;
   for (size_t k = 0; opts[k].c != OPT_GROUP_CHAR || opts[k].doc != NULL; k++) {
-    if (opts[k].c == '?' || opts[k].c == OPT_GROUP_CHAR) {
+    if (opts[k].lname != NULL) {
+      longopts[lopt_i] = (struct option) {
+        opts[k].lname,
+        opts[k].arg != NULL ? required_argument : no_argument,
+        NULL,
+        opts[k].c
+      };
+      lopt_i++;
+    }
+    if (opts[k].c == '?' || opts[k].c == OPT_GROUP_CHAR
+        || IS_LONG_ONLY(opts[k].c)) {
       continue;
     }
-    optstr[str_i] = opts[k].c;
+    optstr[str_i] = (char) opts[k].c;
     str_i++;
     if (opts[k].arg != NULL) {
       optstr[str_i] = ':';
@@ -190,26 +461,118 @@ int main(int argc, char **argv) {
     }
   }
   optstr[str_i] = '\0';
+  longopts[lopt_i] = (struct option) { NULL, 0, NULL, 0 };
   options p = {
     .restr_f = NULL,
-    .punct = false,
-    .init = 0,
+    .files_from = NULL,
+    .recursive = false,
     .sort_mode = NONE,
-    .sort_reversed = false
+    .sort_reversed = false,
+    .stats = false,
+    .expected_set = false,
+    .min_files = 0,
+    .max_files = 0,
+    .output_threads = 1,
+    .output_threads_set = false
   };
+  xwc_options_init(&p.xwc);
   opterr = 0;
   int c;
-  while ((c = getopt(argc, argv, optstr)) != -1) {
+  while ((c = getopt_long(argc, argv, optstr, longopts, NULL)) != -1) {
     switch (c) {
       case OPT_PUNCT:
-        p.punct = true;
+        p.xwc.punct = true;
         break;
       case OPT_RESTRICT:
         p.restr_f = optarg;
         break;
+      case OPT_FILES_FROM:
+        p.files_from = optarg;
+        break;
+      case OPT_RECURSIVE:
+        p.recursive = true;
+        break;
       case OPT_REVERSE:
         p.sort_reversed = true;
         break;
+      case OPT_STATS:
+        p.stats = true;
+        break;
+      case OPT_MAX_MEMORY:
+        if (parse_size(optarg, &p.xwc.max_memory) != 0) {
+          OPT_PARSE_ERR("option requires a size argument", c);
+        }
+        break;
+      case OPT_SPILL_DIR:
+        p.xwc.spill_dir = optarg;
+        break;
+      case OPT_SPILL_PARTS:
+        if (parse_size(optarg, &p.xwc.spill_nparts) != 0
+            || p.xwc.spill_nparts == 0) {
+          OPT_PARSE_ERR("option requires a strictly positive integer "
+              "argument", c);
+        }
+        break;
+      case OPT_THREADS:
+        if (parse_size(optarg, &p.xwc.nthreads) != 0 || p.xwc.nthreads == 0) {
+          OPT_PARSE_ERR("option requires a strictly positive integer "
+              "argument", c);
+        }
+        break;
+      case OPT_OUT_THREADS:
+        if (parse_size(optarg, &p.output_threads) != 0
+            || p.output_threads == 0) {
+          OPT_PARSE_ERR("option requires a strictly positive integer "
+              "argument", c);
+        }
+        p.output_threads_set = true;
+        break;
+      case OPT_UTF8:
+        p.xwc.utf8 = true;
+        break;
+      case OPT_FOLD:
+        p.xwc.fold = true;
+        break;
+      case OPT_EXPECTED:
+        if (parse_size(optarg, &p.xwc.expected) != 0) {
+          OPT_PARSE_ERR("option requires a size argument", c);
+        }
+        p.expected_set = true;
+        break;
+      case OPT_SKETCH:
+        if (parse_size(optarg, &p.xwc.sketch) != 0) {
+          OPT_PARSE_ERR("option requires an integer argument", c);
+        }
+        break;
+      case OPT_IN_FILES:
+        if (parse_files_range(optarg, &p.min_files, &p.max_files) != 0) {
+          OPT_PARSE_ERR("option requires a range argument", c);
+        }
+        p.xwc.membership = true;
+        break;
+      case OPT_HUGE_PAGES:
+        if (strcmp(OPT_ARG_HUGE_NONE, optarg) == 0) {
+          p.xwc.huge_pages = XWC_HUGE_PAGES_NEVER;
+        } else if (parse_size(optarg, &p.xwc.huge_pages) != 0) {
+          OPT_PARSE_ERR("option requires a size argument", c);
+        }
+        break;
+      case OPT_SKETCH_CELLS:
+        if (parse_size(optarg, &p.xwc.sketch_cells) != 0
+            || p.xwc.sketch_cells == 0) {
+          OPT_PARSE_ERR("option requires a strictly positive size argument",
+              c);
+        }
+        break;
+      case OPT_DICTIONARY:
+        if (strcmp(OPT_ARG_DICT_HASH, optarg) == 0) {
+          p.xwc.dictionary = XWC_HASHTABLE;
+        } else if (strcmp(OPT_ARG_DICT_ART, optarg) == 0) {
+          p.xwc.dictionary = XWC_RADIX_TREE;
+        } else {
+          OPT_PARSE_ERR("option value not recognized", c);
+        }
+        break;
       case OPT_SORT_LEX:
         p.sort_mode = LEXICOGRAPHICAL;
         break;
@@ -236,7 +599,7 @@ int main(int argc, char **argv) {
         } else if (v < 0) {
           OPT_PARSE_ERR("option requires a positive integer argument", c);
         } else {
-          p.init = (size_t) v;
+          p.xwc.init = (size_t) v;
         }
         break;
       case '?':
@@ -244,8 +607,8 @@ int main(int argc, char **argv) {
           print_help(argv[0], opts);
           return EXIT_SUCCESS;
         } else {
-          char *p = strchr(optstr, optopt);
-          if (p != NULL && *(p + 1) == ':') {
+          const opt *o = find_opt(opts, optopt);
+          if (o != NULL && o->arg != NULL) {
             OPT_PARSE_ERR("option requires an argument", optopt);
           } else {
             OPT_PARSE_ERR("invalid option", optopt);
@@ -253,228 +616,502 @@ int main(int argc, char **argv) {
         }
     }
   }
-  hashtable *ht = hashtable_empty((int (*)(const void *, const void *))strcmp,
-      (size_t (*)(const void *))str_hashfun);
-  holdall *has = holdall_empty();
-  sbuffer *sb = sbuffer_empty();
-  if (ht == NULL || has == NULL || sb == NULL) {
-    goto error_capacity;
+  if (p.xwc.nthreads > 1 && p.xwc.max_memory != 0) {
+    fprintf(stderr, "%s: --threads cannot be combined with --max-memory\n",
+        argv[0]);
+    suggest_help(argv[0]);
+    return EXIT_FAILURE;
   }
-  int i = optind;
-  size_t nfile = INPUT_FILE_START_INDEX;
-  if (p.restr_f != NULL) {
-    i -= 1;
-    nfile = RESTRICT_FILE_INDEX;
-  }
-  for (; i < (optind == argc ? argc + 1 : argc); i++) {
-    const char *fname;
-    if (nfile == RESTRICT_FILE_INDEX) {
-      fname = p.restr_f;
-    } else if (i >= argc) {
-      fname = STDIN_FNAME;
-    } else {
-      fname = argv[i];
-    }
-    FILE *f;
-    if (strcmp(fname, STDIN_FNAME) == 0) {
-      f = stdin;
-      printf(CHIGHLIGHT "--- starts reading for ");
-      if (nfile == RESTRICT_FILE_INDEX) {
-        printf("restrict");
-      } else {
-        printf("#%zu", nfile);
-      }
-      printf(" FILE" CRESET "\n");
-    } else {
-      f = fopen(fname, "r");
-    }
-    if (f == NULL) {
-      PRINT_READ_ERR(fname);
-      goto error;
-    }
-    sbuffer_clear(sb);
-    bool run = true;
-    bool skip_chr = false;
-    int c = fgetc(f);
-    while (run) {
-      bool cutlen = p.init != 0 && sbuffer_length(sb) == p.init;
-      if (isspace(c) || (p.punct && ispunct(c)) || c == EOF || cutlen) {
-        if (c == EOF) {
-          run = false;
-        }
-        if (skip_chr) {
-          skip_chr = false;
-          goto next_char;
-        }
-        if (sbuffer_length(sb) == 0) {
-          goto next_char;
-        }
-        if (sbuffer_append(sb, '\0') != 0) {
-          goto error_capacity;
-        }
-        char *w = sbuffer_get_str(sb);
-        if (cutlen) {
-          skip_chr = true;
-          fprintf(stderr, "%s: Word from ", argv[0]);
-          if (f == stdin) {
-            fprintf(stderr, "standard input");
-          } else {
-            fprintf(stderr, "file '%s'", fname);
-          }
-          fprintf(stderr, " cut: '%s...'.\n", w);
-        }
-        word_info *wi = hashtable_search(ht, w);
-        if (wi == NULL) {
-          if (nfile != RESTRICT_FILE_INDEX && p.restr_f != NULL) {
-            sbuffer_clear(sb);
-            goto next_char;
-          }
-          char *w2 = malloc(sbuffer_length(sb) * sizeof *w2);
-          if (w2 == NULL) {
-            goto error_capacity;
-          }
-          strcpy(w2, w);
-          if (holdall_put(has, w2) != 0) {
-            goto error_capacity;
-          }
-          wi = malloc(sizeof *wi);
-          if (wi == NULL) {
-            goto error_capacity;
-          }
-          if (hashtable_add(ht, w2, wi) == NULL) {
-            free(wi);
-            goto error_capacity;
-          }
-          wi->file = nfile;
-          wi->occ = (nfile == RESTRICT_FILE_INDEX ? 0 : 1);
-        } else {
-          if (nfile == RESTRICT_FILE_INDEX) {
-            sbuffer_clear(sb);
-            goto next_char;
-          }
-          if (wi->file != nfile) {
-            if (wi->file == RESTRICT_FILE_INDEX) {
-              wi->file = nfile;
-              wi->occ = 1;
-            } else {
-              wi->occ = 0;
-            }
-          } else {
-            wi->occ += 1;
-          }
-        }
-        sbuffer_clear(sb);
-      } else {
-        if (skip_chr) {
-          goto next_char;
-        }
-        if (sbuffer_append(sb, (char) c) != 0) {
-          goto error_capacity;
-        }
-      }
-next_char:
-      c = fgetc(f);
+  if (p.xwc.dictionary == XWC_RADIX_TREE
+      && (p.xwc.nthreads > 1 || p.xwc.max_memory != 0)) {
+    fprintf(stderr, "%s: --dictionary=" OPT_ARG_DICT_ART " cannot be "
+        "combined with --threads or --max-memory\n", argv[0]);
+    suggest_help(argv[0]);
+    return EXIT_FAILURE;
+  }
+  if (p.xwc.sketch != 0 && (p.xwc.nthreads > 1 || p.xwc.max_memory != 0
+      || p.xwc.dictionary == XWC_RADIX_TREE || p.restr_f != NULL)) {
+    fprintf(stderr, "%s: --sketch cannot be combined with --threads, "
+        "--max-memory, --dictionary=" OPT_ARG_DICT_ART " or -"
+        OPT_RESTRICT_STR "\n", argv[0]);
+    suggest_help(argv[0]);
+    return EXIT_FAILURE;
+  }
+  if (p.xwc.membership && (p.xwc.max_memory != 0 || p.xwc.sketch != 0)) {
+    fprintf(stderr, "%s: --in-files cannot be combined with --max-memory or "
+        "--sketch\n", argv[0]);
+    suggest_help(argv[0]);
+    return EXIT_FAILURE;
+  }
+  p.xwc.restricted = p.restr_f != NULL;
+  p.xwc.stats = p.stats;
+  //  Noms des fichiers, par indice.
+  flist *fl = flist_empty();
+  if (fl == NULL) {
+    fprintf(stderr, "Error: Not enough memory\n");
+    return EXIT_FAILURE;
+  }
+  if (collect_names(&p, argc - optind, argv + optind, fl) != 0) {
+    flist_dispose(&fl);
+    return EXIT_FAILURE;
+  }
+  size_t nnames = XWC_FIRST_FILE + flist_count(fl);
+  const char **names = malloc(nnames * sizeof *names);
+  if (names == NULL) {
+    fprintf(stderr, "Error: Not enough memory\n");
+    flist_dispose(&fl);
+    return EXIT_FAILURE;
+  }
+  names[XWC_RESTRICT_FILE] = p.restr_f;
+  for (size_t k = XWC_FIRST_FILE; k < nnames; ++k) {
+    names[k] = flist_get(fl, k - XWC_FIRST_FILE);
+  }
+  client cl = {
+    .prog_name = argv[0],
+    .names = names,
+    .nnames = nnames,
+    .stats = p.stats,
+    .tphase = { 0.0, 0.0 },
+    .tsort = { 0.0, 0.0 },
+    .ow = NULL
+  };
+  p.xwc.cut_context = &cl;
+  p.xwc.cut = (void (*)(void *, size_t, const char *, size_t))cut_word;
+  xwc *x = NULL;
+  int xr = XWC_SUCCESS;
+  chrono testimate = { 0.0, 0.0 };
+  if (p.stats) {
+    testimate = chrono_now();
+  }
+  if (!p.expected_set && p.xwc.max_memory == 0 && p.xwc.sketch == 0
+      && p.xwc.dictionary == XWC_HASHTABLE) {
+    //  Estimation sur le fichier de restriction s'il y en a un, sur les autres
+    //    fichiers sinon, à moins que l'entrée standard n'en fasse partie.
+    size_t first = (p.restr_f != NULL ? XWC_RESTRICT_FILE : XWC_FIRST_FILE);
+    size_t n = (p.restr_f != NULL ? 1 : nnames - XWC_FIRST_FILE);
+    bool std = false;
+    for (size_t k = first; k < first + n; ++k) {
+      std = std || strcmp(names[k], STDIN_FNAME) == 0;
     }
-    if (!feof(f)) {
-      if (f != stdin) {
-        fclose(f);
-      }
-      PRINT_READ_ERR(fname);
-      goto error;
+    if (!std) {
+      p.xwc.expected = xwc_estimate_words(&p.xwc, names + first, n);
     }
-    if (f == stdin) {
-      printf(CHIGHLIGHT "--- ends reading for ");
-      if (nfile == RESTRICT_FILE_INDEX) {
-        printf("restrict");
-      } else {
-        printf("#%zu", nfile);
+  }
+  if (p.stats) {
+    testimate = chrono_since(testimate);
+  }
+  x = xwc_create(&p.xwc);
+  if (x == NULL) {
+    fprintf(stderr, "Error: Not enough memory\n");
+    goto error;
+  }
+  chrono tstart = { 0.0, 0.0 };
+  if (p.stats) {
+    tstart = chrono_now();
+  }
+  for (size_t k = (p.restr_f != NULL ? XWC_RESTRICT_FILE : XWC_FIRST_FILE);
+      k < nnames; ++k) {
+    if (strcmp(names[k], STDIN_FNAME) == 0) {
+      print_stdin_mark("starts", k);
+      xr = xwc_feed_stream(x, k, stdin);
+      if (xr != XWC_SUCCESS) {
+        goto error_count;
       }
-      printf(" FILE" CRESET "\n");
+      print_stdin_mark("ends", k);
       clearerr(stdin);
     } else {
-      if (fclose(f) != 0) {
-        PRINT_READ_ERR(fname);
-        goto error;
+      xr = xwc_feed_path(x, k, names[k]);
+      if (xr != XWC_SUCCESS) {
+        goto error_count;
       }
     }
-    nfile++;
+    //  Le bilan d'un fichier confié aux fils d'exécution n'est disponible
+    //    qu'après xwc_finish.
+    struct xwc_file_stats fs;
+    if (p.stats && xwc_get_file_stats(x, k, &fs) == 0) {
+      print_read_stats(k, names[k], &fs);
+    }
   }
-  if (p.sort_mode == LEXICOGRAPHICAL) {
-    if (p.sort_reversed) {
-      holdall_sort(has, (int (*)(const void *, const void *))rev_strcoll);
-    } else {
-      holdall_sort(has, (int (*)(const void *, const void *))strcoll);
+  xr = xwc_finish(x);
+  if (xr != XWC_SUCCESS) {
+    goto error_count;
+  }
+  if (p.stats && p.xwc.nthreads > 1) {
+    for (size_t k = XWC_FIRST_FILE; k < nnames; ++k) {
+      struct xwc_file_stats fs;
+      if (strcmp(names[k], STDIN_FNAME) != 0
+          && xwc_get_file_stats(x, k, &fs) == 0) {
+        print_read_stats(k, names[k], &fs);
+      }
     }
   }
-  if (p.restr_f != NULL) {
-    printf("%s", FORMAT_FILE_NAME(p.restr_f));
+  chrono tread = { 0.0, 0.0 };
+  if (p.stats) {
+    tread = chrono_since(tstart);
+    cl.tphase = chrono_now();
+  }
+  xwc_order order = (p.sort_mode == NONE ? XWC_ORDER_NONE
+      : p.sort_reversed ? XWC_ORDER_DESCENDING : XWC_ORDER_ASCENDING);
+  //  Avec un seul fil d'exécution de mise en forme, les lignes le sont par le
+  //    fil principal, qui les écrit.
+  size_t nout = (p.output_threads_set ? p.output_threads : p.xwc.nthreads);
+  cl.ow = owriter_create(stdout, nout == 1 ? 0 : nout, &cl,
+      p.xwc.membership
+      ? (size_t (*)(void *, const void *, char *, size_t))format_word_sets
+      : (size_t (*)(void *, const void *, char *, size_t))format_word);
+  if (cl.ow == NULL) {
+    goto error_capacity;
   }
-  if (optind == argc) {
-    printf("\t%s", FORMAT_FILE_NAME(STDIN_FNAME));
+  if (p.xwc.membership) {
+    xr = xwc_apply_sets(x, order, p.min_files, p.max_files, &cl,
+        (int (*)(void *))start_output,
+        (int (*)(void *, const char *, size_t, const struct xwc_occ *,
+          size_t))print_word_sets);
   } else {
-    for (int i = optind; i < argc; i++) {
-      printf("\t%s", FORMAT_FILE_NAME(argv[i]));
+    xr = xwc_apply(x, order, &cl, (int (*)(void *))start_output,
+        (int (*)(void *, const char *, size_t, size_t, long int))print_word);
+  }
+  if (owriter_close(&cl.ow) != 0 && xr == XWC_SUCCESS) {
+    xr = XWC_ERR_CAPACITY;
+  }
+  if (xr == XWC_ERR_LIMIT) {
+    fprintf(stderr, "Error: Memory limit of %zu bytes reached while "
+        "counting partition #%zu; use more --spill-partitions\n",
+        p.xwc.max_memory, xwc_error_index(x));
+    goto error_memory;
+  }
+  if (xr != XWC_SUCCESS) {
+    goto error_count;
+  }
+  if (p.stats) {
+    fflush(stdout);
+    chrono tout = chrono_since(cl.tphase);
+    chrono tall = chrono_since(tstart);
+    struct xwc_stats sts;
+    xwc_get_stats(x, &sts);
+    PRINT_STAT("read.bytes", "%zu", sts.read.bytes);
+    PRINT_STAT("read.mapped_bytes", "%zu", sts.read.mapped);
+    PRINT_STAT("read.compressed_bytes", "%zu", sts.read.compressed);
+    PRINT_STAT("read.tokens", "%zu", sts.read.tokens);
+    PRINT_STAT("read.wall_s", "%.6f", tread.wall);
+    PRINT_STAT("read.cpu_s", "%.6f", tread.cpu);
+    PRINT_STAT("read.bytes_per_s", "%.0f",
+        chrono_rate((double) sts.read.bytes, tread.wall));
+    PRINT_STAT("read.tokens_per_s", "%.0f",
+        chrono_rate((double) sts.read.tokens, tread.wall));
+    PRINT_STAT("estimate.wall_s", "%.6f", testimate.wall);
+    PRINT_STAT("estimate.cpu_s", "%.6f", testimate.cpu);
+    PRINT_STAT("sort.wall_s", "%.6f", cl.tsort.wall);
+    PRINT_STAT("sort.cpu_s", "%.6f", cl.tsort.cpu);
+    PRINT_STAT("output.wall_s", "%.6f", tout.wall);
+    PRINT_STAT("output.cpu_s", "%.6f", tout.cpu);
+    PRINT_STAT("total.wall_s", "%.6f", tall.wall);
+    PRINT_STAT("total.cpu_s", "%.6f", tall.cpu);
+    PRINT_STAT("words.distinct", "%zu", sts.words.distinct);
+    PRINT_STAT("words.expected", "%zu", p.xwc.expected);
+    PRINT_STAT("words.exclusive", "%zu", sts.words.exclusive);
+    PRINT_STAT("words.disqualified", "%zu", sts.words.disqualified);
+    PRINT_STAT("words.restrict_unseen", "%zu", sts.words.unseen);
+    PRINT_STAT("words.selected", "%zu", sts.words.selected);
+    PRINT_STAT("words.zero_copy", "%zu", sts.words.zero_copy);
+    PRINT_STAT("words.copied", "%zu", sts.words.copied);
+    PRINT_STAT("threads", "%zu", sts.threads);
+    PRINT_STAT("hashtable.nslots", "%zu", sts.hashtable.nslots);
+    PRINT_STAT("hashtable.nentries", "%zu", sts.hashtable.nentries);
+    PRINT_STAT("hashtable.ldfact_max", "%f", sts.hashtable.ldfactmax);
+    PRINT_STAT("hashtable.ldfact_curr", "%f", sts.hashtable.ldfactcurr);
+    PRINT_STAT("hashtable.chain_max", "%zu", sts.hashtable.maxlen);
+    PRINT_STAT("hashtable.pos_theo", "%f", sts.hashtable.postheo);
+    PRINT_STAT("hashtable.pos_curr", "%f", sts.hashtable.poscurr);
+    PRINT_STAT("hashtable.resizes", "%zu", sts.hashtable.nresizes);
+    PRINT_STAT("hashtable.reseeds", "%zu", sts.hashtable.nreseeds);
+    if (sts.art.used) {
+      PRINT_STAT("art.nodes4", "%zu", sts.art.nnodes[0]);
+      PRINT_STAT("art.nodes16", "%zu", sts.art.nnodes[1]);
+      PRINT_STAT("art.nodes48", "%zu", sts.art.nnodes[2]);
+      PRINT_STAT("art.nodes256", "%zu", sts.art.nnodes[3]);
+      PRINT_STAT("art.height", "%zu", sts.art.height);
+      PRINT_STAT("art.prefix_bytes", "%zu", sts.art.prefix);
     }
+    print_mem_stats(x);
+    if (sts.spill.used) {
+      PRINT_STAT("spill.partitions", "%zu", sts.spill.partitions);
+      PRINT_STAT("spill.flushes", "%zu", sts.spill.flushes);
+      PRINT_STAT("spill.tuples", "%zu", sts.spill.tuples);
+      PRINT_STAT("spill.bytes", "%zu", sts.spill.bytes);
+    }
+    if (sts.sketch.used) {
+      PRINT_STAT("sketch.capacity", "%zu", sts.sketch.capacity);
+      PRINT_STAT("sketch.cells", "%zu", sts.sketch.cells);
+      PRINT_STAT("sketch.depth", "%zu", sts.sketch.depth);
+      PRINT_STAT("sketch.shared", "%f", sts.sketch.shared);
+      PRINT_STAT("sketch.miss", "%f", sts.sketch.miss);
+    }
+    if (sts.hugepages.threshold == XWC_HUGE_PAGES_NEVER) {
+      PRINT_STAT("hugepages.threshold", "%s", OPT_ARG_HUGE_NONE);
+    } else {
+      PRINT_STAT("hugepages.threshold", "%zu", sts.hugepages.threshold);
+    }
+    PRINT_STAT("hugepages.maps", "%zu", sts.hugepages.maps);
+    PRINT_STAT("hugepages.mapped_bytes", "%zu", sts.hugepages.mapped);
+    PRINT_STAT("hugepages.advised_bytes", "%zu", sts.hugepages.advised);
+    PRINT_STAT("hugepages.fallbacks", "%zu", sts.hugepages.fallbacks);
+    PRINT_STAT("hugepages.thp_bytes", "%zu", sts.hugepages.thp);
+    PRINT_STAT("hugepages.thp_mode", "%s", sts.hugepages.mode);
   }
-  printf("\n");
-  holdall_apply_context(has, ht,
-      (void *(*)(void *, void *))hashtable_search,
-      (int (*)(void *, void *))rprint_word_info);
   goto dispose;
+error_count:
+  switch (xr) {
+    case XWC_ERR_READ:
+      PRINT_READ_ERR(names[xwc_error_index(x)]);
+      goto error;
+    case XWC_ERR_LIMIT:
+      fprintf(stderr, "Error: Memory limit of %zu bytes reached while "
+          "reading ", p.xwc.max_memory);
+      if (strcmp(names[xwc_error_index(x)], STDIN_FNAME) == 0) {
+        fprintf(stderr, "standard input\n");
+      } else {
+        fprintf(stderr, "file '%s'\n", names[xwc_error_index(x)]);
+      }
+      goto error_memory;
+    case XWC_ERR_SPILL:
+      goto error_spill;
+    case XWC_ERR_TEMP:
+      goto error_temp;
+    case XWC_ERR_THREADS:
+      fprintf(stderr, "Error: Cannot start reading threads\n");
+      goto error;
+    case XWC_ERR_DECOMPRESS:
+      fprintf(stderr, "Error: Cannot decompress file '%s'\n",
+          names[xwc_error_index(x)]);
+      goto error;
+    default:
+      goto error_capacity;
+  }
+error_temp:
+  fprintf(stderr, "Error: Cannot create temporary files in '%s'\n",
+      p.xwc.spill_dir);
+  goto error;
+error_spill:
+  fprintf(stderr, "Error: An error has occurred while accessing temporary "
+      "files in '%s'\n", p.xwc.spill_dir);
+  goto error;
 error_capacity:
   fprintf(stderr, "Error: Not enough memory\n");
+  goto error_memory;
+error_memory:
+  print_mem_stats(x);
   goto error;
 error:
   r = EXIT_FAILURE;
   goto dispose;
 dispose:
-  if (has != NULL) {
-    if (ht != NULL) {
-      holdall_apply_context(has, ht,
-          (void *(*)(void *, void *))hashtable_search,
-          (int (*)(void *, void *))rfree_word_info);
-      hashtable_dispose(&ht);
-    }
-    holdall_apply(has, (int (*)(void *))rfree);
-    holdall_dispose(&has);
-  }
-  sbuffer_dispose(&sb);
+  xwc_dispose(&x);
+  free(names);
+  flist_dispose(&fl);
   return r;
 }
 
-//- UTILITAIRES ----------------------------------------------------------------
+//- SORTIE ---------------------------------------------------------------------
 
-int rprint_word_info(char *w, word_info *wi) {
-  if (wi->occ != 0) {
-    printf("%s", w);
-    for (size_t i = 0; i < wi->file; i++) {
-      printf("\t");
-    }
-    printf("%ld\n", wi->occ);
+void cut_word(client *cl, size_t file, const char *w, size_t len) {
+  const char *fname = cl->names[file];
+  bool std = strcmp(fname, STDIN_FNAME) == 0;
+  fprintf(stderr, "%s: Word from %s%s%s cut: '%.*s...'.\n", cl->prog_name,
+      std ? "standard input" : "file '", std ? "" : fname,
+      std ? "" : "'", (int) len, w);
+}
+
+int start_output(client *cl) {
+  if (cl->stats) {
+    cl->tsort = chrono_since(cl->tphase);
+    cl->tphase = chrono_now();
   }
+  print_header(cl);
   return 0;
 }
 
-int rfree_word_info([[maybe_unused]] char *w, word_info *wi) {
-  free(wi);
+int print_word(client *cl, const char *w, size_t len, size_t file,
+    long int occ) {
+  word_record *rec = owriter_record(cl->ow, sizeof *rec + len);
+  if (rec == NULL) {
+    return -1;
+  }
+  *rec = (word_record) { len, file, occ };
+  memcpy(rec + 1, w, len);
   return 0;
 }
 
-int rfree(char *w) {
-  free(w);
+int print_word_sets(client *cl, const char *w, size_t len,
+    const struct xwc_occ *occs, size_t n) {
+  if (n > (SIZE_MAX - sizeof(sets_record) - len) / sizeof *occs) {
+    return -1;
+  }
+  sets_record *rec = owriter_record(cl->ow,
+      sizeof *rec + n * sizeof *occs + len);
+  if (rec == NULL) {
+    return -1;
+  }
+  *rec = (sets_record) { len, n };
+  struct xwc_occ *a = (struct xwc_occ *) (rec + 1);
+  memcpy(a, occs, n * sizeof *occs);
+  memcpy(a + n, w, len);
   return 0;
 }
 
-int rev_strcoll(const char *s1, const char *s2) {
-  return -1 * strcoll(s1, s2);
+size_t format_word([[maybe_unused]] const client *cl, const word_record *rec,
+    char *dest, size_t room) {
+  char num[LONG_STR_MAX];
+  size_t d = long_to_str(rec->occ, num);
+  size_t n = rec->len + rec->file + d + 1;
+  if (n > room) {
+    return n;
+  }
+  memcpy(dest, rec + 1, rec->len);
+  dest += rec->len;
+  memset(dest, '\t', rec->file);
+  dest += rec->file;
+  memcpy(dest, num, d);
+  dest[d] = '\n';
+  return n;
+}
+
+size_t format_word_sets([[maybe_unused]] const client *cl,
+    const sets_record *rec, char *dest, size_t room) {
+  const struct xwc_occ *occs = (const struct xwc_occ *) (rec + 1);
+  size_t n = rec->len + 1;
+  if (rec->n > 0) {
+    n += occs[rec->n - 1].file;
+  }
+  for (size_t k = 0; k < rec->n; ++k) {
+    char num[LONG_STR_MAX];
+    n += long_to_str(occs[k].occ, num);
+  }
+  if (n > room) {
+    return n;
+  }
+  memcpy(dest, occs + rec->n, rec->len);
+  char *p = dest + rec->len;
+  size_t col = 0;
+  for (size_t k = 0; k < rec->n; ++k) {
+    memset(p, '\t', occs[k].file - col);
+    p += occs[k].file - col;
+    col = occs[k].file;
+    p += long_to_str(occs[k].occ, p);
+  }
+  *p = '\n';
+  return n;
+}
+
+size_t long_to_str(long int v, char s[static LONG_STR_MAX]) {
+  char t[LONG_STR_MAX];
+  size_t n = 0;
+  unsigned long int u = (v < 0 ? 0UL - (unsigned long int) v
+      : (unsigned long int) v);
+  do {
+    t[n] = (char) ('0' + u % 10);
+    u /= 10;
+    ++n;
+  } while (u != 0);
+  size_t k = 0;
+  if (v < 0) {
+    s[k] = '-';
+    ++k;
+  }
+  while (n > 0) {
+    --n;
+    s[k] = t[n];
+    ++k;
+  }
+  return k;
+}
+
+void print_header(const client *cl) {
+  if (cl->names[XWC_RESTRICT_FILE] != NULL) {
+    printf("%s", FORMAT_FILE_NAME(cl->names[XWC_RESTRICT_FILE]));
+  }
+  for (size_t k = XWC_FIRST_FILE; k < cl->nnames; ++k) {
+    printf("\t%s", FORMAT_FILE_NAME(cl->names[k]));
+  }
+  printf("\n");
 }
 
-size_t str_hashfun(const char *s) {
-  size_t h = 0;
-  for (const unsigned char *p = (const unsigned char *) s; *p != '\0'; ++p) {
-    h = 37 * h + *p;
+void print_stdin_mark(const char *what, size_t nfile) {
+  printf(CHIGHLIGHT "--- %s reading for ", what);
+  if (nfile == XWC_RESTRICT_FILE) {
+    printf("restrict");
+  } else {
+    printf("#%zu", nfile);
+  }
+  printf(" FILE" CRESET "\n");
+}
+
+void print_read_stats(size_t nfile, const char *fname,
+    const struct xwc_file_stats *fs) {
+  PRINT_STAT("file.%zu.name", "%s", nfile, fname);
+  PRINT_STAT("file.%zu.bytes", "%zu", nfile, fs->bytes);
+  PRINT_STAT("file.%zu.mapped_bytes", "%zu", nfile, fs->mapped);
+  PRINT_STAT("file.%zu.compressed_bytes", "%zu", nfile, fs->compressed);
+  PRINT_STAT("file.%zu.tokens", "%zu", nfile, fs->tokens);
+  PRINT_STAT("file.%zu.wall_s", "%.6f", nfile, fs->wall);
+  PRINT_STAT("file.%zu.cpu_s", "%.6f", nfile, fs->cpu);
+  PRINT_STAT("file.%zu.bytes_per_s", "%.0f", nfile,
+      chrono_rate((double) fs->bytes, fs->wall));
+  PRINT_STAT("file.%zu.tokens_per_s", "%.0f", nfile,
+      chrono_rate((double) fs->tokens, fs->wall));
+  PRINT_STAT("file.%zu.sketch_error", "%zu", nfile, fs->sketch_error);
+}
+
+int parse_files_range(const char *s, size_t *minptr, size_t *maxptr) {
+  if (strcmp(s, OPT_ARG_FILES_ALL) == 0) {
+    *minptr = XWC_ALL_FILES;
+    *maxptr = XWC_ALL_FILES;
+    return 0;
+  }
+  char *end;
+  errno = 0;
+  unsigned long long int lo = strtoull(s, &end, 10);
+  if (!isdigit((unsigned char) *s) || errno == ERANGE || lo == 0
+      || lo > SIZE_MAX) {
+    return -1;
+  }
+  unsigned long long int hi = lo;
+  if (*end == '-') {
+    const char *t = end + 1;
+    if (*t == '\0') {
+      *minptr = (size_t) lo;
+      *maxptr = XWC_ALL_FILES;
+      return 0;
+    }
+    hi = strtoull(t, &end, 10);
+    if (!isdigit((unsigned char) *t) || errno == ERANGE || hi < lo
+        || hi > SIZE_MAX) {
+      return -1;
+    }
+  }
+  if (*end != '\0') {
+    return -1;
   }
-  return h;
+  *minptr = (size_t) lo;
+  *maxptr = (size_t) hi;
+  return 0;
+}
+
+void print_mem_stats(const xwc *x) {
+  struct xwc_memory mem;
+  xwc_get_memory(x, &mem);
+  PRINT_STAT("mem.strings", "%zu", mem.strings);
+  PRINT_STAT("mem.word_info", "%zu", mem.word_info);
+  PRINT_STAT("mem.hashtable.slots", "%zu", mem.slots);
+  PRINT_STAT("mem.hashtable.cells", "%zu", mem.cells);
+  PRINT_STAT("mem.art", "%zu", mem.art);
+  PRINT_STAT("mem.holdall", "%zu", mem.holdall);
+  PRINT_STAT("mem.sbuffer", "%zu", mem.sbuffer);
+  PRINT_STAT("mem.fold", "%zu", mem.fold);
+  PRINT_STAT("mem.threads", "%zu", mem.threads);
+  PRINT_STAT("mem.sketch", "%zu", mem.sketch);
+  PRINT_STAT("mem.total", "%zu", mem.total);
+  PRINT_STAT("mem.limit", "%zu", mem.limit);
 }
 
 //- AIDES ----------------------------------------------------------------------
@@ -487,6 +1124,99 @@ void suggest_help(char *prog_name) {
   printf("Try '%s -?' for more information.\n", prog_name);
 }
 
+int collect_names(const options *p, int nargs, char **args, flist *fl) {
+  int r = FLIST_SUCCESS;
+  for (int k = 0; k < nargs && r == FLIST_SUCCESS; ++k) {
+    r = flist_add(fl, args[k]);
+  }
+  if (r == FLIST_SUCCESS && p->files_from != NULL) {
+    bool std = strcmp(p->files_from, STDIN_FNAME) == 0;
+    FILE *f = (std ? stdin : fopen(p->files_from, "r"));
+    if (f == NULL) {
+      PRINT_READ_ERR(p->files_from);
+      return -1;
+    }
+    r = flist_read(fl, f);
+    if (std) {
+      clearerr(stdin);
+    } else if (fclose(f) != 0 && r == FLIST_SUCCESS) {
+      r = FLIST_ERR_READ;
+    }
+    if (r == FLIST_ERR_READ) {
+      PRINT_READ_ERR(p->files_from);
+      return -1;
+    }
+  }
+  if (r == FLIST_SUCCESS && nargs == 0 && p->files_from == NULL) {
+    r = flist_add(fl, STDIN_FNAME);
+  }
+  if (r == FLIST_SUCCESS && p->recursive) {
+    r = flist_expand(fl, WALK_THREADS);
+  }
+  switch (r) {
+    case FLIST_SUCCESS:
+      return 0;
+    case FLIST_ERR_READ:
+      fprintf(stderr, "Error: Cannot read directory '%s'\n",
+          flist_error_path(fl));
+      return -1;
+    case FLIST_ERR_THREADS:
+      fprintf(stderr, "Error: Cannot start directory traversal threads\n");
+      return -1;
+    default:
+      fprintf(stderr, "Error: Not enough memory\n");
+      return -1;
+  }
+}
+
+int parse_size(const char *s, size_t *vptr) {
+  char *end;
+  errno = 0;
+  unsigned long long int v = strtoull(s, &end, 10);
+  if (!isdigit((unsigned char) *s) || errno == ERANGE) {
+    return -1;
+  }
+  if (*end != '\0') {
+    const char *suffix = strchr(SIZE_SUFFIXES, toupper((unsigned char) *end));
+    if (suffix == NULL || *(end + 1) != '\0') {
+      return -1;
+    }
+    for (const char *q = SIZE_SUFFIXES; q <= suffix; q++) {
+      if (v > ULLONG_MAX / SIZE_SUFFIX_BASE) {
+        return -1;
+      }
+      v *= SIZE_SUFFIX_BASE;
+    }
+  }
+  if (v > SIZE_MAX) {
+    return -1;
+  }
+  *vptr = (size_t) v;
+  return 0;
+}
+
+const opt *find_opt(const opt opts[], int c) {
+  for (size_t k = 0; opts[k].c != OPT_END.c || opts[k].doc != OPT_END.doc;
+      k++) {
+    if (opts[k].c == c && c != OPT_GROUP_CHAR) {
+      return &opts[k];
+    }
+  }
+  return NULL;
+}
+
+void print_opt_err(const char *prog_name, const char *msg, int c,
+    const opt opts[], const char *arg) {
+  const opt *o = find_opt(opts, c);
+  if (c == 0) {
+    fprintf(stderr, "%s: %s -- '%s'\n", prog_name, msg, arg);
+  } else if (IS_LONG_ONLY(c) && o != NULL) {
+    fprintf(stderr, "%s: %s -- '--%s'\n", prog_name, msg, o->lname);
+  } else {
+    fprintf(stderr, "%s: %s -- '%c'\n", prog_name, msg, c);
+  }
+}
+
 void print_help(char *prog_name, opt opts[]) {
   print_usage(prog_name);
   print_multi_line(0, "\nExclusive word counting. Print the number of "
@@ -501,9 +1231,13 @@ void print_help(char *prog_name, opt opts[]) {
       "number of occurrences in the FILE in which it appears to the exclusion "
       "of all others in the column associated with the FILE. No tab characters "
       "are written on a line after the number of occurrences.\n\nRead the "
-      "standard input when no FILE is given or for any FILE which is \"-\". In "
-      "such cases, \"\" is displayed in the column associated with the FILE on "
-      "the header line.\n\nThe locale specified by the environment affects "
+      "standard input when neither FILE nor --files-from is given or for any "
+      "FILE which is \"-\". In such cases, \"\" is displayed in the column "
+      "associated with the FILE on the header line.\n\nA FILE compressed "
+      "with gzip, or with zstd if the program was built with ZSTD=1, is "
+      "recognized by its first bytes and decompressed on the fly by a "
+      "separate thread while its words are counted; its name is displayed "
+      "unchanged.\n\nThe locale specified by the environment affects "
       "sort order. Set 'LC_ALL=C' to get the traditional sort order that uses "
       "native byte values.\n");
   size_t k = 0;
@@ -514,11 +1248,24 @@ void print_help(char *prog_name, opt opts[]) {
       if (!opts[k].group_prev) {
         printf("\n");
       }
-      printf("  -%c ", opts[k].c);
-      if (opts[k].arg != NULL) {
-        printf("%s\t", opts[k].arg);
+      if (IS_LONG_ONLY(opts[k].c)) {
+        int n = printf("  --%s", opts[k].lname);
+        if (opts[k].arg != NULL) {
+          n += printf("=%s", opts[k].arg);
+        }
+        if (n < HELP_DOC_COLUMN) {
+          PRINT_WHITESPACE(HELP_DOC_COLUMN - n);
+        } else {
+          printf("\n");
+          PRINT_WHITESPACE(HELP_DOC_COLUMN);
+        }
       } else {
-        printf("\t\t");
+        printf("  -%c ", opts[k].c);
+        if (opts[k].arg != NULL) {
+          printf("%s\t", opts[k].arg);
+        } else {
+          printf("\t\t");
+        }
       }
       print_multi_line(HELP_DOC_COLUMN, opts[k].doc);
       printf("\n");
@@ -0,0 +1,31 @@
+#!/bin/sh
+#  cut_limit.sh : vérifie qu'avec -i N un mot d'exactement N caractères suivi
+#    d'un séparateur est compté entier sans être signalé comme coupé, et que le
+#    mot qui le suit est compté, l'entrée étant projetée en mémoire ou lue sur
+#    l'entrée standard.
+#  Usage : cut_limit.sh XWC
+
+xwc=${1:?usage: cut_limit.sh XWC}
+dir=$(mktemp -d) || exit 1
+trap 'rm -rf "$dir"' EXIT
+printf 'abc def\nabcd ef\nabc' > "$dir/in.txt"
+fail=0
+for src in file stdin; do
+  if [ $src = file ]; then
+    LC_ALL=C "$xwc" -i 3 "$dir/in.txt" > "$dir/out" 2> "$dir/err"
+  else
+    LC_ALL=C "$xwc" -i 3 - < "$dir/in.txt" > "$dir/out" 2> "$dir/err"
+  fi
+  for line in "$(printf 'abc\t3')" "$(printf 'def\t1')" "$(printf 'ef\t1')"; do
+    if ! grep -qx "$line" "$dir/out"; then
+      echo "FAIL cut_limit ($src): missing line '$line'"
+      fail=1
+    fi
+  done
+  if [ "$(grep -c 'cut:' "$dir/err")" != 1 ]; then
+    echo "FAIL cut_limit ($src): expected a single cut word"
+    fail=1
+  fi
+done
+[ $fail = 0 ] && echo "PASS cut_limit"
+exit $fail
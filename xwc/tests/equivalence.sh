@@ -0,0 +1,75 @@
+#!/bin/sh
+#  equivalence.sh : vérifie que xwc produit les mêmes sorties, standard et
+#    d'erreur, que celui de la révision REV du dépôt, pour toutes les
+#    combinaisons des options -p, -i et -r, avec ou sans -l, sur des fichiers
+#    projetés en mémoire et sur l'entrée standard. La révision de référence
+#    est construite dans un arbre de travail temporaire.
+#  Usage : equivalence.sh XWC REV
+
+xwc=${1:?usage: equivalence.sh XWC REV}
+rev=${2:?usage: equivalence.sh XWC REV}
+case $xwc in
+  /*) ;;
+  *) xwc="$PWD/$xwc" ;;
+esac
+top=$(git rev-parse --show-toplevel) || exit 1
+dir=$(mktemp -d) || exit 1
+trap 'git -C "$top" worktree remove --force "$dir/ref" 2> /dev/null;
+  rm -rf "$dir"' EXIT
+trap 'exit 1' HUP INT PIPE TERM
+git -C "$top" worktree add -q --detach "$dir/ref" "$rev" || exit 1
+make -s -C "$dir/ref/xwc" > /dev/null || exit 1
+ref="$dir/ref/xwc/xwc"
+#  Entrées : mots de longueurs variées, séparés par des espaces ou des
+#    ponctuations, dont certains dépassent largement les limites de -i ; la
+#    taille des fichiers dépasse celle des blocs lus sur l'entrée standard.
+gen() {
+  awk -v seed="$1" -v n="$2" 'BEGIN {
+    srand(seed)
+    split("a b c d e f g h i j k l m n o p q r s t u v w x y z A B C", al, " ")
+    split(" | |\n|, |.|-|;\n|!|  |\t", sep, "|")
+    for (i = 0; i < n; ++i) {
+      len = int(rand() * rand() * 12) + 1
+      if (rand() < 0.01) {
+        len += 200
+      }
+      w = ""
+      for (j = 0; j < len; ++j) {
+        w = w al[int(rand() * 4 + (len % 6)) + 1]
+      }
+      printf "%s%s", w, sep[int(rand() * 10) + 1]
+    }
+  }' > "$dir/$3"
+}
+gen 1 60000 f0.txt
+gen 2 60000 f1.txt
+gen 3 2000 f2.txt
+gen 1 3000 r.txt
+fail=0
+run() {
+  name=$1
+  shift
+  LC_ALL=C "$ref" "$@" > "$dir/exp.out" 2> "$dir/exp.err" < "$dir/in"
+  LC_ALL=C "$xwc" "$@" > "$dir/got.out" 2> "$dir/got.err" < "$dir/in"
+  sed 's/^[^:]*: //' "$dir/exp.err" > "$dir/exp.msg"
+  sed 's/^[^:]*: //' "$dir/got.err" > "$dir/got.msg"
+  if ! cmp -s "$dir/exp.out" "$dir/got.out" \
+      || ! cmp -s "$dir/exp.msg" "$dir/got.msg"; then
+    echo "FAIL equivalence ($name): $*"
+    fail=1
+  fi
+}
+cd "$dir" || exit 1
+cp f1.txt in
+for opts in "" "-p" "-i 1" "-i 3" "-i 4 -p" "-i 7" "-r r.txt" \
+    "-r r.txt -p" "-i 3 -r r.txt" "-i 5 -p -r r.txt"; do
+  for sort in "" "-l" "-l -R"; do
+    # shellcheck disable=SC2086
+    run file $opts $sort f0.txt f1.txt f2.txt f0.txt
+    # shellcheck disable=SC2086
+    run stdin $opts $sort f2.txt - f0.txt
+  done
+done
+run "stdin restrict" -l -r - f2.txt
+[ $fail = 0 ] && echo "PASS equivalence"
+exit $fail
@@ -0,0 +1,35 @@
+#!/bin/sh
+#  stats.sh : vérifie qu'avec --stats les durées de lecture de chaque fichier
+#    sont mesurées, c'est-à-dire que son débit en octets par seconde n'est pas
+#    nul, avec un ou plusieurs fils d'exécution, et que les agrandissements
+#    de la table de hachage sont comptés.
+#  Usage : stats.sh XWC
+
+xwc=${1:?usage: stats.sh XWC}
+dir=$(mktemp -d) || exit 1
+trap 'rm -rf "$dir"' EXIT
+awk 'BEGIN { for (i = 0; i < 200000; ++i) print "w" (i % 5000), "x" i }' \
+  > "$dir/in.txt"
+fail=0
+for threads in 1 2; do
+  LC_ALL=C "$xwc" --stats --threads=$threads "$dir/in.txt" "$dir/in.txt" \
+    > /dev/null 2> "$dir/err"
+  n=$(grep -c '^xwc\.file\.[0-9]*\.bytes_per_s=' "$dir/err")
+  if [ "$n" != 2 ]; then
+    echo "FAIL stats (threads=$threads): expected 2 per-file rates, got $n"
+    fail=1
+  fi
+  if grep -q '^xwc\.file\.[0-9]*\.bytes_per_s=0$' "$dir/err"; then
+    echo "FAIL stats (threads=$threads): per-file bytes_per_s is zero"
+    fail=1
+  fi
+done
+#  L'entrée standard n'est pas échantillonnée : la table n'est pas
+#    dimensionnée d'avance et doit être agrandie.
+LC_ALL=C "$xwc" --stats - < "$dir/in.txt" > /dev/null 2> "$dir/err"
+if ! grep -q '^xwc\.hashtable\.resizes=[1-9]' "$dir/err"; then
+  echo "FAIL stats (stdin): hashtable resizes not counted"
+  fail=1
+fi
+[ $fail = 0 ] && echo "PASS stats"
+exit $fail
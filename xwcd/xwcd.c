@@ -0,0 +1,723 @@
+//  xwcd.c : démon qui compte les mots exclusifs d'un ensemble de fichiers,
+//    garde les comptes en mémoire et répond aux requêtes de ses clients sur
+//    une socket locale, selon le protocole décrit par xwcd.h. Les fichiers
+//    peuvent être ajoutés au fil des requêtes ; les réponses sont données sans
+//    relire les fichiers déjà comptés.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+#include <locale.h>
+#include <getopt.h>
+#include <signal.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "libxwc.h"
+#include "xwcd.h"
+
+#define STDIN_FNAME "-"
+
+//  Nombre maximal de clients connectés simultanément et longueur de la file
+//    des connexions en attente.
+#define CLIENTS_MAX 64
+#define BACKLOG     16
+
+#define NAMES_CAPACITY_MIN  8
+#define NAMES_CAPACITY_MUL  2
+
+//  Les options qui n'ont qu'un nom long sont identifiées par des valeurs qui ne
+//    peuvent pas être celles d'un caractère.
+#define OPT_LONG_ONLY(n)  (UCHAR_MAX + 1 + (n))
+#define OPT_UTF8          OPT_LONG_ONLY(0)
+#define OPT_DICTIONARY    OPT_LONG_ONLY(1)
+#define OPT_THREADS       OPT_LONG_ONLY(2)
+#define OPT_EXPECTED      OPT_LONG_ONLY(3)
+
+#define OPT_ARG_DICT_HASH "hashtable"
+#define OPT_ARG_DICT_ART  "art"
+
+#define ERR_MSG_LEN 256
+
+//- STRUCTURES -----------------------------------------------------------------
+
+//  server : type et nom de type pour une structure regroupant l'état du
+//    démon : le nom de l'exécutable prog_name, le contexte de comptage x, les
+//    nnames noms des fichiers comptés, par indice, names[XWC_RESTRICT_FILE]
+//    valant NULL en l'absence de fichier restreignant, la capacité namescap
+//    de names, le fait que le contexte soit devenu inutilisable après une
+//    erreur, broken, le fait qu'un arrêt ait été demandé, stop, et le message
+//    de la dernière requête qui a échoué, err.
+typedef struct {
+  const char *prog_name;
+  xwc *x;
+  char **names;
+  size_t nnames;
+  size_t namescap;
+  bool broken;
+  bool stop;
+  char err[ERR_MSG_LEN];
+} server;
+
+//  conn : type et nom de type pour une structure décrivant la connexion d'un
+//    client : sa socket fd et son buffer de réception buf, de capacité
+//    XWCD_LINE_MAX, dont les len premiers octets sont reçus mais pas encore
+//    traités.
+typedef struct {
+  int fd;
+  char *buf;
+  size_t len;
+} conn;
+
+//  interrupted : un signal d'arrêt a été reçu.
+static volatile sig_atomic_t interrupted = 0;
+
+//- PROTOTYPES -----------------------------------------------------------------
+
+//  on_signal : affecte 1 à interrupted.
+static void on_signal(int sig);
+
+//  cut_word : signale sur la sortie erreur que le mot w de longueur len, lu
+//    dans le fichier d'indice file, est coupé.
+static void cut_word(server *s, size_t file, const char *w, size_t len);
+
+//  xwc_error_text : renvoie un texte décrivant le code d'erreur r de la
+//    bibliothèque.
+static const char *xwc_error_text(int r);
+
+//  fail : affecte à s->err le message formé selon format et les arguments qui
+//    suivent, puis renvoie -1.
+static int fail(server *s, const char *format, ...);
+
+//  broken : marque le contexte de s comme inutilisable après l'échec de code r
+//    de la bibliothèque puis renvoie fail.
+static int broken(server *s, int r);
+
+//  add_name : tente d'ajouter une copie de name à la fin des noms de s.
+//    Renvoie une valeur non nulle en cas de dépassement de capacité, zéro
+//    sinon.
+static int add_name(server *s, const char *name);
+
+//  load : compte les mots des fichiers de s passés sur la ligne de commande,
+//    le fichier restreignant en premier s'il y en a un, puis termine la
+//    lecture. Renvoie XWC_SUCCESS en cas de succès, un code d'erreur sinon.
+static int load(server *s);
+
+//  listen_on : tente de créer une socket d'écoute de nom path. Une socket de
+//    même nom qui n'est plus écoutée est d'abord supprimée. Renvoie la socket
+//    en cas de succès, -1 sinon, après avoir affiché un message d'erreur.
+static int listen_on(const char *prog_name, const char *path);
+
+//  serve : répond aux requêtes reçues sur la socket d'écoute lfd jusqu'à ce
+//    qu'un arrêt soit demandé ou qu'un signal d'arrêt soit reçu. Renvoie une
+//    valeur non nulle en cas d'erreur de la boucle d'attente, zéro sinon.
+static int serve(server *s, int lfd);
+
+//  receive : lit ce qui est disponible sur la connexion c et répond à chacune
+//    des requêtes complètes. Renvoie une valeur non nulle si la connexion
+//    doit être fermée, zéro sinon.
+static int receive(server *s, conn *c);
+
+//  respond : traite la requête line et écrit la réponse sur la socket fd.
+//    Renvoie une valeur non nulle en cas d'échec de l'écriture, zéro sinon.
+static int respond(server *s, int fd, char *line);
+
+//  dispatch : traite la requête line, dont le contenu est altéré, en écrivant
+//    ses données sur out. Renvoie zéro en cas de succès, -1 sinon, le message
+//    d'erreur étant alors affecté à s->err.
+static int dispatch(server *s, char *line, FILE *out);
+
+//  cmd_add, cmd_query, cmd_dump, cmd_files : traitement des commandes
+//    homonymes du protocole, d'arguments args, selon les conventions de
+//    dispatch.
+static int cmd_add(server *s, char *args, FILE *out);
+static int cmd_query(server *s, char *args, FILE *out);
+static int cmd_dump(server *s, char *args, FILE *out);
+static int cmd_files(server *s, FILE *out);
+
+//  print_tuple : écrit sur out la ligne de données du mot w de longueur len,
+//    qui n'apparaît que dans le fichier d'indice file, occ fois. Renvoie zéro.
+static int print_tuple(FILE *out, const char *w, size_t len, size_t file,
+    long int occ);
+
+//  write_all : écrit sur fd les n octets pointés par buf. Renvoie une valeur
+//    non nulle en cas d'échec, zéro sinon.
+static int write_all(int fd, const char *buf, size_t n);
+
+//  parse_count : convertit la chaîne s en un entier positif affecté à *vptr.
+//    Renvoie une valeur non nulle en cas d'échec, zéro sinon.
+static int parse_count(const char *s, size_t *vptr);
+
+static void print_usage(const char *prog_name);
+
+//- MAIN -----------------------------------------------------------------------
+
+int main(int argc, char **argv) {
+  setlocale(LC_COLLATE, "");
+  struct option longopts[] = {
+    { "utf8", no_argument, NULL, OPT_UTF8 },
+    { "dictionary", required_argument, NULL, OPT_DICTIONARY },
+    { "threads", required_argument, NULL, OPT_THREADS },
+    { "expected-words", required_argument, NULL, OPT_EXPECTED },
+    { "socket", required_argument, NULL, 'S' },
+    { NULL, 0, NULL, 0 }
+  };
+  struct xwc_options opts;
+  xwc_options_init(&opts);
+  const char *restr_f = NULL;
+  const char *path = XWCD_SOCKET_DEF;
+  bool expected_set = false;
+  int c;
+  while ((c = getopt_long(argc, argv, "pfi:r:S:", longopts, NULL)) != -1) {
+    switch (c) {
+      case 'p':
+        opts.punct = true;
+        break;
+      case 'f':
+        opts.fold = true;
+        break;
+      case 'i':
+        if (parse_count(optarg, &opts.init) != 0) {
+          fprintf(stderr, "%s: invalid value for -%c: '%s'\n", argv[0], c,
+              optarg);
+          return EXIT_FAILURE;
+        }
+        break;
+      case 'r':
+        restr_f = optarg;
+        break;
+      case 'S':
+        path = optarg;
+        break;
+      case OPT_UTF8:
+        opts.utf8 = true;
+        break;
+      case OPT_DICTIONARY:
+        if (strcmp(OPT_ARG_DICT_HASH, optarg) == 0) {
+          opts.dictionary = XWC_HASHTABLE;
+        } else if (strcmp(OPT_ARG_DICT_ART, optarg) == 0) {
+          opts.dictionary = XWC_RADIX_TREE;
+        } else {
+          fprintf(stderr, "%s: invalid value for --dictionary: '%s'\n",
+              argv[0], optarg);
+          return EXIT_FAILURE;
+        }
+        break;
+      case OPT_THREADS:
+        if (parse_count(optarg, &opts.nthreads) != 0 || opts.nthreads == 0) {
+          fprintf(stderr, "%s: invalid value for --threads: '%s'\n", argv[0],
+              optarg);
+          return EXIT_FAILURE;
+        }
+        break;
+      case OPT_EXPECTED:
+        if (parse_count(optarg, &opts.expected) != 0) {
+          fprintf(stderr, "%s: invalid value for --expected-words: '%s'\n",
+              argv[0], optarg);
+          return EXIT_FAILURE;
+        }
+        expected_set = true;
+        break;
+      default:
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+  }
+  if (opts.dictionary == XWC_RADIX_TREE && opts.nthreads > 1) {
+    fprintf(stderr, "%s: --dictionary=" OPT_ARG_DICT_ART " cannot be "
+        "combined with --threads\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  opts.restricted = restr_f != NULL;
+  int r = EXIT_SUCCESS;
+  int lfd = -1;
+  server s = {
+    .prog_name = argv[0],
+    .x = NULL,
+    .names = NULL,
+    .nnames = 0,
+    .namescap = 0,
+    .broken = false,
+    .stop = false
+  };
+  if (add_name(&s, restr_f) != 0) {
+    goto error_capacity;
+  }
+  for (int k = optind; k < argc; ++k) {
+    if (add_name(&s, argv[k]) != 0) {
+      goto error_capacity;
+    }
+  }
+  if (!expected_set && opts.dictionary == XWC_HASHTABLE
+      && s.nnames > XWC_FIRST_FILE) {
+    size_t first = (restr_f != NULL ? XWC_RESTRICT_FILE : XWC_FIRST_FILE);
+    bool std = false;
+    for (size_t k = first; k < s.nnames; ++k) {
+      std = std || strcmp(s.names[k], STDIN_FNAME) == 0;
+    }
+    if (!std) {
+      opts.expected = xwc_estimate_words(&opts,
+          (const char *const *) s.names + first, s.nnames - first);
+    }
+  }
+  opts.cut_context = &s;
+  opts.cut = (void (*)(void *, size_t, const char *, size_t))cut_word;
+  s.x = xwc_create(&opts);
+  if (s.x == NULL) {
+    goto error_capacity;
+  }
+  int xr = load(&s);
+  if (xr == XWC_ERR_READ) {
+    fprintf(stderr, "Error: An error has occurred while reading file '%s'\n",
+        s.names[xwc_error_index(s.x)]);
+    goto error;
+  }
+  if (xr == XWC_ERR_DECOMPRESS) {
+    fprintf(stderr, "Error: Cannot decompress file '%s'\n",
+        s.names[xwc_error_index(s.x)]);
+    goto error;
+  }
+  if (xr != XWC_SUCCESS) {
+    fprintf(stderr, "Error: %s\n", xwc_error_text(xr));
+    goto error;
+  }
+  lfd = listen_on(argv[0], path);
+  if (lfd == -1) {
+    goto error;
+  }
+  struct sigaction sa;
+  sa.sa_handler = on_signal;
+  sigemptyset(&sa.sa_mask);
+  sa.sa_flags = 0;
+  sigaction(SIGINT, &sa, NULL);
+  sigaction(SIGTERM, &sa, NULL);
+  signal(SIGPIPE, SIG_IGN);
+  fprintf(stderr, "%s: listening on '%s'\n", argv[0], path);
+  if (serve(&s, lfd) != 0) {
+    fprintf(stderr, "Error: %s\n", strerror(errno));
+    r = EXIT_FAILURE;
+  }
+  goto dispose;
+error_capacity:
+  fprintf(stderr, "Error: Not enough memory\n");
+  goto error;
+error:
+  r = EXIT_FAILURE;
+  goto dispose;
+dispose:
+  if (lfd != -1) {
+    close(lfd);
+    unlink(path);
+  }
+  xwc_dispose(&s.x);
+  for (size_t k = 0; k < s.nnames; ++k) {
+    free(s.names[k]);
+  }
+  free(s.names);
+  return r;
+}
+
+//- COMPTAGE -------------------------------------------------------------------
+
+void on_signal([[maybe_unused]] int sig) {
+  interrupted = 1;
+}
+
+void cut_word(server *s, size_t file, const char *w, size_t len) {
+  fprintf(stderr, "%s: Word from file '%s' cut: '%.*s...'.\n", s->prog_name,
+      s->names[file], (int) len, w);
+}
+
+const char *xwc_error_text(int r) {
+  switch (r) {
+    case XWC_ERR_CAPACITY:
+      return "Not enough memory";
+    case XWC_ERR_READ:
+      return "Read error";
+    case XWC_ERR_THREADS:
+      return "Cannot start reading threads";
+    case XWC_ERR_STATE:
+      return "Operation not allowed";
+    case XWC_ERR_DECOMPRESS:
+      return "Cannot decompress file";
+    default:
+      return "Counting error";
+  }
+}
+
+int fail(server *s, const char *format, ...) {
+  va_list ap;
+  va_start(ap, format);
+  vsnprintf(s->err, sizeof s->err, format, ap);
+  va_end(ap);
+  return -1;
+}
+
+int broken(server *s, int r) {
+  s->broken = true;
+  return fail(s, "%s; the counts are no longer available",
+      xwc_error_text(r));
+}
+
+int add_name(server *s, const char *name) {
+  if (s->nnames == s->namescap) {
+    size_t cap = (s->namescap == 0 ? NAMES_CAPACITY_MIN
+        : s->namescap * NAMES_CAPACITY_MUL);
+    char **a = realloc(s->names, cap * sizeof *a);
+    if (a == NULL) {
+      return -1;
+    }
+    s->names = a;
+    s->namescap = cap;
+  }
+  char *copy = NULL;
+  if (name != NULL) {
+    copy = malloc(strlen(name) + 1);
+    if (copy == NULL) {
+      return -1;
+    }
+    strcpy(copy, name);
+  }
+  s->names[s->nnames] = copy;
+  s->nnames += 1;
+  return 0;
+}
+
+int load(server *s) {
+  for (size_t k = XWC_RESTRICT_FILE; k < s->nnames; ++k) {
+    if (s->names[k] == NULL) {
+      continue;
+    }
+    int r = (strcmp(s->names[k], STDIN_FNAME) == 0
+        ? xwc_feed_stream(s->x, k, stdin)
+        : xwc_feed_path(s->x, k, s->names[k]));
+    if (r != XWC_SUCCESS) {
+      return r;
+    }
+  }
+  return xwc_finish(s->x);
+}
+
+//- SOCKET ---------------------------------------------------------------------
+
+int listen_on(const char *prog_name, const char *path) {
+  struct sockaddr_un addr;
+  if (strlen(path) >= sizeof addr.sun_path) {
+    fprintf(stderr, "%s: socket name is too long: '%s'\n", prog_name, path);
+    return -1;
+  }
+  memset(&addr, 0, sizeof addr);
+  addr.sun_family = AF_UNIX;
+  strcpy(addr.sun_path, path);
+  struct stat st;
+  if (lstat(path, &st) == 0) {
+    if (!S_ISSOCK(st.st_mode)) {
+      fprintf(stderr, "%s: '%s' exists and is not a socket\n", prog_name,
+          path);
+      return -1;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd != -1
+        && connect(fd, (struct sockaddr *) &addr, sizeof addr) == 0) {
+      close(fd);
+      fprintf(stderr, "%s: another server is listening on '%s'\n",
+          prog_name, path);
+      return -1;
+    }
+    if (fd != -1) {
+      close(fd);
+    }
+    unlink(path);
+  }
+  int lfd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (lfd == -1) {
+    goto error;
+  }
+  if (bind(lfd, (struct sockaddr *) &addr, sizeof addr) != 0) {
+    close(lfd);
+    goto error;
+  }
+  if (listen(lfd, BACKLOG) != 0) {
+    close(lfd);
+    unlink(path);
+    goto error;
+  }
+  return lfd;
+error:
+  fprintf(stderr, "%s: cannot listen on '%s': %s\n", prog_name, path,
+      strerror(errno));
+  return -1;
+}
+
+int serve(server *s, int lfd) {
+  struct pollfd pfds[1 + CLIENTS_MAX];
+  conn conns[CLIENTS_MAX];
+  size_t nconns = 0;
+  int r = 0;
+  while (!s->stop && interrupted == 0) {
+    pfds[0] = (struct pollfd) { lfd, POLLIN, 0 };
+    for (size_t k = 0; k < nconns; ++k) {
+      pfds[1 + k] = (struct pollfd) { conns[k].fd, POLLIN, 0 };
+    }
+    if (poll(pfds, 1 + nconns, -1) == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      r = -1;
+      break;
+    }
+    //  Parcours à rebours : la connexion fermée est remplacée par la dernière,
+    //    qui a déjà été traitée.
+    for (size_t k = nconns; k > 0 && !s->stop; --k) {
+      if (pfds[k].revents != 0 && receive(s, &conns[k - 1]) != 0) {
+        close(conns[k - 1].fd);
+        free(conns[k - 1].buf);
+        conns[k - 1] = conns[nconns - 1];
+        nconns -= 1;
+      }
+    }
+    if (!s->stop && (pfds[0].revents & POLLIN) != 0) {
+      int fd = accept(lfd, NULL, NULL);
+      if (fd == -1) {
+        continue;
+      }
+      char *buf = (nconns < CLIENTS_MAX ? malloc(XWCD_LINE_MAX) : NULL);
+      if (buf == NULL) {
+        static const char busy[] = XWCD_STATUS_ERR " Too many clients\n\n";
+        write_all(fd, busy, sizeof busy - 1);
+        close(fd);
+        continue;
+      }
+      conns[nconns] = (conn) { fd, buf, 0 };
+      nconns += 1;
+    }
+  }
+  for (size_t k = 0; k < nconns; ++k) {
+    close(conns[k].fd);
+    free(conns[k].buf);
+  }
+  return r;
+}
+
+int receive(server *s, conn *c) {
+  ssize_t n = read(c->fd, c->buf + c->len, XWCD_LINE_MAX - c->len);
+  if (n <= 0) {
+    return n == -1 && errno == EINTR ? 0 : -1;
+  }
+  size_t start = c->len;
+  c->len += (size_t) n;
+  size_t first = 0;
+  char *eol;
+  while (!s->stop && (eol = memchr(c->buf + start, '\n',
+      c->len - start)) != NULL) {
+    *eol = '\0';
+    if (respond(s, c->fd, c->buf + first) != 0) {
+      return -1;
+    }
+    first = (size_t) (eol - c->buf) + 1;
+    start = first;
+  }
+  if (first == 0 && c->len == XWCD_LINE_MAX) {
+    static const char overlong[] = XWCD_STATUS_ERR " Request too long\n\n";
+    write_all(c->fd, overlong, sizeof overlong - 1);
+    return -1;
+  }
+  memmove(c->buf, c->buf + first, c->len - first);
+  c->len -= first;
+  return 0;
+}
+
+int respond(server *s, int fd, char *line) {
+  //  La réponse est préparée en mémoire pour être envoyée d'un seul appel. En
+  //    cas d'échec, les données déjà écrites sont abandonnées.
+  char *data = NULL;
+  size_t size = 0;
+  FILE *out = open_memstream(&data, &size);
+  if (out == NULL) {
+    return -1;
+  }
+  fputs(XWCD_STATUS_OK "\n", out);
+  int d = dispatch(s, line, out);
+  fputc('\n', out);
+  if (fclose(out) != 0) {
+    free(data);
+    return -1;
+  }
+  int r;
+  if (d == 0) {
+    r = write_all(fd, data, size);
+  } else {
+    char msg[ERR_MSG_LEN + sizeof XWCD_STATUS_ERR + 3];
+    int len = snprintf(msg, sizeof msg, XWCD_STATUS_ERR " %s\n\n", s->err);
+    r = write_all(fd, msg, (size_t) len);
+  }
+  free(data);
+  return r;
+}
+
+//- COMMANDES ------------------------------------------------------------------
+
+int dispatch(server *s, char *line, FILE *out) {
+  size_t n = strcspn(line, " ");
+  char *args = line + n;
+  if (*args != '\0') {
+    *args = '\0';
+    ++args;
+  }
+  if (strcmp(line, XWCD_CMD_SHUTDOWN) == 0) {
+    s->stop = true;
+    return 0;
+  }
+  if (strcmp(line, XWCD_CMD_FILES) == 0) {
+    return cmd_files(s, out);
+  }
+  bool known = strcmp(line, XWCD_CMD_ADD) == 0
+    || strcmp(line, XWCD_CMD_QUERY) == 0 || strcmp(line, XWCD_CMD_DUMP) == 0;
+  if (!known) {
+    return fail(s, "Unknown command '%.64s'", line);
+  }
+  if (s->broken) {
+    return fail(s, "The counts are no longer available");
+  }
+  if (strcmp(line, XWCD_CMD_ADD) == 0) {
+    return cmd_add(s, args, out);
+  }
+  if (strcmp(line, XWCD_CMD_QUERY) == 0) {
+    return cmd_query(s, args, out);
+  }
+  return cmd_dump(s, args, out);
+}
+
+int cmd_add(server *s, char *args, FILE *out) {
+  if (*args != '/') {
+    return fail(s, "An absolute path is required");
+  }
+  //  Le fichier est ouvert ici plutôt que par xwc_feed_path : un fichier
+  //    introuvable ne rend pas le contexte inutilisable.
+  FILE *f = fopen(args, "r");
+  if (f == NULL) {
+    return fail(s, "Cannot open '%.128s': %s", args, strerror(errno));
+  }
+  size_t file = s->nnames;
+  if (add_name(s, args) != 0) {
+    fclose(f);
+    return fail(s, "Not enough memory");
+  }
+  int r = xwc_feed_stream(s->x, file, f);
+  if (fclose(f) != 0 && r == XWC_SUCCESS) {
+    r = XWC_ERR_READ;
+  }
+  if (r == XWC_SUCCESS) {
+    r = xwc_finish(s->x);
+  }
+  if (r != XWC_SUCCESS) {
+    return broken(s, r);
+  }
+  fprintf(out, "%zu\n", file);
+  return 0;
+}
+
+int cmd_query(server *s, char *args, FILE *out) {
+  char *save;
+  for (char *w = strtok_r(args, " ", &save); w != NULL;
+      w = strtok_r(NULL, " ", &save)) {
+    size_t file;
+    long int occ;
+    int r = xwc_query(s->x, w, strlen(w), &file, &occ);
+    if (r != XWC_SUCCESS) {
+      return broken(s, r);
+    }
+    if (occ == 0) {
+      fprintf(out, "%s\t-\t0\n", w);
+    } else {
+      fprintf(out, "%s\t%zu\t%ld\n", w, file, occ);
+    }
+  }
+  return 0;
+}
+
+int cmd_dump(server *s, char *args, FILE *out) {
+  bool sorted = false;
+  bool reversed = false;
+  char *save;
+  for (char *a = strtok_r(args, " ", &save); a != NULL;
+      a = strtok_r(NULL, " ", &save)) {
+    if (strcmp(a, XWCD_ARG_SORT_LEX) == 0) {
+      sorted = true;
+    } else if (strcmp(a, XWCD_ARG_SORT_NONE) == 0) {
+      sorted = false;
+    } else if (strcmp(a, XWCD_ARG_REVERSE) == 0) {
+      reversed = true;
+    } else {
+      return fail(s, "Unknown argument '%.64s'", a);
+    }
+  }
+  xwc_order order = (!sorted ? XWC_ORDER_NONE
+      : reversed ? XWC_ORDER_DESCENDING : XWC_ORDER_ASCENDING);
+  int r = xwc_apply(s->x, order, out, NULL,
+      (int (*)(void *, const char *, size_t, size_t, long int))print_tuple);
+  if (r != XWC_SUCCESS) {
+    return broken(s, r);
+  }
+  return 0;
+}
+
+int cmd_files(server *s, FILE *out) {
+  for (size_t k = XWC_RESTRICT_FILE; k < s->nnames; ++k) {
+    if (s->names[k] != NULL) {
+      fprintf(out, "%zu\t%s\n", k, s->names[k]);
+    }
+  }
+  return 0;
+}
+
+int print_tuple(FILE *out, const char *w, size_t len, size_t file,
+    long int occ) {
+  fwrite(w, 1, len, out);
+  fprintf(out, "\t%zu\t%ld\n", file, occ);
+  return 0;
+}
+
+//- OUTILS ---------------------------------------------------------------------
+
+int write_all(int fd, const char *buf, size_t n) {
+  while (n != 0) {
+    ssize_t k = write(fd, buf, n);
+    if (k == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return -1;
+    }
+    buf += k;
+    n -= (size_t) k;
+  }
+  return 0;
+}
+
+int parse_count(const char *s, size_t *vptr) {
+  char *end;
+  errno = 0;
+  unsigned long long int v = strtoull(s, &end, 10);
+  if (!isdigit((unsigned char) *s) || *end != '\0' || errno == ERANGE
+      || v > SIZE_MAX) {
+    return -1;
+  }
+  *vptr = (size_t) v;
+  return 0;
+}
+
+void print_usage(const char *prog_name) {
+  fprintf(stderr, "Usage: %s [-p] [-f] [-i VALUE] [-r FILE] [--utf8] "
+      "[--dictionary=TYPE] [--threads=N] [--expected-words=N] [-S PATH] "
+      "[FILE]...\n", prog_name);
+}
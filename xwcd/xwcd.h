@@ -0,0 +1,50 @@
+//  xwcd.h : protocole de dialogue entre le démon xwcd, qui garde en mémoire
+//    les comptes de mots exclusifs d'un ensemble de fichiers, et ses clients.
+
+#ifndef XWCD__H
+#define XWCD__H
+
+//  Fonctionnement général :
+//  - le démon écoute sur une socket locale de type flot (domaine AF_UNIX),
+//      dont le nom par défaut est XWCD_SOCKET_DEF ;
+//  - une requête est une ligne terminée par '\n', d'au plus XWCD_LINE_MAX
+//      octets fin de ligne comprise, formée d'une commande suivie de ses
+//      arguments, séparés par des espaces ;
+//  - la réponse débute par une ligne d'état, XWCD_STATUS_OK ou
+//      XWCD_STATUS_ERR suivi d'un espace et d'un message, se poursuit en cas
+//      de succès par des lignes de données et se termine par une ligne vide.
+//      Un mot n'est jamais vide et ne contient ni espace ni fin de ligne : une
+//      ligne de données ne peut pas être vide ;
+//  - les lignes de données d'un mot sont de la forme « mot\tfichier\tocc »,
+//      où fichier est l'indice du seul fichier où le mot apparaît et occ son
+//      nombre d'occurrences, ou de la forme « mot\t-\t0 » si le mot n'est pas
+//      exclusif ;
+//  - les commandes sont :
+//      XWCD_CMD_ADD CHEMIN : compte les mots du fichier de chemin absolu
+//        CHEMIN, qui reçoit l'indice suivant ; la donnée est cet indice ;
+//      XWCD_CMD_QUERY MOT... : une ligne de données par MOT, recherché après
+//        avoir été tronqué et plié comme les mots des fichiers, mais repris
+//        tel qu'il a été envoyé ;
+//      XWCD_CMD_DUMP [ORDRE] [XWCD_ARG_REVERSE] : une ligne de données par
+//        mot exclusif, dans l'ordre ORDRE, XWCD_ARG_SORT_LEX ou
+//        XWCD_ARG_SORT_NONE, ce dernier par défaut ;
+//      XWCD_CMD_FILES : une ligne « indice\tnom » par fichier compté ;
+//      XWCD_CMD_SHUTDOWN : arrête le démon après sa réponse.
+
+#define XWCD_SOCKET_DEF     "/tmp/xwcd.socket"
+#define XWCD_LINE_MAX       65536
+
+#define XWCD_STATUS_OK      "OK"
+#define XWCD_STATUS_ERR     "ERR"
+
+#define XWCD_CMD_ADD        "ADD"
+#define XWCD_CMD_QUERY      "QUERY"
+#define XWCD_CMD_DUMP       "DUMP"
+#define XWCD_CMD_FILES      "FILES"
+#define XWCD_CMD_SHUTDOWN   "SHUTDOWN"
+
+#define XWCD_ARG_SORT_LEX   "lexicographical"
+#define XWCD_ARG_SORT_NONE  "none"
+#define XWCD_ARG_REVERSE    "reverse"
+
+#endif
@@ -0,0 +1,184 @@
+//  xwcq.c : client en ligne de commande du démon xwcd. Envoie une requête
+//    formée de la commande et de ses arguments, affiche les données de la
+//    réponse sur la sortie standard ou son message d'erreur sur la sortie
+//    erreur.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "xwcd.h"
+
+//- PROTOTYPES -----------------------------------------------------------------
+
+//  connect_to : tente de se connecter à la socket de nom path. Renvoie la
+//    socket en cas de succès, -1 sinon.
+static int connect_to(const char *path);
+
+//  append : ajoute à la requête req, de longueur *lenptr, le caractère sep
+//    s'il n'est pas nul puis la chaîne s. Renvoie une valeur non nulle si la
+//    requête dépasse la longueur maximale, zéro sinon.
+static int append(char *req, size_t *lenptr, char sep, const char *s);
+
+static void print_usage(const char *prog_name);
+
+//- MAIN -----------------------------------------------------------------------
+
+int main(int argc, char **argv) {
+  const char *path = XWCD_SOCKET_DEF;
+  int c;
+  while ((c = getopt(argc, argv, "S:")) != -1) {
+    switch (c) {
+      case 'S':
+        path = optarg;
+        break;
+      default:
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+  }
+  if (optind == argc) {
+    print_usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+  //  La commande est mise en majuscules ; le chemin d'un fichier ajouté est
+  //    rendu absolu, le démon n'ayant pas le même répertoire courant.
+  char *req = malloc(XWCD_LINE_MAX);
+  if (req == NULL) {
+    fprintf(stderr, "Error: Not enough memory\n");
+    return EXIT_FAILURE;
+  }
+  size_t len = 0;
+  for (char *q = argv[optind]; *q != '\0'; ++q) {
+    *q = (char) toupper((unsigned char) *q);
+  }
+  bool add = strcmp(argv[optind], XWCD_CMD_ADD) == 0;
+  if (add && argc - optind != 2) {
+    print_usage(argv[0]);
+    goto error;
+  }
+  for (int k = optind; k < argc; ++k) {
+    int r;
+    if (add && k > optind && argv[k][0] != '/') {
+      char cwd[PATH_MAX];
+      if (getcwd(cwd, sizeof cwd) == NULL) {
+        goto error_io;
+      }
+      r = append(req, &len, ' ', cwd);
+      if (r == 0) {
+        r = append(req, &len, strcmp(cwd, "/") == 0 ? '\0' : '/', argv[k]);
+      }
+    } else {
+      r = append(req, &len, len != 0 ? ' ' : '\0', argv[k]);
+    }
+    if (r != 0) {
+      fprintf(stderr, "%s: request is too long\n", argv[0]);
+      goto error;
+    }
+  }
+  req[len] = '\n';
+  len += 1;
+  int fd = connect_to(path);
+  if (fd == -1) {
+    fprintf(stderr, "%s: cannot connect to '%s': %s\n", argv[0], path,
+        strerror(errno));
+    goto error;
+  }
+  FILE *f = fdopen(fd, "r+");
+  if (f == NULL) {
+    close(fd);
+    goto error_io;
+  }
+  if (fwrite(req, 1, len, f) != len || fflush(f) != 0) {
+    fclose(f);
+    goto error_io;
+  }
+  //  Réponse : ligne d'état, lignes de données, ligne vide.
+  char *line = NULL;
+  size_t cap = 0;
+  ssize_t n = getline(&line, &cap, f);
+  bool ok = n > 0 && strcmp(line, XWCD_STATUS_OK "\n") == 0;
+  if (!ok) {
+    if (n > (ssize_t) sizeof XWCD_STATUS_ERR
+        && strncmp(line, XWCD_STATUS_ERR " ", sizeof XWCD_STATUS_ERR) == 0) {
+      fprintf(stderr, "%s: %s", argv[0], line + sizeof XWCD_STATUS_ERR);
+    } else {
+      fprintf(stderr, "%s: invalid response\n", argv[0]);
+    }
+  }
+  bool done = false;
+  while (ok && (n = getline(&line, &cap, f)) > 0) {
+    if (strcmp(line, "\n") == 0) {
+      done = true;
+      break;
+    }
+    fputs(line, stdout);
+  }
+  free(line);
+  fclose(f);
+  free(req);
+  if (ok && !done) {
+    fprintf(stderr, "%s: truncated response\n", argv[0]);
+  }
+  return ok && done ? EXIT_SUCCESS : EXIT_FAILURE;
+error_io:
+  fprintf(stderr, "%s: %s\n", argv[0], strerror(errno));
+  goto error;
+error:
+  free(req);
+  return EXIT_FAILURE;
+}
+
+//- OUTILS ---------------------------------------------------------------------
+
+int connect_to(const char *path) {
+  struct sockaddr_un addr;
+  if (strlen(path) >= sizeof addr.sun_path) {
+    errno = ENAMETOOLONG;
+    return -1;
+  }
+  memset(&addr, 0, sizeof addr);
+  addr.sun_family = AF_UNIX;
+  strcpy(addr.sun_path, path);
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd == -1) {
+    return -1;
+  }
+  if (connect(fd, (struct sockaddr *) &addr, sizeof addr) != 0) {
+    int e = errno;
+    close(fd);
+    errno = e;
+    return -1;
+  }
+  return fd;
+}
+
+int append(char *req, size_t *lenptr, char sep, const char *s) {
+  size_t n = strlen(s);
+  size_t k = (sep != '\0' ? 1 : 0);
+  //  Un octet est réservé pour la fin de ligne.
+  if (n + k >= XWCD_LINE_MAX - *lenptr) {
+    return -1;
+  }
+  if (k != 0) {
+    req[*lenptr] = sep;
+  }
+  memcpy(req + *lenptr + k, s, n);
+  *lenptr += k + n;
+  return 0;
+}
+
+void print_usage(const char *prog_name) {
+  fprintf(stderr, "Usage: %s [-S PATH] COMMAND [ARG]...\n"
+      "Commands: " XWCD_CMD_ADD " FILE | " XWCD_CMD_QUERY " WORD... | "
+      XWCD_CMD_DUMP " [" XWCD_ARG_SORT_LEX "|" XWCD_ARG_SORT_NONE "] ["
+      XWCD_ARG_REVERSE "] | " XWCD_CMD_FILES " | " XWCD_CMD_SHUTDOWN "\n",
+      prog_name);
+}
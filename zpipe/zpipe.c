@@ -0,0 +1,352 @@
+//  zpipe.c : partie implantation d'un module pour la décompression, par un fil
+//    d'exécution dédié, d'un fichier compressé au format gzip ou zstd.
+
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <zlib.h>
+
+#if defined ZPIPE_WITH_ZSTD && ZPIPE_WITH_ZSTD != 0
+#define ZPIPE__ZSTD 1
+#include <zstd.h>
+#else
+#define ZPIPE__ZSTD 0
+#endif
+
+#include "zpipe.h"
+
+//  Nombres magiques des formats : RFC 1952 pour gzip, RFC 8878 pour zstd.
+#define ZPIPE__GZIP_MAGIC "\x1f\x8b"
+#define ZPIPE__ZSTD_MAGIC "\x28\xb5\x2f\xfd"
+#define ZPIPE__MAGIC_MAX  4
+
+//  ZPIPE__INSIZE : taille du buffer d'octets compressés.
+#define ZPIPE__INSIZE ((size_t) 1 << 18)
+
+//  ZPIPE__STRIDE : écart entre les adresses de deux buffers consécutifs.
+#define ZPIPE__STRIDE (ZPIPE_HEADROOM + ZPIPE_BUFSIZE)
+
+//  Valeurs renvoyées par les fonctions de décompression.
+enum {
+  ZPIPE__MORE,
+  ZPIPE__END,
+  ZPIPE__ERROR,
+};
+
+//  struct zpipe, zpipe : les buffers sont numérotés dans l'ordre et rangés
+//    dans le tableau bufs, le buffer de numéro n à l'adresse bufs + (n modulo
+//    ZPIPE_NBUFS) * ZPIPE__STRIDE + ZPIPE_HEADROOM et sa longueur au rang n
+//    modulo ZPIPE_NBUFS du tableau lens. Les buffers de numéros compris entre
+//    freed et filled (exclu) sont remplis, ceux de numéros inférieurs à next
+//    ont été renvoyés par zpipe_next. Les numéros, les indicateurs done,
+//    failed et cancelled ainsi que in sont protégés par lock ; full signale au
+//    fil appelant qu'un buffer est rempli ou que la décompression est achevée,
+//    empty au fil de décompression qu'un buffer est rendu ou que la
+//    décompression est interrompue. Les autres composants sont propres au fil
+//    de décompression : le buffer inbuf, de longueur inlen, reçoit les nread
+//    derniers octets lus ; member_end indique que le dernier membre gzip ou la
+//    dernière trame zstd décompressés sont complets.
+struct zpipe {
+  FILE *stream;
+  int format;
+  char *bufs;
+  size_t lens[ZPIPE_NBUFS];
+  size_t filled;
+  size_t freed;
+  size_t next;
+  bool done;
+  bool failed;
+  bool cancelled;
+  size_t in;
+  pthread_t thread;
+  pthread_mutex_t lock;
+  pthread_cond_t full;
+  pthread_cond_t empty;
+  char *inbuf;
+  size_t inlen;
+  size_t nread;
+  bool member_end;
+  z_stream zs;
+#if ZPIPE__ZSTD
+  ZSTD_DStream *ds;
+  ZSTD_inBuffer zin;
+#endif
+};
+
+//  zpipe__run : boucle du fil de décompression associé à zp.
+static void *zpipe__run(zpipe *zp);
+
+//  zpipe__fill : tente de remplir le buffer d'octets compressés associé à zp.
+//    Renvoie false à la fin du flot ou en cas d'erreur de lecture, true sinon.
+static bool zpipe__fill(zpipe *zp);
+
+//  zpipe__gzip, zpipe__zstd : décompressent au format gzip ou zstd au plus
+//    size octets à l'adresse dest et affectent leur nombre à *nptr. Renvoient
+//    ZPIPE__MORE si size octets ont été décompressés, ZPIPE__END à la fin des
+//    données compressées, ZPIPE__ERROR si elles sont invalides ou tronquées ou
+//    en cas d'erreur de lecture.
+static int zpipe__gzip(zpipe *zp, char *dest, size_t size, size_t *nptr);
+#if ZPIPE__ZSTD
+static int zpipe__zstd(zpipe *zp, char *dest, size_t size, size_t *nptr);
+#endif
+
+int zpipe_format(int fd) {
+  struct stat st;
+  if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+    return ZPIPE_PLAIN;
+  }
+  unsigned char m[ZPIPE__MAGIC_MAX];
+  ssize_t n = pread(fd, m, sizeof m, 0);
+  if (n >= (ssize_t) sizeof ZPIPE__ZSTD_MAGIC - 1
+      && memcmp(m, ZPIPE__ZSTD_MAGIC, sizeof ZPIPE__ZSTD_MAGIC - 1) == 0) {
+    return ZPIPE_ZSTD;
+  }
+  if (n >= (ssize_t) sizeof ZPIPE__GZIP_MAGIC - 1
+      && memcmp(m, ZPIPE__GZIP_MAGIC, sizeof ZPIPE__GZIP_MAGIC - 1) == 0) {
+    return ZPIPE_GZIP;
+  }
+  return ZPIPE_PLAIN;
+}
+
+bool zpipe_supported(int format) {
+  return format == ZPIPE_GZIP || (ZPIPE__ZSTD && format == ZPIPE_ZSTD);
+}
+
+zpipe *zpipe_open(FILE *f, int format) {
+  if (!zpipe_supported(format)) {
+    return NULL;
+  }
+  zpipe *zp = malloc(sizeof *zp);
+  if (zp == NULL) {
+    return NULL;
+  }
+  zp->stream = f;
+  zp->format = format;
+  zp->bufs = malloc(ZPIPE_NBUFS * ZPIPE__STRIDE);
+  zp->inbuf = malloc(ZPIPE__INSIZE);
+  if (zp->bufs == NULL || zp->inbuf == NULL) {
+    goto error_capacity;
+  }
+  zp->filled = 0;
+  zp->freed = 0;
+  zp->next = 0;
+  zp->done = false;
+  zp->failed = false;
+  zp->cancelled = false;
+  zp->in = 0;
+  zp->inlen = 0;
+  zp->nread = 0;
+  zp->member_end = false;
+  if (format == ZPIPE_GZIP) {
+    zp->zs = (z_stream) { 0 };
+    //  15 + 16 : fenêtre maximale, en-tête et pied gzip.
+    if (inflateInit2(&zp->zs, 15 + 16) != Z_OK) {
+      goto error_capacity;
+    }
+  }
+#if ZPIPE__ZSTD
+  if (format == ZPIPE_ZSTD) {
+    zp->ds = ZSTD_createDStream();
+    if (zp->ds == NULL) {
+      goto error_capacity;
+    }
+    ZSTD_initDStream(zp->ds);
+    zp->zin = (ZSTD_inBuffer) { zp->inbuf, 0, 0 };
+  }
+#endif
+  pthread_mutex_init(&zp->lock, NULL);
+  pthread_cond_init(&zp->full, NULL);
+  pthread_cond_init(&zp->empty, NULL);
+  if (pthread_create(&zp->thread, NULL, (void *(*)(void *))zpipe__run, zp)
+      != 0) {
+    pthread_mutex_destroy(&zp->lock);
+    pthread_cond_destroy(&zp->full);
+    pthread_cond_destroy(&zp->empty);
+    if (format == ZPIPE_GZIP) {
+      inflateEnd(&zp->zs);
+    }
+#if ZPIPE__ZSTD
+    if (format == ZPIPE_ZSTD) {
+      ZSTD_freeDStream(zp->ds);
+    }
+#endif
+    goto error_capacity;
+  }
+  return zp;
+error_capacity:
+  free(zp->bufs);
+  free(zp->inbuf);
+  free(zp);
+  return NULL;
+}
+
+char *zpipe_next(zpipe *zp, size_t *nptr) {
+  pthread_mutex_lock(&zp->lock);
+  if (zp->freed < zp->next) {
+    zp->freed += 1;
+    pthread_cond_signal(&zp->empty);
+  }
+  while (zp->next == zp->filled && !zp->done) {
+    pthread_cond_wait(&zp->full, &zp->lock);
+  }
+  if (zp->next == zp->filled) {
+    pthread_mutex_unlock(&zp->lock);
+    return NULL;
+  }
+  size_t k = zp->next % ZPIPE_NBUFS;
+  zp->next += 1;
+  *nptr = zp->lens[k];
+  pthread_mutex_unlock(&zp->lock);
+  return zp->bufs + k * ZPIPE__STRIDE + ZPIPE_HEADROOM;
+}
+
+size_t zpipe_in(zpipe *zp) {
+  pthread_mutex_lock(&zp->lock);
+  size_t in = zp->in;
+  pthread_mutex_unlock(&zp->lock);
+  return in;
+}
+
+int zpipe_close(zpipe **zpptr) {
+  zpipe *zp = *zpptr;
+  if (zp == NULL) {
+    return 0;
+  }
+  pthread_mutex_lock(&zp->lock);
+  zp->cancelled = true;
+  pthread_cond_signal(&zp->empty);
+  pthread_mutex_unlock(&zp->lock);
+  pthread_join(zp->thread, NULL);
+  pthread_mutex_destroy(&zp->lock);
+  pthread_cond_destroy(&zp->full);
+  pthread_cond_destroy(&zp->empty);
+  if (zp->format == ZPIPE_GZIP) {
+    inflateEnd(&zp->zs);
+  }
+#if ZPIPE__ZSTD
+  if (zp->format == ZPIPE_ZSTD) {
+    ZSTD_freeDStream(zp->ds);
+  }
+#endif
+  int r = zp->failed ? -1 : 0;
+  free(zp->bufs);
+  free(zp->inbuf);
+  free(zp);
+  *zpptr = NULL;
+  return r;
+}
+
+void *zpipe__run(zpipe *zp) {
+  int r = ZPIPE__MORE;
+  while (r == ZPIPE__MORE) {
+    pthread_mutex_lock(&zp->lock);
+    while (zp->filled - zp->freed == ZPIPE_NBUFS && !zp->cancelled) {
+      pthread_cond_wait(&zp->empty, &zp->lock);
+    }
+    if (zp->cancelled) {
+      pthread_mutex_unlock(&zp->lock);
+      break;
+    }
+    size_t k = zp->filled % ZPIPE_NBUFS;
+    pthread_mutex_unlock(&zp->lock);
+    char *dest = zp->bufs + k * ZPIPE__STRIDE + ZPIPE_HEADROOM;
+    size_t n;
+#if ZPIPE__ZSTD
+    r = (zp->format == ZPIPE_GZIP ? zpipe__gzip(zp, dest, ZPIPE_BUFSIZE, &n)
+        : zpipe__zstd(zp, dest, ZPIPE_BUFSIZE, &n));
+#else
+    r = zpipe__gzip(zp, dest, ZPIPE_BUFSIZE, &n);
+#endif
+    pthread_mutex_lock(&zp->lock);
+    if (n != 0) {
+      zp->lens[k] = n;
+      zp->filled += 1;
+    }
+    zp->in = zp->nread;
+    zp->done = (r != ZPIPE__MORE);
+    zp->failed = (r == ZPIPE__ERROR);
+    pthread_cond_signal(&zp->full);
+    pthread_mutex_unlock(&zp->lock);
+  }
+  return NULL;
+}
+
+bool zpipe__fill(zpipe *zp) {
+  zp->inlen = fread(zp->inbuf, 1, ZPIPE__INSIZE, zp->stream);
+  zp->nread += zp->inlen;
+  return zp->inlen != 0;
+}
+
+int zpipe__gzip(zpipe *zp, char *dest, size_t size, size_t *nptr) {
+  z_stream *zs = &zp->zs;
+  zs->next_out = (Bytef *) dest;
+  zs->avail_out = (uInt) size;
+  int r = ZPIPE__MORE;
+  while (zs->avail_out != 0) {
+    int z = (zp->member_end ? Z_BUF_ERROR : inflate(zs, Z_NO_FLUSH));
+    if (z == Z_STREAM_END) {
+      zp->member_end = true;
+      continue;
+    }
+    if (z == Z_OK) {
+      continue;
+    }
+    //  Z_BUF_ERROR : aucun progrès n'est possible sans nouveaux octets.
+    if (z != Z_BUF_ERROR || (zs->avail_in != 0 && !zp->member_end)) {
+      r = ZPIPE__ERROR;
+      break;
+    }
+    if (zs->avail_in == 0) {
+      if (!zpipe__fill(zp)) {
+        r = (zp->member_end && !ferror(zp->stream) ? ZPIPE__END
+            : ZPIPE__ERROR);
+        break;
+      }
+      zs->next_in = (Bytef *) zp->inbuf;
+      zs->avail_in = (uInt) zp->inlen;
+    }
+    //  Un fichier gzip peut être la concaténation de plusieurs membres.
+    if (zp->member_end) {
+      if (inflateReset(zs) != Z_OK) {
+        r = ZPIPE__ERROR;
+        break;
+      }
+      zp->member_end = false;
+    }
+  }
+  *nptr = size - zs->avail_out;
+  return r;
+}
+
+#if ZPIPE__ZSTD
+
+int zpipe__zstd(zpipe *zp, char *dest, size_t size, size_t *nptr) {
+  ZSTD_outBuffer out = { dest, size, 0 };
+  int r = ZPIPE__MORE;
+  while (out.pos < out.size) {
+    size_t ipos = zp->zin.pos;
+    size_t opos = out.pos;
+    //  Une valeur nulle signale la fin d'une trame ; la suivante éventuelle
+    //    est décompressée à l'appel suivant.
+    size_t z = ZSTD_decompressStream(zp->ds, &out, &zp->zin);
+    if (ZSTD_isError(z)) {
+      r = ZPIPE__ERROR;
+      break;
+    }
+    if (zp->zin.pos != ipos || out.pos != opos) {
+      zp->member_end = (z == 0);
+      continue;
+    }
+    if (!zpipe__fill(zp)) {
+      r = (zp->member_end && !ferror(zp->stream) ? ZPIPE__END : ZPIPE__ERROR);
+      break;
+    }
+    zp->zin = (ZSTD_inBuffer) { zp->inbuf, zp->inlen, 0 };
+  }
+  *nptr = out.pos;
+  return r;
+}
+
+#endif
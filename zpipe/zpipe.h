@@ -0,0 +1,78 @@
+//  zpipe.h : partie interface d'un module pour la décompression, par un fil
+//    d'exécution dédié, d'un fichier compressé au format gzip ou zstd.
+
+#ifndef ZPIPE__H
+#define ZPIPE__H
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+//  Fonctionnement général :
+//  - le format d'un fichier est reconnu à ses premiers octets, lus sans
+//      modifier la position courante ;
+//  - un fil d'exécution lit le fichier compressé et remplit à l'avance, dans
+//      un tableau circulaire de ZPIPE_NBUFS buffers de ZPIPE_BUFSIZE octets,
+//      les octets décompressés, pendant que le fil appelant consomme les
+//      buffers déjà remplis. La décompression et le traitement des octets
+//      décompressés occupent ainsi deux cœurs ;
+//  - le format zstd n'est pris en charge que si le module est compilé avec
+//      la macro ZPIPE_WITH_ZSTD définie et non nulle, et lié à la bibliothèque
+//      zstd.
+
+//  ZPIPE_BUFSIZE, ZPIPE_NBUFS : taille et nombre des buffers d'octets
+//    décompressés.
+#define ZPIPE_BUFSIZE ((size_t) 1 << 20)
+#define ZPIPE_NBUFS   4
+
+//  ZPIPE_HEADROOM : nombre d'octets qui précèdent chaque buffer et que le fil
+//    appelant peut modifier.
+#define ZPIPE_HEADROOM 8
+
+//  Formats de fichier.
+enum {
+  ZPIPE_PLAIN,
+  ZPIPE_GZIP,
+  ZPIPE_ZSTD,
+};
+
+//  zpipe_format : renvoie le format du fichier ordinaire ouvert associé au
+//    descripteur fd, ZPIPE_PLAIN s'il n'est pas compressé, n'est pas un
+//    fichier ordinaire ou ne peut être lu.
+extern int zpipe_format(int fd);
+
+//  zpipe_supported : renvoie true si le format format est pris en charge,
+//    false sinon.
+extern bool zpipe_supported(int format);
+
+//  struct zpipe, zpipe : type et nom de type d'un contrôleur regroupant les
+//    informations nécessaires pour gérer une décompression.
+typedef struct zpipe zpipe;
+
+//  zpipe_open : tente d'allouer les ressources nécessaires pour gérer la
+//    décompression du flot f, supposé au format format pris en charge et lu
+//    depuis sa position courante, puis de lancer le fil d'exécution associé.
+//    Renvoie NULL en cas de dépassement de capacité ou si le fil d'exécution
+//    ne peut être lancé. Renvoie sinon un pointeur vers le contrôleur associé
+//    à la décompression.
+extern zpipe *zpipe_open(FILE *f, int format);
+
+//  zpipe_next : rend le buffer renvoyé par l'appel précédent puis attend que
+//    le suivant soit rempli. Renvoie NULL à la fin de la décompression ou si
+//    elle a échoué. Renvoie sinon l'adresse des octets décompressés suivants
+//    et affecte leur nombre, non nul, à *nptr. Les octets demeurent valides
+//    jusqu'à l'appel suivant.
+extern char *zpipe_next(zpipe *zp, size_t *nptr);
+
+//  zpipe_in : renvoie le nombre d'octets compressés lus jusqu'ici pour la
+//    décompression associée à zp.
+extern size_t zpipe_in(zpipe *zp);
+
+//  zpipe_close : interrompt si besoin la décompression associée à *zpptr,
+//    libère les ressources allouées à sa gestion puis affecte NULL à *zpptr.
+//    Sans effet si *zpptr vaut NULL. Renvoie une valeur non nulle si une
+//    erreur de lecture est survenue ou si les données compressées sont
+//    invalides ou tronquées, zéro sinon.
+extern int zpipe_close(zpipe **zpptr);
+
+#endif